@@ -152,6 +152,8 @@ int main (int argc, char *argv[])
     //
     bool isHighRTT = false;
 
+    bool queueTelemetry = false;
+
     CommandLine cmd;
     cmd.AddValue ("id", "The running ID", id);
     cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, DcTcp", transportProt);
@@ -183,6 +185,8 @@ int main (int argc, char *argv[])
 
     cmd.AddValue ("HighRTT", "Whether to enable high RTT", isHighRTT);
 
+    cmd.AddValue ("queueTelemetry", "Whether to dump the queue disc events for queue_analyze.py instead of sampling the queue length", queueTelemetry);
+
     // cmd.AddValue ("enableIncast", "Whether to enable incast", enableIncast);
 
     cmd.Parse (argc, argv);
@@ -328,52 +332,37 @@ int main (int argc, char *argv[])
     NetDeviceContainer switchToRecvNetDeviceContainer = p2p.Install (switchToRecvNodeContainer);
 
 
-    Ptr<DWRRQueueDisc> dwrrQdisc = CreateObject<DWRRQueueDisc> ();
-    Ptr<Ipv4SimplePacketFilter> filter = CreateObject<Ipv4SimplePacketFilter> ();
-
-    dwrrQdisc->AddPacketFilter (filter);
-
-    ObjectFactory innerQueueFactory;
+    std::string innerQueueType;
     if (aqm == TCN)
     {
-        innerQueueFactory.SetTypeId ("ns3::TCNQueueDisc");
+        innerQueueType = "ns3::TCNQueueDisc";
     }
     else if (aqm == CODEL)
     {
-        innerQueueFactory.SetTypeId ("ns3::CoDelQueueDisc");
+        innerQueueType = "ns3::CoDelQueueDisc";
     }
     else if (aqm == PIE)
     {
-        innerQueueFactory.SetTypeId ("ns3::PieQueueDisc");
+        innerQueueType = "ns3::PieQueueDisc";
     }
     else
     {
-        innerQueueFactory.SetTypeId ("ns3::XXXQueueDisc");
-    }
-
-    /*
-    for (uint32_t i = 0; i < QUEUE_NUM; ++i)
-    {
-        Ptr<QueueDisc> queueDisc = innerQueueFactory.Create<QueueDisc> ();
-        dwrrQdisc->AddDWRRClass (queueDisc, i, 1500);
+        innerQueueType = "ns3::XXXQueueDisc";
     }
-    */
-
-    Ptr<QueueDisc> queueDisc1 = innerQueueFactory.Create<QueueDisc> ();
-    Ptr<QueueDisc> queueDisc2 = innerQueueFactory.Create<QueueDisc> ();
-    Ptr<QueueDisc> queueDisc3 = innerQueueFactory.Create<QueueDisc> ();
 
-    dwrrQdisc->AddDWRRClass (queueDisc1, 0, 3000);
-    dwrrQdisc->AddDWRRClass (queueDisc2, 1, 1500);
-    dwrrQdisc->AddDWRRClass (queueDisc3, 2, 1500);
+    uint16_t handle = tc.SetRootQueueDisc ("ns3::DWRRQueueDisc");
+    tc.AddPacketFilter (handle, "ns3::Ipv4SimplePacketFilter");
+    TrafficControlHelper::ClassIdList classes = tc.AddQueueDiscClasses (handle, 1, "ns3::DWRRClass",
+                                                                        "Quantum", UintegerValue (3000));
+    TrafficControlHelper::ClassIdList otherClasses = tc.AddQueueDiscClasses (handle, 2, "ns3::DWRRClass",
+                                                                             "Quantum", UintegerValue (1500));
+    classes.insert (classes.end (), otherClasses.begin (), otherClasses.end ());
+    tc.AddChildQueueDiscs (handle, classes, innerQueueType);
 
     Ptr<NetDevice> device = switchToRecvNetDeviceContainer.Get (0);
-    Ptr<TrafficControlLayer> tcl = device->GetNode ()->GetObject<TrafficControlLayer> ();
+    tc.Install (device);
+    Ptr<QueueDisc> dwrrQdisc = device->GetNode ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (device);
 
-    dwrrQdisc->SetNetDevice (device);
-    tcl->SetRootQueueDiscOnDevice (device, dwrrQdisc);
-
-    tc.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "Limit", UintegerValue (bufferSize));
     Ipv4InterfaceContainer switchToRecvIpv4Container = ipv4.Assign (switchToRecvNetDeviceContainer);
 
     //free_cdf (rttCdfTable);
@@ -509,7 +498,16 @@ int main (int argc, char *argv[])
     queuediscDataset.SetTitle ("queue_disc");
     queuediscDataset.SetStyle (Gnuplot2dDataset::LINES_POINTS);
 
-    Simulator::ScheduleNow (&CheckQueueDiscSize, dwrrQdisc);
+    if (queueTelemetry)
+    {
+        Ptr<QueueDiscTelemetry> telemetry = CreateObject<QueueDiscTelemetry> ();
+        telemetry->SetAttribute ("FileName", StringValue (GetFormatedStr (id, "queue_disc", "bin", aqm, load, CODELInterval, CODELTarget, TCNThreshold, numOfSenders)));
+        dwrrQdisc->SetTelemetry (telemetry);
+    }
+    else
+    {
+        Simulator::ScheduleNow (&CheckQueueDiscSize, dwrrQdisc);
+    }
 
     NS_LOG_INFO ("Enabling Flow Monitor");
     Ptr<FlowMonitor> flowMonitor;
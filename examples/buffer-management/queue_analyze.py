@@ -1,27 +1,77 @@
 import sys
+import struct
 
-def main(argv):
-
-    print "Reading ..."
+# The layout of QueueDiscTelemetrySample (src/traffic-control/model/queue-disc-telemetry.h)
+SAMPLE = struct.Struct ('<qqIIIB3x')
+HEADER = struct.Struct ('<8sIQ')
+MAGIC = 'QDTELEM\x01'
+DEQUEUE, DROP, MARK = 1, 2, 3
 
-    sum_value = 0
-    length = 0
-    value_list = []
-
-    with open (argv[1]) as f:
+def read_plt (name):
+    values = []
+    with open (name) as f:
         read_data = f.readlines()[4:-1]
-    f.closed
     for line in read_data:
         splited_data = line.split (' ', 1)
-        value = int (splited_data[1])
-        sum_value += value
-        length += 1
-        value_list.append(value)
+        values.append ((int (splited_data[1]), 1))
+    return values, None, None
+
+def read_telemetry (name):
+    with open (name, 'rb') as f:
+        data = f.read ()
+    magic, sample_size, steps_per_second = HEADER.unpack_from (data, 0)
+    if sample_size != SAMPLE.size:
+        raise ValueError ("Unexpected sample size %d" % sample_size)
+
+    # Weight every queue length by the time it lasted
+    values = []
+    sojourns = []
+    counts = {DROP: 0, MARK: 0}
+    last_time = None
+    last_packets = 0
+    for offset in xrange (HEADER.size, len (data) - SAMPLE.size + 1, SAMPLE.size):
+        time, sojourn, nbytes, packets, size, event = SAMPLE.unpack_from (data, offset)
+        if last_time is not None and time > last_time:
+            values.append ((last_packets, time - last_time))
+        last_time = time
+        last_packets = packets
+        if event == DEQUEUE:
+            sojourns.append (sojourn * 1e6 / steps_per_second)
+        elif event in counts:
+            counts[event] += 1
+    return values, sojourns, counts
+
+def percentile (weighted, p):
+    weighted = sorted (weighted)
+    total = sum (w for v, w in weighted)
+    acc = 0
+    for v, w in weighted:
+        acc += w
+        if acc >= total * p:
+            return v
+    return weighted[-1][0]
+
+def main(argv):
+
+    print "Reading ..."
+
+    with open (argv[1], 'rb') as f:
+        is_telemetry = f.read (len (MAGIC)) == MAGIC
+    if is_telemetry:
+        values, sojourns, counts = read_telemetry (argv[1])
+    else:
+        values, sojourns, counts = read_plt (argv[1])
 
-    value_list.sort ()
+    total = sum (w for v, w in values)
+    print "The average queue length: %f" % (sum (v * w for v, w in values) / float (total))
+    print "The 99 queue length: %f" % percentile (values, 0.99)
 
-    print "The average queue length: %f" % (sum_value / length)
-    print "The 99 queue length: %f" % (value_list[int(length * 0.99)])
+    if sojourns:
+        sojourns.sort ()
+        print "The average sojourn time (us): %f" % (sum (sojourns) / len (sojourns))
+        print "The 99 sojourn time (us): %f" % sojourns[int (len (sojourns) * 0.99)]
+    if counts:
+        print "Dropped packets: %d, marked packets: %d" % (counts[DROP], counts[MARK])
 
 if __name__ == '__main__':
     main (sys.argv)
@@ -343,6 +343,9 @@ int main (int argc, char *argv[])
     uint32_t xxxTarget = 10;
     uint32_t xxxMarkingThreshold = 30;
 
+    uint32_t sharedBufferSize = 0;
+    double sharedBufferAlpha = 1.0;
+
     CommandLine cmd;
     cmd.AddValue ("ID", "Running ID", id);
     cmd.AddValue ("StartTime", "Start time of the simulation", START_TIME);
@@ -434,6 +437,9 @@ int main (int argc, char *argv[])
     cmd.AddValue ("XXXTarget", "The persistent target for XXX", xxxTarget);
     cmd.AddValue ("XXXMarkingThreshold", "The instantaneous marking threshold for XXX", xxxMarkingThreshold);
 
+    cmd.AddValue ("sharedBufferSize", "Bytes of the buffer shared by all the ports of a switch, 0 for per-port buffers", sharedBufferSize);
+    cmd.AddValue ("sharedBufferAlpha", "The Dynamic Threshold alpha of the shared buffer", sharedBufferAlpha);
+
 
     cmd.Parse (argc, argv);
 
@@ -794,6 +800,13 @@ int main (int argc, char *argv[])
         tc.SetRootQueueDisc ("ns3::XXXQueueDisc");
     }
 
+    if (sharedBufferSize > 0)
+    {
+        tc.SetSharedBuffer ("BufferSize", UintegerValue (sharedBufferSize),
+                            "Policy", StringValue ("DYNAMIC_THRESHOLD"),
+                            "Alpha", DoubleValue (sharedBufferAlpha));
+    }
+
     NS_LOG_INFO ("Configuring servers");
     // Setting servers
     p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (LEAF_SERVER_CAPACITY)));
@@ -1030,10 +1043,10 @@ int main (int argc, char *argv[])
 
             if (runMode == TLB || runMode == DRB || runMode == PRESTO || runMode == WEIGHTED_PRESTO || runMode == Clove)
             {
-                std::pair<int, int> leafToSpine = std::make_pair<int, int> (i, j);
+                std::pair<int, int> leafToSpine = std::make_pair (i, j);
                 leafToSpinePath[leafToSpine] = netDeviceContainer.Get (0)->GetIfIndex ();
 
-                std::pair<int, int> spineToLeaf = std::make_pair<int, int> (j, i);
+                std::pair<int, int> spineToLeaf = std::make_pair (j, i);
                 spineToLeafPath[spineToLeaf] = netDeviceContainer.Get (1)->GetIfIndex ();
             }
 
@@ -10,7 +10,9 @@
 #include "ns3/ipv4-drb-routing-helper.h"
 #include "ns3/ipv4-xpath-routing-helper.h"
 #include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-tlb-helper.h"
 #include "ns3/ipv4-clove.h"
+#include "ns3/clove-helper.h"
 #include "ns3/ipv4-tlb-probing.h"
 #include "ns3/link-monitor-module.h"
 #include "ns3/traffic-control-module.h"
@@ -957,10 +959,10 @@ int main (int argc, char *argv[])
 
             if (runMode == TLB || runMode == DRB || runMode == PRESTO || runMode == WEIGHTED_PRESTO || runMode == Clove)
             {
-                std::pair<int, int> leafToSpine = std::make_pair<int, int> (i, j);
+                std::pair<int, int> leafToSpine = std::make_pair (i, j);
                 leafToSpinePath[leafToSpine] = netDeviceContainer.Get (0)->GetIfIndex ();
 
-                std::pair<int, int> spineToLeaf = std::make_pair<int, int> (j, i);
+                std::pair<int, int> spineToLeaf = std::make_pair (j, i);
                 spineToLeafPath[spineToLeaf] = netDeviceContainer.Get (1)->GetIfIndex ();
             }
 
@@ -1235,6 +1237,23 @@ int main (int argc, char *argv[])
         srand (randomSeed);
     }
 
+    // The load balancers draw from their own ns-3 streams, run with --RngRun to get independent replications
+    NodeContainer allNodes = NodeContainer::GetGlobal ();
+    int64_t stream = 0;
+    stream += congaRoutingHelper.AssignStreams (allNodes, stream);
+    stream += drillRoutingHelper.AssignStreams (allNodes, stream);
+    stream += letFlowRoutingHelper.AssignStreams (allNodes, stream);
+    stream += drbRoutingHelper.AssignStreams (allNodes, stream);
+    stream += Ipv4TLBHelper ().AssignStreams (allNodes, stream);
+    stream += CloveHelper ().AssignStreams (allNodes, stream);
+    for (std::vector<Ptr<Ipv4TLBProbing> >::iterator itr = probings.begin (); itr != probings.end (); ++itr)
+    {
+        if (*itr != 0)
+        {
+            stream += (*itr)->AssignStreams (stream);
+        }
+    }
+
     NS_LOG_INFO ("Create applications");
 
     long flowCount = 0;
@@ -2,10 +2,29 @@
 
 #include "clove-helper.h"
 
+#include "ns3/node.h"
+
 namespace ns3 {
 
-/* ... */
+CloveHelper::CloveHelper ()
+{
+
+}
 
+int64_t
+CloveHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4Clove> clove = (*i)->GetObject<Ipv4Clove> ();
+        if (clove != 0)
+        {
+            currentStream += clove->AssignStreams (currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
 
 }
 
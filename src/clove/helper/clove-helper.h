@@ -3,10 +3,30 @@
 #define CLOVE_HELPER_H
 
 #include "ns3/ipv4-clove.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
-/* ... */
+/**
+ * The Ipv4Clove instances are aggregated to the nodes by the InternetStackHelper,
+ * this helper configures the ones already installed.
+ */
+class CloveHelper
+{
+public:
+    CloveHelper ();
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by the Ipv4Clove of the nodes. Return the number of streams that
+     * have been assigned.
+     *
+     * \param c NodeContainer of the set of nodes whose Ipv4Clove should use a fixed stream
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams (NodeContainer c, int64_t stream);
+};
 
 }
 
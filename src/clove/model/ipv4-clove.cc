@@ -13,21 +13,22 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4Clove");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4Clove);
 
 Ipv4Clove::Ipv4Clove () :
-    m_flowletTimeout (MicroSeconds (200)),
     m_runMode (CLOVE_RUNMODE_EDGE_FLOWLET),
     m_halfRTT (MicroSeconds (40)),
     m_disToUncongestedPath (false)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Clove::Ipv4Clove (const Ipv4Clove &other) :
-    m_flowletTimeout (other.m_flowletTimeout),
     m_runMode (other.m_runMode),
+    m_flowletTable (other.m_flowletTable),
     m_halfRTT (other.m_halfRTT),
     m_disToUncongestedPath (other.m_disToUncongestedPath)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -39,8 +40,14 @@ Ipv4Clove::GetTypeId (void)
         .AddConstructor<Ipv4Clove> ()
         .AddAttribute ("FlowletTimeout", "FlowletTimeout",
                        TimeValue (MicroSeconds (40)),
-                       MakeTimeAccessor (&Ipv4Clove::m_flowletTimeout),
+                       MakeTimeAccessor (&Ipv4Clove::SetFlowletTimeout,
+                                         &Ipv4Clove::GetFlowletTimeout),
                        MakeTimeChecker ())
+        .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                       UintegerValue (4096),
+                       MakeUintegerAccessor (&Ipv4Clove::SetFlowletTableSize,
+                                             &Ipv4Clove::GetFlowletTableSize),
+                       MakeUintegerChecker<uint32_t> (1))
         .AddAttribute ("RunMode", "RunMode",
                        UintegerValue (0),
                        MakeUintegerAccessor (&Ipv4Clove::m_runMode),
@@ -58,6 +65,14 @@ Ipv4Clove::GetTypeId (void)
     return tid;
 }
 
+int64_t
+Ipv4Clove::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 void
 Ipv4Clove::AddAddressWithTor (Ipv4Address address, uint32_t torId)
 {
@@ -96,26 +111,40 @@ Ipv4Clove::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    struct CloveFlowlet flowlet;
-    std::map<uint32_t, CloveFlowlet>::iterator flowletItr = m_flowletMap.find (flowId);
-    if (flowletItr != m_flowletMap.end ())
+    FlowletTable::Entry &flowlet = m_flowletTable.Lookup (flowId);
+    uint32_t path = flowlet.path;
+    if (!m_flowletTable.IsActive (flowlet))
     {
-        flowlet = flowletItr->second;
-    }
-    else
-    {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
+        path = Ipv4Clove::CalPath (destTor);
     }
 
-    if (Simulator::Now () - flowlet.lastSeen >= m_flowletTimeout)
-    {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
-    }
+    m_flowletTable.Update (flowlet, flowId, path);
 
-    flowlet.lastSeen = Simulator::Now ();
-    m_flowletMap[flowId] = flowlet;
+    return path;
+}
 
-    return flowlet.path;
+void
+Ipv4Clove::SetFlowletTimeout (Time timeout)
+{
+    m_flowletTable.SetTimeout (timeout);
+}
+
+Time
+Ipv4Clove::GetFlowletTimeout (void) const
+{
+    return m_flowletTable.GetTimeout ();
+}
+
+void
+Ipv4Clove::SetFlowletTableSize (uint32_t size)
+{
+    m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4Clove::GetFlowletTableSize (void) const
+{
+    return m_flowletTable.GetSize ();
 }
 
 
@@ -143,11 +172,11 @@ Ipv4Clove::CalPath (uint32_t destTor)
     std::vector<uint32_t> paths = itr->second;
     if (m_runMode == CLOVE_RUNMODE_EDGE_FLOWLET)
     {
-        return paths[rand() % paths.size ()];
+        return paths[m_rand->GetInteger (0, paths.size () - 1)];
     }
     else if (m_runMode == CLOVE_RUNMODE_ECN)
     {
-        double r = ((double) rand () / RAND_MAX);
+        double r = m_rand->GetValue (0.0, 1.0);
         std::vector<uint32_t>::iterator itr = paths.begin ();
         double weightSum = 0.0;
         for ( ; itr != paths.end (); ++itr)
@@ -173,6 +202,12 @@ Ipv4Clove::CalPath (uint32_t destTor)
     return 0;
 }
 
+void
+Ipv4Clove::FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt)
+{
+    Ipv4Clove::FlowRecv (path, daddr, withECN);
+}
+
 void
 Ipv4Clove::FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN)
 {
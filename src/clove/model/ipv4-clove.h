@@ -5,6 +5,9 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-path-selector.h"
+#include "ns3/flowlet-table.h"
 
 #include <vector>
 #include <map>
@@ -16,12 +19,7 @@
 
 namespace ns3 {
 
-struct CloveFlowlet {
-    Time lastSeen;
-    uint32_t path;
-};
-
-class Ipv4Clove : public Object {
+class Ipv4Clove : public Object, public Ipv4PathSelector {
 
 public:
     Ipv4Clove ();
@@ -32,21 +30,40 @@ public:
     void AddAddressWithTor (Ipv4Address address, uint32_t torId);
     void AddAvailPath (uint32_t destTor, uint32_t path);
 
-    uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
+    virtual uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
 
     void FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN);
 
+    // Path selector hook, Clove only reacts to the ECN echoed by the ACKs
+    virtual void FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt);
+
     bool FindTorId (Ipv4Address daddr, uint32_t &torId);
 
+    void SetFlowletTimeout (Time timeout);
+    Time GetFlowletTimeout (void) const;
+
+    void SetFlowletTableSize (uint32_t size);
+    uint32_t GetFlowletTableSize (void) const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model. Return the number of streams that have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams (int64_t stream);
+
 private:
     uint32_t CalPath (uint32_t destTor);
 
-    Time m_flowletTimeout;
     uint32_t m_runMode;
 
     std::map<uint32_t, std::vector<uint32_t> > m_availablePath;
     std::map<Ipv4Address, uint32_t> m_ipTorMap;
-    std::map<uint32_t, CloveFlowlet> m_flowletMap;
+    FlowletTable m_flowletTable;
+
+    Ptr<UniformRandomVariable> m_rand;
 
     // Clove ECN
     Time m_halfRTT;
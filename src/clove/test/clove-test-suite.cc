@@ -46,6 +46,50 @@ CloveTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// The random path selection only depends on the stream assigned to the instance
+class CloveStreamTestCase : public TestCase
+{
+public:
+  CloveStreamTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CloveStreamTestCase::CloveStreamTestCase ()
+  : TestCase ("Clove instances with the same stream pick the same paths")
+{
+}
+
+void
+CloveStreamTestCase::DoRun (void)
+{
+  Ipv4Address saddr ("10.1.1.1");
+  Ipv4Address daddr ("10.1.2.1");
+  Ptr<Ipv4Clove> clove[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      clove[i] = CreateObject<Ipv4Clove> ();
+      clove[i]->AddAddressWithTor (daddr, 1);
+      for (uint32_t path = 0; path < 8; path++)
+        {
+          clove[i]->AddAvailPath (1, path);
+        }
+      NS_TEST_ASSERT_MSG_EQ (clove[i]->AssignStreams (7), 1, "Clove should use a single stream");
+    }
+
+  bool differentPaths = false;
+  uint32_t firstPath = clove[0]->GetPath (0, saddr, daddr);
+  NS_TEST_ASSERT_MSG_EQ (clove[1]->GetPath (0, saddr, daddr), firstPath, "The first flow should get the same path");
+  for (uint32_t flowId = 1; flowId < 64; flowId++)
+    {
+      uint32_t path = clove[0]->GetPath (flowId, saddr, daddr);
+      NS_TEST_ASSERT_MSG_EQ (clove[1]->GetPath (flowId, saddr, daddr), path, "Every flow should get the same path");
+      differentPaths = differentPaths || path != firstPath;
+    }
+  NS_TEST_ASSERT_MSG_EQ (differentPaths, true, "The flows should be spread over the paths");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +105,7 @@ CloveTestSuite::CloveTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new CloveTestCase1, TestCase::QUICK);
+  AddTestCase (new CloveStreamTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -8,6 +8,7 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
 #include "ipv4-conga-tag.h"
 
 #include <algorithm>
@@ -29,15 +30,14 @@ Ipv4CongaRouting::Ipv4CongaRouting ():
     m_C (DataRate("1Gbps")),
     m_Q (3),
     m_agingTime (MilliSeconds (10)),
-    m_flowletTimeout (MicroSeconds(50)), // The default value of flowlet timeout is small for experimental purpose
     m_ecmpMode (false),
     // Variables
     m_feedbackIndex (0),
-    m_dreEvent (),
-    m_agingEvent (),
     m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
+  m_flowletTable.SetTimeout (MicroSeconds (50)); // The default value of flowlet timeout is small for experimental purpose
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4CongaRouting::~Ipv4CongaRouting ()
@@ -51,11 +51,24 @@ Ipv4CongaRouting::GetTypeId (void)
   static TypeId tid = TypeId("ns3::Ipv4CongaRouting")
       .SetParent<Object>()
       .SetGroupName ("Internet")
-      .AddConstructor<Ipv4CongaRouting> ();
+      .AddConstructor<Ipv4CongaRouting> ()
+      .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                     UintegerValue (65536),
+                     MakeUintegerAccessor (&Ipv4CongaRouting::SetFlowletTableSize,
+                                           &Ipv4CongaRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (1));
 
   return tid;
 }
 
+int64_t
+Ipv4CongaRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4CongaRouting::SetLeafId (uint32_t leafId)
 {
@@ -66,7 +79,25 @@ Ipv4CongaRouting::SetLeafId (uint32_t leafId)
 void
 Ipv4CongaRouting::SetFlowletTimeout (Time timeout)
 {
-  m_flowletTimeout = timeout;
+  m_flowletTable.SetTimeout (timeout);
+}
+
+void
+Ipv4CongaRouting::SetFlowletTableSize (uint32_t size)
+{
+  m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4CongaRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+uint64_t
+Ipv4CongaRouting::GetFlowletTableCollisions (void) const
+{
+  return m_flowletTable.GetCollisions ();
 }
 
 void
@@ -137,6 +168,7 @@ Ipv4CongaRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t
   congaRouteEntry.networkMask = networkMask;
   congaRouteEntry.port = port;
   m_routeEntryList.push_back (congaRouteEntry);
+  m_portGroups.clear ();
 }
 
 std::vector<CongaRouteEntry>
@@ -154,9 +186,39 @@ Ipv4CongaRouting::LookupCongaRouteEntries (Ipv4Address dest)
   return congaRouteEntries;
 }
 
+const std::vector<uint32_t> &
+Ipv4CongaRouting::LookupPortGroup (Ipv4Address dest)
+{
+  std::map<Ipv4Address, std::vector<uint32_t> >::iterator groupItr = m_portGroups.find (dest);
+  if (groupItr != m_portGroups.end ())
+  {
+    return groupItr->second;
+  }
+
+  // First packet towards this destination, compile the ports of all the matching routes
+  std::vector<uint32_t> &ports = m_portGroups[dest];
+  std::vector<CongaRouteEntry>::iterator itr = m_routeEntryList.begin ();
+  for ( ; itr != m_routeEntryList.end (); ++itr)
+  {
+    if((*itr).networkMask.IsMatch(dest, (*itr).network))
+    {
+      ports.push_back ((*itr).port);
+    }
+  }
+  return ports;
+}
+
 Ptr<Ipv4Route>
 Ipv4CongaRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
+  // Routes are never modified once built, reuse the one of this port and destination
+  std::pair<uint32_t, Ipv4Address> key = std::make_pair (port, destAddress);
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> >::iterator routeItr = m_routeCache.find (key);
+  if (routeItr != m_routeCache.end ())
+  {
+    return routeItr->second;
+  }
+
   Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
   Ptr<Channel> channel = dev->GetChannel ();
   uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
@@ -168,6 +230,7 @@ Ipv4CongaRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
   route->SetGateway (nextHopAddr);
   route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
   route->SetDestination (destAddress);
+  m_routeCache[key] = route;
   return route;
 }
 
@@ -206,9 +269,6 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  // Packet arrival time
-  Time now = Simulator::Now ();
-
   // Extract the flow id
   uint32_t flowId = 0;
   FlowIdTag flowIdTag;
@@ -221,9 +281,9 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<CongaRouteEntry> routeEntries = Ipv4CongaRouting::LookupCongaRouteEntries (destAddress);
+  const std::vector<uint32_t> &ports = Ipv4CongaRouting::LookupPortGroup (destAddress);
 
-  if (routeEntries.empty ())
+  if (ports.empty ())
   {
     NS_LOG_ERROR (this << " Conga routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -233,23 +293,30 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   // Dev use
   if (m_ecmpMode)
   {
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+    uint32_t selectedPort = ports[flowId % ports.size ()];
     Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
     ucb (route, packet, header);
   }
 
-  // Turn on DRE event scheduler if it is not running
-  if (!m_dreEvent.IsRunning ())
+  // The DRE and the metrics are only used by the packets, thus the periodic
+  // updates are run lazily, when the next packet arrives
+  Ipv4CongaRouting::DreEvent ();
+  Ipv4CongaRouting::AgingEvent ();
+
+  // Turn on DRE timer if it is not running
+  if (!m_dreTimer.IsRunning ())
   {
-    NS_LOG_LOGIC (this << " Conga routing restarts dre event scheduling");
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
+    NS_LOG_LOGIC (this << " Conga routing restarts dre timer");
+    m_dreTimer.SetPeriod (m_tdre);
+    m_dreTimer.Start ();
   }
 
-  // Turn on aging event scheduler if it is not running
-  if (!m_agingEvent.IsRunning ())
+  // Turn on aging timer if it is not running
+  if (!m_agingTimer.IsRunning ())
   {
-    NS_LOG_LOGIC (this << "Conga routing restarts aging event scheduling");
-    m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
+    NS_LOG_LOGIC (this << "Conga routing restarts aging timer");
+    m_agingTimer.SetPeriod (m_agingTime / 4);
+    m_agingTimer.Start ();
   }
 
   // First, check if this switch if leaf switch
@@ -321,41 +388,35 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // If not hit, determine the port based on the congestion degree of the link
 
       // Flowlet table look up
-      struct Flowlet *flowlet = NULL;
+      FlowletTable::Entry &flowlet = m_flowletTable.Lookup (flowId);
 
       // If the flowlet table entry is valid, return the port
-      std::map<uint32_t, struct Flowlet *>::iterator flowletItr = m_flowletTable.find (flowId);
-      if (flowletItr != m_flowletTable.end ())
+      if (m_flowletTable.IsActive (flowlet))
       {
-        flowlet = flowletItr->second;
-        if (flowlet != NULL && // Impossible in normal cases
-            now - flowlet->activeTime <= m_flowletTimeout)
-        {
-          // Do not forget to update the flowlet active time
-          flowlet->activeTime = now;
+        // Return the port information used for routing routine to select the port
+        selectedPort = flowlet.path;
 
-          // Return the port information used for routing routine to select the port
-          selectedPort = flowlet->port;
+        // Do not forget to update the flowlet active time
+        m_flowletTable.Update (flowlet, flowId, selectedPort);
 
-          // Construct Conga Header for the packet
-          ipv4CongaTag.SetLbTag (selectedPort);
-          ipv4CongaTag.SetCe (0);
+        // Construct Conga Header for the packet
+        ipv4CongaTag.SetLbTag (selectedPort);
+        ipv4CongaTag.SetCe (0);
 
-          // Piggyback the feedback information
-          ipv4CongaTag.SetFbLbTag (fbLbTag);
-          ipv4CongaTag.SetFbMetric (fbMetric);
-          packet->AddPacketTag(ipv4CongaTag);
+        // Piggyback the feedback information
+        ipv4CongaTag.SetFbLbTag (fbLbTag);
+        ipv4CongaTag.SetFbMetric (fbMetric);
+        packet->AddPacketTag(ipv4CongaTag);
 
-          // Update local dre
-          Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
+        // Update local dre
+        Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
-          Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-          ucb (route, packet, header);
+        Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
+        ucb (route, packet, header);
 
-          NS_LOG_LOGIC (this << " Sending Conga on leaf switch (flowlet hit): " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
+        NS_LOG_LOGIC (this << " Sending Conga on leaf switch (flowlet hit): " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
 
-          return true;
-        }
+        return true;
       }
 
       NS_LOG_LOGIC (this << " Flowlet expires, calculate the new port");
@@ -371,11 +432,11 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       uint32_t minPortCongestion = (std::numeric_limits<uint32_t>::max)();
 
       std::vector<uint32_t> portCandidates;
-      std::vector<CongaRouteEntry>::iterator routeEntryItr = routeEntries.begin ();
+      std::vector<uint32_t>::const_iterator portItr = ports.begin ();
 
-      for ( ; routeEntryItr != routeEntries.end (); ++routeEntryItr)
+      for ( ; portItr != ports.end (); ++portItr)
       {
-        uint32_t port = (*routeEntryItr).port;
+        uint32_t port = *portItr;
         uint32_t localCongestion = 0;
         uint32_t remoteCongestion = 0;
 
@@ -409,31 +470,19 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       }
 
       // 3. Select one port from all those candidate ports
-      if (flowlet != NULL &&
-            std::find(portCandidates.begin (), portCandidates.end (), flowlet->port) != portCandidates.end ())
+      if (flowlet.valid &&
+            std::find(portCandidates.begin (), portCandidates.end (), flowlet.path) != portCandidates.end ())
       {
         // Prefer the port cached in flowlet table
-        selectedPort = flowlet->port;
-        // Activate the flowlet entry again
-        flowlet->activeTime = now;
+        selectedPort = flowlet.path;
       }
       else
       {
         // If there are no cached ports, we randomly choose a good port
-        selectedPort = portCandidates[rand() % portCandidates.size ()];
-        if (flowlet == NULL)
-        {
-          struct Flowlet *newFlowlet = new Flowlet;
-          newFlowlet->port = selectedPort;
-          newFlowlet->activeTime = now;
-          m_flowletTable[flowId] = newFlowlet;
-        }
-        else
-        {
-          flowlet->port = selectedPort;
-          flowlet->activeTime = now;
-        }
+        selectedPort = portCandidates[m_rand->GetInteger (0, portCandidates.size () - 1)];
       }
+      // Activate the flowlet entry again
+      m_flowletTable.Update (flowlet, flowId, selectedPort);
 
       // 4. Construct Conga Header for the packet
       ipv4CongaTag.SetLbTag (selectedPort);
@@ -529,7 +578,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       packet->RemovePacketTag (ipv4CongaTag);
 
       // Pick port using standard ECMP
-      uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+      uint32_t selectedPort = ports[flowId % ports.size ()];
 
       Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
@@ -557,7 +606,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     }
 
     // Determine the port using standard ECMP
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+    uint32_t selectedPort = ports[flowId % ports.size ()];
 
     // Update local dre
     uint32_t X = Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
@@ -586,21 +635,25 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 void
 Ipv4CongaRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4CongaRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4CongaRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4CongaRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
@@ -620,13 +673,9 @@ Ipv4CongaRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4CongaRouting::DoDispose (void)
 {
-  std::map<uint32_t, Flowlet *>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end (); ++itr )
-  {
-    delete (itr->second);
-  }
-  m_dreEvent.Cancel ();
-  m_agingEvent.Cancel ();
+  m_dreTimer.Stop ();
+  m_agingTimer.Stop ();
+  m_routeCache.clear ();
   m_ipv4=0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -649,35 +698,47 @@ Ipv4CongaRouting::UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet,
 void
 Ipv4CongaRouting::DreEvent ()
 {
-  bool moveToIdleStatus = true;
-
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr )
+  while (m_dreTimer.IsExpired ())
   {
-    uint32_t newX = itr->second * (1 - m_alpha);
-    itr->second = newX;
-    if (newX != 0)
+    m_dreTimer.Expire ();
+
+    bool moveToIdleStatus = true;
+
+    std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
+    for ( ; itr != m_XMap.end (); ++itr )
     {
-      moveToIdleStatus = false;
+      uint32_t newX = itr->second * (1 - m_alpha);
+      itr->second = newX;
+      if (newX != 0)
+      {
+        moveToIdleStatus = false;
+      }
     }
-  }
 
-  NS_LOG_LOGIC (this << " Dre event finished, the dre table is now: ");
-  Ipv4CongaRouting::PrintDreTable ();
+    NS_LOG_LOGIC (this << " Dre event finished, the dre table is now: ");
+    Ipv4CongaRouting::PrintDreTable ();
 
-  if (!moveToIdleStatus)
-  {
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
-  }
-  else
-  {
-    NS_LOG_LOGIC (this << " Dre event goes into idle status");
+    if (moveToIdleStatus)
+    {
+      NS_LOG_LOGIC (this << " Dre event goes into idle status");
+      m_dreTimer.Stop ();
+    }
   }
 }
 
 void
 Ipv4CongaRouting::AgingEvent ()
 {
+    if (!m_agingTimer.IsExpired ())
+    {
+      return;
+    }
+
+    // The metrics are only refreshed by the packets, thus the last due
+    // expiration ages every metric the previous ones would have aged
+    m_agingTimer.ExpireAll ();
+    Time now = m_agingTimer.GetLastExpiration ();
+
     bool moveToIdleStatus = true;
     std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
         m_congaToLeafTable.begin ();
@@ -687,7 +748,7 @@ Ipv4CongaRouting::AgingEvent ()
         (itr->second).begin ();
       for (; innerItr != (itr->second).end (); ++innerItr)
       {
-        if (Simulator::Now () - (innerItr->second).first > m_agingTime)
+        if (now - (innerItr->second).first > m_agingTime)
         {
           (innerItr->second).second = 0;
         }
@@ -699,35 +760,37 @@ Ipv4CongaRouting::AgingEvent ()
     }
     std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr2 =
         m_congaFromLeafTable.begin ();
-    for ( ; itr2 != m_congaFromLeafTable.end (); ++itr2 )
+    while (itr2 != m_congaFromLeafTable.end ())
     {
         std::map<uint32_t, FeedbackInfo>::iterator innerItr2 =
           (itr2->second).begin ();
-        for ( ; innerItr2 != (itr2->second).end (); ++innerItr2)
+        while (innerItr2 != (itr2->second).end ())
         {
-          if (Simulator::Now () - (innerItr2->second).updateTime > m_agingTime)
+          if (now - (innerItr2->second).updateTime > m_agingTime)
           {
-            (itr2->second).erase (innerItr2);
-            if ((itr2->second).empty ())
-            {
-                m_congaFromLeafTable.erase (itr2);
-            }
+            (itr2->second).erase (innerItr2++);
           }
           else
           {
             moveToIdleStatus = false;
+            ++innerItr2;
           }
         }
+        if ((itr2->second).empty ())
+        {
+          m_congaFromLeafTable.erase (itr2++);
+        }
+        else
+        {
+          ++itr2;
+        }
     }
 
 
-    if (!moveToIdleStatus)
-    {
-      m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
-    }
-    else
+    if (moveToIdleStatus)
     {
       NS_LOG_LOGIC (this << " Aging event goes into idle status");
+      m_agingTimer.Stop ();
     }
 }
 
@@ -800,13 +863,8 @@ Ipv4CongaRouting::PrintFlowletTable ()
 /*
   std::ostringstream oss;
   oss << "===== Flowlet For Leaf: " << m_leafId << "=====" << std::endl;
-  std::map<uint32_t, Flowlet*>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end(); ++itr )
-  {
-    oss << "flowId: " << itr->first << std::endl << "\t"
-        << "port: " << (itr->second)->port << "\t"
-        << "activeTime" << (itr->second)->activeTime << std::endl;
-  }
+  oss << "size: " << m_flowletTable.GetSize () << "\t"
+      << "collisions: " << m_flowletTable.GetCollisions () << std::endl;
   oss << "===================";
   NS_LOG_LOGIC (oss.str ());
 */
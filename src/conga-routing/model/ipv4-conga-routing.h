@@ -9,18 +9,15 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
-#include "ns3/event-id.h"
+#include "ns3/lazy-timer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
 #include <map>
 #include <vector>
 
 namespace ns3 {
 
-struct Flowlet {
-  uint32_t port;
-  Time activeTime;
-};
-
 struct FeedbackInfo {
   uint32_t ce;
   bool change;
@@ -55,6 +52,11 @@ public:
 
   void SetFlowletTimeout (Time timeout);
 
+  void SetFlowletTableSize (uint32_t size);
+  uint32_t GetFlowletTableSize (void) const;
+
+  uint64_t GetFlowletTableCollisions (void) const;
+
   void AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId);
 
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
@@ -63,6 +65,15 @@ public:
 
   void EnableEcmpMode ();
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model. Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -100,9 +111,6 @@ private:
 
   Time m_agingTime;
 
-  // Flowlet Timeout
-  Time m_flowletTimeout;
-
   // Dev use
   bool m_ecmpMode;
 
@@ -110,11 +118,14 @@ private:
   // Used to maintain the round robin
   unsigned long m_feedbackIndex;
 
-  // Dre Event ID
-  EventId m_dreEvent;
+  // DRE decay, every m_tdre while some X is not zero
+  LazyTimer m_dreTimer;
+
+  // Metric aging, every m_agingTime / 4 while some metric is not aged
+  LazyTimer m_agingTimer;
 
-  // Metric aging event
-  EventId m_agingEvent;
+  // Breaks the ties between the good ports of a new flowlet
+  Ptr<UniformRandomVariable> m_rand;
 
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
@@ -122,6 +133,12 @@ private:
   // Route table
   std::vector<CongaRouteEntry> m_routeEntryList;
 
+  // (port, destination) to route cache, flushed whenever an interface or address changes
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> > m_routeCache;
+
+  // Destination to port group cache, flushed whenever a route is added
+  std::map<Ipv4Address, std::vector<uint32_t> > m_portGroups;
+
   // Ip and leaf switch map,
   // used to determine the which leaf switch the packet would go through
   std::map<Ipv4Address, uint32_t> m_ipLeafIdMap;
@@ -132,8 +149,8 @@ private:
   // Congestion From Leaf Table
   std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;
 
-  // Flowlet Table
-  std::map<uint32_t, Flowlet *> m_flowletTable;
+  // Flowlet Table, also holds the flowlet timeout
+  FlowletTable m_flowletTable;
 
   // Parameters
   // DRE
@@ -143,6 +160,7 @@ private:
   // DRE algorithm
   uint32_t UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t path);
 
+  // Run the DRE decays and the metric aging due since the previous packet
   void DreEvent();
 
   void AgingEvent ();
@@ -153,6 +171,9 @@ private:
 
   std::vector<CongaRouteEntry> LookupCongaRouteEntries (Ipv4Address dest);
 
+  // The ports of all the routes matching the destination, compiled on the first lookup
+  const std::vector<uint32_t> & LookupPortGroup (Ipv4Address dest);
+
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
   // Debug use
@@ -73,6 +73,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_timeouts = CreateObject<TimerWheelScheduler> ();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -92,6 +93,12 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  while (!m_timeouts->IsEmpty ())
+    {
+      Scheduler::Event next = m_timeouts->RemoveNext ();
+      next.impl->Unref ();
+    }
+  m_timeouts = 0;
   SimulatorImpl::DoDispose ();
 }
 void
@@ -137,7 +144,18 @@ DefaultSimulatorImpl::GetSystemId (void) const
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
-  Scheduler::Event next = m_events->RemoveNext ();
+  Scheduler::Event next;
+  // the wheel finds its next timeout faster from the current time
+  m_timeouts->Advance (m_currentTs);
+  if (!m_timeouts->IsEmpty ()
+      && (m_events->IsEmpty () || m_timeouts->PeekNext () < m_events->PeekNext ()))
+    {
+      next = m_timeouts->RemoveNext ();
+    }
+  else
+    {
+      next = m_events->RemoveNext ();
+    }
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
@@ -155,7 +173,7 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  return (m_events->IsEmpty () && m_timeouts->IsEmpty ()) || m_stop;
 }
 
 void
@@ -197,14 +215,14 @@ DefaultSimulatorImpl::Run (void)
   ProcessEventsWithContext ();
   m_stop = false;
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  while (!(m_events->IsEmpty () && m_timeouts->IsEmpty ()) && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!m_events->IsEmpty () || !m_timeouts->IsEmpty () || m_unscheduledEvents == 0);
 }
 
 void 
@@ -245,6 +263,28 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
+EventId
+DefaultSimulatorImpl::ScheduleTimeout (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleTimeout Thread-unsafe invocation!");
+
+  Time tAbsolute = delay + TimeStep (m_currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (m_currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = GetContext ();
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_timeouts->Advance (m_currentTs);
+  m_timeouts->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
 void
 DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
 {
@@ -344,12 +384,25 @@ DefaultSimulatorImpl::Remove (const EventId &id)
     {
       return;
     }
+  RemoveEvent (id);
+}
+
+void
+DefaultSimulatorImpl::RemoveEvent (const EventId &id)
+{
   Scheduler::Event event;
   event.impl = id.PeekEventImpl ();
   event.key.m_ts = id.GetTs ();
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
-  m_events->Remove (event);
+  if (m_timeouts->Contains (event.impl, event.key.m_uid))
+    {
+      m_timeouts->Remove (event);
+    }
+  else
+    {
+      m_events->Remove (event);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -362,7 +415,16 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
 {
   if (!IsExpired (id))
     {
-      id.PeekEventImpl ()->Cancel ();
+      if (m_timeouts->Contains (id.PeekEventImpl (), id.GetUid ()))
+        {
+          // the timeouts are cheap to remove, do not leave them
+          // in the wheel until they are due
+          RemoveEvent (id);
+        }
+      else
+        {
+          id.PeekEventImpl ()->Cancel ();
+        }
     }
 }
 
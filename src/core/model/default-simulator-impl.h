@@ -23,6 +23,7 @@
 
 #include "simulator-impl.h"
 #include "scheduler.h"
+#include "timer-wheel-scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
@@ -43,6 +44,13 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * The timeouts scheduled with Simulator::ScheduleTimeout are kept in a
+ * TimerWheelScheduler next to the event queue, and the next event run is
+ * the earliest of the heads of both, so that they run in the same order as
+ * if they were all in the event queue. Cancelling or removing a timeout
+ * takes it out of the wheel at once, whereas a cancelled event stays in
+ * the event queue until it is due.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -64,6 +72,7 @@ public:
   virtual void Stop (void);
   virtual void Stop (Time const &delay);
   virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual EventId ScheduleTimeout (Time const &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
@@ -83,6 +92,12 @@ private:
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Take an event out of the event queue or of the timeouts.
+   *
+   * \param [in] id The event.
+   */
+  void RemoveEvent (const EventId &id);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -115,6 +130,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The timeouts. */
+  Ptr<TimerWheelScheduler> m_timeouts;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -21,6 +21,8 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,13 +33,75 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** The step between two size classes of the events. */
+const size_t POOL_GRANULARITY = 16;
+/** The number of size classes, the larger events are not pooled. */
+const size_t POOL_CLASSES = 16;
+/** The maximum number of free blocks kept for a size class. */
+const uint32_t POOL_MAX_FREE = 4096;
+
+/** The memory of a released event. */
+struct FreeBlock
+{
+  FreeBlock *next;  //!< The next free block of the size class
+};
+
+/**
+ * Whether the pool of the thread has been destroyed. It has no
+ * destructor, so that it can still be read by the events released
+ * after the pool, when the thread or the program exits.
+ */
+thread_local bool g_eventPoolDestroyed = false;
+
+/**
+ * The free blocks of the size classes. Each thread has its own, so
+ * that the events can be created and released by the threads of a
+ * multithreaded simulator without a lock.
+ */
+struct EventPool
+{
+  EventPool ()
+  {
+    for (size_t i = 0; i < POOL_CLASSES; i++)
+      {
+        head[i] = 0;
+        count[i] = 0;
+      }
+  }
+  ~EventPool ()
+  {
+    for (size_t i = 0; i < POOL_CLASSES; i++)
+      {
+        while (head[i] != 0)
+          {
+            FreeBlock *block = head[i];
+            head[i] = block->next;
+            ::operator delete (block);
+          }
+      }
+    // the events released by the static destructors are not pooled
+    g_eventPoolDestroyed = true;
+  }
+
+  FreeBlock *head[POOL_CLASSES];   //!< The first free block of each size class
+  uint32_t count[POOL_CLASSES];    //!< The free blocks of each size class
+};
+
+thread_local EventPool g_eventPool;   //!< The free blocks of the thread
+bool g_eventPoolEnabled = true;       //!< Whether the released events are pooled
+
+} // unnamed namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_schedulerIndex (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +130,65 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void
+EventImpl::SetSchedulerIndex (uint32_t index)
+{
+  m_schedulerIndex = index;
+}
+
+uint32_t
+EventImpl::GetSchedulerIndex (void) const
+{
+  return m_schedulerIndex;
+}
+
+void *
+EventImpl::operator new (size_t size)
+{
+  size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  if (g_eventPoolEnabled && !g_eventPoolDestroyed)
+    {
+      EventPool &pool = g_eventPool;
+      FreeBlock *block = pool.head[sizeClass];
+      if (block != 0)
+        {
+          pool.head[sizeClass] = block->next;
+          pool.count[sizeClass]--;
+          return block;
+        }
+    }
+  // a block of the full size class, so that it can be pooled when released
+  return ::operator new ((sizeClass + 1) * POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, size_t size)
+{
+  size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (g_eventPoolEnabled && !g_eventPoolDestroyed && sizeClass < POOL_CLASSES)
+    {
+      EventPool &pool = g_eventPool;
+      if (pool.count[sizeClass] < POOL_MAX_FREE)
+        {
+          FreeBlock *block = static_cast<FreeBlock *> (p);
+          block->next = pool.head[sizeClass];
+          pool.head[sizeClass] = block;
+          pool.count[sizeClass]++;
+          return;
+        }
+    }
+  ::operator delete (p);
+}
+
+void
+EventImpl::EnablePool (bool enabled)
+{
+  NS_LOG_FUNCTION (enabled);
+  g_eventPoolEnabled = enabled;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -65,6 +66,47 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Set the index of the event in the scheduler which holds it.
+   *
+   * The schedulers which can remove an event without searching it
+   * keep its position here, see QuadHeapScheduler and
+   * TimerWheelScheduler.
+   *
+   * \param [in] index The index of the event in the scheduler.
+   */
+  void SetSchedulerIndex (uint32_t index);
+  /**
+   * \returns The index of the event in the scheduler which holds it.
+   */
+  uint32_t GetSchedulerIndex (void) const;
+
+  /**
+   * Allocate the memory of an event.
+   *
+   * The events of up to 256 bytes are rounded up to a size class of 16
+   * bytes and taken from the free list of the class, kept by each
+   * thread, so that scheduling an event does not usually allocate memory.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void *operator new (size_t size);
+  /**
+   * Release the memory of an event to the free list of its size class.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, size_t size);
+  /**
+   * Enable or disable the reuse of the memory of the events.
+   *
+   * The reuse is enabled by default. It can be changed at any time.
+   *
+   * \param [in] enabled Whether the memory of the events is reused.
+   */
+  static void EnablePool (bool enabled);
 
 protected:
   /**
@@ -77,6 +119,7 @@ protected:
 
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
+  uint32_t m_schedulerIndex;  /**< The index of the event in its scheduler. */
 };
 
 } // namespace ns3
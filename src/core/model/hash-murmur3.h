@@ -92,6 +92,26 @@ public:
    */
   virtual void clear (void);
 
+  /**
+   * Murmur3 32-bit finalization mix.
+   *
+   * A bijective avalanche of a single 32-bit word, suitable to hash
+   * fixed-width integer keys (e.g. flow ids) without going through a
+   * byte buffer.
+   *
+   * \param [in] h the word to mix
+   * \return the mixed word
+   */
+  static inline uint32_t Fmix32 (uint32_t h)
+  {
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+  }
+
 private:
   /**
    * Seed value
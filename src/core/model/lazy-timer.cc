@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "lazy-timer.h"
+#include "simulator.h"
+#include "assert.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::LazyTimer implementation.
+ */
+
+namespace ns3 {
+
+LazyTimer::LazyTimer ()
+  : m_period (Seconds (0)),
+    m_next (Seconds (0)),
+    m_running (false)
+{
+}
+
+void
+LazyTimer::SetPeriod (Time period)
+{
+  m_period = period;
+}
+
+Time
+LazyTimer::GetPeriod (void) const
+{
+  return m_period;
+}
+
+void
+LazyTimer::Start (void)
+{
+  Start (m_period);
+}
+
+void
+LazyTimer::Start (Time delay)
+{
+  NS_ASSERT_MSG (m_period.IsStrictlyPositive (), "The period of a lazy timer must be positive");
+  m_next = Simulator::Now () + delay;
+  m_running = true;
+}
+
+void
+LazyTimer::Stop (void)
+{
+  m_running = false;
+}
+
+bool
+LazyTimer::IsRunning (void) const
+{
+  return m_running;
+}
+
+bool
+LazyTimer::IsExpired (void) const
+{
+  return m_running && m_next <= Simulator::Now ();
+}
+
+Time
+LazyTimer::Expire (void)
+{
+  NS_ASSERT (IsExpired ());
+  Time expiration = m_next;
+  m_next += m_period;
+  return expiration;
+}
+
+uint64_t
+LazyTimer::ExpireAll (void)
+{
+  if (!IsExpired ())
+    {
+      return 0;
+    }
+  uint64_t n = (Simulator::Now () - m_next).GetTimeStep () / m_period.GetTimeStep () + 1;
+  m_next += TimeStep (m_period.GetTimeStep () * n);
+  return n;
+}
+
+Time
+LazyTimer::GetNextExpiration (void) const
+{
+  return m_next;
+}
+
+Time
+LazyTimer::GetLastExpiration (void) const
+{
+  return m_next - m_period;
+}
+
+} // namespace ns3
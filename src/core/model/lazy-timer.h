@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LAZY_TIMER_H
+#define LAZY_TIMER_H
+
+#include "nstime.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::LazyTimer class declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup timer
+ * \brief A periodic timer which does not schedule any event.
+ *
+ * The owner of a periodic task which only updates its own state can poll a
+ * LazyTimer before each use of that state, and run the expirations that are
+ * due at that time, each one at its own expiration time, instead of keeping
+ * an event in the scheduler for every period. As long as the state is only
+ * read or changed after polling, the result is the same as with a periodic
+ * event, except for an expiration and an access at the same timestamp: the
+ * expiration is always considered to happen first.
+ *
+ * Expirations whose effect is known to be void (e.g., the decay of counters
+ * which are already zero) can be skipped at once with ExpireAll.
+ */
+class LazyTimer
+{
+public:
+  LazyTimer ();
+
+  /**
+   * \param [in] period The time between two expirations.
+   */
+  void SetPeriod (Time period);
+  Time GetPeriod (void) const;
+
+  /**
+   * Start the timer, the first expiration is one period from now.
+   */
+  void Start (void);
+  /**
+   * Start the timer.
+   * \param [in] delay The time from now to the first expiration.
+   */
+  void Start (Time delay);
+  void Stop (void);
+  bool IsRunning (void) const;
+
+  /**
+   * \return true if the timer is running and its next expiration is due.
+   */
+  bool IsExpired (void) const;
+  /**
+   * Consume the next expiration, which must be due.
+   * \return The time of the expiration.
+   */
+  Time Expire (void);
+  /**
+   * Consume all the due expirations.
+   * \return Their number.
+   */
+  uint64_t ExpireAll (void);
+
+  Time GetNextExpiration (void) const;
+  /**
+   * \return The time of the last consumed expiration.
+   */
+  Time GetLastExpiration (void) const;
+
+private:
+  Time m_period;
+  Time m_next;        //!< The next expiration
+  bool m_running;
+};
+
+} // namespace ns3
+
+#endif /* LAZY_TIMER_H */
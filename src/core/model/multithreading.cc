@@ -0,0 +1,39 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "multithreading.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Multithreading implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Multithreading");
+
+bool Multithreading::s_enabled = false;
+thread_local Multithreading::Counters *Multithreading::t_counters = 0;
+
+Multithreading::Counters::Counters (uint32_t partition)
+  : partition (partition),
+    packetUid (0),
+    streamIndex (0)
+{
+}
+
+void
+Multithreading::Enable (bool enabled)
+{
+  NS_LOG_FUNCTION (enabled);
+  s_enabled = enabled;
+}
+
+void
+Multithreading::SetCounters (Counters *counters)
+{
+  t_counters = counters;
+}
+
+} // namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MULTITHREADING_H
+#define MULTITHREADING_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Multithreading class declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Whether the events of the simulation run on several threads at once.
+ *
+ * The state shared by every packet and object, such as the reference counts
+ * and the free lists of the packet data, is only protected while a simulator
+ * implementation running events concurrently enables it, so that
+ * single-threaded simulations keep plain increments and free lists.
+ *
+ * It must only be enabled or disabled while a single thread runs.
+ */
+class Multithreading
+{
+public:
+  /**
+   * \param [in] enabled Whether events run on several threads from now on.
+   */
+  static void Enable (bool enabled);
+
+  /**
+   * \return true if events may run on several threads.
+   */
+  inline static bool IsEnabled (void)
+  {
+    return s_enabled;
+  }
+
+  /**
+   * Increment a reference count.
+   * \param [in,out] count The reference count.
+   */
+  inline static void Increment (uint32_t &count)
+  {
+    if (s_enabled)
+      {
+        __atomic_add_fetch (&count, 1, __ATOMIC_RELAXED);
+      }
+    else
+      {
+        count++;
+      }
+  }
+
+  /**
+   * Decrement a reference count.
+   * \param [in,out] count The reference count.
+   * \return The reference count after the decrement.
+   */
+  inline static uint32_t Decrement (uint32_t &count)
+  {
+    if (s_enabled)
+      {
+        return __atomic_sub_fetch (&count, 1, __ATOMIC_ACQ_REL);
+      }
+    return --count;
+  }
+
+  /**
+   * Increment a counter handing out unique values.
+   * \param [in,out] counter The counter.
+   * \return The value of the counter before the increment.
+   */
+  template <typename T>
+  inline static T FetchAndIncrement (T &counter)
+  {
+    if (s_enabled)
+      {
+        return __atomic_fetch_add (&counter, 1, __ATOMIC_RELAXED);
+      }
+    return counter++;
+  }
+
+  /**
+   * The unique values handed out to the events of a partition, so that they
+   * do not depend on the order in which the threads run.
+   */
+  struct Counters
+  {
+    /**
+     * Constructor.
+     * \param [in] partition The index of the partition.
+     */
+    Counters (uint32_t partition = 0);
+
+    uint32_t partition;    //!< The index of the partition
+    uint32_t packetUid;    //!< The next packet uid of the partition
+    uint64_t streamIndex;  //!< The next RNG stream index of the partition
+  };
+
+  /**
+   * \param [in] counters The counters of the partition run by the calling
+   * thread, 0 to use the process-wide ones.
+   */
+  static void SetCounters (Counters *counters);
+
+  /**
+   * \return The counters of the partition run by the calling thread, 0 if
+   * it runs none.
+   */
+  inline static Counters *GetCounters (void)
+  {
+    return t_counters;
+  }
+
+private:
+  static bool s_enabled;  //!< Whether events may run on several threads
+  static thread_local Counters *t_counters;  //!< The counters of the partition of the thread
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADING_H */
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quad-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::QuadHeapScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuadHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (QuadHeapScheduler);
+
+TypeId
+QuadHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuadHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<QuadHeapScheduler> ()
+  ;
+  return tid;
+}
+
+QuadHeapScheduler::QuadHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuadHeapScheduler::~QuadHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuadHeapScheduler::SiftUp (uint32_t index, const Event &ev)
+{
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / 4;
+      if (!(ev.key < m_heap[parent].key))
+        {
+          break;
+        }
+      m_heap[index] = m_heap[parent];
+      m_heap[index].impl->SetSchedulerIndex (index);
+      index = parent;
+    }
+  m_heap[index] = ev;
+  ev.impl->SetSchedulerIndex (index);
+}
+
+void
+QuadHeapScheduler::SiftDown (uint32_t index, const Event &ev)
+{
+  uint32_t size = m_heap.size ();
+  while (true)
+    {
+      uint32_t first = 4 * index + 1;
+      if (first >= size)
+        {
+          break;
+        }
+      uint32_t last = std::min (first + 4, size);
+      uint32_t smallest = first;
+      for (uint32_t child = first + 1; child < last; child++)
+        {
+          if (m_heap[child].key < m_heap[smallest].key)
+            {
+              smallest = child;
+            }
+        }
+      if (!(m_heap[smallest].key < ev.key))
+        {
+          break;
+        }
+      m_heap[index] = m_heap[smallest];
+      m_heap[index].impl->SetSchedulerIndex (index);
+      index = smallest;
+    }
+  m_heap[index] = ev;
+  ev.impl->SetSchedulerIndex (index);
+}
+
+void
+QuadHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  m_heap.push_back (ev);
+  SiftUp (m_heap.size () - 1, ev);
+}
+
+bool
+QuadHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_heap.empty ();
+}
+
+Scheduler::Event
+QuadHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_heap.empty ());
+  return m_heap.front ();
+}
+
+Scheduler::Event
+QuadHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_heap.empty ());
+  Event next = m_heap.front ();
+  Event last = m_heap.back ();
+  m_heap.pop_back ();
+  if (!m_heap.empty ())
+    {
+      SiftDown (0, last);
+    }
+  return next;
+}
+
+void
+QuadHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint32_t i = ev.impl->GetSchedulerIndex ();
+  NS_ASSERT (i < m_heap.size () && m_heap[i].key.m_uid == ev.key.m_uid);
+  Event last = m_heap.back ();
+  m_heap.pop_back ();
+  if (i < m_heap.size ())
+    {
+      // the last entry comes from another subtree and may
+      // have to move either way
+      if (i > 0 && last.key < m_heap[(i - 1) / 4].key)
+        {
+          SiftUp (i, last);
+        }
+      else
+        {
+          SiftDown (i, last);
+        }
+    }
+}
+
+} // namespace ns3
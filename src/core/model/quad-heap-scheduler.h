@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUAD_HEAP_SCHEDULER_H
+#define QUAD_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::QuadHeapScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a 4-ary heap event scheduler
+ *
+ * The events are kept in a single contiguous vector managed as an
+ * implicit heap in which every entry has four children. Compared to
+ * the binary heap of HeapScheduler, the heap is half as deep and the
+ * four children of an entry are adjacent in memory, so that sifting
+ * an entry down touches about half as many cache lines. Compared to
+ * MapScheduler, no memory is allocated per event once the vector has
+ * grown to the peak number of pending events.
+ *
+ * The entries are moved into the hole left by the sifted entry rather
+ * than swapped, and the root is at index 0: the children of the entry
+ * \c i are at <tt>4 i + 1</tt> to <tt>4 i + 4</tt>.
+ *
+ * This is the default scheduler, see the SchedulerType global value.
+ * Each event keeps its index in the heap with
+ * EventImpl::SetSchedulerIndex, updated whenever it is moved, so that
+ * Remove finds it at once and takes logarithmic time.
+ */
+class QuadHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  QuadHeapScheduler ();
+  /** Destructor. */
+  virtual ~QuadHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Event list type:  vector of Events, managed as a 4-ary heap. */
+  typedef std::vector<Scheduler::Event> QuadHeap;
+
+  /**
+   * Move an entry up from a given index to its proper position.
+   *
+   * \param [in] index The index of the hole to fill.
+   * \param [in] ev The entry to place.
+   */
+  void SiftUp (uint32_t index, const Scheduler::Event &ev);
+  /**
+   * Move an entry down from a given index to its proper position.
+   *
+   * \param [in] index The index of the hole to fill.
+   * \param [in] ev The entry to place.
+   */
+  void SiftDown (uint32_t index, const Scheduler::Event &ev);
+
+  /** The event list. */
+  QuadHeap m_heap;
+};
+
+} // namespace ns3
+
+#endif /* QUAD_HEAP_SCHEDULER_H */
@@ -23,6 +23,7 @@
 #include "integer.h"
 #include "config.h"
 #include "log.h"
+#include "multithreading.h"
 
 /**
  * \file
@@ -94,9 +95,13 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint64_t next = g_nextStreamIndex;
-  g_nextStreamIndex++;
-  return next;
+  Multithreading::Counters *counters = Multithreading::GetCounters ();
+  if (counters != 0)
+    {
+      // each partition of a multithreaded run has its own range of streams
+      return static_cast<uint64_t> (counters->partition + 1) << 48 | counters->streamIndex++;
+    }
+  return Multithreading::FetchAndIncrement (g_nextStreamIndex);
 }
 
 } // namespace ns3
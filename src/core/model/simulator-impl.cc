@@ -42,4 +42,11 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+EventId
+SimulatorImpl::ScheduleTimeout (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  return Schedule (delay, event);
+}
+
 } // namespace ns3
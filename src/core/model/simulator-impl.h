@@ -65,6 +65,12 @@ public:
   virtual void Stop (Time const &delay) = 0;
   /** \copydoc Simulator::Schedule(const Time&,const Ptr<EventImpl>&) */
   virtual EventId Schedule (Time const &delay, EventImpl *event) = 0;
+  /**
+   * \copydoc Simulator::ScheduleTimeout(const Time&,const Ptr<EventImpl>&)
+   *
+   * The default implementation schedules the timeout as an event.
+   */
+  virtual EventId ScheduleTimeout (Time const &delay, EventImpl *event);
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
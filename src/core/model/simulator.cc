@@ -21,7 +21,7 @@
 #include "simulator.h"
 #include "simulator-impl.h"
 #include "scheduler.h"
-#include "map-scheduler.h"
+#include "quad-heap-scheduler.h"
 #include "event-impl.h"
 
 #include "ptr.h"
@@ -72,7 +72,7 @@ static GlobalValue g_simTypeImpl = GlobalValue
  */
 static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
                                                   "The object class to use as the scheduler implementation",
-                                                  TypeIdValue (MapScheduler::GetTypeId ()),
+                                                  TypeIdValue (QuadHeapScheduler::GetTypeId ()),
                                                   MakeTypeIdChecker ());
 
 /**
@@ -241,6 +241,12 @@ Simulator::Schedule (Time const &delay, const Ptr<EventImpl> &event)
   return DoSchedule (delay, GetPointer (event));
 }
 
+EventId
+Simulator::ScheduleTimeout (Time const &delay, const Ptr<EventImpl> &event)
+{
+  return DoScheduleTimeout (delay, GetPointer (event));
+}
+
 EventId
 Simulator::ScheduleNow (const Ptr<EventImpl> &ev)
 {
@@ -262,6 +268,11 @@ Simulator::DoSchedule (Time const &time, EventImpl *impl)
   return GetImpl ()->Schedule (time, impl);
 }
 EventId 
+Simulator::DoScheduleTimeout (Time const &time, EventImpl *impl)
+{
+  return GetImpl ()->ScheduleTimeout (time, impl);
+}
+EventId 
 Simulator::DoScheduleNow (EventImpl *impl)
 {
   return GetImpl ()->ScheduleNow (impl);
@@ -279,6 +290,12 @@ Simulator::Schedule (Time const &delay, void (*f)(void))
   return DoSchedule (delay, MakeEvent (f));
 }
 
+EventId
+Simulator::ScheduleTimeout (Time const &delay, void (*f)(void))
+{
+  return DoScheduleTimeout (delay, MakeEvent (f));
+}
+
 void
 Simulator::ScheduleWithContext (uint32_t context, Time const &delay, void (*f)(void))
 {
@@ -272,7 +272,7 @@ MakeTimerImpl (IntToType<0>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn);
+      return Simulator::ScheduleTimeout (delay, m_fn);
     }
     virtual void Invoke (void)
     {
@@ -307,7 +307,7 @@ MakeTimerImpl (IntToType<1>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1);
     }
     virtual void Invoke (void)
     {
@@ -347,7 +347,7 @@ MakeTimerImpl (IntToType<2>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1, m_a2);
     }
     virtual void Invoke (void)
     {
@@ -392,7 +392,7 @@ MakeTimerImpl (IntToType<3>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1, m_a2, m_a3);
     }
     virtual void Invoke (void)
     {
@@ -442,7 +442,7 @@ MakeTimerImpl (IntToType<4>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1, m_a2, m_a3, m_a4);
     }
     virtual void Invoke (void)
     {
@@ -497,7 +497,7 @@ MakeTimerImpl (IntToType<5>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
     virtual void Invoke (void)
     {
@@ -557,7 +557,7 @@ MakeTimerImpl (IntToType<6>, FN fn)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+      return Simulator::ScheduleTimeout (delay, m_fn, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
     virtual void Invoke (void)
     {
@@ -647,7 +647,7 @@ MakeTimerImpl (IntToType<0>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr);
     }
     virtual void Invoke (void)
     {
@@ -684,7 +684,7 @@ MakeTimerImpl (IntToType<1>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1);
     }
     virtual void Invoke (void)
     {
@@ -726,7 +726,7 @@ MakeTimerImpl (IntToType<2>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1, m_a2);
     }
     virtual void Invoke (void)
     {
@@ -773,7 +773,7 @@ MakeTimerImpl (IntToType<3>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3);
     }
     virtual void Invoke (void)
     {
@@ -825,7 +825,7 @@ MakeTimerImpl (IntToType<4>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4);
     }
     virtual void Invoke (void)
     {
@@ -882,7 +882,7 @@ MakeTimerImpl (IntToType<5>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5);
     }
     virtual void Invoke (void)
     {
@@ -944,7 +944,7 @@ MakeTimerImpl (IntToType<6>, MEM_PTR memPtr, OBJ_PTR objPtr)
     }
     virtual EventId Schedule (const Time &delay)
     {
-      return Simulator::Schedule (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
+      return Simulator::ScheduleTimeout (delay, m_memPtr, m_objPtr, m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
     virtual void Invoke (void)
     {
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "timer-wheel-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <string.h>
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::TimerWheelScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheelScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TimerWheelScheduler);
+
+TypeId
+TimerWheelScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerWheelScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimerWheelScheduler> ()
+  ;
+  return tid;
+}
+
+TimerWheelScheduler::TimerWheelScheduler ()
+  : m_current (0),
+    m_free (NONE),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  memset (m_slots, 0xff, sizeof (m_slots));
+  memset (m_tails, 0xff, sizeof (m_tails));
+  memset (m_used, 0, sizeof (m_used));
+  memset (m_sorted, 0, sizeof (m_sorted));
+}
+
+TimerWheelScheduler::~TimerWheelScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+TimerWheelScheduler::GetLevel (uint64_t ts) const
+{
+  uint64_t diff = ts ^ m_current;
+  if (diff == 0)
+    {
+      return 0;
+    }
+  return (63 - __builtin_clzll (diff)) / SLOT_BITS;
+}
+
+void
+TimerWheelScheduler::Link (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  uint64_t ts = entry.ev.key.m_ts;
+  entry.level = GetLevel (ts);
+  entry.slot = (ts >> (entry.level * SLOT_BITS)) & (SLOTS - 1);
+  uint64_t bit = (uint64_t)1 << entry.slot;
+  uint32_t &head = m_slots[entry.level][entry.slot];
+  uint32_t &tail = m_tails[entry.level][entry.slot];
+  // the entry goes after the last one of a sorted slot which is not
+  // later, most events being scheduled after the ones of their slot
+  uint32_t prev = NONE;
+  if ((m_sorted[entry.level] & bit) != 0)
+    {
+      prev = tail;
+      while (prev != NONE && entry.ev.key < m_entries[prev].ev.key)
+        {
+          prev = m_entries[prev].prev;
+        }
+    }
+  uint32_t &next = prev == NONE ? head : m_entries[prev].next;
+  entry.prev = prev;
+  entry.next = next;
+  if (next != NONE)
+    {
+      m_entries[next].prev = index;
+    }
+  else
+    {
+      tail = index;
+    }
+  next = index;
+  m_used[entry.level] |= bit;
+}
+
+void
+TimerWheelScheduler::Unlink (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  if (entry.prev != NONE)
+    {
+      m_entries[entry.prev].next = entry.next;
+    }
+  else
+    {
+      m_slots[entry.level][entry.slot] = entry.next;
+      if (entry.next == NONE)
+        {
+          m_used[entry.level] &= ~((uint64_t)1 << entry.slot);
+          m_sorted[entry.level] &= ~((uint64_t)1 << entry.slot);
+        }
+    }
+  if (entry.next != NONE)
+    {
+      m_entries[entry.next].prev = entry.prev;
+    }
+  else
+    {
+      m_tails[entry.level][entry.slot] = entry.prev;
+    }
+}
+
+void
+TimerWheelScheduler::Sort (uint32_t level, uint32_t slot)
+{
+  m_sort.clear ();
+  for (uint32_t i = m_slots[level][slot]; i != NONE; i = m_entries[i].next)
+    {
+      m_sort.push_back (std::make_pair (m_entries[i].ev.key, i));
+    }
+  // the keys are unique, the indices are never compared
+  std::sort (m_sort.begin (), m_sort.end ());
+  uint32_t prev = NONE;
+  for (SortedEntries::iterator i = m_sort.begin (); i != m_sort.end (); i++)
+    {
+      uint32_t index = i->second;
+      m_entries[index].prev = prev;
+      m_entries[index].next = NONE;
+      if (prev == NONE)
+        {
+          m_slots[level][slot] = index;
+        }
+      else
+        {
+          m_entries[prev].next = index;
+        }
+      prev = index;
+    }
+  m_tails[level][slot] = prev;
+  m_sorted[level] |= (uint64_t)1 << slot;
+}
+
+uint32_t
+TimerWheelScheduler::FindNext (void)
+{
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      if (m_used[level] == 0)
+        {
+          continue;
+        }
+      // the events of the upper levels and of the next slots of
+      // this level are all later than the ones of this slot
+      uint32_t slot = __builtin_ctzll (m_used[level]);
+      if ((m_sorted[level] & ((uint64_t)1 << slot)) == 0)
+        {
+          Sort (level, slot);
+        }
+      return m_slots[level][slot];
+    }
+  NS_ASSERT (false);
+  return NONE;
+}
+
+void
+TimerWheelScheduler::Advance (uint64_t ts)
+{
+  NS_ASSERT (ts >= m_current);
+  // The slots of the current time in the upper levels are empty, and
+  // stay at the same place in the levels above the one of the new time
+  uint32_t top = GetLevel (ts);
+  m_current = ts;
+  // In each level, the slot of the new time can only hold events
+  // which share this slot with it, and which belong to a lower level
+  // from now on. Moving them down from the top level makes them
+  // reach the slot of the new time in the first level.
+  for (uint32_t level = top; level > 0; level--)
+    {
+      uint32_t slot = (ts >> (level * SLOT_BITS)) & (SLOTS - 1);
+      if ((m_used[level] & ((uint64_t)1 << slot)) == 0)
+        {
+          continue;
+        }
+      uint32_t index = m_slots[level][slot];
+      m_slots[level][slot] = NONE;
+      m_tails[level][slot] = NONE;
+      m_used[level] &= ~((uint64_t)1 << slot);
+      m_sorted[level] &= ~((uint64_t)1 << slot);
+      while (index != NONE)
+        {
+          uint32_t next = m_entries[index].next;
+          Link (index);
+          NS_ASSERT (m_entries[index].level < level);
+          index = next;
+        }
+    }
+}
+
+void
+TimerWheelScheduler::Release (uint32_t index)
+{
+  m_entries[index].level = LEVELS;
+  m_entries[index].next = m_free;
+  m_free = index;
+  m_size--;
+}
+
+void
+TimerWheelScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_ASSERT (ev.key.m_ts >= m_current);
+  uint32_t index = m_free;
+  if (index == NONE)
+    {
+      index = m_entries.size ();
+      m_entries.push_back (Entry ());
+    }
+  else
+    {
+      m_free = m_entries[index].next;
+    }
+  m_entries[index].ev = ev;
+  Link (index);
+  ev.impl->SetSchedulerIndex (index);
+  m_size++;
+}
+
+bool
+TimerWheelScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+TimerWheelScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // sorting the slot of the next event does not change the events
+  return m_entries[const_cast<TimerWheelScheduler *> (this)->FindNext ()].ev;
+}
+
+Scheduler::Event
+TimerWheelScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  uint32_t index = FindNext ();
+  Event next = m_entries[index].ev;
+  Advance (next.key.m_ts);
+  Unlink (index);
+  Release (index);
+  return next;
+}
+
+void
+TimerWheelScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_ASSERT (Contains (ev.impl, ev.key.m_uid));
+  uint32_t index = ev.impl->GetSchedulerIndex ();
+  Unlink (index);
+  Release (index);
+}
+
+bool
+TimerWheelScheduler::Contains (const EventImpl *impl, uint32_t uid) const
+{
+  // the index of the event may have been set by another scheduler
+  uint32_t index = impl->GetSchedulerIndex ();
+  return index < m_entries.size ()
+         && m_entries[index].level < LEVELS
+         && m_entries[index].ev.key.m_uid == uid;
+}
+
+} // namespace ns3
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_SCHEDULER_H
+#define TIMER_WHEEL_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <utility>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::TimerWheelScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a hierarchical timer wheel event scheduler
+ *
+ * The timestamps are split in groups of 6 bits, each level of the wheel
+ * having 64 slots indexed by one group. An event is stored in the level
+ * of the most significant group in which its timestamp differs from the
+ * current time of the wheel, in the slot given by its own value of this
+ * group, so that an event due in less than 64 time steps is in the first
+ * level and an event due in 1ms, with a 1ns resolution, in the fourth.
+ * The slots are doubly linked lists, and a bitmap per level tells which
+ * ones are used. The entries of the lists are taken from a single vector
+ * and linked by their index in it, which each event keeps with
+ * EventImpl::SetSchedulerIndex, so that no memory is allocated per event
+ * once the vector has grown to the peak number of pending events.
+ *
+ * Inserting and removing an event are done in constant time, without
+ * comparing it to the other events, and an event whose uid is known can
+ * be removed without its timestamp: this is what the timeouts need,
+ * since most of them are cancelled or rescheduled before they expire.
+ * When the wheel moves to the time of its next event, or to the current
+ * time of the simulator (see Advance), the events of the slot of this
+ * time in the upper levels are moved down. An event which expires is
+ * thus moved at most once per level, while an event cancelled early is
+ * not moved at all.
+ *
+ * The events are removed in the order of their timestamp and uid, like
+ * with the other schedulers: the next event is the smallest one of the
+ * first used slot of the first used level, a slot of the first level
+ * holding the events of a single timestamp. This slot is sorted when it
+ * is first searched, and the events linked in a sorted slot are
+ * inserted in order from its end, so that the next event is found by
+ * scanning the bitmaps even when the timeouts are cancelled in the
+ * order they would expire.
+ *
+ * DefaultSimulatorImpl keeps the events scheduled with
+ * Simulator::ScheduleTimeout in a TimerWheelScheduler next to its main
+ * scheduler. It can also be used as the main scheduler itself.
+ */
+class TimerWheelScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  TimerWheelScheduler ();
+  /** Destructor. */
+  virtual ~TimerWheelScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+  /**
+   * Test if an event is in the wheel.
+   *
+   * \param [in] impl The event.
+   * \param [in] uid The uid of the event.
+   * \returns \c true if the event with this uid is in the wheel.
+   */
+  bool Contains (const EventImpl *impl, uint32_t uid) const;
+  /**
+   * Move the wheel to a time.
+   *
+   * The events are placed relative to the time of the wheel, in the
+   * level of the most significant group in which they differ from it.
+   * A wheel which only moves when its own events expire thus keeps the
+   * events scheduled long after its time in a few slots of the upper
+   * levels, and sorts a crowded slot to find the next event. The
+   * simulator moves it to its current time before inserting an event or
+   * looking for the next one, so that the events are spread over the
+   * slots of the lower levels.
+   *
+   * \param [in] ts The time, not before the time of the wheel nor after
+   *             the next event.
+   */
+  void Advance (uint64_t ts);
+
+private:
+  /** The number of bits of the timestamp per level. */
+  static const uint32_t SLOT_BITS = 6;
+  /** The number of slots per level. */
+  static const uint32_t SLOTS = 1 << SLOT_BITS;
+  /** The number of levels to cover 64 bit timestamps. */
+  static const uint32_t LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+
+  /** The index of no entry. */
+  static const uint32_t NONE = 0xffffffff;
+
+  /** An event linked in a slot. */
+  struct Entry
+  {
+    Scheduler::Event ev;  //!< The event
+    uint32_t prev;        //!< The previous entry of the slot
+    uint32_t next;        //!< The next entry of the slot, or of the free list
+    uint32_t level;       //!< The level of the slot, LEVELS if the entry is free
+    uint32_t slot;        //!< The index of the slot in its level
+  };
+
+  /**
+   * Get the level of a timestamp.
+   *
+   * \param [in] ts The timestamp, not before the current time.
+   * \returns The level of the slot of \p ts.
+   */
+  inline uint32_t GetLevel (uint64_t ts) const;
+  /**
+   * Link an entry in the slot of its timestamp.
+   *
+   * \param [in] index The index of the entry.
+   */
+  void Link (uint32_t index);
+  /**
+   * Unlink an entry from its slot.
+   *
+   * \param [in] index The index of the entry.
+   */
+  void Unlink (uint32_t index);
+  /**
+   * Sort the entries of a slot by the key of their event.
+   *
+   * \param [in] level The level of the slot.
+   * \param [in] slot The index of the slot in its level.
+   */
+  void Sort (uint32_t level, uint32_t slot);
+  /**
+   * Find the entry of the next event, without moving the wheel.
+   *
+   * \returns The index of the entry of the next event.
+   */
+  uint32_t FindNext (void);
+  /**
+   * Release an entry.
+   *
+   * \param [in] index The index of the entry, unlinked.
+   */
+  void Release (uint32_t index);
+
+  uint32_t m_slots[LEVELS][SLOTS]; //!< The first entry of each slot
+  uint32_t m_tails[LEVELS][SLOTS]; //!< The last entry of each slot
+  uint64_t m_used[LEVELS];         //!< The bitmap of the used slots of each level
+  uint64_t m_sorted[LEVELS];       //!< The bitmap of the sorted slots of each level
+  uint64_t m_current;              //!< The current time of the wheel
+  std::vector<Entry> m_entries;    //!< The entries, linked in the slots or free
+  /** Container type: the keys and indices of the entries of a slot. */
+  typedef std::vector<std::pair<Scheduler::EventKey, uint32_t> > SortedEntries;
+  SortedEntries m_sort;            //!< The entries of the slot being sorted
+  uint32_t m_free;                 //!< The first released entry
+  uint32_t m_size;                 //!< The number of events in the wheel
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_SCHEDULER_H */
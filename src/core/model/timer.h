@@ -68,6 +68,9 @@ class TimerImpl;
  * management policies. These policies are specified at construction time
  * and cannot be changed after.
  *
+ * The expiration of a timer is scheduled with Simulator::ScheduleTimeout,
+ * so that cancelling or suspending it removes it from the simulator.
+ *
  * \see Watchdog for a simpler interface for a watchdog timer.
  */
 class Timer
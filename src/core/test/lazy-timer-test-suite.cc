@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/lazy-timer.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+class LazyTimerTestCase : public TestCase
+{
+public:
+  LazyTimerTestCase ();
+  virtual void DoRun (void);
+  void Poll (void);
+  void Skip (uint64_t expected);
+  LazyTimer m_timer;
+  std::vector<Time> m_expirations;
+};
+
+LazyTimerTestCase::LazyTimerTestCase ()
+  : TestCase ("Check the expirations reported by a lazy timer")
+{
+}
+
+void
+LazyTimerTestCase::Poll (void)
+{
+  while (m_timer.IsExpired ())
+    {
+      m_expirations.push_back (m_timer.Expire ());
+    }
+}
+
+void
+LazyTimerTestCase::Skip (uint64_t expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_timer.ExpireAll (), expected, "Unexpected number of skipped expirations");
+}
+
+void
+LazyTimerTestCase::DoRun (void)
+{
+  m_timer.SetPeriod (MicroSeconds (10));
+  m_timer.Start ();
+  NS_TEST_ASSERT_MSG_EQ (m_timer.IsExpired (), false, "The timer should not expire at once");
+
+  Simulator::Schedule (MicroSeconds (35), &LazyTimerTestCase::Poll, this);
+  Simulator::Schedule (MicroSeconds (40), &LazyTimerTestCase::Poll, this);
+  Simulator::Schedule (MicroSeconds (100), &LazyTimerTestCase::Skip, this, 6);
+  Simulator::Schedule (MicroSeconds (100), &LazyTimerTestCase::Skip, this, 0);
+  Simulator::Schedule (MicroSeconds (112), &LazyTimerTestCase::Poll, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_expirations.size (), 5, "Every due expiration should be reported once");
+  NS_TEST_EXPECT_MSG_EQ (m_expirations[0], MicroSeconds (10), "The first expiration should be one period after the start");
+  NS_TEST_EXPECT_MSG_EQ (m_expirations[2], MicroSeconds (30), "The expirations should be reported in order");
+  NS_TEST_EXPECT_MSG_EQ (m_expirations[3], MicroSeconds (40), "An expiration at the polling time should be due");
+  NS_TEST_EXPECT_MSG_EQ (m_expirations[4], MicroSeconds (110), "The skipped expirations should keep the phase");
+  NS_TEST_EXPECT_MSG_EQ (m_timer.GetLastExpiration (), MicroSeconds (110), "Wrong last expiration");
+
+  m_timer.Stop ();
+  NS_TEST_EXPECT_MSG_EQ (m_timer.IsExpired (), false, "A stopped timer should not expire");
+}
+
+static class LazyTimerTestSuite : public TestSuite
+{
+public:
+  LazyTimerTestSuite ()
+    : TestSuite ("lazy-timer", UNIT)
+  {
+    AddTestCase (new LazyTimerTestCase (), TestCase::QUICK);
+  }
+} g_lazyTimerTestSuite;
@@ -23,6 +23,9 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/quad-heap-scheduler.h"
+#include "ns3/timer-wheel-scheduler.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +462,295 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Record1 (uint32_t a);
+  void Record5 (uint32_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e);
+  std::vector<uint64_t> m_values;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the memory of the events is reused")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Record1 (uint32_t a)
+{
+  m_values.push_back (a);
+}
+
+void
+SimulatorEventPoolTestCase::Record5 (uint32_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e)
+{
+  m_values.push_back (a + b + c + d + e);
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  // a released event is reused for the next event of its size class
+  EventImpl *first = MakeEvent (&SimulatorEventPoolTestCase::Record1, this, 1);
+  first->Unref ();
+  EventImpl *second = MakeEvent (&SimulatorEventPoolTestCase::Record1, this, 2);
+  NS_TEST_EXPECT_MSG_EQ (second, first, "The released event should be reused");
+  second->Invoke ();
+  second->Unref ();
+
+  EventImpl::EnablePool (false);
+  EventImpl *third = MakeEvent (&SimulatorEventPoolTestCase::Record1, this, 3);
+  NS_TEST_EXPECT_MSG_NE (third, first, "The released event should not be reused without the pool");
+  third->Invoke ();
+  third->Unref ();
+  EventImpl::EnablePool (true);
+
+  // the events of different sizes keep their arguments
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (NanoSeconds (2 * i), &SimulatorEventPoolTestCase::Record1, this, i);
+      Simulator::Schedule (NanoSeconds (2 * i + 1), &SimulatorEventPoolTestCase::Record5, this, i, 1, 2, 3, 4);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_values.size (), 202, "Every event should run");
+  NS_TEST_EXPECT_MSG_EQ (m_values[0], 2, "Unexpected argument");
+  NS_TEST_EXPECT_MSG_EQ (m_values[1], 3, "Unexpected argument");
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_values[2 + 2 * i], i, "Unexpected argument");
+      NS_TEST_EXPECT_MSG_EQ (m_values[3 + 2 * i], i + 10, "Unexpected argument");
+    }
+}
+
+class QuadHeapRemoveTestCase : public TestCase
+{
+public:
+  QuadHeapRemoveTestCase ();
+private:
+  virtual void DoRun (void);
+  void Record (uint32_t value);
+};
+
+QuadHeapRemoveTestCase::QuadHeapRemoveTestCase ()
+  : TestCase ("Check that the events removed from the 4-ary heap leave it in order")
+{
+}
+
+void
+QuadHeapRemoveTestCase::Record (uint32_t value)
+{
+}
+
+void
+QuadHeapRemoveTestCase::DoRun (void)
+{
+  uint64_t ts = 54321;
+  std::vector<Scheduler::Event> events;
+  std::vector<Ptr<EventImpl> > impls;
+  Ptr<QuadHeapScheduler> heap = CreateObject<QuadHeapScheduler> ();
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      ts = (ts * 6364136223846793005ULL + 1442695040888963407ULL);
+      impls.push_back (Ptr<EventImpl> (MakeEvent (&QuadHeapRemoveTestCase::Record, this, i), false));
+      Scheduler::Event ev;
+      ev.impl = PeekPointer (impls.back ());
+      ev.key.m_ts = (ts >> 20) % 100000;
+      ev.key.m_uid = i;
+      ev.key.m_context = 0;
+      events.push_back (ev);
+    }
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      heap->Insert (events[i]);
+    }
+  // the removed events are found by their index, wherever the
+  // insertions of the other events moved them
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      if (i % 3 == 0)
+        {
+          heap->Remove (events[i]);
+        }
+      heap->Insert (events[1000 + i]);
+    }
+  Scheduler::Event last = heap->RemoveNext ();
+  uint32_t n = 1;
+  while (!heap->IsEmpty ())
+    {
+      Scheduler::Event next = heap->RemoveNext ();
+      NS_TEST_EXPECT_MSG_EQ ((last.key < next.key), true, "The events should be removed in order");
+      NS_TEST_EXPECT_MSG_EQ ((next.key.m_uid >= 1000 || next.key.m_uid % 3 != 0), true, "A removed event should not come out");
+      last = next;
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 1666, "Every event left should come out");
+}
+
+class SimulatorTimeoutTestCase : public TestCase
+{
+public:
+  SimulatorTimeoutTestCase ();
+private:
+  virtual void DoRun (void);
+  void Record (uint32_t value);
+  void Reschedule (void);
+  std::vector<uint32_t> m_values;
+  EventId m_timeout;
+};
+
+SimulatorTimeoutTestCase::SimulatorTimeoutTestCase ()
+  : TestCase ("Check that the timeouts run in order and are removed when cancelled")
+{
+}
+
+void
+SimulatorTimeoutTestCase::Record (uint32_t value)
+{
+  m_values.push_back (value);
+}
+
+void
+SimulatorTimeoutTestCase::Reschedule (void)
+{
+  Simulator::Cancel (m_timeout);
+  NS_TEST_EXPECT_MSG_EQ (m_timeout.IsExpired (), true, "A cancelled timeout should be expired");
+  m_timeout = Simulator::ScheduleTimeout (MicroSeconds (5), &SimulatorTimeoutTestCase::Record, this, 7);
+}
+
+void
+SimulatorTimeoutTestCase::DoRun (void)
+{
+  // the wheel keeps the order of the timestamps and uids
+  uint64_t ts = 12345;
+  std::vector<Scheduler::Event> events;
+  std::vector<Ptr<EventImpl> > impls;
+  Ptr<TimerWheelScheduler> wheel = CreateObject<TimerWheelScheduler> ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ts = (ts * 6364136223846793005ULL + 1442695040888963407ULL);
+      impls.push_back (Ptr<EventImpl> (MakeEvent (&SimulatorTimeoutTestCase::Record, this, i), false));
+      Scheduler::Event ev;
+      ev.impl = PeekPointer (impls.back ());
+      ev.key.m_ts = (ts >> 20) % (i % 2 ? 1000 : 10000000000ULL);
+      ev.key.m_uid = i;
+      ev.key.m_context = 0;
+      wheel->Insert (ev);
+      events.push_back (ev);
+    }
+  for (uint32_t i = 0; i < 1000; i += 3)
+    {
+      wheel->Remove (events[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (wheel->Contains (events[3].impl, 3), false, "A removed event should not be in the wheel");
+  NS_TEST_EXPECT_MSG_EQ (wheel->Contains (events[4].impl, 4), true, "An event should be in the wheel");
+  Scheduler::Event last = wheel->RemoveNext ();
+  uint32_t n = 1;
+  while (!wheel->IsEmpty ())
+    {
+      Scheduler::Event next = wheel->RemoveNext ();
+      NS_TEST_EXPECT_MSG_EQ ((last.key < next.key), true, "The events should be removed in order");
+      NS_TEST_EXPECT_MSG_NE (next.key.m_uid % 3, 0, "A removed event should not come out");
+      last = next;
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 666, "Every event left should come out");
+
+  // the timeouts and the events of the same time run in the order they were scheduled
+  Simulator::Schedule (MicroSeconds (1), &SimulatorTimeoutTestCase::Record, this, 0);
+  Simulator::ScheduleTimeout (MicroSeconds (1), &SimulatorTimeoutTestCase::Record, this, 1);
+  Simulator::Schedule (MicroSeconds (1), &SimulatorTimeoutTestCase::Record, this, 2);
+  Simulator::ScheduleTimeout (MicroSeconds (2), &SimulatorTimeoutTestCase::Record, this, 4);
+  Simulator::Schedule (MicroSeconds (2), &SimulatorTimeoutTestCase::Record, this, 5);
+  Simulator::ScheduleTimeout (NanoSeconds (1500), &SimulatorTimeoutTestCase::Record, this, 3);
+  EventId cancelled = Simulator::ScheduleTimeout (MicroSeconds (1), &SimulatorTimeoutTestCase::Record, this, 100);
+  EventId removed = Simulator::ScheduleTimeout (Seconds (1), &SimulatorTimeoutTestCase::Record, this, 101);
+  m_timeout = Simulator::ScheduleTimeout (MicroSeconds (3), &SimulatorTimeoutTestCase::Record, this, 102);
+  Simulator::Schedule (MicroSeconds (2), &SimulatorTimeoutTestCase::Reschedule, this);
+  Simulator::Schedule (MicroSeconds (6), &SimulatorTimeoutTestCase::Record, this, 6);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetDelayLeft (removed), Seconds (1), "Unexpected delay left");
+  cancelled.Cancel ();
+  Simulator::Remove (removed);
+  NS_TEST_EXPECT_MSG_EQ (cancelled.IsExpired (), true, "A cancelled timeout should be expired");
+  NS_TEST_EXPECT_MSG_EQ (removed.IsExpired (), true, "A removed timeout should be expired");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MicroSeconds (7), "The simulation should end with the last timeout");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_values.size (), 8, "Unexpected number of events run");
+  for (uint32_t i = 0; i < m_values.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_values[i], i, "Unexpected order of the events");
+    }
+}
+
+class SimulatorTimeoutRearmTestCase : public TestCase
+{
+public:
+  SimulatorTimeoutRearmTestCase ();
+private:
+  virtual void DoRun (void);
+  void Rearm (uint32_t flow);
+  void Expire (uint32_t flow);
+  std::vector<EventId> m_timeouts;
+  std::vector<Time> m_rearmed;
+  std::vector<Time> m_expired;
+  Time m_last;
+};
+
+SimulatorTimeoutRearmTestCase::SimulatorTimeoutRearmTestCase ()
+  : TestCase ("Check the timeouts which are cancelled and rescheduled many times")
+{
+}
+
+void
+SimulatorTimeoutRearmTestCase::Rearm (uint32_t flow)
+{
+  Simulator::Cancel (m_timeouts[flow]);
+  m_timeouts[flow] = Simulator::ScheduleTimeout (MilliSeconds (200), &SimulatorTimeoutRearmTestCase::Expire, this, flow);
+  m_rearmed[flow] = Simulator::Now ();
+  if (Simulator::Now () < MilliSeconds (20))
+    {
+      Simulator::Schedule (MicroSeconds (100 + flow), &SimulatorTimeoutRearmTestCase::Rearm, this, flow);
+    }
+}
+
+void
+SimulatorTimeoutRearmTestCase::Expire (uint32_t flow)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_expired[flow], Time (0), "A timeout should expire once");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), m_rearmed[flow] + MilliSeconds (200), "The last timeout should expire");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (Simulator::Now (), m_last, "The timeouts should expire in order");
+  m_expired[flow] = Simulator::Now ();
+  m_last = Simulator::Now ();
+}
+
+void
+SimulatorTimeoutRearmTestCase::DoRun (void)
+{
+  // the wheel follows the time of the events while the timeouts are
+  // rescheduled before they expire
+  uint32_t flows = 50;
+  m_timeouts.resize (flows);
+  m_rearmed.resize (flows);
+  m_expired.resize (flows);
+  for (uint32_t flow = 0; flow < flows; flow++)
+    {
+      Simulator::Schedule (NanoSeconds (flow), &SimulatorTimeoutRearmTestCase::Rearm, this, flow);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  for (uint32_t flow = 0; flow < flows; flow++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expired[flow], m_rearmed[flow] + MilliSeconds (200), "Every flow should time out");
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +767,13 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (QuadHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (TimerWheelScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new QuadHeapRemoveTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorTimeoutTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorTimeoutRearmTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
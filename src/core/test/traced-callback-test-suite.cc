@@ -62,6 +62,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New traced callback has sinks");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -70,6 +71,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Connected traced callback has no sinks");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -90,6 +92,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // If we now disconnect callback two then neither callback should be called.
   //
   trace.DisconnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "Disconnected traced callback has sinks");
   m_one = false;
   m_two = false;
   trace (1, 2);
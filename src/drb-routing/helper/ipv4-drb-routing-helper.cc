@@ -55,5 +55,19 @@ Ipv4DrbRoutingHelper::GetDrbRouting (Ptr<Ipv4> ipv4) const
   return 0;
 }
 
+int64_t
+Ipv4DrbRoutingHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+  {
+    Ptr<Ipv4DrbRouting> routing = GetDrbRouting ((*i)->GetObject<Ipv4> ());
+    if (routing != 0)
+    {
+      currentStream += routing->AssignStreams (currentStream);
+    }
+  }
+  return (currentStream - stream);
 }
 
+}
@@ -8,6 +8,7 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <set>
 
@@ -36,6 +37,15 @@ public:
           const std::set<Ipv4Address>& exclusiveIPs = std::set<Ipv4Address> ());
   bool AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t path);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model. Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -56,6 +66,8 @@ private:
   std::map<uint32_t, uint32_t> m_indexMap;
   enum DrbRoutingMode m_mode;
 
+  Ptr<UniformRandomVariable> m_rand;
+
   Ptr<Ipv4> m_ipv4;
 };
 
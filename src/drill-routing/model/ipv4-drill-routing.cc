@@ -38,6 +38,7 @@ Ipv4DrillRouting::Ipv4DrillRouting ()
     : m_d (2)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrillRouting::~Ipv4DrillRouting ()
@@ -45,6 +46,14 @@ Ipv4DrillRouting::~Ipv4DrillRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+int64_t
+Ipv4DrillRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4DrillRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
 {
@@ -54,6 +63,7 @@ Ipv4DrillRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t
   drillRouteEntry.networkMask = networkMask;
   drillRouteEntry.port = port;
   m_routeEntryList.push_back (drillRouteEntry);
+  m_portGroups.clear ();
 }
 
 std::vector<DrillRouteEntry>
@@ -71,6 +81,28 @@ Ipv4DrillRouting::LookupDrillRouteEntries (Ipv4Address dest)
   return drillRouteEntries;
 }
 
+std::vector<uint32_t> &
+Ipv4DrillRouting::LookupPortGroup (Ipv4Address dest)
+{
+  std::map<Ipv4Address, std::vector<uint32_t> >::iterator groupItr = m_portGroups.find (dest);
+  if (groupItr != m_portGroups.end ())
+  {
+    return groupItr->second;
+  }
+
+  // First packet towards this destination, compile the ports of all the matching routes
+  std::vector<uint32_t> &ports = m_portGroups[dest];
+  std::vector<DrillRouteEntry>::iterator itr = m_routeEntryList.begin ();
+  for ( ; itr != m_routeEntryList.end (); ++itr)
+  {
+    if((*itr).networkMask.IsMatch(dest, (*itr).network))
+    {
+      ports.push_back ((*itr).port);
+    }
+  }
+  return ports;
+}
+
 uint32_t
 Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
 {
@@ -113,6 +145,14 @@ Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
 Ptr<Ipv4Route>
 Ipv4DrillRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
+  // Routes are never modified once built, reuse the one of this port and destination
+  std::pair<uint32_t, Ipv4Address> key = std::make_pair (port, destAddress);
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> >::iterator routeItr = m_routeCache.find (key);
+  if (routeItr != m_routeCache.end ())
+  {
+    return routeItr->second;
+  }
+
   Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
   Ptr<Channel> channel = dev->GetChannel ();
   uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
@@ -124,6 +164,7 @@ Ipv4DrillRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
   route->SetGateway (nextHopAddr);
   route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
   route->SetDestination (destAddress);
+  m_routeCache[key] = route;
   return route;
 }
 
@@ -164,7 +205,7 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  std::vector<DrillRouteEntry> allPorts = Ipv4DrillRouting::LookupDrillRouteEntries (destAddress);
+  std::vector<uint32_t> &allPorts = Ipv4DrillRouting::LookupPortGroup (destAddress);
 
   if (allPorts.empty ())
   {
@@ -176,8 +217,6 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   uint32_t leastLoadInterface = 0;
   uint32_t leastLoad = std::numeric_limits<uint32_t>::max ();
 
-  std::random_shuffle (allPorts.begin (), allPorts.end ());
-
   std::map<Ipv4Address, uint32_t>::iterator itr = m_previousBestQueueMap.find (destAddress);
 
   if (itr != m_previousBestQueueMap.end ())
@@ -188,13 +227,16 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   uint32_t sampleNum = m_d < allPorts.size () ? m_d : allPorts.size ();
 
+  // Sample d distinct ports with a partial Fisher-Yates shuffle of the cached group,
+  // the order of the group does not matter to later lookups
   for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort ++)
   {
-    uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (allPorts[samplePort].port);
+    std::swap (allPorts[samplePort], allPorts[m_rand->GetInteger (samplePort, allPorts.size () - 1)]);
+    uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (allPorts[samplePort]);
     if (sampleLoad < leastLoad)
     {
       leastLoad = sampleLoad;
-      leastLoadInterface = allPorts[samplePort].port;
+      leastLoadInterface = allPorts[samplePort];
     }
   }
 
@@ -211,21 +253,25 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 void
 Ipv4DrillRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4DrillRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4DrillRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4DrillRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
@@ -244,6 +290,7 @@ Ipv4DrillRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4DrillRouting::DoDispose (void)
 {
+  m_routeCache.clear ();
 }
 }
 
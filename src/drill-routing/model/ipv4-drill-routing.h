@@ -8,6 +8,7 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
 #include <map>
@@ -32,9 +33,20 @@ public:
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
   std::vector<DrillRouteEntry> LookupDrillRouteEntries (Ipv4Address dest);
 
+  // The ports of all the routes matching the destination, compiled on the first lookup
+  std::vector<uint32_t> & LookupPortGroup (Ipv4Address dest);
+
   uint32_t CalculateQueueLength (uint32_t interface);
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model. Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
 
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
@@ -54,8 +66,16 @@ private:
   uint32_t m_d;
   std::map<Ipv4Address, uint32_t> m_previousBestQueueMap;
 
+  Ptr<UniformRandomVariable> m_rand;
+
   Ptr<Ipv4> m_ipv4;
   std::vector<DrillRouteEntry> m_routeEntryList;
+
+  // (port, destination) to route cache, flushed whenever an interface or address changes
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> > m_routeCache;
+
+  // Destination to port group cache, flushed whenever a route is added
+  std::map<Ipv4Address, std::vector<uint32_t> > m_portGroups;
 };
 
 }
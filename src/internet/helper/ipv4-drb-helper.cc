@@ -38,4 +38,24 @@ Ipv4DrbHelper::GetIpv4Drb (Ptr<Ipv4> ipv4) const
   return 0;
 }
 
+int64_t
+Ipv4DrbHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+  {
+    Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4> ();
+    if (ipv4 == 0)
+    {
+      continue;
+    }
+    Ptr<Ipv4Drb> drb = GetIpv4Drb (ipv4);
+    if (drb != 0)
+    {
+      currentStream += drb->AssignStreams (currentStream);
+    }
+  }
+  return (currentStream - stream);
+}
+
 }
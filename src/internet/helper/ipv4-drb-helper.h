@@ -2,6 +2,7 @@
 #define IPV4_DRB_HELPER
 
 #include "ns3/node.h"
+#include "ns3/node-container.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-drb.h"
 
@@ -16,6 +17,17 @@ public:
   Ipv4DrbHelper *Copy (void) const;
   virtual Ptr<Ipv4Drb> Create (Ptr<Node> node) const;
   Ptr<Ipv4Drb> GetIpv4Drb(Ptr<Ipv4> ipv4) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the Ipv4Drb of the nodes. Return the number of streams that
+   * have been assigned.
+   *
+   * \param c NodeContainer of the set of nodes whose Ipv4Drb should use a fixed stream
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
 };
 
 }
@@ -82,6 +82,16 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes installed by PopulateRoutingTables() after a
+   * change of the topology, such as a link going down.
+   *
+   * The routing tables end up the same as after RecomputeRoutingTables(),
+   * but the routes of a node are only computed again when the change may
+   * modify them; otherwise the node only loses its routes to the hosts and
+   * networks which are no longer reachable.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
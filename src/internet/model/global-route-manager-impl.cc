@@ -25,12 +25,17 @@
 #include <utility>
 #include <vector>
 #include <queue>
+#include <set>
 #include <algorithm>
 #include <iostream>
+#include <unistd.h>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-thread.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
@@ -44,6 +49,16 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * The number of threads computing the routes of the routers.
+ *
+ * This is accessible as "--GlobalRoutingThreads" from CommandLine.
+ */
+static GlobalValue g_globalRoutingThreads ("GlobalRoutingThreads",
+                                           "The number of threads computing the global routes, 0 for one per processor",
+                                           UintegerValue (0),
+                                           MakeUintegerChecker<uint32_t> ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -531,6 +546,606 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+// ---------------------------------------------------------------------------
+//
+// SPFGraph Implementation
+//
+// ---------------------------------------------------------------------------
+
+/// The status of the vertices in an SPF calculation
+enum SPFGraphStatus
+{
+  SPF_GRAPH_NOT_EXPLORED = 0,
+  SPF_GRAPH_CANDIDATE,
+  SPF_GRAPH_IN_SPFTREE
+};
+
+/**
+ * A candidate in the SPF calculation.  The candidates are popped in order of
+ * distance, the networks before the routers, then in the order they were
+ * pushed, or got a lower distance, which is the order CandidateQueue keeps.
+ */
+struct SPFCandidate
+{
+  uint32_t distance;  //!< the distance from the root
+  uint32_t rank;      //!< 0 for a network, 1 for a router
+  uint32_t sequence;  //!< the order the candidate was pushed in
+  uint32_t vertex;    //!< the vertex
+
+  /**
+   * \param [in] o The other candidate.
+   * \return true if this candidate is popped after the other one.
+   */
+  bool operator< (const SPFCandidate &o) const
+  {
+    if (distance != o.distance)
+      {
+        return distance > o.distance;
+      }
+    if (rank != o.rank)
+      {
+        return rank > o.rank;
+      }
+    return sequence > o.sequence;
+  }
+};
+
+struct SPFGraph::Workspace
+{
+  std::vector<uint8_t> status;        //!< the SPFGraphStatus of each vertex
+  std::vector<uint32_t> distance;     //!< the distance of each vertex from the root
+  std::vector<uint32_t> sequence;     //!< the sequence of the current candidate of each vertex
+  std::vector<uint8_t> processed;     //!< whether the stubs of a vertex were processed
+  std::vector<std::vector<std::pair<uint32_t, int32_t> > > exits;  //!< the root exit directions of each vertex
+  std::vector<std::vector<uint32_t> > parents;   //!< the parents of each vertex
+  std::vector<std::vector<uint32_t> > children;  //!< the children of each vertex in the SPF tree
+  std::vector<std::pair<uint32_t, int32_t> > merged;  //!< the exit directions of an equal cost path
+  std::priority_queue<SPFCandidate> candidates;  //!< the candidates, with stale entries
+  uint32_t nextSequence;              //!< the sequence of the next candidate
+};
+
+const uint32_t SPFGraph::NO_VERTEX;
+
+SPFGraph::SPFGraph (const GlobalRouteManagerLSDB *lsdb)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  GlobalRouteManagerLSDB::LSDBMap_t::const_iterator i;
+  for (i = lsdb->m_database.begin (); i != lsdb->m_database.end (); i++)
+    {
+      Vertex v;
+      v.id = i->first.Get ();
+      v.type = SPFVertex::VertexUnknown;
+      v.mask = 0;
+      v.firstLink = 0;
+      v.nLinks = 0;
+      if (i->second->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          v.type = SPFVertex::VertexRouter;
+        }
+      else if (i->second->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          v.type = SPFVertex::VertexNetwork;
+          v.mask = i->second->GetNetworkLSANetworkMask ().Get ();
+        }
+      m_vertices.push_back (v);
+    }
+//
+// The attached routers of a network are looked up, as in GetLSAByLinkData (),
+// as the first LSA with a transit network record whose link data is their
+// address.
+//
+  std::map<uint32_t, uint32_t> byLinkData;
+  uint32_t n = 0;
+  for (i = lsdb->m_database.begin (); i != lsdb->m_database.end (); i++, n++)
+    {
+      GlobalRoutingLSA *lsa = i->second;
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              byLinkData.insert (std::make_pair (lr->GetLinkData ().Get (), n));
+            }
+        }
+    }
+  n = 0;
+  for (i = lsdb->m_database.begin (); i != lsdb->m_database.end (); i++, n++)
+    {
+      GlobalRoutingLSA *lsa = i->second;
+      Vertex &v = m_vertices[n];
+      v.firstLink = m_links.size ();
+      if (v.type == SPFVertex::VertexNetwork)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              Link l;
+              l.type = GlobalRoutingLinkRecord::Unknown;
+              l.linkId = lsa->GetAttachedRouter (j).Get ();
+              l.linkData = 0;
+              l.metric = 0;
+              std::map<uint32_t, uint32_t>::const_iterator t = byLinkData.find (l.linkId);
+              l.target = t != byLinkData.end () ? t->second : NO_VERTEX;
+              m_links.push_back (l);
+            }
+        }
+      else
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+              Link l;
+              l.type = lr->GetLinkType ();
+              l.linkId = lr->GetLinkId ().Get ();
+              l.linkData = lr->GetLinkData ().Get ();
+              l.metric = lr->GetMetric ();
+              l.target = NO_VERTEX;
+              if (l.type == GlobalRoutingLinkRecord::PointToPoint
+                  || l.type == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  l.target = FindVertex (l.linkId);
+                }
+              m_links.push_back (l);
+            }
+        }
+      v.nLinks = m_links.size () - v.firstLink;
+    }
+  for (uint32_t j = 0; j < lsdb->GetNumExtLSAs (); j++)
+    {
+      GlobalRoutingLSA *extlsa = lsdb->GetExtLSA (j);
+      External e;
+      e.advertisingRouter = extlsa->GetAdvertisingRouter ().Get ();
+      e.vertex = FindVertex (e.advertisingRouter);
+      if (e.vertex != NO_VERTEX && m_vertices[e.vertex].type != SPFVertex::VertexRouter)
+        {
+          e.vertex = NO_VERTEX;
+        }
+      e.mask = extlsa->GetNetworkLSANetworkMask ().Get ();
+      e.network = extlsa->GetLinkStateId ().Get () & e.mask;
+      m_externals.push_back (e);
+    }
+}
+
+SPFGraph::Workspace *
+SPFGraph::CreateWorkspace (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Workspace *ws = new Workspace;
+  uint32_t n = m_vertices.size ();
+  ws->status.resize (n);
+  ws->distance.resize (n);
+  ws->sequence.resize (n);
+  ws->processed.resize (n);
+  ws->exits.resize (n);
+  ws->parents.resize (n);
+  ws->children.resize (n);
+  ws->nextSequence = 0;
+  return ws;
+}
+
+void
+SPFGraph::DeleteWorkspace (Workspace *ws)
+{
+  NS_LOG_FUNCTION (ws);
+  delete ws;
+}
+
+uint32_t
+SPFGraph::GetNVertices (void) const
+{
+  return m_vertices.size ();
+}
+
+const SPFGraph::Vertex &
+SPFGraph::GetVertex (uint32_t i) const
+{
+  return m_vertices[i];
+}
+
+const SPFGraph::Link &
+SPFGraph::GetLink (uint32_t i) const
+{
+  return m_links[i];
+}
+
+uint32_t
+SPFGraph::GetNExternals (void) const
+{
+  return m_externals.size ();
+}
+
+const SPFGraph::External &
+SPFGraph::GetExternal (uint32_t i) const
+{
+  return m_externals[i];
+}
+
+uint32_t
+SPFGraph::FindVertex (uint32_t id) const
+{
+  uint32_t low = 0;
+  uint32_t high = m_vertices.size ();
+  while (low < high)
+    {
+      uint32_t middle = low + (high - low) / 2;
+      if (m_vertices[middle].id < id)
+        {
+          low = middle + 1;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  if (low < m_vertices.size () && m_vertices[low].id == id)
+    {
+      return low;
+    }
+  return NO_VERTEX;
+}
+
+int32_t
+SPFGraph::FindInterface (const Interfaces &interfaces, uint32_t a, uint32_t mask)
+{
+  for (Interfaces::const_iterator i = interfaces.begin (); i != interfaces.end (); i++)
+    {
+      if ((i->first & mask) == (a & mask))
+        {
+          return i->second;
+        }
+    }
+  return -1;
+}
+
+bool
+SPFGraph::CheckForStubNode (uint32_t root, const Interfaces &interfaces,
+                            std::vector<SPFRoute> &routes) const
+{
+  const Vertex &r = m_vertices[root];
+  uint32_t transits = 0;
+  const Link *transitLink = 0;
+  for (uint32_t i = r.firstLink; i < r.firstLink + r.nLinks; i++)
+    {
+      if (m_links[i].type == GlobalRoutingLinkRecord::TransitNetwork
+          || m_links[i].type == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          transits++;
+          transitLink = &m_links[i];
+        }
+    }
+  if (transits == 0)
+    {
+      return true;
+    }
+  if (transits == 1 && transitLink->type == GlobalRoutingLinkRecord::PointToPoint)
+    {
+      NS_ASSERT (transitLink->target != NO_VERTEX);
+      const Vertex &w = m_vertices[transitLink->target];
+      for (uint32_t j = w.firstLink; j < w.firstLink + w.nLinks; j++)
+        {
+          const Link &lr = m_links[j];
+          if (lr.type == GlobalRoutingLinkRecord::PointToPoint && lr.linkId == r.id)
+            {
+              SPFRoute route;
+              route.type = SPFRoute::NetworkRoute;
+              route.dest = 0;
+              route.mask = 0;
+              route.nextHop = lr.linkData;
+              route.interface = FindInterface (interfaces, transitLink->linkData, 0xffffffff);
+              routes.push_back (route);
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+void
+SPFGraph::Calculate (uint32_t root, const Interfaces &interfaces, Workspace &ws,
+                     std::vector<SPFRoute> &routes, std::vector<uint32_t> &distances,
+                     StubRoutes &stubRoutes) const
+{
+  routes.clear ();
+  distances.clear ();
+  stubRoutes.clear ();
+  if (CheckForStubNode (root, interfaces, routes))
+    {
+      return;
+    }
+
+  uint32_t n = m_vertices.size ();
+  std::fill (ws.status.begin (), ws.status.end (), SPF_GRAPH_NOT_EXPLORED);
+  std::fill (ws.distance.begin (), ws.distance.end (), SPF_INFINITY);
+  std::fill (ws.processed.begin (), ws.processed.end (), 0);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ws.exits[i].clear ();
+      ws.parents[i].clear ();
+      ws.children[i].clear ();
+    }
+  ws.nextSequence = 0;
+  ws.status[root] = SPF_GRAPH_IN_SPFTREE;
+  ws.distance[root] = 0;
+
+  uint32_t hostRoutes = 0;
+  uint32_t v = root;
+  for (;;)
+    {
+      Next (root, v, interfaces, ws);
+//
+// Pop the closest candidate, skipping the entries left behind when a
+// candidate got a lower distance.
+//
+      v = NO_VERTEX;
+      while (!ws.candidates.empty ())
+        {
+          SPFCandidate c = ws.candidates.top ();
+          ws.candidates.pop ();
+          if (ws.status[c.vertex] == SPF_GRAPH_CANDIDATE && ws.sequence[c.vertex] == c.sequence)
+            {
+              v = c.vertex;
+              break;
+            }
+        }
+      if (v == NO_VERTEX)
+        {
+          break;
+        }
+      ws.status[v] = SPF_GRAPH_IN_SPFTREE;
+      for (std::vector<uint32_t>::const_iterator p = ws.parents[v].begin (); p != ws.parents[v].end (); p++)
+        {
+          ws.children[*p].push_back (v);
+        }
+//
+// Add the host routes to the point-to-point interfaces of a router, or the
+// network route to a transit network, as SPFIntraAddRouter () and
+// SPFIntraAddTransit () do.
+//
+      const Vertex &vv = m_vertices[v];
+      const std::vector<std::pair<uint32_t, int32_t> > &exits = ws.exits[v];
+      SPFRoute route;
+      if (vv.type == SPFVertex::VertexRouter)
+        {
+          route.type = SPFRoute::HostRoute;
+          route.mask = 0xffffffff;
+          for (uint32_t j = vv.firstLink; j < vv.firstLink + vv.nLinks; j++)
+            {
+              if (m_links[j].type != GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  continue;
+                }
+              route.dest = m_links[j].linkData;
+              for (uint32_t k = 0; k < exits.size (); k++)
+                {
+                  if (exits[k].second >= 0)
+                    {
+                      route.nextHop = exits[k].first;
+                      route.interface = exits[k].second;
+                      routes.push_back (route);
+                      hostRoutes++;
+                    }
+                }
+            }
+        }
+      else if (vv.type == SPFVertex::VertexNetwork)
+        {
+          route.type = SPFRoute::NetworkRoute;
+          route.mask = vv.mask;
+          route.dest = vv.id & vv.mask;
+          for (uint32_t k = 0; k < exits.size (); k++)
+            {
+              if (exits[k].second >= 0)
+                {
+                  route.nextHop = exits[k].first;
+                  route.interface = exits[k].second;
+                  routes.push_back (route);
+                }
+            }
+        }
+      else
+        {
+          NS_ASSERT_MSG (0, "illegal SPFVertex type");
+        }
+    }
+
+// Second stage of SPF calculation procedure
+  stubRoutes.assign (n, std::make_pair (0, 0));
+  ProcessStubs (root, root, ws, routes, hostRoutes, stubRoutes);
+  for (uint32_t i = 0; i < m_externals.size (); i++)
+    {
+      const External &e = m_externals[i];
+      if (e.vertex == NO_VERTEX || e.vertex == root || ws.status[e.vertex] != SPF_GRAPH_IN_SPFTREE)
+        {
+          continue;
+        }
+      const std::vector<std::pair<uint32_t, int32_t> > &exits = ws.exits[e.vertex];
+      for (uint32_t k = 0; k < exits.size (); k++)
+        {
+          if (exits[k].second >= 0)
+            {
+              SPFRoute route;
+              route.type = SPFRoute::ExternalRoute;
+              route.dest = e.network;
+              route.mask = e.mask;
+              route.nextHop = exits[k].first;
+              route.interface = exits[k].second;
+              routes.push_back (route);
+            }
+        }
+    }
+  distances = ws.distance;
+}
+
+void
+SPFGraph::Next (uint32_t root, uint32_t v, const Interfaces &interfaces, Workspace &ws) const
+{
+  const Vertex &vv = m_vertices[v];
+  for (uint32_t i = vv.firstLink; i < vv.firstLink + vv.nLinks; i++)
+    {
+      const Link &l = m_links[i];
+      uint32_t w = l.target;
+      if (vv.type == SPFVertex::VertexRouter)
+        {
+          if (l.type == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          NS_ASSERT_MSG (l.type == GlobalRoutingLinkRecord::PointToPoint
+                         || l.type == GlobalRoutingLinkRecord::TransitNetwork, "illegal Link Type");
+          NS_ASSERT (w != NO_VERTEX);
+        }
+      else if (w == NO_VERTEX)
+        {
+          continue;
+        }
+      if (ws.status[w] == SPF_GRAPH_IN_SPFTREE)
+        {
+          continue;
+        }
+      uint32_t distance = ws.distance[v];
+      if (vv.type == SPFVertex::VertexRouter)
+        {
+          distance += l.metric;
+        }
+
+      if (ws.status[w] == SPF_GRAPH_CANDIDATE)
+        {
+          if (ws.distance[w] < distance)
+            {
+              continue;
+            }
+          else if (ws.distance[w] == distance)
+            {
+//
+// Merge the exit directions and the parents of an equal cost path.
+//
+              ws.merged.clear ();
+              NexthopCalculation (root, v, w, l, interfaces, ws, ws.merged);
+              std::vector<std::pair<uint32_t, int32_t> > &exits = ws.exits[w];
+              exits.insert (exits.end (), ws.merged.begin (), ws.merged.end ());
+              std::sort (exits.begin (), exits.end ());
+              exits.erase (std::unique (exits.begin (), exits.end ()), exits.end ());
+              if (std::find (ws.parents[w].begin (), ws.parents[w].end (), v) == ws.parents[w].end ())
+                {
+                  ws.parents[w].push_back (v);
+                }
+              continue;
+            }
+        }
+//
+// A new candidate, or a lower cost path to a candidate, which moves behind
+// the candidates of the same distance.
+//
+      NexthopCalculation (root, v, w, l, interfaces, ws, ws.exits[w]);
+      ws.distance[w] = distance;
+      ws.parents[w].assign (1, v);
+      ws.status[w] = SPF_GRAPH_CANDIDATE;
+      SPFCandidate c;
+      c.distance = distance;
+      c.rank = m_vertices[w].type == SPFVertex::VertexNetwork ? 0 : 1;
+      c.sequence = ws.nextSequence++;
+      c.vertex = w;
+      ws.sequence[w] = c.sequence;
+      ws.candidates.push (c);
+    }
+}
+
+void
+SPFGraph::NexthopCalculation (uint32_t root, uint32_t v, uint32_t w, const Link &l,
+                              const Interfaces &interfaces, const Workspace &ws,
+                              std::vector<std::pair<uint32_t, int32_t> > &exits) const
+{
+  const Vertex &vv = m_vertices[v];
+  const Vertex &ww = m_vertices[w];
+  if (v == root)
+    {
+      if (ww.type == SPFVertex::VertexRouter)
+        {
+//
+// The next hop is the address of the first link of <w> back to the root.
+//
+          for (uint32_t j = ww.firstLink; j < ww.firstLink + ww.nLinks; j++)
+            {
+              if (m_links[j].linkId == vv.id)
+                {
+                  int32_t outIf = FindInterface (interfaces, l.linkData, 0xffffffff);
+                  exits.assign (1, std::make_pair (m_links[j].linkData, outIf));
+                  return;
+                }
+            }
+          NS_FATAL_ERROR ("No link from " << Ipv4Address (ww.id) << " back to the root");
+        }
+      NS_ASSERT (ww.type == SPFVertex::VertexNetwork);
+      int32_t outIf = FindInterface (interfaces, ww.id, ww.mask);
+      exits.assign (1, std::make_pair (0, outIf));
+    }
+  else if (vv.type == SPFVertex::VertexNetwork && ws.parents[v].front () == root)
+    {
+      NS_ASSERT (ws.exits[v].size () == 1);
+      NS_ASSERT (ww.type == SPFVertex::VertexRouter);
+      for (uint32_t j = ww.firstLink; j < ww.firstLink + ww.nLinks; j++)
+        {
+          if (m_links[j].linkId == vv.id)
+            {
+              exits.assign (1, std::make_pair (m_links[j].linkData, ws.exits[v].front ().second));
+              break;
+            }
+        }
+    }
+  else
+    {
+//
+// Unlike SPFNexthopCalculation (), which asserts that a network further away
+// has a single exit, the routers behind a network reached over equal cost
+// paths inherit all of them.
+//
+      exits = ws.exits[v];
+    }
+}
+
+void
+SPFGraph::ProcessStubs (uint32_t root, uint32_t v, Workspace &ws,
+                        std::vector<SPFRoute> &routes, uint32_t hostRoutes,
+                        StubRoutes &stubRoutes) const
+{
+  const Vertex &vv = m_vertices[v];
+  if (vv.type == SPFVertex::VertexRouter && v != root)
+    {
+      uint32_t first = routes.size ();
+      const std::vector<std::pair<uint32_t, int32_t> > &exits = ws.exits[v];
+      for (uint32_t i = vv.firstLink; i < vv.firstLink + vv.nLinks; i++)
+        {
+          const Link &l = m_links[i];
+          if (l.type != GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          SPFRoute route;
+          route.type = SPFRoute::NetworkRoute;
+          route.mask = l.linkData;
+          route.dest = l.linkId & l.linkData;
+          for (uint32_t k = 0; k < exits.size (); k++)
+            {
+              if (exits[k].second >= 0)
+                {
+                  route.nextHop = exits[k].first;
+                  route.interface = exits[k].second;
+                  routes.push_back (route);
+                }
+            }
+        }
+      stubRoutes[v] = std::make_pair (first - hostRoutes, routes.size () - first);
+    }
+  for (uint32_t i = 0; i < ws.children[v].size (); i++)
+    {
+      uint32_t child = ws.children[v][i];
+      if (!ws.processed[child])
+        {
+          ProcessStubs (root, child, ws, routes, hostRoutes, stubRoutes);
+          ws.processed[child] = 1;
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,7 +1154,12 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_graph (0),
+    m_batch (0),
+    m_batchEnd (0),
+    m_nextRoot (0),
+    m_nextWorkspace (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -552,6 +1172,7 @@ GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
     {
       delete m_lsdb;
     }
+  delete m_graph;
 }
 
 void
@@ -563,6 +1184,24 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  delete m_graph;
+  m_graph = 0;
+  m_trees.clear ();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Ipv4GlobalRouting> gr)
+{
+  NS_LOG_FUNCTION (gr);
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      gr->RemoveRoute (0);
+    }
 }
 
 void
@@ -579,18 +1218,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (gr);
     }
   if (m_lsdb)
     {
@@ -598,6 +1227,9 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  delete m_graph;
+  m_graph = 0;
+  m_trees.clear ();
 }
 
 //
@@ -692,10 +1324,21 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 // algorithm then iterates again.  It terminates when the candidate
 // list becomes empty. 
 //
+// SPFCalculate () follows the above on SPFVertex trees and looks the LSAs and
+// the nodes up in lists, which gets slow with hundreds of routers.  The
+// routes are rather computed on a compact copy of the LSDB, SPFGraph, which
+// yields the same routes in the same order, with one task per router spread
+// over several threads.  The routes are then added to the routers by this
+// thread, in the order of the node list.
+//
 void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_graph;
+  m_graph = new SPFGraph (m_lsdb);
+  m_trees.clear ();
+  std::vector<SPFRoot> roots;
 //
 // Walk the list of nodes in the system.
 //
@@ -724,12 +1367,556 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (CreateRoot (node, rtr->GetRouterId (), false));
         }
     }
+  CalculateRoutes (roots);
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::CreateRoot (Ptr<Node> node, Ipv4Address routerId, bool replace) const
+{
+  NS_LOG_FUNCTION (this << node << routerId << replace);
+  SPFRoot root;
+  root.nodeId = node->GetId ();
+  root.vertex = m_graph->FindVertex (routerId.Get ());
+  NS_ASSERT_MSG (root.vertex != SPFGraph::NO_VERTEX,
+                 "GlobalRouteManagerImpl::CreateRoot (): No LSA for router " << routerId);
+  root.replace = replace;
+//
+// The interfaces are searched in the order of Ipv4L3Protocol::GetInterfaceForPrefix ()
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::CreateRoot (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          root.interfaces.push_back (std::make_pair (ipv4->GetAddress (i, j).GetLocal ().Get (), i));
+        }
+    }
+  return root;
+}
+
+void
+GlobalRouteManagerImpl::CalculateRoutes (std::vector<SPFRoot> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  UintegerValue value;
+  g_globalRoutingThreads.GetValue (value);
+  uint32_t nThreads = value.Get () != 0 ? value.Get () : sysconf (_SC_NPROCESSORS_ONLN);
+  nThreads = std::max<uint32_t> (1, std::min<uint32_t> (nThreads, roots.size ()));
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      m_workspaces.push_back (m_graph->CreateWorkspace ());
+    }
+//
+// The routes of a batch of routers are kept until they are added, the next
+// batch is computed afterward.
+//
+  uint32_t batchSize = std::max<uint32_t> (64, 16 * nThreads);
+  m_batch = &roots;
+  for (uint32_t start = 0; start < roots.size (); start += batchSize)
+    {
+      m_batchEnd = std::min<uint32_t> (start + batchSize, roots.size ());
+      m_nextRoot = start;
+      m_nextWorkspace = 0;
+      std::vector<Ptr<SystemThread> > workers;
+      for (uint32_t i = 1; i < nThreads; i++)
+        {
+          workers.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::CalculateWorker, this)));
+          workers.back ()->Start ();
+        }
+      CalculateWorker ();
+      for (std::vector<Ptr<SystemThread> >::iterator i = workers.begin (); i != workers.end (); i++)
+        {
+          (*i)->Join ();
+        }
+
+      for (uint32_t i = start; i < m_batchEnd; i++)
+        {
+          SPFRoot &root = roots[i];
+          Ptr<GlobalRouter> router = NodeList::GetNode (root.nodeId)->GetObject<GlobalRouter> ();
+          NS_ASSERT (router);
+          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+          NS_ASSERT (gr);
+          if (root.replace)
+            {
+              DeleteRoutes (gr);
+            }
+          NS_LOG_LOGIC ("Adding " << root.routes.size () << " routes to node " << root.nodeId);
+          for (std::vector<SPFRoute>::const_iterator r = root.routes.begin (); r != root.routes.end (); r++)
+            {
+              switch (r->type)
+                {
+                case SPFRoute::HostRoute:
+                  gr->AddHostRouteTo (Ipv4Address (r->dest), Ipv4Address (r->nextHop), r->interface);
+                  break;
+                case SPFRoute::NetworkRoute:
+                  gr->AddNetworkRouteTo (Ipv4Address (r->dest), Ipv4Mask (r->mask),
+                                         Ipv4Address (r->nextHop), r->interface);
+                  break;
+                case SPFRoute::ExternalRoute:
+                  gr->AddASExternalRouteTo (Ipv4Address (r->dest), Ipv4Mask (r->mask),
+                                            Ipv4Address (r->nextHop), r->interface);
+                  break;
+                }
+            }
+          std::vector<SPFRoute> ().swap (root.routes);
+          SPFTree &tree = m_trees[root.nodeId];
+          tree.distances.swap (root.tree.distances);
+          tree.stubRoutes.swap (root.tree.stubRoutes);
+        }
+    }
+  m_batch = 0;
+  for (uint32_t i = 0; i < m_workspaces.size (); i++)
+    {
+      SPFGraph::DeleteWorkspace (m_workspaces[i]);
+    }
+  m_workspaces.clear ();
+}
+
+void
+GlobalRouteManagerImpl::CalculateWorker (void)
+{
+  // Runs on the worker threads: only the graph and the roots are accessed
+  SPFGraph::Workspace *ws = m_workspaces[m_nextWorkspace++];
+  for (;;)
+    {
+      uint32_t i = m_nextRoot++;
+      if (i >= m_batchEnd)
+        {
+          break;
+        }
+      SPFRoot &root = (*m_batch)[i];
+      m_graph->Calculate (root.vertex, root.interfaces, *ws, root.routes,
+                          root.tree.distances, root.tree.stubRoutes);
+    }
+}
+
+/**
+ * \brief Compare a link of two graphs, the vertex it leads to by link state ID.
+ * \param g1 the first graph
+ * \param l1 the link of the first graph
+ * \param g2 the second graph
+ * \param l2 the link of the second graph
+ * \returns true if the links are the same
+ */
+static bool
+IsSameLink (const SPFGraph &g1, const SPFGraph::Link &l1, const SPFGraph &g2, const SPFGraph::Link &l2)
+{
+  if (l1.type != l2.type || l1.linkId != l2.linkId || l1.linkData != l2.linkData
+      || l1.metric != l2.metric)
+    {
+      return false;
+    }
+  if (l1.target == SPFGraph::NO_VERTEX || l2.target == SPFGraph::NO_VERTEX)
+    {
+      return l1.target == l2.target;
+    }
+  return g1.GetVertex (l1.target).id == g2.GetVertex (l2.target).id;
+}
+
+uint32_t
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_graph == 0)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return m_trees.size ();
+    }
+  SPFGraph *oldGraph = m_graph;
+  m_graph = 0;
+  std::map<uint32_t, SPFTree> oldTrees;
+  oldTrees.swap (m_trees);
+  delete m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  m_graph = new SPFGraph (m_lsdb);
+//
+// Walk the vertices of both graphs, which are ordered by link state ID, and
+// find those whose links changed.
+//
+  std::vector<SPFChange> changes;
+  std::vector<uint32_t> oldVertexOf (m_graph->GetNVertices (), SPFGraph::NO_VERTEX);
+  uint32_t i = 0;
+  uint32_t j = 0;
+  while (i < oldGraph->GetNVertices () || j < m_graph->GetNVertices ())
+    {
+      SPFChange c;
+      c.oldVertex = SPFGraph::NO_VERTEX;
+      c.newVertex = SPFGraph::NO_VERTEX;
+      c.deletionsOnly = true;
+      if (j == m_graph->GetNVertices ()
+          || (i < oldGraph->GetNVertices () && oldGraph->GetVertex (i).id < m_graph->GetVertex (j).id))
+        {
+          c.oldVertex = i++;
+        }
+      else if (i == oldGraph->GetNVertices () || m_graph->GetVertex (j).id < oldGraph->GetVertex (i).id)
+        {
+          c.newVertex = j++;
+          c.deletionsOnly = false;
+        }
+      else
+        {
+          c.oldVertex = i++;
+          c.newVertex = j++;
+          oldVertexOf[c.newVertex] = c.oldVertex;
+        }
+      if (c.oldVertex != SPFGraph::NO_VERTEX)
+        {
+          const SPFGraph::Vertex &ov = oldGraph->GetVertex (c.oldVertex);
+          uint32_t k = 0;
+          uint32_t nNew = 0;
+          if (c.newVertex != SPFGraph::NO_VERTEX)
+            {
+              const SPFGraph::Vertex &nv = m_graph->GetVertex (c.newVertex);
+              if (nv.type != ov.type || nv.mask != ov.mask)
+                {
+                  c.deletionsOnly = false;
+                }
+              nNew = nv.nLinks;
+              for (uint32_t l = ov.firstLink; l < ov.firstLink + ov.nLinks; l++)
+                {
+                  if (k < nNew && IsSameLink (*oldGraph, oldGraph->GetLink (l),
+                                              *m_graph, m_graph->GetLink (nv.firstLink + k)))
+                    {
+                      k++;
+                    }
+                  else
+                    {
+                      c.deleted.push_back (l);
+                    }
+                }
+            }
+          else
+            {
+              for (uint32_t l = ov.firstLink; l < ov.firstLink + ov.nLinks; l++)
+                {
+                  c.deleted.push_back (l);
+                }
+            }
+          if (k < nNew)
+            {
+              c.deletionsOnly = false;
+            }
+          if (c.deletionsOnly && c.deleted.empty () && c.newVertex != SPFGraph::NO_VERTEX)
+            {
+              continue;
+            }
+        }
+      changes.push_back (c);
+    }
+  NS_LOG_LOGIC (changes.size () << " vertices changed");
+//
+// The hosts still advertised, and the number of links leading to each vertex.
+//
+  std::vector<uint32_t> inDegree (m_graph->GetNVertices (), 0);
+  std::set<uint32_t> hostsLeft;
+  for (i = 0; i < m_graph->GetNVertices (); i++)
+    {
+      const SPFGraph::Vertex &v = m_graph->GetVertex (i);
+      for (uint32_t l = v.firstLink; l < v.firstLink + v.nLinks; l++)
+        {
+          const SPFGraph::Link &link = m_graph->GetLink (l);
+          if (link.target != SPFGraph::NO_VERTEX)
+            {
+              inDegree[link.target]++;
+            }
+          if (v.type == SPFVertex::VertexRouter && link.type == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              hostsLeft.insert (link.linkData);
+            }
+        }
+    }
+  bool externalsChanged = oldGraph->GetNExternals () != m_graph->GetNExternals ();
+  for (i = 0; !externalsChanged && i < m_graph->GetNExternals (); i++)
+    {
+      const SPFGraph::External &oe = oldGraph->GetExternal (i);
+      const SPFGraph::External &ne = m_graph->GetExternal (i);
+      externalsChanged = oe.advertisingRouter != ne.advertisingRouter
+        || oe.network != ne.network || oe.mask != ne.mask;
+    }
+//
+// Compute again the routers the changes may affect, and remove the routes
+// the others lose.
+//
+  std::vector<SPFRoot> roots;
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator n = NodeList::Begin (); n != listEnd; n++)
+    {
+      Ptr<Node> node = *n;
+      if (node->GetSystemId () != systemId)
+        {
+          continue;
+        }
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr)
+        {
+          continue;
+        }
+      std::map<uint32_t, SPFTree>::iterator old = oldTrees.find (node->GetId ());
+      if (!rtr->GetNumLSAs ())
+        {
+          if (old != oldTrees.end ())
+            {
+              DeleteRoutes (rtr->GetRoutingProtocol ());
+            }
+          continue;
+        }
+      uint32_t oldRoot = oldGraph->FindVertex (rtr->GetRouterId ().Get ());
+      std::vector<uint32_t> hosts;
+      std::vector<std::pair<uint32_t, uint32_t> > stubs;
+      std::vector<uint32_t> gone;
+      bool affected = old == oldTrees.end () || oldRoot == SPFGraph::NO_VERTEX || externalsChanged
+        || IsAffected (*oldGraph, changes, inDegree, oldRoot, old->second.distances, hosts, stubs, gone);
+      for (i = 0; !affected && i < hosts.size (); i++)
+        {
+          affected = hostsLeft.count (hosts[i]) != 0;
+        }
+      if (affected)
+        {
+          roots.push_back (CreateRoot (node, rtr->GetRouterId (), true));
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = rtr->GetRoutingProtocol ();
+      for (i = 0; i < hosts.size (); i++)
+        {
+          gr->RemoveHostRoutesTo (Ipv4Address (hosts[i]));
+        }
+      SPFTree &tree = m_trees[node->GetId ()];
+      if (old->second.distances.empty ())
+        {
+          continue;
+        }
+//
+// The routes to the stub networks of the vertices are consecutive, in the
+// order of the stub records: remove those of the vertices no longer
+// reachable and of the stub records deleted.
+//
+      SPFGraph::StubRoutes &oldStubs = old->second.stubRoutes;
+      std::vector<std::pair<uint32_t, uint32_t> > removed;
+      std::vector<uint32_t> removedFrom;
+      for (i = 0; i < gone.size (); i++)
+        {
+          removed.push_back (oldStubs[gone[i]]);
+          removedFrom.push_back (gone[i]);
+        }
+      for (i = 0; i < stubs.size (); i++)
+        {
+          uint32_t v = stubs[i].first;
+          if (std::binary_search (gone.begin (), gone.end (), v))
+            {
+              continue;
+            }
+          const SPFGraph::Vertex &vv = oldGraph->GetVertex (v);
+          uint32_t nStubs = 0;
+          for (uint32_t l = vv.firstLink; l < vv.firstLink + vv.nLinks; l++)
+            {
+              if (oldGraph->GetLink (l).type == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  nStubs++;
+                }
+            }
+          uint32_t exits = oldStubs[v].second / nStubs;
+          removed.push_back (std::make_pair (oldStubs[v].first + stubs[i].second * exits, exits));
+          removedFrom.push_back (v);
+        }
+      for (i = 0; i < removed.size (); i++)
+        {
+          oldStubs[removedFrom[i]].second -= removed[i].second;
+        }
+      std::sort (removed.begin (), removed.end ());
+      std::vector<uint32_t> firsts;
+      std::vector<uint32_t> shifts (1, 0);
+      for (i = 0; i < removed.size (); i++)
+        {
+          firsts.push_back (removed[i].first);
+          shifts.push_back (shifts.back () + removed[i].second);
+        }
+      for (i = removed.size (); i > 0; i--)
+        {
+          gr->RemoveNetworkRoutes (removed[i - 1].first, removed[i - 1].second);
+        }
+//
+// Carry the tree over to the new graph.
+//
+      tree.distances.assign (m_graph->GetNVertices (), SPF_INFINITY);
+      tree.stubRoutes.assign (m_graph->GetNVertices (), std::make_pair (0, 0));
+      for (i = 0; i < m_graph->GetNVertices (); i++)
+        {
+          uint32_t o = oldVertexOf[i];
+          if (o == SPFGraph::NO_VERTEX || std::binary_search (gone.begin (), gone.end (), o))
+            {
+              continue;
+            }
+          tree.distances[i] = old->second.distances[o];
+          uint32_t k = std::lower_bound (firsts.begin (), firsts.end (), oldStubs[o].first) - firsts.begin ();
+          tree.stubRoutes[i] = std::make_pair (oldStubs[o].first - shifts[k], oldStubs[o].second);
+        }
+    }
+  NS_LOG_LOGIC ("Computing again the routes of " << roots.size () << " routers");
+  CalculateRoutes (roots);
+  delete oldGraph;
+  return roots.size ();
+}
+
+bool
+GlobalRouteManagerImpl::IsAffected (const SPFGraph &oldGraph, const std::vector<SPFChange> &changes,
+                                    const std::vector<uint32_t> &inDegree, uint32_t root,
+                                    const std::vector<uint32_t> &distances,
+                                    std::vector<uint32_t> &hosts,
+                                    std::vector<std::pair<uint32_t, uint32_t> > &stubs,
+                                    std::vector<uint32_t> &gone) const
+{
+  NS_LOG_FUNCTION (this << root);
+//
+// The next hops of the root come from the links of its neighbors back to it,
+// directly or through a network, so any change there is taken as affecting it.
+//
+  uint32_t rootId = oldGraph.GetVertex (root).id;
+  std::set<uint32_t> neighbors;
+  neighbors.insert (rootId);
+  const SPFGraph *graphs[2] = { &oldGraph, m_graph };
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      uint32_t r = graphs[g]->FindVertex (rootId);
+      if (r == SPFGraph::NO_VERTEX)
+        {
+          continue;
+        }
+      const SPFGraph::Vertex &rv = graphs[g]->GetVertex (r);
+      for (uint32_t l = rv.firstLink; l < rv.firstLink + rv.nLinks; l++)
+        {
+          uint32_t t = graphs[g]->GetLink (l).target;
+          if (t == SPFGraph::NO_VERTEX)
+            {
+              continue;
+            }
+          const SPFGraph::Vertex &tv = graphs[g]->GetVertex (t);
+          neighbors.insert (tv.id);
+          if (tv.type != SPFVertex::VertexNetwork)
+            {
+              continue;
+            }
+          for (uint32_t k = tv.firstLink; k < tv.firstLink + tv.nLinks; k++)
+            {
+              uint32_t u = graphs[g]->GetLink (k).target;
+              if (u != SPFGraph::NO_VERTEX)
+                {
+                  neighbors.insert (graphs[g]->GetVertex (u).id);
+                }
+            }
+        }
+    }
+//
+// Elsewhere, deleting a link off the shortest paths changes nothing, and
+// deleting the only way to a vertex leading nowhere only loses its routes.
+//
+  for (std::vector<SPFChange>::const_iterator c = changes.begin (); c != changes.end (); c++)
+    {
+      const SPFGraph::Vertex &cv = c->oldVertex != SPFGraph::NO_VERTEX ?
+        oldGraph.GetVertex (c->oldVertex) : m_graph->GetVertex (c->newVertex);
+      if (neighbors.count (cv.id))
+        {
+          return true;
+        }
+      if (distances.empty () || c->oldVertex == SPFGraph::NO_VERTEX
+          || distances[c->oldVertex] == SPF_INFINITY)
+        {
+          continue;
+        }
+      if (!c->deletionsOnly || (c->newVertex == SPFGraph::NO_VERTEX && cv.type == SPFVertex::VertexNetwork))
+        {
+          return true;
+        }
+      uint32_t rank = 0;
+      uint32_t next = cv.firstLink;
+      for (std::vector<uint32_t>::const_iterator k = c->deleted.begin (); k != c->deleted.end (); k++)
+        {
+          const SPFGraph::Link &l = oldGraph.GetLink (*k);
+          uint32_t metric = 0;
+          if (cv.type == SPFVertex::VertexRouter)
+            {
+              for (; next < *k; next++)
+                {
+                  if (oldGraph.GetLink (next).type == GlobalRoutingLinkRecord::StubNetwork)
+                    {
+                      rank++;
+                    }
+                }
+              if (l.type == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  hosts.push_back (l.linkData);
+                }
+              else if (l.type == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  stubs.push_back (std::make_pair (c->oldVertex, rank));
+                  continue;
+                }
+              metric = l.metric;
+            }
+          uint32_t w = l.target;
+          if (w == SPFGraph::NO_VERTEX || distances[w] == SPF_INFINITY
+              || distances[c->oldVertex] + metric != distances[w])
+            {
+              continue;
+            }
+          const SPFGraph::Vertex &wv = oldGraph.GetVertex (w);
+          uint32_t nw = m_graph->FindVertex (wv.id);
+          if ((nw != SPFGraph::NO_VERTEX && inDegree[nw] > 0) || wv.type != SPFVertex::VertexRouter)
+            {
+              return true;
+            }
+          for (uint32_t m = wv.firstLink; m < wv.firstLink + wv.nLinks; m++)
+            {
+              const SPFGraph::Link &wl = oldGraph.GetLink (m);
+              uint32_t x = wl.target;
+              uint32_t wm = wv.type == SPFVertex::VertexRouter ? wl.metric : 0;
+              if (x != SPFGraph::NO_VERTEX && distances[x] != SPF_INFINITY
+                  && distances[w] + wm == distances[x])
+                {
+                  return true;
+                }
+            }
+          gone.push_back (w);
+        }
+    }
+//
+// The routers no longer reachable lose their routes, which cannot be told
+// apart from those of the routers left when they are external routes.
+//
+  std::sort (gone.begin (), gone.end ());
+  gone.erase (std::unique (gone.begin (), gone.end ()), gone.end ());
+  for (std::vector<uint32_t>::const_iterator w = gone.begin (); w != gone.end (); w++)
+    {
+      const SPFGraph::Vertex &wv = oldGraph.GetVertex (*w);
+      for (uint32_t m = wv.firstLink; m < wv.firstLink + wv.nLinks; m++)
+        {
+          const SPFGraph::Link &wl = oldGraph.GetLink (m);
+          if (wl.type == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              hosts.push_back (wl.linkData);
+            }
+        }
+      for (uint32_t e = 0; e < oldGraph.GetNExternals (); e++)
+        {
+          if (oldGraph.GetExternal (e).vertex == *w)
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -27,6 +27,7 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <atomic>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -38,6 +39,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class SPFGraph;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -674,6 +676,8 @@ public:
 
 
 private:
+  friend class SPFGraph;
+
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
@@ -696,6 +700,253 @@ private:
   GlobalRouteManagerLSDB& operator= (GlobalRouteManagerLSDB& lsdb);
 };
 
+/**
+ * @brief A route computed by SPFGraph for the router at the root of the
+ * calculation.
+ */
+struct SPFRoute
+{
+  /**
+   * @brief Enumeration of the tables of Ipv4GlobalRouting a route is added to.
+   */
+  enum Type {
+    HostRoute = 0,      /**< Added with Ipv4GlobalRouting::AddHostRouteTo () */
+    NetworkRoute,       /**< Added with Ipv4GlobalRouting::AddNetworkRouteTo () */
+    ExternalRoute       /**< Added with Ipv4GlobalRouting::AddASExternalRouteTo () */
+  };
+
+  Type type;          //!< the table the route is added to
+  uint32_t dest;      //!< the destination host or network
+  uint32_t mask;      //!< the network mask, unused for the host routes
+  uint32_t nextHop;   //!< the next hop address
+  int32_t interface;  //!< the outgoing interface of the root
+};
+
+/**
+ * @brief The Link State DataBase (LSDB) in the compact form used to compute
+ * the routes of every router.
+ *
+ * The router and network LSAs of a GlobalRouteManagerLSDB are numbered in the
+ * order of their link state ID, and their link records, or the routers
+ * attached to the network, are copied into a single array in which the vertex
+ * at the other end of each transit link is looked up once.  The SPF
+ * calculation of a root then works on arrays indexed by vertex, and never
+ * searches the database or the node list.
+ *
+ * The graph is not modified once built, so that the routes of several roots
+ * can be calculated at once by several threads, each with its own Workspace.
+ * Calculate () yields the same routes, in the same order, as
+ * GlobalRouteManagerImpl::SPFCalculate () adds them.
+ */
+class SPFGraph
+{
+public:
+  static const uint32_t NO_VERTEX = 0xffffffff; //!< index of a missing vertex
+
+  /**
+   * @brief A link record of a router, or a router attached to a network.
+   */
+  struct Link
+  {
+    uint8_t type;       //!< the GlobalRoutingLinkRecord::LinkType, Unknown for an attached router
+    uint32_t linkId;    //!< the link ID, or the address of the attached router
+    uint32_t linkData;  //!< the link data
+    uint32_t metric;    //!< the metric
+    uint32_t target;    //!< the vertex the transit link leads to, NO_VERTEX if none
+  };
+
+  /**
+   * @brief A router or a network.
+   */
+  struct Vertex
+  {
+    uint32_t id;         //!< the link state ID
+    uint8_t type;        //!< the SPFVertex::VertexType
+    uint32_t mask;       //!< the network mask of a network
+    uint32_t firstLink;  //!< the index of the first link of the vertex
+    uint32_t nLinks;     //!< the number of links of the vertex
+  };
+
+  /**
+   * @brief An external route advertised by a router.
+   */
+  struct External
+  {
+    uint32_t advertisingRouter;  //!< the router ID of the advertising router
+    uint32_t vertex;             //!< the vertex of the advertising router, NO_VERTEX if none
+    uint32_t network;            //!< the external network
+    uint32_t mask;               //!< the external network mask
+  };
+
+  /**
+   * @brief The local addresses of a root and their interface, in the order
+   * Ipv4::GetInterfaceForPrefix () searches them.
+   */
+  typedef std::vector<std::pair<uint32_t, int32_t> > Interfaces;
+
+  /**
+   * @brief The index among the network routes of a root of the first route
+   * to the stub networks of each vertex, and the number of these routes,
+   * which are consecutive.
+   */
+  typedef std::vector<std::pair<uint32_t, uint32_t> > StubRoutes;
+
+  /**
+   * @brief The state of an SPF calculation, reused from one root to the next.
+   */
+  struct Workspace;
+
+  /**
+   * @brief Copy an LSDB.
+   * @param lsdb the database to copy
+   */
+  explicit SPFGraph (const GlobalRouteManagerLSDB *lsdb);
+
+  /**
+   * @brief Create a workspace sized for this graph.
+   * @returns the workspace, deleted with DeleteWorkspace ()
+   */
+  Workspace *CreateWorkspace (void) const;
+
+  /**
+   * @brief Delete a workspace created by CreateWorkspace ().
+   * @param ws the workspace
+   */
+  static void DeleteWorkspace (Workspace *ws);
+
+  /**
+   * @returns the number of vertices
+   */
+  uint32_t GetNVertices (void) const;
+
+  /**
+   * @param i the index of the vertex
+   * @returns the vertex
+   */
+  const Vertex &GetVertex (uint32_t i) const;
+
+  /**
+   * @param i the index of the link, between the first link of a vertex and
+   * its last one
+   * @returns the link
+   */
+  const Link &GetLink (uint32_t i) const;
+
+  /**
+   * @returns the number of external routes
+   */
+  uint32_t GetNExternals (void) const;
+
+  /**
+   * @param i the index of the external route
+   * @returns the external route
+   */
+  const External &GetExternal (uint32_t i) const;
+
+  /**
+   * @brief Look up a vertex by its link state ID.
+   * @param id the link state ID
+   * @returns the index of the vertex, NO_VERTEX if none
+   */
+  uint32_t FindVertex (uint32_t id) const;
+
+  /**
+   * @brief Calculate the routes of a router.
+   *
+   * This does not access any node, and can thus run on any thread.
+   *
+   * @param root the vertex of the router
+   * @param interfaces the local addresses of the router
+   * @param ws the workspace of the calling thread
+   * @param routes the routes to add to the router, in order
+   * @param distances the distance from the root of every vertex, SPF_INFINITY
+   * if unreachable, or empty if the router is a stub and only has a default
+   * route
+   * @param stubRoutes the routes to the stub networks of every vertex, empty
+   * if the router is a stub
+   */
+  void Calculate (uint32_t root, const Interfaces &interfaces, Workspace &ws,
+                  std::vector<SPFRoute> &routes, std::vector<uint32_t> &distances,
+                  StubRoutes &stubRoutes) const;
+
+private:
+  /**
+   * @brief SPFGraph copy construction is disallowed.
+   * @param graph object to copy from
+   */
+  SPFGraph (SPFGraph &graph);
+
+  /**
+   * @brief SPFGraph copy assignment operator is disallowed.
+   * @param graph object to copy from
+   * @returns the copied object
+   */
+  SPFGraph &operator= (SPFGraph &graph);
+
+  /**
+   * @brief Add a default route to the next hop if the root is a stub, as
+   * GlobalRouteManagerImpl::CheckForStubNode () does.
+   * @param root the vertex of the router
+   * @param interfaces the local addresses of the router
+   * @param routes the routes of the router
+   * @returns true if the node is a stub
+   */
+  bool CheckForStubNode (uint32_t root, const Interfaces &interfaces,
+                         std::vector<SPFRoute> &routes) const;
+
+  /**
+   * @brief Examine the links of a vertex just added to the SPF tree, as
+   * GlobalRouteManagerImpl::SPFNext () does.
+   * @param root the vertex of the router
+   * @param v the vertex added to the tree
+   * @param interfaces the local addresses of the router
+   * @param ws the workspace
+   */
+  void Next (uint32_t root, uint32_t v, const Interfaces &interfaces, Workspace &ws) const;
+
+  /**
+   * @brief Compute the exit directions of the root toward a vertex, as
+   * GlobalRouteManagerImpl::SPFNexthopCalculation () does.
+   * @param root the vertex of the router
+   * @param v the parent
+   * @param w the destination
+   * @param l the link from the parent to the destination
+   * @param interfaces the local addresses of the router
+   * @param ws the workspace
+   * @param exits the exit directions toward w, only replaced when found
+   */
+  void NexthopCalculation (uint32_t root, uint32_t v, uint32_t w, const Link &l,
+                           const Interfaces &interfaces, const Workspace &ws,
+                           std::vector<std::pair<uint32_t, int32_t> > &exits) const;
+
+  /**
+   * @brief Add the routes to the stub networks of a vertex and its children,
+   * as GlobalRouteManagerImpl::SPFProcessStubs () does.
+   * @param root the vertex of the router
+   * @param v the vertex
+   * @param ws the workspace
+   * @param routes the routes of the router
+   * @param hostRoutes the number of host routes among the routes
+   * @param stubRoutes the routes to the stub networks of every vertex
+   */
+  void ProcessStubs (uint32_t root, uint32_t v, Workspace &ws,
+                     std::vector<SPFRoute> &routes, uint32_t hostRoutes,
+                     StubRoutes &stubRoutes) const;
+
+  /**
+   * @brief Look up the interface of a root on a prefix.
+   * @param interfaces the local addresses of the router
+   * @param a the address
+   * @param mask the mask of the prefix
+   * @returns the interface, or -1 if none
+   */
+  static int32_t FindInterface (const Interfaces &interfaces, uint32_t a, uint32_t mask);
+
+  std::vector<Vertex> m_vertices;     //!< the vertices, ordered by link state ID
+  std::vector<Link> m_links;          //!< the links of all the vertices
+  std::vector<External> m_externals;  //!< the external routes
+};
+
 /**
  * @brief A global router implementation.
  *
@@ -733,6 +984,21 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the routes after a change of
+ * the topology, computing again only the routers whose routes may change.
+ *
+ * The routes of a router are left untouched, or only lose the routes to the
+ * hosts and networks which are no longer advertised, when the links which
+ * changed were neither on one of its shortest paths nor needed to reach a
+ * router or network; otherwise they are computed again.  The routing tables
+ * end up the same as after DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes ().
+ *
+ * @returns the number of routers whose routes were computed again
+ */
+  uint32_t UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -767,6 +1033,95 @@ private:
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /**
+   * \brief What is kept of the SPF tree of a router to update its routes.
+   */
+  struct SPFTree
+  {
+    std::vector<uint32_t> distances;    //!< the distances of the vertices, empty for a stub
+    SPFGraph::StubRoutes stubRoutes;    //!< the routes to the stub networks of the vertices
+  };
+
+  /**
+   * \brief A router whose routes are computed on the compact graph.
+   */
+  struct SPFRoot
+  {
+    uint32_t nodeId;                    //!< the node of the router
+    uint32_t vertex;                    //!< the vertex of the router in m_graph
+    bool replace;                       //!< whether to delete the routes of the router first
+    SPFGraph::Interfaces interfaces;    //!< the local addresses of the router
+    std::vector<SPFRoute> routes;       //!< the computed routes
+    SPFTree tree;                       //!< the computed SPF tree
+  };
+
+  /**
+   * \brief A vertex whose links changed between two graphs.
+   */
+  struct SPFChange
+  {
+    uint32_t oldVertex;              //!< the vertex in the old graph, NO_VERTEX if new
+    uint32_t newVertex;              //!< the vertex in the new graph, NO_VERTEX if gone
+    bool deletionsOnly;              //!< whether the new links are the old ones with some deleted
+    std::vector<uint32_t> deleted;   //!< the old links deleted, if deletionsOnly
+  };
+
+  SPFGraph* m_graph; //!< the compact LSDB the current routes were computed on
+  std::map<uint32_t, SPFTree> m_trees; //!< the SPF tree of each router, by node id
+  std::vector<SPFRoot> *m_batch; //!< the routers computed by the worker threads
+  uint32_t m_batchEnd; //!< the end of the routers of m_batch to compute
+  std::vector<SPFGraph::Workspace *> m_workspaces; //!< the workspaces of the worker threads
+  std::atomic<uint32_t> m_nextRoot; //!< the next router of the batch to compute
+  std::atomic<uint32_t> m_nextWorkspace; //!< the next workspace to hand to a worker thread
+
+  /**
+   * \brief Prepare the computation of the routes of a router.
+   * \param node the node of the router
+   * \param routerId the router ID
+   * \param replace whether to delete the routes of the router first
+   * \returns the router to compute
+   */
+  SPFRoot CreateRoot (Ptr<Node> node, Ipv4Address routerId, bool replace) const;
+
+  /**
+   * \brief Compute the routes of some routers on m_graph with several threads
+   * and add them to the routers, in order.
+   * \param roots the routers
+   */
+  void CalculateRoutes (std::vector<SPFRoot> &roots);
+
+  /**
+   * \brief Compute the routes of the routers of m_batch until none is left.
+   */
+  void CalculateWorker (void);
+
+  /**
+   * \brief Find out whether a change of the graph may modify the routes of a
+   * router other than by removing some of them.
+   * \param oldGraph the graph the routes were computed on
+   * \param changes the vertices which changed
+   * \param inDegree the number of links leading to each vertex of m_graph
+   * \param root the vertex of the router in oldGraph
+   * \param distances the distances from the router in oldGraph
+   * \param hosts the hosts whose routes to remove
+   * \param stubs the stub records whose routes to remove, as their vertex in
+   * oldGraph and their rank among the stub records of the vertex
+   * \param gone the vertices no longer reachable, whose routes to remove
+   * \returns true if the routes must be computed again
+   */
+  bool IsAffected (const SPFGraph &oldGraph, const std::vector<SPFChange> &changes,
+                   const std::vector<uint32_t> &inDegree, uint32_t root,
+                   const std::vector<uint32_t> &distances,
+                   std::vector<uint32_t> &hosts,
+                   std::vector<std::pair<uint32_t, uint32_t> > &stubs,
+                   std::vector<uint32_t> &gone) const;
+
+  /**
+   * \brief Delete all the routes of a router.
+   * \param gr the routing protocol of the router
+   */
+  static void DeleteRoutes (Ptr<Ipv4GlobalRouting> gr);
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
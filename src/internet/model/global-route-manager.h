@@ -62,6 +62,12 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables, computing again only the routes a change of the topology may modify
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
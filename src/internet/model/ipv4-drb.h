@@ -5,6 +5,7 @@
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 
@@ -22,9 +23,19 @@ public:
   void AddCoreSwitchAddress (Ipv4Address address);
   void AddCoreSwitchAddress (uint32_t k, Ipv4Address address);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model. Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
 private:
   std::vector<Ipv4Address> m_coreSwitchAddressList;
   std::map<uint32_t, uint32_t> m_indexMap;
+  Ptr<UniformRandomVariable> m_rand;
 };
 
 }
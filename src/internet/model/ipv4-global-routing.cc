@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <iterator>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -27,11 +28,13 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 #include "ns3/flow-id-tag.h"
 #include "ns3/hash.h"
+#include "ns3/hash-murmur3.h"
 
 namespace ns3 {
 
@@ -55,6 +58,17 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_perFlowEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("PerflowEcmpHash",
+                   "How flows are hashed onto the equal cost next hops when PerflowEcmpRouting is enabled",
+                   EnumValue (Ipv4GlobalRouting::ECMP_HASH_INTEGER),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::m_ecmpHashMode),
+                   MakeEnumChecker (Ipv4GlobalRouting::ECMP_HASH_INTEGER, "Integer",
+                                    Ipv4GlobalRouting::ECMP_HASH_STRING, "String"))
+    .AddAttribute ("PerflowEcmpTtlPerturbation",
+                   "Set to true to mix the TTL into the per flow ECMP hash, so that each hop makes an independent choice",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_ecmpTtlPerturbation),
+                   MakeBooleanChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -67,6 +81,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 Ipv4GlobalRouting::Ipv4GlobalRouting ()
   : m_randomEcmpRouting (false),
     m_perFlowEcmpRouting (false),
+    m_ecmpHashMode (ECMP_HASH_INTEGER),
+    m_ecmpTtlPerturbation (true),
     m_respondToInterfaceEvents (false)
 {
   NS_LOG_FUNCTION (this);
@@ -88,6 +104,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_nextHopGroups.clear ();
 }
 
 void
@@ -98,6 +115,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_nextHopGroups.clear ();
 }
 
 void
@@ -113,6 +131,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_nextHopGroups.clear ();
 }
 
 void
@@ -126,6 +145,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_nextHopGroups.clear ();
 }
 
 void
@@ -141,6 +161,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_nextHopGroups.clear ();
 }
 
 
@@ -149,7 +170,33 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
 {
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
+
+  // Lookups not bound to an output device (i.e., all the forwarded packets)
+  // are served from the precomputed next hop groups
+  NextHopGroup boundGroup;
+  const NextHopGroup *group = &boundGroup;
+  if (oif == 0)
+    {
+      group = &GetNextHopGroup (dest);
+    }
+  else
+    {
+      BuildNextHopGroup (dest, oif, boundGroup);
+    }
+
+  if (group->empty ())
+    {
+      return 0;
+    }
+
+  uint32_t selectIndex = SelectEcmpIndex (group->size (), header, flowId);
+  return (*group)[selectIndex];
+}
+
+void
+Ipv4GlobalRouting::BuildNextHopGroup (Ipv4Address dest, Ptr<NetDevice> oif, NextHopGroup &group)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
@@ -222,44 +269,75 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  for (RouteVec_t::const_iterator itr = allRoutes.begin (); itr != allRoutes.end (); ++itr)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else if (m_perFlowEcmpRouting && flowId != 0) // If the flow id is 0, it may be the socket setup endpoint request, we simply return the first
-        {                                           // available route to indicate the address is not local
-          std::stringstream hash_string;
-          hash_string << flowId;
-          hash_string << header.GetTtl ();
-          uint32_t hashPerturbe = Hash32 (hash_string.str ()); // Hash Perturbe
-          selectIndex = hashPerturbe % allRoutes.size();
-          NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId);
-        }
-      else
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex);
+      Ipv4RoutingTableEntry* route = *itr;
       // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
+      Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
       /// \todo handle multi-address case
       rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
       rtentry->SetGateway (route->GetGateway ());
       uint32_t interfaceIdx = route->GetInterface ();
       rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
+      group.push_back (rtentry);
+    }
+}
+
+const Ipv4GlobalRouting::NextHopGroup&
+Ipv4GlobalRouting::GetNextHopGroup (Ipv4Address dest)
+{
+  NextHopGroups::iterator itr = m_nextHopGroups.find (dest);
+  if (itr == m_nextHopGroups.end ())
+    {
+      NS_LOG_LOGIC ("Building the next hop group for destination " << dest);
+      itr = m_nextHopGroups.insert (std::make_pair (dest, NextHopGroup ())).first;
+      BuildNextHopGroup (dest, 0, itr->second);
+    }
+  return itr->second;
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectEcmpIndex (uint32_t groupSize, const Ipv4Header &header, uint32_t flowId)
+{
+  // pick up one of the routes uniformly at random if random
+  // ECMP routing is enabled, or always select the first route
+  // consistently if random ECMP routing is disabled
+  uint32_t selectIndex;
+  if (m_randomEcmpRouting)
+    {
+      selectIndex = m_rand->GetInteger (0, groupSize - 1);
+    }
+  else if (m_perFlowEcmpRouting && flowId != 0) // If the flow id is 0, it may be the socket setup endpoint request, we simply return the first
+    {                                           // available route to indicate the address is not local
+      uint32_t hashPerturbe;
+      if (m_ecmpHashMode == ECMP_HASH_INTEGER)
+        {
+          uint32_t key = flowId;
+          if (m_ecmpTtlPerturbation)
+            {
+              key ^= static_cast<uint32_t> (header.GetTtl ()) * 0x9e3779b1;
+            }
+          hashPerturbe = Hash::Function::Murmur3::Fmix32 (key);
+        }
+      else
+        {
+          std::stringstream hash_string;
+          hash_string << flowId;
+          if (m_ecmpTtlPerturbation)
+            {
+              hash_string << header.GetTtl ();
+            }
+          hashPerturbe = Hash32 (hash_string.str ()); // Hash Perturbe
+        }
+      selectIndex = hashPerturbe % groupSize;
+      NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId);
     }
   else
     {
-      return 0;
+      selectIndex = 0;
     }
+  return selectIndex;
 }
 
 uint32_t
@@ -326,6 +404,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_nextHopGroups.clear ();
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -379,6 +458,41 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+void
+Ipv4GlobalRouting::RemoveHostRoutesTo (Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+  m_nextHopGroups.clear ();
+  HostRoutesI i = m_hostRoutes.begin ();
+  while (i != m_hostRoutes.end ())
+    {
+      if ((*i)->GetDest () == dest)
+        {
+          delete *i;
+          i = m_hostRoutes.erase (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+}
+
+void
+Ipv4GlobalRouting::RemoveNetworkRoutes (uint32_t first, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << first << n);
+  NS_ASSERT (first + n <= m_networkRoutes.size ());
+  m_nextHopGroups.clear ();
+  NetworkRoutesI j = m_networkRoutes.begin ();
+  std::advance (j, first);
+  for (uint32_t k = 0; k < n; k++)
+    {
+      delete *j;
+      j = m_networkRoutes.erase (j);
+    }
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -409,6 +523,7 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_nextHopGroups.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -578,11 +693,11 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  // the next hop devices and source addresses may change
+  m_nextHopGroups.clear ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -590,11 +705,11 @@ void
 Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  // the next hop devices and source addresses may change
+  m_nextHopGroups.clear ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -602,11 +717,11 @@ void
 Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  // the next hop devices and source addresses may change
+  m_nextHopGroups.clear ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -614,11 +729,11 @@ void
 Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  // the next hop devices and source addresses may change
+  m_nextHopGroups.clear ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -74,6 +76,16 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /**
+   * \brief How a flow is hashed onto the ECMP next hops when PerflowEcmpRouting is enabled
+   */
+  enum EcmpHashMode
+  {
+    ECMP_HASH_INTEGER,  //!< Murmur3 finalizer over the flow id (and TTL) bits
+    ECMP_HASH_STRING    //!< Murmur3 over the decimal flow id followed by the TTL byte (legacy)
+  };
+
   /**
    * \brief Construct an empty Ipv4GlobalRouting routing protocol,
    *
@@ -216,6 +228,27 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove all the host routes to a destination.
+   *
+   * \param dest The Ipv4Address of the destination host.
+   *
+   * \see Ipv4GlobalRouting::RemoveRoute
+   */
+  void RemoveHostRoutesTo (Ipv4Address dest);
+
+  /**
+   * \brief Remove consecutive network routes, the AS external routes
+   * excepted.
+   *
+   * \param first The index of the first route to remove among the network
+   * routes, in the order they were added.
+   * \param n The number of routes to remove.
+   *
+   * \see Ipv4GlobalRouting::RemoveRoute
+   */
+  void RemoveNetworkRoutes (uint32_t first, uint32_t n);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -235,6 +268,12 @@ private:
 
   bool m_perFlowEcmpRouting;
 
+  /// How the flow id is hashed when per flow ECMP is enabled
+  EcmpHashMode m_ecmpHashMode;
+
+  /// Set to true to mix the TTL into the per flow ECMP hash, so that successive hops pick independently
+  bool m_ecmpTtlPerturbation;
+
   /// Set to true if this interface should respond to interface events by globallly recomputing routes
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP
@@ -261,8 +300,40 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// The routes (one per equal cost next hop) used to reach a destination
+  typedef std::vector<Ptr<Ipv4Route> > NextHopGroup;
+  /// container of next hop groups, indexed by destination
+  typedef std::map<Ipv4Address, NextHopGroup> NextHopGroups;
+
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv4Header &header, uint32_t flowId, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Build a next hop group by scanning the host, network and external routes
+   * \param dest the destination address
+   * \param oif the output device the routes must use, 0 for any
+   * \param group the group to fill with one route per matching entry
+   */
+  void BuildNextHopGroup (Ipv4Address dest, Ptr<NetDevice> oif, NextHopGroup &group);
+
+  /**
+   * \brief Get the cached next hop group of a destination, building it on the first lookup
+   * \param dest the destination address
+   * \return the next hop group, empty if the destination is unreachable
+   */
+  const NextHopGroup& GetNextHopGroup (Ipv4Address dest);
+
+  /**
+   * \brief Select one of the equal cost next hops
+   * \param groupSize the number of next hops
+   * \param header the IPv4 header of the packet
+   * \param flowId the flow id of the packet, 0 if unknown
+   * \return the index of the selected next hop
+   */
+  uint32_t SelectEcmpIndex (uint32_t groupSize, const Ipv4Header &header, uint32_t flowId);
+
+  /// Next hop groups built so far; flushed whenever the routing table or the interfaces change
+  NextHopGroups m_nextHopGroups;
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
@@ -22,6 +22,10 @@
 
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/integer.h"
+#include "ns3/string.h"
+#include "ns3/abort.h"
+#include <sstream>
 #include "ipv4-queue-disc-item.h"
 #include "ipv4-packet-filter.h"
 
@@ -68,6 +72,7 @@ Ipv4SimplePacketFilter::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Ipv4SimplePacketFilter")
     .SetParent<Ipv4PacketFilter> ()
     .SetGroupName ("Internet")
+    .AddConstructor<Ipv4SimplePacketFilter> ()
   ;
   return tid;
 }
@@ -93,6 +98,114 @@ Ipv4SimplePacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
 
 // ------------------------------------------------------------------------- //
 
+NS_OBJECT_ENSURE_REGISTERED (Ipv4DscpPacketFilter);
+
+TypeId
+Ipv4DscpPacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4DscpPacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4DscpPacketFilter> ()
+    .AddAttribute ("DscpMap",
+                   "The classes of the DSCPs, as a list of dscp:class pairs",
+                   StringValue (""),
+                   MakeStringAccessor (&Ipv4DscpPacketFilter::SetDscpMap,
+                                       &Ipv4DscpPacketFilter::GetDscpMap),
+                   MakeStringChecker ())
+    .AddAttribute ("DefaultClass",
+                   "The class of the DSCPs not in the map",
+                   IntegerValue (PacketFilter::PF_NO_MATCH),
+                   MakeIntegerAccessor (&Ipv4DscpPacketFilter::m_defaultClass),
+                   MakeIntegerChecker<int32_t> ())
+  ;
+  return tid;
+}
+
+Ipv4DscpPacketFilter::Ipv4DscpPacketFilter ()
+  : m_defaultClass (PacketFilter::PF_NO_MATCH)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < N_DSCP; i++)
+    {
+      m_classes[i] = PacketFilter::PF_NO_MATCH;
+    }
+}
+
+Ipv4DscpPacketFilter::~Ipv4DscpPacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4DscpPacketFilter::SetDscpClass (Ipv4Header::DscpType dscp, int32_t cl)
+{
+  NS_LOG_FUNCTION (this << dscp << cl);
+  NS_ABORT_MSG_IF (dscp >= N_DSCP, "Invalid DSCP " << dscp);
+  m_classes[dscp] = cl;
+}
+
+void
+Ipv4DscpPacketFilter::SetDscpMap (std::string map)
+{
+  NS_LOG_FUNCTION (this << map);
+
+  for (uint32_t i = 0; i < N_DSCP; i++)
+    {
+      m_classes[i] = PacketFilter::PF_NO_MATCH;
+    }
+
+  for (std::string::iterator c = map.begin (); c != map.end (); c++)
+    {
+      if (*c == ',')
+        {
+          *c = ' ';
+        }
+    }
+  std::istringstream iss (map);
+  std::string pair;
+  while (iss >> pair)
+    {
+      std::istringstream pss (pair);
+      uint32_t dscp;
+      int32_t cl;
+      char sep;
+      bool ok = (pss >> dscp >> sep >> cl) && sep == ':' && pss.eof ();
+      NS_ABORT_MSG_UNLESS (ok, "Invalid DSCP map entry " << pair);
+      SetDscpClass (static_cast<Ipv4Header::DscpType> (dscp), cl);
+    }
+}
+
+std::string
+Ipv4DscpPacketFilter::GetDscpMap (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < N_DSCP; i++)
+    {
+      if (m_classes[i] != PacketFilter::PF_NO_MATCH)
+        {
+          if (oss.tellp () > 0)
+            {
+              oss << " ";
+            }
+          oss << i << ":" << m_classes[i];
+        }
+    }
+  return oss.str ();
+}
+
+int32_t
+Ipv4DscpPacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+  // CheckProtocol has already made sure that the item is an Ipv4QueueDiscItem
+  const Ipv4QueueDiscItem *ipv4Item = static_cast<const Ipv4QueueDiscItem *> (PeekPointer (item));
+  int32_t cl = m_classes[ipv4Item->GetHeader ().GetDscp ()];
+  return cl == PacketFilter::PF_NO_MATCH ? m_defaultClass : cl;
+}
+
+// ------------------------------------------------------------------------- //
+
 NS_OBJECT_ENSURE_REGISTERED (PfifoFastIpv4PacketFilter);
 
 TypeId
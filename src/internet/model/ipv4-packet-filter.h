@@ -25,6 +25,8 @@
 
 #include "ns3/object.h"
 #include "ns3/packet-filter.h"
+#include "ns3/ipv4-header.h"
+#include <string>
 
 namespace ns3 {
 
@@ -64,6 +66,46 @@ private:
   virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
 };
 
+/**
+ * \ingroup internet
+ *
+ * Ipv4DscpPacketFilter classifies IPv4 packets through a table indexed by
+ * the DSCP of the header already parsed in the Ipv4QueueDiscItem.
+ *
+ * The table is set by the DscpMap attribute, a list of "dscp:class" pairs
+ * separated by spaces or commas, e.g., "46:0 10:1 0:2". The packets whose
+ * DSCP is not in the list get the DefaultClass, which is no match unless
+ * set.
+ */
+class Ipv4DscpPacketFilter: public Ipv4PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4DscpPacketFilter ();
+  virtual ~Ipv4DscpPacketFilter ();
+
+  /**
+   * \brief Set the class of the packets with the given DSCP
+   * \param dscp the DSCP
+   * \param cl the class, PF_NO_MATCH for the default class
+   */
+  void SetDscpClass (Ipv4Header::DscpType dscp, int32_t cl);
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+  void SetDscpMap (std::string map);
+  std::string GetDscpMap (void) const;
+
+  static const uint32_t N_DSCP = 64;  //!< number of DSCP values
+
+  int32_t m_classes[N_DSCP];          //!< class of each DSCP
+  int32_t m_defaultClass;             //!< class of the unlisted DSCPs
+};
+
 
 /**
  * \ingroup internet
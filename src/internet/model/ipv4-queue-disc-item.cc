@@ -71,6 +71,19 @@ void Ipv4QueueDiscItem::AddHeader(void)
   m_headerAdded = true;
 }
 
+bool
+Ipv4QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv4Header::EcnType ecn = m_header.GetEcn ();
+  if (!m_headerAdded && (ecn == Ipv4Header::ECN_ECT0 || ecn == Ipv4Header::ECN_ECT1))
+    {
+      m_header.SetEcn (Ipv4Header::ECN_CE);
+      return true;
+    }
+  return false;
+}
+
 void
 Ipv4QueueDiscItem::Print (std::ostream& os) const
 {
@@ -1,8 +1,24 @@
 #include "ipv4-xpath-tag.h"
+#include "ns3/assert.h"
 
 namespace ns3 {
 
-Ipv4XPathTag::Ipv4XPathTag () {}
+const uint32_t Ipv4XPathTag::MAX_HOPS;
+const uint32_t Ipv4XPathTag::MAX_ENCODED_HOPS;
+const uint32_t Ipv4XPathTag::MAX_ENCODED_PORT;
+const uint32_t Ipv4XPathTag::BINARY_FLAG;
+const uint32_t Ipv4XPathTag::PORT_BITS;
+
+Ipv4XPathTag::Ipv4XPathTag ()
+  : m_pathId (0),
+    m_hopCount (0),
+    m_hop (0)
+{
+  for (uint32_t i = 0; i < MAX_HOPS; i++)
+  {
+    m_ports[i] = 0;
+  }
+}
 
 TypeId
 Ipv4XPathTag::GetTypeId (void)
@@ -16,7 +32,21 @@ Ipv4XPathTag::GetTypeId (void)
 }
 
 uint32_t
-Ipv4XPathTag::GetPathId (void)
+Ipv4XPathTag::EncodePathId (const std::vector<uint32_t> &ports)
+{
+  NS_ASSERT_MSG (ports.size () <= MAX_ENCODED_HOPS, "The path has too many hops to be encoded");
+
+  uint32_t pathId = BINARY_FLAG;
+  for (uint32_t i = 0; i < ports.size (); i++)
+  {
+    NS_ASSERT_MSG (ports[i] > 0 && ports[i] <= MAX_ENCODED_PORT, "Port " << ports[i] << " cannot be encoded");
+    pathId |= ports[i] << (i * PORT_BITS);
+  }
+  return pathId;
+}
+
+uint32_t
+Ipv4XPathTag::GetPathId (void) const
 {
   return m_pathId;
 }
@@ -25,6 +55,52 @@ void
 Ipv4XPathTag::SetPathId (uint32_t pathId)
 {
   m_pathId = pathId;
+  m_hopCount = 0;
+  m_hop = 0;
+
+  if (pathId & BINARY_FLAG)
+  {
+    uint32_t ports = pathId & ~BINARY_FLAG;
+    while (ports != 0 && m_hopCount < MAX_ENCODED_HOPS)
+    {
+      m_ports[m_hopCount++] = ports & MAX_ENCODED_PORT;
+      ports >>= PORT_BITS;
+    }
+  }
+  else
+  {
+    while (pathId != 0 && m_hopCount < MAX_HOPS)
+    {
+      m_ports[m_hopCount++] = pathId % 100;
+      pathId /= 100;
+    }
+  }
+}
+
+uint32_t
+Ipv4XPathTag::GetHopCount (void) const
+{
+  return m_hopCount;
+}
+
+bool
+Ipv4XPathTag::IsFinalHop (void) const
+{
+  return m_hop >= m_hopCount;
+}
+
+uint32_t
+Ipv4XPathTag::GetCurrentPort (void) const
+{
+  NS_ASSERT (m_hop < m_hopCount);
+  return m_ports[m_hop];
+}
+
+void
+Ipv4XPathTag::NextHop (void)
+{
+  NS_ASSERT (m_hop < m_hopCount);
+  m_hop++;
 }
 
 TypeId
@@ -36,25 +112,32 @@ Ipv4XPathTag::GetInstanceTypeId (void) const
 uint32_t
 Ipv4XPathTag::GetSerializedSize (void) const
 {
-  return sizeof (uint32_t);
+  return sizeof (uint32_t) + 2 + MAX_HOPS;
 }
 
 void
 Ipv4XPathTag::Serialize (TagBuffer i) const
 {
   i.WriteU32 (m_pathId);
+  i.WriteU8 (m_hopCount);
+  i.WriteU8 (m_hop);
+  i.Write (m_ports, MAX_HOPS);
 }
 
 void
 Ipv4XPathTag::Deserialize (TagBuffer i)
 {
   m_pathId = i.ReadU32 ();
+  m_hopCount = i.ReadU8 ();
+  m_hop = i.ReadU8 ();
+  i.Read (m_ports, MAX_HOPS);
 }
 
 void
 Ipv4XPathTag::Print (std::ostream &os) const
 {
-  os << "Path Id = " << m_pathId;
+  os << "Path Id = " << m_pathId << ", Hop = " << static_cast<uint32_t> (m_hop)
+     << "/" << static_cast<uint32_t> (m_hopCount);
 }
 
 }
@@ -3,19 +3,66 @@
 
 #include "ns3/tag.h"
 
+#include <vector>
+
 namespace ns3 {
 
+/**
+ * The source route of an XPath packet: the output port of every hop and a
+ * pointer to the hop the packet is currently at. Each switch reads the port
+ * of its hop and advances the pointer in place.
+ *
+ * The route is given as a 32 bit path id, in one of two formats:
+ * - binary (bit 31 set): 6 bits per hop, first hop in the lowest bits and a
+ *   zero port ending the route, i.e., up to 5 hops with ports up to 63.
+ *   This is the format of EncodePathId and of Ipv4XPathPathHelper
+ * - legacy decimal (bit 31 clear): two decimal digits per hop, first hop in
+ *   the lowest digits, e.g., 302 goes out of port 2 and then port 3
+ */
 class Ipv4XPathTag: public Tag
 {
 public:
+    static const uint32_t MAX_HOPS = 8;
+    static const uint32_t MAX_ENCODED_HOPS = 5;
+    static const uint32_t MAX_ENCODED_PORT = 63;
+
     Ipv4XPathTag ();
 
     static TypeId GetTypeId (void);
 
-    uint32_t GetPathId (void);
+    /**
+     * \param ports the output port of each hop, at most MAX_ENCODED_HOPS ports below MAX_ENCODED_PORT + 1
+     * \return the binary path id of the route
+     */
+    static uint32_t EncodePathId (const std::vector<uint32_t> &ports);
 
+    /**
+     * \return the path id the route has been built from
+     */
+    uint32_t GetPathId (void) const;
+
+    /**
+     * Set the route from its path id and move the hop pointer to the first hop
+     */
     void SetPathId (uint32_t pathId);
 
+    uint32_t GetHopCount (void) const;
+
+    /**
+     * \return true if all the hops of the route have been taken
+     */
+    bool IsFinalHop (void) const;
+
+    /**
+     * \return the output port of the current hop
+     */
+    uint32_t GetCurrentPort (void) const;
+
+    /**
+     * Move the hop pointer to the next hop
+     */
+    void NextHop (void);
+
     virtual TypeId GetInstanceTypeId (void) const;
 
     virtual uint32_t GetSerializedSize (void) const;
@@ -27,7 +74,13 @@ public:
     virtual void Print (std::ostream &os) const;
 
 private:
+    static const uint32_t BINARY_FLAG = 0x80000000;
+    static const uint32_t PORT_BITS = 6;
+
     uint32_t m_pathId;
+    uint8_t m_hopCount;
+    uint8_t m_hop;
+    uint8_t m_ports[MAX_HOPS];
 };
 
 }
@@ -65,6 +65,21 @@ void Ipv6QueueDiscItem::AddHeader(void)
   m_headerAdded = true;
 }
 
+bool
+Ipv6QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The ECN field is made of the two least significant bits of the traffic class
+  uint8_t tc = m_header.GetTrafficClass ();
+  uint8_t ecn = tc & 0x03;
+  if (!m_headerAdded && (ecn == 0x01 || ecn == 0x02))
+    {
+      m_header.SetTrafficClass (tc | 0x03);
+      return true;
+    }
+  return false;
+}
+
 void
 Ipv6QueueDiscItem::Print (std::ostream& os) const
 {
@@ -63,6 +63,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Mark the packet, by setting the ECN field of the header to CE
+   * \return true if the packet was ECN capable and is now marked.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
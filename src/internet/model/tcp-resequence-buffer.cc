@@ -106,7 +106,7 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   if (!m_checkEvent.IsRunning ())
   {
     NS_LOG_LOGIC ("Turn on periodical check");
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
+    m_checkEvent = Simulator::ScheduleTimeout (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
     m_inOrderQueueTimer = Simulator::Now ();
     m_outOrderQueueTimer = Simulator::Now ();
   }
@@ -280,7 +280,7 @@ TcpResequenceBuffer::PeriodicalCheck ()
 
   if (!m_inOrderQueue.empty () || !m_outOrderQueue.empty ())
   {
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
+    m_checkEvent = Simulator::ScheduleTimeout (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
   }
   else
   {
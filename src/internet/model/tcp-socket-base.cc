@@ -361,6 +361,8 @@ TcpSocketBase::TcpSocketBase (void)
     m_CloveEnabled (false),
     m_CloveSendSide (false),
     m_piggybackCloveInfo (false),
+    m_pathSelector (0),
+    m_pathFlowId (0),
     // Pause
     m_isPauseEnabled (false),
     m_isPause (false),
@@ -467,6 +469,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_CloveEnabled (sock.m_CloveEnabled),
     m_CloveSendSide (false),
     m_piggybackCloveInfo (false),
+    m_pathSelector (0),
+    m_pathFlowId (0),
     // Pause
     m_isPauseEnabled (sock.m_isPauseEnabled),
     m_isPause (false),
@@ -1153,6 +1157,7 @@ TcpSocketBase::DoConnect (void)
       {
           m_CloveSendSide = true;
       }
+      SetupPathSelector ();
       SendEmptyPacket (sendflags);
 
       // XXX Resequence Buffer Support, disable resequence buffer on sender side
@@ -1437,7 +1442,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
-      m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+      m_persistEvent = Simulator::ScheduleTimeout (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
       NS_ASSERT (m_persistTimeout == Simulator::GetDelayLeft (m_persistEvent));
     }
 
@@ -1644,12 +1649,9 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
     bool found = packet->RemovePacketTag(tcpTLBTag);
     if (found)
     {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                m_endPoint->GetPeerAddress (), m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
         m_pathAcked = tcpTLBTag.GetPath ();
         // std::cout << this << " Path acked: " << m_pathAcked << std::endl;
-        ipv4TLB->FlowRecv (flowId, m_pathAcked, m_endPoint->GetPeerAddress (), bytesAcked, withECE, tcpTLBTag.GetTime ());
+        m_ipv4TLB->FlowRecv (m_pathFlowId, m_pathAcked, m_endPoint->GetPeerAddress (), bytesAcked, withECE, tcpTLBTag.GetTime ());
     }
   }
 
@@ -1660,9 +1662,8 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
     bool found = packet->RemovePacketTag(tcpCloveTag);
     if (found)
     {
-        Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
         m_pathAcked = tcpCloveTag.GetPath ();
-        ipv4Clove->FlowRecv (m_pathAcked, m_endPoint->GetPeerAddress (), withECE);
+        m_ipv4Clove->FlowRecv (m_pathAcked, m_endPoint->GetPeerAddress (), withECE);
     }
   }
 
@@ -2382,7 +2383,7 @@ TcpSocketBase::DoPeerClose (void)
     {
       NS_LOG_LOGIC ("TcpSocketBase " << this << " scheduling LATO1");
       Time lastRto = m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4);
-      m_lastAckEvent = Simulator::Schedule (lastRto, &TcpSocketBase::LastAckTimeout, this);
+      m_lastAckEvent = Simulator::ScheduleTimeout (lastRto, &TcpSocketBase::LastAckTimeout, this);
     }
 }
 
@@ -2524,53 +2525,38 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
         }
     }
 
-  // XXX TLB Support
-  if (m_TLBEnabled)
+  // XXX Edge load balancer Support
+  if (m_pathSelector != 0 && (m_TLBSendSide || m_CloveSendSide))
   {
-    if (m_TLBSendSide)
+    bool synRetrans = hasSyn && (m_synCount != m_synRetries - 1);
+    uint32_t path = SelectPath (p, synRetrans);
+    if (synRetrans)
     {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-      uint32_t path = ipv4TLB->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-      // std::cout << this << " Get Path From TLB: " << path << std::endl;
-
-      // XPath Support
-      Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
-      p->AddPacketTag (ipv4XPathTag);
-
-      // TLB Support
-      TcpTLBTag tcpTLBTag;
-      tcpTLBTag.SetPath (path);
-      tcpTLBTag.SetTime (Simulator::Now ());
-      p->AddPacketTag (tcpTLBTag);
-
-      bool synRetrans = hasSyn && (m_synCount != m_synRetries - 1);
-      ipv4TLB->FlowSend (flowId, m_endPoint->GetPeerAddress (), path, p->GetSize (), synRetrans);
-      if (synRetrans)
-      {
-          ipv4TLB->FlowTimeout (flowId, m_endPoint->GetPeerAddress (), path);
-      }
+        m_pathSelector->FlowTimeout (m_pathFlowId, m_endPoint->GetPeerAddress (), path);
+    }
 
-      // Pause Support
-      if (m_isPauseEnabled && m_oldPath == 0)
-      {
-          m_oldPath = path;
-      }
+    // Pause Support
+    if (m_TLBSendSide && m_isPauseEnabled && m_oldPath == 0)
+    {
+        m_oldPath = path;
+    }
 
-      if (m_isPauseEnabled
-            && !m_isPause
-            && m_oldPath != path)
-      {
-          std::cout << "Turning on pause" << std::endl;
-          m_isPause = true;
-          m_oldPath = path;
-          Time pauseTime = ipv4TLB->GetPauseTime (flowId);
-          Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
-      }
+    if (m_TLBSendSide
+          && m_isPauseEnabled
+          && !m_isPause
+          && m_oldPath != path)
+    {
+        std::cout << "Turning on pause" << std::endl;
+        m_isPause = true;
+        m_oldPath = path;
+        Time pauseTime = m_ipv4TLB->GetPauseTime (m_pathFlowId);
+        Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
     }
+  }
+
+  // XXX TLB Support
+  if (m_TLBEnabled)
+  {
 
     if (m_piggybackTLBInfo)
     {
@@ -2582,11 +2568,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
     if (m_TLBReverseAckEnabled && (hasSyn || isAck) && !m_TLBSendSide)
     {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                        m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-      uint32_t path = ipv4TLB->GetAckPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
+      uint32_t path = m_ipv4TLB->GetAckPath (m_pathFlowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
 
       // XPath Support
       Ipv4XPathTag ipv4XPathTag;
@@ -2596,33 +2578,11 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
   }
 
   // XXX Clove Support
-  if (m_CloveEnabled)
+  if (m_CloveEnabled && m_piggybackCloveInfo)
   {
-    if (m_CloveSendSide)
-    {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
-      uint32_t path = ipv4Clove->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-
-      // XPath Support
-      Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
-      p->AddPacketTag (ipv4XPathTag);
-
-      // Clove Support
-      TcpCloveTag tcpCloveTag;
-      tcpCloveTag.SetPath (path);
-      p->AddPacketTag (tcpCloveTag);
-    }
-
-    if (m_piggybackCloveInfo)
-    {
-      TcpCloveTag tcpCloveTag;
-      tcpCloveTag.SetPath (m_ClovePath);
-      p->AddPacketTag (tcpCloveTag);
-    }
+    TcpCloveTag tcpCloveTag;
+    tcpCloveTag.SetPath (m_ClovePath);
+    p->AddPacketTag (tcpCloveTag);
   }
 
   m_txTrace (p, header, this);
@@ -2666,7 +2626,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
                     << Simulator::Now ().GetSeconds () << " to expire at time "
                     << (Simulator::Now () + m_rto.Get ()).GetSeconds ());
 
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+      m_retxEvent = Simulator::ScheduleTimeout (m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
     }
 }
 
@@ -2797,6 +2757,7 @@ TcpSocketBase::CompleteFork (Ptr<Packet> p, const TcpHeader& h,
       m_endPoint = 0;
     }
   m_tcp->AddSocket (this);
+  SetupPathSelector ();
 
   // Change the cloned socket from LISTEN state to SYN_RCVD
   NS_LOG_DEBUG ("LISTEN -> SYN_RCVD");
@@ -2957,7 +2918,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent = Simulator::ScheduleTimeout (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   m_txTrace (p, header, this);
@@ -2966,67 +2927,29 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     {
       TcpSocketBase::AttachFlowId (p, m_endPoint->GetLocalAddress (),
                          m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-      // XXX TLB Support
-      if (m_TLBEnabled && m_TLBSendSide)
+      // XXX Edge load balancer Support
+      if (m_pathSelector != 0 && (m_TLBSendSide || m_CloveSendSide))
       {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        uint32_t path = ipv4TLB->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-        // std::cout << this << " Get Path From TLB: " << path << std::endl;
-
-        // XPath Support
-        Ipv4XPathTag ipv4XPathTag;
-        ipv4XPathTag.SetPathId (path);
-        p->AddPacketTag (ipv4XPathTag);
-
-        // TLB Support
-        TcpTLBTag tcpTLBTag;
-        tcpTLBTag.SetPath (path);
-        tcpTLBTag.SetTime (Simulator::Now ());
-        p->AddPacketTag (tcpTLBTag);
-        ipv4TLB->FlowSend (flowId, m_endPoint->GetPeerAddress (), path, p->GetSize (), isRetransmission);
+        uint32_t path = SelectPath (p, isRetransmission);
 
         // Pause Support
-        if (m_isPauseEnabled && m_oldPath == 0)
+        if (m_TLBSendSide && m_isPauseEnabled && m_oldPath == 0)
         {
             m_oldPath = path;
         }
-        if (m_isPauseEnabled
+        if (m_TLBSendSide
+            && m_isPauseEnabled
             && !m_isPause
             && m_oldPath != path)
         {
             std::cout << "Turning on pause ..." << std::endl;
             m_isPause = true;
             m_oldPath = path;
-            Time pauseTime = ipv4TLB->GetPauseTime (flowId);
+            Time pauseTime = m_ipv4TLB->GetPauseTime (m_pathFlowId);
             Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
         }
       }
 
-      // XXX Clove Support
-      if (m_CloveEnabled)
-      {
-        if (m_CloveSendSide)
-        {
-          uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                                 m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-          Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
-          uint32_t path = ipv4Clove->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-
-          // XPath Support
-          Ipv4XPathTag ipv4XPathTag;
-          ipv4XPathTag.SetPathId (path);
-          p->AddPacketTag (ipv4XPathTag);
-
-          // Clove Support
-          TcpCloveTag tcpCloveTag;
-          tcpCloveTag.SetPath (path);
-          p->AddPacketTag (tcpCloveTag);
-        }
-      }
-
 
       if (m_isPause)
       {
@@ -3325,8 +3248,8 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       else if (m_delAckEvent.IsExpired ())
         {
           m_congestionControl->CwndEvent(m_tcb, TcpCongestionOps::CA_EVENT_DELAY_ACK_RESERVED, this);
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          m_delAckEvent = Simulator::ScheduleTimeout (m_delAckTimeout,
+                                                      &TcpSocketBase::DelAckTimeout, this);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
                         (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
         }
@@ -3427,7 +3350,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
       NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      m_retxEvent = Simulator::ScheduleTimeout (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3544,7 +3467,7 @@ TcpSocketBase::PersistTimeout ()
   NS_LOG_LOGIC ("Schedule persist timeout at time "
                 << Simulator::Now ().GetSeconds () << " to expire at time "
                 << (Simulator::Now () + m_persistTimeout).GetSeconds ());
-  m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+  m_persistEvent = Simulator::ScheduleTimeout (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
 }
 
 void
@@ -3594,13 +3517,10 @@ TcpSocketBase::Retransmit ()
 
   if (m_tcb->m_congState != TcpSocketState::CA_LOSS)
     {
-      // XXX TLB Support
-      if (m_TLBEnabled)
+      // XXX Edge load balancer Support
+      if (m_pathSelector != 0)
       {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                m_endPoint->GetPeerAddress (), m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        ipv4TLB->FlowTimeout (flowId, m_endPoint->GetPeerAddress (), m_pathAcked);
+        m_pathSelector->FlowTimeout (m_pathFlowId, m_endPoint->GetPeerAddress (), m_pathAcked);
       }
       m_tcb->m_congState = TcpSocketState::CA_LOSS;
       m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, BytesInFlight ());
@@ -3685,8 +3605,8 @@ TcpSocketBase::TimeWait ()
   CancelAllTimers ();
   // Move from TIME_WAIT to CLOSED after 2*MSL. Max segment lifetime is 2 min
   // according to RFC793, p.28
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
+  m_timewaitEvent = Simulator::ScheduleTimeout (Seconds (2 * m_msl),
+                                                &TcpSocketBase::CloseAndNotify, this);
 }
 
 /* Below are the attribute get/set functions */
@@ -4150,6 +4070,71 @@ TcpSocketBase::CalFlowId (const Ipv4Address &saddr, const Ipv4Address &daddr,
   return Hash32 (hash_string.str ());
 }
 
+void
+TcpSocketBase::SetupPathSelector (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_ipv4TLB = 0;
+  m_ipv4Clove = 0;
+  m_pathSelector = 0;
+
+  if (m_endPoint == 0 || (!m_TLBEnabled && !m_CloveEnabled))
+    {
+      return;
+    }
+
+  m_pathFlowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
+          m_endPoint->GetPeerAddress (), m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
+
+  if (m_TLBEnabled)
+    {
+      m_ipv4TLB = m_node->GetObject<Ipv4TLB> ();
+      NS_ASSERT_MSG (m_ipv4TLB != 0, "TLB is enabled but the node has no Ipv4TLB");
+      m_pathSelector = PeekPointer (m_ipv4TLB);
+    }
+
+  if (m_CloveEnabled)
+    {
+      m_ipv4Clove = m_node->GetObject<Ipv4Clove> ();
+      NS_ASSERT_MSG (m_ipv4Clove != 0, "Clove is enabled but the node has no Ipv4Clove");
+      if (m_pathSelector == 0)
+        {
+          m_pathSelector = PeekPointer (m_ipv4Clove);
+        }
+    }
+}
+
+uint32_t
+TcpSocketBase::SelectPath (Ptr<Packet> p, bool isRetransmission)
+{
+  uint32_t path = m_pathSelector->GetPath (m_pathFlowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
+
+  // XPath Support
+  Ipv4XPathTag ipv4XPathTag;
+  ipv4XPathTag.SetPathId (path);
+  p->AddPacketTag (ipv4XPathTag);
+
+  if (m_TLBSendSide)
+    {
+      // TLB Support
+      TcpTLBTag tcpTLBTag;
+      tcpTLBTag.SetPath (path);
+      tcpTLBTag.SetTime (Simulator::Now ());
+      p->AddPacketTag (tcpTLBTag);
+    }
+  else
+    {
+      // Clove Support
+      TcpCloveTag tcpCloveTag;
+      tcpCloveTag.SetPath (path);
+      p->AddPacketTag (tcpCloveTag);
+    }
+
+  m_pathSelector->FlowSend (m_pathFlowId, m_endPoint->GetPeerAddress (), path, p->GetSize (), isRetransmission);
+  return path;
+}
+
 void
 TcpSocketBase::RecoverFromPause (void)
 {
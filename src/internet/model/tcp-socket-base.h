@@ -41,6 +41,7 @@
 #include "tcp-resequence-buffer.h"
 #include "tcp-flow-bender.h"
 #include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-clove.h"
 #include "tcp-pause-buffer.h"
 
 namespace ns3 {
@@ -931,6 +932,23 @@ protected:
   uint32_t CalFlowId (const Ipv4Address &saddr, const Ipv4Address &daddr,
           uint16_t sport, uint16_t dport);
 
+  /**
+   * \brief Resolve the edge load balancer of the connection
+   *
+   * Looks up the TLB / Clove objects aggregated to the node and the flow id
+   * of the connection once, when the end point is known, so that the per
+   * segment code does not have to.
+   */
+  void SetupPathSelector (void);
+
+  /**
+   * \brief Ask the path selector for the path of a segment and tag the segment
+   * \param p the segment
+   * \param isRetransmission whether the segment is a retransmission
+   * \return the selected path
+   */
+  uint32_t SelectPath (Ptr<Packet> p, bool isRetransmission);
+
   void RecoverFromPause (void);
 
 protected:
@@ -1037,6 +1055,12 @@ protected:
   bool                      m_piggybackCloveInfo;
   uint32_t                  m_ClovePath;
 
+  // Edge load balancer context, resolved by SetupPathSelector
+  Ptr<Ipv4TLB>              m_ipv4TLB;
+  Ptr<Ipv4Clove>            m_ipv4Clove;
+  Ipv4PathSelector         *m_pathSelector;         //!< The balancer choosing the paths, 0 if none
+  uint32_t                  m_pathFlowId;           //!< Flow id of the connection seen by the balancer
+
   // Pause Support
   bool                      m_isPauseEnabled;
   bool                      m_isPause;
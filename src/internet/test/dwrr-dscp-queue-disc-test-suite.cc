@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/tcn-queue-disc.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-packet-filter.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+
+/**
+ * This class tests the classification of the DSCP packet filter
+ */
+class Ipv4DscpPacketFilterTest : public TestCase
+{
+public:
+  Ipv4DscpPacketFilterTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4DscpPacketFilterTest::Ipv4DscpPacketFilterTest ()
+  : TestCase ("Test the DSCP to class map")
+{
+}
+
+static Ptr<Ipv4QueueDiscItem>
+CreateItemWithDscp (Ipv4Header::DscpType dscp, uint32_t size)
+{
+  Ipv4Header ipHeader;
+  ipHeader.SetPayloadSize (size);
+  ipHeader.SetDscp (dscp);
+  ipHeader.SetEcn (Ipv4Header::ECN_ECT0);
+  ipHeader.SetProtocol (6);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (size), dest, 0, ipHeader);
+}
+
+void
+Ipv4DscpPacketFilterTest::DoRun (void)
+{
+  Ptr<Ipv4DscpPacketFilter> filter = CreateObject<Ipv4DscpPacketFilter> ();
+  filter->SetAttribute ("DscpMap", StringValue ("46:0, 10:1 0:2"));
+
+  StringValue map;
+  filter->GetAttribute ("DscpMap", map);
+  NS_TEST_EXPECT_MSG_EQ (map.Get (), "0:2 10:1 46:0", "The map should be reported by DSCP");
+
+  NS_TEST_EXPECT_MSG_EQ (filter->Classify (CreateItemWithDscp (Ipv4Header::DSCP_EF, 100)), 0, "Wrong class for EF");
+  NS_TEST_EXPECT_MSG_EQ (filter->Classify (CreateItemWithDscp (Ipv4Header::DSCP_AF11, 100)), 1, "Wrong class for AF11");
+  NS_TEST_EXPECT_MSG_EQ (filter->Classify (CreateItemWithDscp (Ipv4Header::DscpDefault, 100)), 2, "Wrong class for the default DSCP");
+  NS_TEST_EXPECT_MSG_EQ (filter->Classify (CreateItemWithDscp (Ipv4Header::DSCP_CS1, 100)), PacketFilter::PF_NO_MATCH,
+                         "An unlisted DSCP should not match");
+
+  filter->SetAttribute ("DefaultClass", IntegerValue (3));
+  NS_TEST_EXPECT_MSG_EQ (filter->Classify (CreateItemWithDscp (Ipv4Header::DSCP_CS1, 100)), 3,
+                         "An unlisted DSCP should get the default class");
+}
+
+/**
+ * This class tests a hierarchy of strict priority and DWRR classes with a
+ * TCN queue disc each, built by the TrafficControlHelper
+ */
+class DWRRHelperHierarchyTest : public TestCase
+{
+public:
+  DWRRHelperHierarchyTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DWRRHelperHierarchyTest::DWRRHelperHierarchyTest ()
+  : TestCase ("Test a DWRR hierarchy installed by the helper")
+{
+}
+
+void
+DWRRHelperHierarchyTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<TrafficControlLayer> ());
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (device);
+
+  // Class 0 above classes 1 and 2, which share the rest 2:1
+  TrafficControlHelper tc;
+  uint16_t handle = tc.SetRootQueueDisc ("ns3::DWRRQueueDisc");
+  tc.AddPacketFilter (handle, "ns3::Ipv4DscpPacketFilter",
+                      "DscpMap", StringValue ("46:0 10:1"),
+                      "DefaultClass", IntegerValue (2));
+  TrafficControlHelper::ClassIdList classes = tc.AddQueueDiscClasses (handle, 1, "ns3::DWRRClass",
+                                                                      "Priority", UintegerValue (1));
+  TrafficControlHelper::ClassIdList weighted = tc.AddQueueDiscClasses (handle, 1, "ns3::DWRRClass",
+                                                                       "Quantum", UintegerValue (2000));
+  classes.push_back (weighted[0]);
+  weighted = tc.AddQueueDiscClasses (handle, 1, "ns3::DWRRClass",
+                                     "Quantum", UintegerValue (1000));
+  classes.push_back (weighted[0]);
+  tc.AddChildQueueDiscs (handle, classes, "ns3::TCNQueueDisc",
+                         "Mode", StringValue ("QUEUE_MODE_PACKETS"),
+                         "MaxPackets", UintegerValue (100));
+  QueueDiscContainer qdiscs = tc.Install (device);
+  NS_TEST_ASSERT_MSG_EQ (qdiscs.GetN (), 4, "The root and three children should be installed");
+
+  Ptr<QueueDisc> root = node->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (device);
+  NS_TEST_ASSERT_MSG_EQ ((DynamicCast<DWRRQueueDisc> (root) != 0), true, "The root should be a DWRR queue disc");
+  root->Initialize ();
+  NS_TEST_ASSERT_MSG_EQ (root->GetNQueueDiscClasses (), 3, "Three classes should be created");
+
+  // The IP header makes the items 1000 bytes long
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      root->Enqueue (CreateItemWithDscp (Ipv4Header::DSCP_AF11, 980));
+      root->Enqueue (CreateItemWithDscp (Ipv4Header::DSCP_CS1, 980));
+    }
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      root->Enqueue (CreateItemWithDscp (Ipv4Header::DSCP_EF, 980));
+    }
+  NS_TEST_ASSERT_MSG_EQ (root->GetNPackets (), 65, "Every packet should be queued");
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (root->Dequeue ());
+      NS_TEST_ASSERT_MSG_EQ (item->GetHeader ().GetDscp (), Ipv4Header::DSCP_EF, "The strict priority class should go first");
+    }
+
+  uint32_t nAf11 = 0;
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (root->Dequeue ());
+      if (item->GetHeader ().GetDscp () == Ipv4Header::DSCP_AF11)
+        {
+          nAf11++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (nAf11, 20, "The weighted classes should share 2:1");
+
+  Simulator::Destroy ();
+}
+
+static class DWRRDscpQueueDiscTestSuite : public TestSuite
+{
+public:
+  DWRRDscpQueueDiscTestSuite ()
+    : TestSuite ("dwrr-dscp-queue-disc", UNIT)
+  {
+    AddTestCase (new Ipv4DscpPacketFilterTest, TestCase::QUICK);
+    AddTestCase (new DWRRHelperHierarchyTest, TestCase::QUICK);
+  }
+} g_dwrrDscpQueueDiscTestSuite;
@@ -36,6 +36,16 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/enum.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-route-manager-impl.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/node-list.h"
+#include "ns3/simulation-singleton.h"
+#include <sstream>
 
 using namespace ns3;
 
@@ -419,6 +429,262 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class Ipv4GlobalRoutingPerFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingPerFlowEcmpTestCase ();
+  virtual ~Ipv4GlobalRoutingPerFlowEcmpTestCase ();
+
+private:
+  Ptr<Ipv4Route> Lookup (Ptr<Ipv4GlobalRouting> routing, uint32_t flowId);
+  void CheckFlows (Ptr<Ipv4GlobalRouting> routing, std::string mode);
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingPerFlowEcmpTestCase::Ipv4GlobalRoutingPerFlowEcmpTestCase ()
+  : TestCase ("Per flow ECMP hashing over precomputed next hop groups")
+{
+}
+
+Ipv4GlobalRoutingPerFlowEcmpTestCase::~Ipv4GlobalRoutingPerFlowEcmpTestCase ()
+{
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRoutingPerFlowEcmpTestCase::Lookup (Ptr<Ipv4GlobalRouting> routing, uint32_t flowId)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (FlowIdTag (flowId));
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address ("10.2.0.1"));
+  header.SetTtl (64);
+  Socket::SocketErrno sockerr;
+  return routing->RouteOutput (p, header, 0, sockerr);
+}
+
+void
+Ipv4GlobalRoutingPerFlowEcmpTestCase::CheckFlows (Ptr<Ipv4GlobalRouting> routing, std::string mode)
+{
+  routing->SetAttribute ("PerflowEcmpHash", StringValue (mode));
+
+  Ptr<NetDevice> first = Lookup (routing, 1)->GetOutputDevice ();
+  uint32_t onFirst = 0;
+  for (uint32_t flowId = 1; flowId <= 64; flowId++)
+    {
+      Ptr<Ipv4Route> route = Lookup (routing, flowId);
+      NS_TEST_EXPECT_MSG_EQ (route, Lookup (routing, flowId), mode << " hashing should consistently select the same next hop");
+      if (route->GetOutputDevice () == first)
+        {
+          onFirst++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (onFirst, 0, mode << " hashing should use the first next hop");
+  NS_TEST_EXPECT_MSG_LT (onFirst, 64, mode << " hashing should use the second next hop");
+}
+
+// Node A has two equal cost next hops towards 10.2.0.1, through B and C
+void
+Ipv4GlobalRoutingPerFlowEcmpTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (3);
+
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer dAdB = devHelper.Install (NodeContainer (c.Get (0), c.Get (1)));
+  NetDeviceContainer dAdC = devHelper.Install (NodeContainer (c.Get (0), c.Get (2)));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer iAiB = ipv4.Assign (dAdB);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.252");
+  Ipv4InterfaceContainer iAiC = ipv4.Assign (dAdC);
+
+  Ptr<Ipv4> ipv4A = c.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetAttribute ("PerflowEcmpRouting", BooleanValue (true));
+  routing->SetIpv4 (ipv4A);
+  routing->AddHostRouteTo (Ipv4Address ("10.2.0.1"), iAiB.GetAddress (1), ipv4A->GetInterfaceForDevice (dAdB.Get (0)));
+  routing->AddHostRouteTo (Ipv4Address ("10.2.0.1"), iAiC.GetAddress (1), ipv4A->GetInterfaceForDevice (dAdC.Get (0)));
+
+  CheckFlows (routing, "Integer");
+  CheckFlows (routing, "String");
+
+  // Removing a route must invalidate the next hop group of the destination
+  routing->RemoveRoute (1);
+  for (uint32_t flowId = 1; flowId <= 64; flowId++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Lookup (routing, flowId)->GetOutputDevice (), dAdB.Get (0),
+                             "Only the remaining next hop should be used");
+    }
+
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+  virtual ~Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  std::vector<std::string> GetRoutes (void) const;
+  std::vector<std::string> GetLegacyRoutes (void) const;
+  void CheckRoutes (std::string what);
+  void SetUp (Ptr<NetDevice> a, Ptr<NetDevice> b, bool up);
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Parallel and incremental global routes match the SPF of each router")
+{
+}
+
+Ipv4GlobalRoutingUpdateTestCase::~Ipv4GlobalRoutingUpdateTestCase ()
+{
+}
+
+// The routes of every router, in order
+std::vector<std::string>
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (void) const
+{
+  std::vector<std::string> routes;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = (*i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::ostringstream os;
+      for (uint32_t j = 0; j < gr->GetNRoutes (); j++)
+        {
+          os << *gr->GetRoute (j) << "\n";
+        }
+      routes.push_back (os.str ());
+    }
+  return routes;
+}
+
+// The routes of every router computed by the SPFVertex based calculation
+std::vector<std::string>
+Ipv4GlobalRoutingUpdateTestCase::GetLegacyRoutes (void) const
+{
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr->GetNumLSAs ())
+        {
+          SimulationSingleton<GlobalRouteManagerImpl>::Get ()->DebugSPFCalculate (rtr->GetRouterId ());
+        }
+    }
+  std::vector<std::string> routes = GetRoutes ();
+  // Leave routes computed on the graph for the next update
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckRoutes (std::string what)
+{
+  std::vector<std::string> routes = GetRoutes ();
+  std::vector<std::string> legacy = GetLegacyRoutes ();
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), legacy.size (), what);
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (routes[i], legacy[i], what << ": routes of node " << i << " differ");
+    }
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::SetUp (Ptr<NetDevice> a, Ptr<NetDevice> b, bool up)
+{
+  Ptr<NetDevice> devices[2] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Ipv4> ipv4 = devices[i]->GetNode ()->GetObject<Ipv4> ();
+      if (up)
+        {
+          ipv4->SetUp (ipv4->GetInterfaceForDevice (devices[i]));
+        }
+      else
+        {
+          ipv4->SetDown (ipv4->GetInterfaceForDevice (devices[i]));
+        }
+    }
+}
+
+// A k = 4 fat tree of point to point links
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (4));
+  NodeContainer core, agg, edge, hosts;
+  core.Create (4);
+  agg.Create (8);
+  edge.Create (8);
+  hosts.Create (16);
+
+  InternetStackHelper internet;
+  internet.Install (core);
+  internet.Install (agg);
+  internet.Install (edge);
+  internet.Install (hosts);
+
+  SimpleNetDeviceHelper p2p;
+  p2p.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  NetDeviceContainer hostLink, coreLink;
+  for (uint32_t pod = 0; pod < 4; pod++)
+    {
+      for (uint32_t a = 0; a < 2; a++)
+        {
+          for (uint32_t c = 0; c < 2; c++)
+            {
+              NetDeviceContainer d = p2p.Install (NodeContainer (agg.Get (2 * pod + a), core.Get (2 * a + c)));
+              ipv4.Assign (d);
+              ipv4.NewNetwork ();
+              coreLink = d;
+            }
+          for (uint32_t e = 0; e < 2; e++)
+            {
+              NetDeviceContainer d = p2p.Install (NodeContainer (agg.Get (2 * pod + a), edge.Get (2 * pod + e)));
+              ipv4.Assign (d);
+              ipv4.NewNetwork ();
+            }
+        }
+      for (uint32_t e = 0; e < 2; e++)
+        {
+          for (uint32_t h = 0; h < 2; h++)
+            {
+              NetDeviceContainer d = p2p.Install (NodeContainer (edge.Get (2 * pod + e), hosts.Get (4 * pod + 2 * e + h)));
+              ipv4.Assign (d);
+              ipv4.NewNetwork ();
+              hostLink = d;
+            }
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  CheckRoutes ("Initial routes");
+
+  SetUp (hostLink.Get (0), hostLink.Get (1), false);
+  uint32_t computed = SimulationSingleton<GlobalRouteManagerImpl>::Get ()->UpdateRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (computed, 5, "A failed host link should only affect its edge switch and neighbors");
+  CheckRoutes ("Routes after a host link failure");
+
+  SetUp (coreLink.Get (0), coreLink.Get (1), false);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->UpdateRoutes ();
+  CheckRoutes ("Routes after a core link failure");
+
+  SetUp (hostLink.Get (0), hostLink.Get (1), true);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->UpdateRoutes ();
+  CheckRoutes ("Routes after a host link repair");
+
+  Simulator::Destroy ();
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (0));
+}
 
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
@@ -431,6 +697,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingPerFlowEcmpTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv6-queue-disc-item.h"
+#include "ns3/tcn-queue-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+
+/**
+ * This class tests the ECN marking of the IPv4 and IPv6 queue disc items
+ */
+class QueueDiscItemMarkTest : public TestCase
+{
+public:
+  QueueDiscItemMarkTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QueueDiscItemMarkTest::QueueDiscItemMarkTest ()
+  : TestCase ("Test the ECN marking of the IPv4 and IPv6 items")
+{
+}
+
+static Ptr<Ipv4QueueDiscItem>
+CreateIpv4Item (Ipv4Header::EcnType ecn)
+{
+  Ipv4Header ipHeader;
+  ipHeader.SetPayloadSize (100);
+  ipHeader.SetDscp (Ipv4Header::DSCP_AF11);
+  ipHeader.SetEcn (ecn);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (100), dest, 0, ipHeader);
+}
+
+static Ptr<Ipv6QueueDiscItem>
+CreateIpv6Item (uint8_t trafficClass)
+{
+  Ipv6Header ipHeader;
+  ipHeader.SetPayloadLength (100);
+  ipHeader.SetTrafficClass (trafficClass);
+  Address dest;
+  return Create<Ipv6QueueDiscItem> (Create<Packet> (100), dest, 0, ipHeader);
+}
+
+void
+QueueDiscItemMarkTest::DoRun (void)
+{
+  Ptr<Ipv4QueueDiscItem> item = CreateIpv4Item (Ipv4Header::ECN_NotECT);
+  NS_TEST_EXPECT_MSG_EQ (item->Mark (), false, "A packet not ECN capable should not be marked");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetEcn (), Ipv4Header::ECN_NotECT, "The ECN field should be untouched");
+
+  item = CreateIpv4Item (Ipv4Header::ECN_ECT0);
+  NS_TEST_EXPECT_MSG_EQ (item->Mark (), true, "An ECT(0) packet should be marked");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetEcn (), Ipv4Header::ECN_CE, "The ECN field should be CE");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetDscp (), Ipv4Header::DSCP_AF11, "The DSCP should be untouched");
+
+  item = CreateIpv4Item (Ipv4Header::ECN_ECT1);
+  NS_TEST_EXPECT_MSG_EQ (item->Mark (), true, "An ECT(1) packet should be marked");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetEcn (), Ipv4Header::ECN_CE, "The ECN field should be CE");
+  NS_TEST_EXPECT_MSG_EQ (item->Mark (), false, "A packet already marked should not be marked again");
+
+  item = CreateIpv4Item (Ipv4Header::ECN_ECT1);
+  item->AddHeader ();
+  NS_TEST_EXPECT_MSG_EQ (item->Mark (), false, "A packet whose header is added should not be marked");
+
+  Ptr<Ipv6QueueDiscItem> item6 = CreateIpv6Item (0xa0);
+  NS_TEST_EXPECT_MSG_EQ (item6->Mark (), false, "An IPv6 packet not ECN capable should not be marked");
+  item6 = CreateIpv6Item (0xa2);
+  NS_TEST_EXPECT_MSG_EQ (item6->Mark (), true, "An IPv6 ECT(0) packet should be marked");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) item6->GetHeader ().GetTrafficClass (), 0xa3, "The ECN field should be CE");
+}
+
+/**
+ * This class tests that an AQM marks through the item
+ */
+class TcnQueueDiscMarkTest : public TestCase
+{
+public:
+  TcnQueueDiscMarkTest ();
+
+private:
+  virtual void DoRun (void);
+  void Dequeue (Ptr<TCNQueueDisc> queue, Ipv4Header::EcnType expected);
+};
+
+TcnQueueDiscMarkTest::TcnQueueDiscMarkTest ()
+  : TestCase ("Test the marking of the TCN queue disc")
+{
+}
+
+void
+TcnQueueDiscMarkTest::Dequeue (Ptr<TCNQueueDisc> queue, Ipv4Header::EcnType expected)
+{
+  Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+  NS_TEST_ASSERT_MSG_NE (item, 0, "There should be a packet to dequeue");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetEcn (), expected, "Unexpected ECN field after the dequeue");
+}
+
+void
+TcnQueueDiscMarkTest::DoRun (void)
+{
+  Ptr<TCNQueueDisc> queue = CreateObject<TCNQueueDisc> ();
+  queue->SetAttribute ("Mode", StringValue ("QUEUE_MODE_PACKETS"));
+  queue->SetAttribute ("MaxPackets", UintegerValue (10));
+  queue->SetAttribute ("Threshold", StringValue ("1ms"));
+  queue->Initialize ();
+
+  queue->Enqueue (CreateIpv4Item (Ipv4Header::ECN_ECT1));
+  queue->Enqueue (CreateIpv4Item (Ipv4Header::ECN_ECT1));
+  queue->Enqueue (CreateIpv4Item (Ipv4Header::ECN_NotECT));
+  Simulator::Schedule (MicroSeconds (500), &TcnQueueDiscMarkTest::Dequeue, this, queue, Ipv4Header::ECN_ECT1);
+  Simulator::Schedule (MilliSeconds (2), &TcnQueueDiscMarkTest::Dequeue, this, queue, Ipv4Header::ECN_CE);
+  Simulator::Schedule (MilliSeconds (3), &TcnQueueDiscMarkTest::Dequeue, this, queue, Ipv4Header::ECN_NotECT);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+static class QueueDiscItemMarkTestSuite : public TestSuite
+{
+public:
+  QueueDiscItemMarkTestSuite ()
+    : TestSuite ("queue-disc-item-mark", UNIT)
+  {
+    AddTestCase (new QueueDiscItemMarkTest, TestCase::QUICK);
+    AddTestCase (new TcnQueueDiscMarkTest, TestCase::QUICK);
+  }
+} g_queueDiscItemMarkTestSuite;
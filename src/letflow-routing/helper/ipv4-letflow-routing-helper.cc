@@ -55,5 +55,19 @@ Ipv4LetFlowRoutingHelper::GetLetFlowRouting (Ptr<Ipv4> ipv4) const
   return 0;
 }
 
+int64_t
+Ipv4LetFlowRoutingHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+  {
+    Ptr<Ipv4LetFlowRouting> routing = GetLetFlowRouting ((*i)->GetObject<Ipv4> ());
+    if (routing != 0)
+    {
+      currentStream += routing->AssignStreams (currentStream);
+    }
+  }
+  return (currentStream - stream);
 }
 
+}
@@ -4,6 +4,7 @@
 
 #include "ns3/ipv4-letflow-routing.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
@@ -18,6 +19,18 @@ public:
     virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
     Ptr<Ipv4LetFlowRouting> GetLetFlowRouting (Ptr<Ipv4> ipv4) const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by the Ipv4LetFlowRouting of the nodes. Return the number of streams
+     * that have been assigned. The routing protocols should have previously
+     * been installed.
+     *
+     * \param c NodeContainer of the set of nodes whose routing protocol should use a fixed stream
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams (NodeContainer c, int64_t stream);
 };
 
 }
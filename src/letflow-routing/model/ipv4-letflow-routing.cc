@@ -8,6 +8,7 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
 
@@ -18,10 +19,11 @@ NS_LOG_COMPONENT_DEFINE("Ipv4LetFlowRouting");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4LetFlowRouting);
 
 Ipv4LetFlowRouting::Ipv4LetFlowRouting ():
-    m_flowletTimeout (MicroSeconds(50)), // The default value of flowlet timeout is small for experimental purpose
     m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
+  m_flowletTable.SetTimeout (MicroSeconds (50)); // The default value of flowlet timeout is small for experimental purpose
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4LetFlowRouting::~Ipv4LetFlowRouting ()
@@ -36,11 +38,24 @@ Ipv4LetFlowRouting::GetTypeId (void)
       .SetParent<Object>()
       .SetGroupName ("Internet")
       .AddConstructor<Ipv4LetFlowRouting> ()
+      .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                     UintegerValue (65536),
+                     MakeUintegerAccessor (&Ipv4LetFlowRouting::SetFlowletTableSize,
+                                           &Ipv4LetFlowRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (1))
   ;
 
   return tid;
 }
 
+int64_t
+Ipv4LetFlowRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4LetFlowRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
 {
@@ -50,6 +65,7 @@ Ipv4LetFlowRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_
   letFlowRouteEntry.networkMask = networkMask;
   letFlowRouteEntry.port = port;
   m_routeEntryList.push_back (letFlowRouteEntry);
+  m_portGroups.clear ();
 }
 
 std::vector<LetFlowRouteEntry>
@@ -67,9 +83,39 @@ Ipv4LetFlowRouting::LookupLetFlowRouteEntries (Ipv4Address dest)
   return letFlowRouteEntries;
 }
 
+const std::vector<uint32_t> &
+Ipv4LetFlowRouting::LookupPortGroup (Ipv4Address dest)
+{
+  std::map<Ipv4Address, std::vector<uint32_t> >::iterator groupItr = m_portGroups.find (dest);
+  if (groupItr != m_portGroups.end ())
+  {
+    return groupItr->second;
+  }
+
+  // First packet towards this destination, compile the ports of all the matching routes
+  std::vector<uint32_t> &ports = m_portGroups[dest];
+  std::vector<LetFlowRouteEntry>::iterator itr = m_routeEntryList.begin ();
+  for ( ; itr != m_routeEntryList.end (); ++itr)
+  {
+    if((*itr).networkMask.IsMatch(dest, (*itr).network))
+    {
+      ports.push_back ((*itr).port);
+    }
+  }
+  return ports;
+}
+
 Ptr<Ipv4Route>
 Ipv4LetFlowRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
+  // Routes are never modified once built, reuse the one of this port and destination
+  std::pair<uint32_t, Ipv4Address> key = std::make_pair (port, destAddress);
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> >::iterator routeItr = m_routeCache.find (key);
+  if (routeItr != m_routeCache.end ())
+  {
+    return routeItr->second;
+  }
+
   Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
   Ptr<Channel> channel = dev->GetChannel ();
   uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
@@ -81,13 +127,32 @@ Ipv4LetFlowRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
   route->SetGateway (nextHopAddr);
   route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
   route->SetDestination (destAddress);
+  m_routeCache[key] = route;
   return route;
 }
 
 void
 Ipv4LetFlowRouting::SetFlowletTimeout (Time timeout)
 {
-  m_flowletTimeout = timeout;
+  m_flowletTable.SetTimeout (timeout);
+}
+
+void
+Ipv4LetFlowRouting::SetFlowletTableSize (uint32_t size)
+{
+  m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4LetFlowRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+uint64_t
+Ipv4LetFlowRouting::GetFlowletTableCollisions (void) const
+{
+  return m_flowletTable.GetCollisions ();
 }
 
 Ptr<Ipv4Route>
@@ -125,9 +190,6 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
     return false;
   }
 
-  // Packet arrival time
-  Time now = Simulator::Now ();
-
   // Extract the flow id
   uint32_t flowId = 0;
   FlowIdTag flowIdTag;
@@ -140,9 +202,9 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<LetFlowRouteEntry> routeEntries = Ipv4LetFlowRouting::LookupLetFlowRouteEntries (destAddress);
+  const std::vector<uint32_t> &ports = Ipv4LetFlowRouting::LookupPortGroup (destAddress);
 
-  if (routeEntries.empty ())
+  if (ports.empty ())
   {
     NS_LOG_ERROR (this << " LetFlow routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -152,61 +214,54 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   uint32_t selectedPort;
 
   // If the flowlet table entry is valid, return the port
-  std::map<uint32_t, struct LetFlowFlowlet>::iterator flowletItr = m_flowletTable.find (flowId);
-  if (flowletItr != m_flowletTable.end ())
+  FlowletTable::Entry &flowlet = m_flowletTable.Lookup (flowId);
+  if (m_flowletTable.IsActive (flowlet))
   {
-    LetFlowFlowlet flowlet = flowletItr->second;
-    if (now - flowlet.activeTime <= m_flowletTimeout)
-    {
-      // Do not forget to update the flowlet active time
-      flowlet.activeTime = now;
+    // Return the port information used for routing routine to select the port
+    selectedPort = flowlet.path;
 
-      // Return the port information used for routing routine to select the port
-      selectedPort = flowlet.port;
+    // Do not forget to update the flowlet active time
+    m_flowletTable.Update (flowlet, flowId, selectedPort);
 
-      Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
+    Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
+    ucb (route, packet, header);
 
-      m_flowletTable[flowId] = flowlet;
-
-      return true;
-    }
+    return true;
   }
 
   // Not hit. Random Select the Port
-  selectedPort = routeEntries[rand () % routeEntries.size ()].port;
+  selectedPort = ports[m_rand->GetInteger (0, ports.size () - 1)];
 
-  LetFlowFlowlet flowlet;
-
-  flowlet.port = selectedPort;
-  flowlet.activeTime = now;
+  m_flowletTable.Update (flowlet, flowId, selectedPort);
 
   Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
   ucb (route, packet, header);
 
-  m_flowletTable[flowId] = flowlet;
-
   return true;
 }
 
 void
 Ipv4LetFlowRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4LetFlowRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4LetFlowRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
 Ipv4LetFlowRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_routeCache.clear ();
 }
 
 void
@@ -226,6 +281,7 @@ Ipv4LetFlowRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4LetFlowRouting::DoDispose (void)
 {
+  m_routeCache.clear ();
   m_ipv4=0;
   Ipv4RoutingProtocol::DoDispose ();
 }
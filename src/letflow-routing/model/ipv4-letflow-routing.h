@@ -10,13 +10,13 @@
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
-namespace ns3 {
+#include <map>
+#include <vector>
 
-struct LetFlowFlowlet {
-  uint32_t port;
-  Time activeTime;
-};
+namespace ns3 {
 
 struct LetFlowRouteEntry {
   Ipv4Address network;
@@ -49,22 +49,45 @@ public:
   virtual void DoDispose (void);
 
   std::vector<LetFlowRouteEntry> LookupLetFlowRouteEntries (Ipv4Address dest);
+
+  // The ports of all the routes matching the destination, compiled on the first lookup
+  const std::vector<uint32_t> & LookupPortGroup (Ipv4Address dest);
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
   void SetFlowletTimeout (Time timeout);
 
-private:
-  // Flowlet Timeout
-  Time m_flowletTimeout;
+  void SetFlowletTableSize (uint32_t size);
+  uint32_t GetFlowletTableSize (void) const;
 
+  uint64_t GetFlowletTableCollisions (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model. Return the number of streams that have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
 
-  // Flowlet Table
-  std::map<uint32_t, LetFlowFlowlet> m_flowletTable;
+  // Flowlet Table, also holds the flowlet timeout
+  FlowletTable m_flowletTable;
+
+  // Picks the port of a new flowlet
+  Ptr<UniformRandomVariable> m_rand;
 
   // Route table
   std::vector<LetFlowRouteEntry> m_routeEntryList;
+
+  // (port, destination) to route cache, flushed whenever an interface or address changes
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> > m_routeCache;
+
+  // Destination to port group cache, flushed whenever a route is added
+  std::map<Ipv4Address, std::vector<uint32_t> > m_portGroups;
 };
 
 }
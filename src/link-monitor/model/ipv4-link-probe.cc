@@ -6,6 +6,7 @@
 #include "ns3/config.h"
 #include "ns3/simulator.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/traffic-control-layer.h"
 
 #include "link-monitor.h"
 
@@ -27,7 +28,8 @@ Ipv4LinkProbe::GetTypeId (void)
 
 Ipv4LinkProbe::Ipv4LinkProbe (Ptr<Node> node, Ptr<LinkMonitor> linkMonitor)
     :LinkProbe (linkMonitor),
-     m_checkTime (MicroSeconds (100))
+     m_checkTime (MicroSeconds (100)),
+     m_resetQueueDiscOccupancy (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -40,8 +42,8 @@ Ipv4LinkProbe::Ipv4LinkProbe (Ptr<Node> node, Ptr<LinkMonitor> linkMonitor)
     m_accumulatedDequeueBytes[interface] = 0;
     m_NPacketsInQueue[interface] = 0;
     m_NBytesInQueue[interface] = 0;
-    m_NPacketsInQueueDisc[interface] = 0;
-    m_NBytesInQueueDisc[interface] = 0;
+    m_lastOccupancyIntegral[interface] = 0;
+    m_lastOccupancyCheck[interface] = Time (0);
 
     m_queueProbe[interface] = Create<Ipv4QueueProbe> ();
     m_queueProbe[interface]->SetInterfaceId (interface);
@@ -62,15 +64,8 @@ Ipv4LinkProbe::Ipv4LinkProbe (Ptr<Node> node, Ptr<LinkMonitor> linkMonitor)
     Config::ConnectWithoutContext (oss3.str (),
             MakeCallback (&Ipv4QueueProbe::BytesInQueueLogger, m_queueProbe[interface]));
 
-    std::ostringstream oss4;
-    oss4 << "/NodeList/" << node->GetId () << "/$ns3::TrafficControlLayer/RootQueueDiscList/" << interface << "/PacketsInQueue";
-    Config::ConnectWithoutContext (oss4.str (),
-            MakeCallback (&Ipv4QueueProbe::PacketsInQueueDiscLogger, m_queueProbe[interface]));
-
-    std::ostringstream oss5;
-    oss5 << "/NodeList/" << node->GetId () << "/$ns3::TrafficControlLayer/RootQueueDiscList/" << interface << "/BytesInQueue";
-    Config::ConnectWithoutContext (oss5.str (),
-            MakeCallback (&Ipv4QueueProbe::BytesInQueueDiscLogger, m_queueProbe[interface]));
+    // The queue disc occupancy is read from the root queue disc at every check,
+    // see CheckCurrentStatus
 
   }
 
@@ -121,17 +116,43 @@ Ipv4LinkProbe::BytesInQueueLogger (uint32_t NBytes, uint32_t interface)
 }
 
 void
-Ipv4LinkProbe::PacketsInQueueDiscLogger (uint32_t NPackets, uint32_t interface)
+Ipv4LinkProbe::CheckQueueDisc (uint32_t interface, struct LinkProbe::LinkStats &stats)
 {
-  NS_LOG_LOGIC ("Packets in queue are now: " << NPackets);
-  m_NPacketsInQueueDisc[interface] = NPackets;
-}
+  Ptr<TrafficControlLayer> tc = m_ipv4->GetObject<TrafficControlLayer> ();
+  Ptr<QueueDisc> qdisc = tc != 0 ? tc->GetRootQueueDiscOnDevice (m_ipv4->GetNetDevice (interface)) : 0;
+  if (qdisc == 0)
+  {
+    stats.packetsInQueueDisc = 0;
+    stats.bytesInQueueDisc = 0;
+    stats.averageBytesInQueueDisc = 0;
+    stats.peakBytesInQueueDisc = 0;
+    return;
+  }
 
-void
-Ipv4LinkProbe::BytesInQueueDiscLogger (uint32_t NBytes, uint32_t interface)
-{
-  NS_LOG_LOGIC ("Bytes in queue are now: " << NBytes);
-  m_NBytesInQueueDisc[interface] = NBytes;
+  stats.packetsInQueueDisc = qdisc->GetNPackets ();
+  stats.bytesInQueueDisc = qdisc->GetNBytes ();
+  stats.peakBytesInQueueDisc = qdisc->GetPeakOccupancy ();
+
+  // The average covers the check interval, from the integral at the last
+  // check, or at the start of the window if it was reset since
+  Time now = Simulator::Now ();
+  Time last = m_lastOccupancyCheck[interface];
+  double lastIntegral = m_lastOccupancyIntegral[interface];
+  if (qdisc->GetOccupancyWindowStart () > last)
+  {
+    last = qdisc->GetOccupancyWindowStart ();
+    lastIntegral = 0;
+  }
+  double integral = qdisc->GetOccupancyIntegral ();
+  int64_t interval = (now - last).GetTimeStep ();
+  stats.averageBytesInQueueDisc = interval > 0 ? (integral - lastIntegral) / interval : stats.bytesInQueueDisc;
+  if (m_resetQueueDiscOccupancy)
+  {
+    qdisc->ResetOccupancyStats ();
+    integral = 0;
+  }
+  m_lastOccupancyIntegral[interface] = integral;
+  m_lastOccupancyCheck[interface] = now;
 }
 
 void
@@ -155,8 +176,7 @@ Ipv4LinkProbe::CheckCurrentStatus ()
           Ipv4LinkProbe::GetLinkUtility (interface, m_accumulatedDequeueBytes[interface] - lastDequeueBytes, m_checkTime);
       newStats.packetsInQueue = m_NPacketsInQueue[interface];
       newStats.bytesInQueue = m_NBytesInQueue[interface];
-      newStats.packetsInQueueDisc = m_NPacketsInQueueDisc[interface];
-      newStats.bytesInQueueDisc = m_NBytesInQueueDisc[interface];
+      CheckQueueDisc (interface, newStats);
       std::vector<struct LinkProbe::LinkStats> newVector;
       newVector.push_back (newStats);
       m_stats[interface] = newVector;
@@ -175,8 +195,7 @@ Ipv4LinkProbe::CheckCurrentStatus ()
           Ipv4LinkProbe::GetLinkUtility (interface, m_accumulatedDequeueBytes[interface] - lastDequeueBytes, m_checkTime);
       newStats.packetsInQueue = m_NPacketsInQueue[interface];
       newStats.bytesInQueue = m_NBytesInQueue[interface];
-      newStats.packetsInQueueDisc = m_NPacketsInQueueDisc[interface];
-      newStats.bytesInQueueDisc = m_NPacketsInQueueDisc[interface];
+      CheckQueueDisc (interface, newStats);
       (itr->second).push_back (newStats);
     }
   }
@@ -215,4 +234,10 @@ Ipv4LinkProbe::SetCheckTime (Time checkTime)
   m_checkTime = checkTime;
 }
 
+void
+Ipv4LinkProbe::SetResetQueueDiscOccupancy (bool reset)
+{
+  m_resetQueueDiscOccupancy = reset;
+}
+
 }
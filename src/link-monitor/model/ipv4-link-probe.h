@@ -26,6 +26,10 @@ public:
 
   void SetCheckTime (Time checkTime);
 
+  // Whether to start a new occupancy measurement window of the root queue
+  // discs at every check, so that their peak covers the check interval
+  void SetResetQueueDiscOccupancy (bool reset);
+
   void TxLogger (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
 
   void DequeueLogger (Ptr<const Packet> packet, uint32_t interface);
@@ -34,10 +38,6 @@ public:
 
   void BytesInQueueLogger (uint32_t NBytes, uint32_t interface);
 
-  void PacketsInQueueDiscLogger (uint32_t NPackets, uint32_t interface);
-
-  void BytesInQueueDiscLogger (uint32_t NBytes, uint32_t interface);
-
   void CheckCurrentStatus ();
 
   void Start ();
@@ -47,6 +47,8 @@ private:
 
   double GetLinkUtility (uint32_t interface, uint64_t bytes, Time time);
 
+  void CheckQueueDisc (uint32_t interface, struct LinkProbe::LinkStats &stats);
+
   Time m_checkTime;
 
   EventId m_checkEvent;
@@ -59,8 +61,11 @@ private:
   std::map<uint32_t, uint32_t> m_NPacketsInQueue;
   std::map<uint32_t, uint32_t> m_NBytesInQueue;
 
-  std::map<uint32_t, uint32_t> m_NPacketsInQueueDisc;
-  std::map<uint32_t, uint32_t> m_NBytesInQueueDisc;
+  bool m_resetQueueDiscOccupancy;
+
+  // The occupancy integral of the root queue disc and the time of the last check
+  std::map<uint32_t, double> m_lastOccupancyIntegral;
+  std::map<uint32_t, Time> m_lastOccupancyCheck;
 
   std::map<uint32_t, DataRate> m_dataRate;
 
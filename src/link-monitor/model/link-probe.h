@@ -41,6 +41,13 @@ public:
     uint32_t    packetsInQueueDisc;
 
     uint32_t    bytesInQueueDisc;
+
+    // The time-weighted average bytes in the queue disc since the last check
+    double      averageBytesInQueueDisc;
+
+    // The peak bytes in the queue disc in its occupancy measurement window,
+    // which starts at the last check if the probe resets it
+    uint32_t    peakBytesInQueueDisc;
   };
 
   static TypeId GetTypeId (void);
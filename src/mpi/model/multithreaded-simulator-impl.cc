@@ -0,0 +1,846 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/multithreading.h"
+#include "ns3/system-thread.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <sched.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** The timestamp of the partitions without event. */
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * Find the group of a node, halving the paths on the way.
+ * \param [in,out] parent The parent of each node in its group.
+ * \param [in] node The node id.
+ * \return The node id representing the group.
+ */
+uint32_t
+FindGroup (std::vector<uint32_t> &parent, uint32_t node)
+{
+  while (parent[node] != node)
+    {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+  return node;
+}
+
+/**
+ * \param [in] device A device.
+ * \param [in] channel The channel of the device.
+ * \param [out] delay The delay of the channel.
+ * \return true if the two ends of the channel can be run by different threads.
+ */
+bool
+IsSplittable (Ptr<NetDevice> device, Ptr<Channel> channel, TimeValue &delay)
+{
+  BooleanValue deepCopy;
+  return device->IsPointToPoint ()
+         && channel->GetNDevices () == 2
+         && channel->GetAttributeFailSafe ("Delay", delay)
+         && channel->GetAttributeFailSafe ("DeepCopy", deepCopy)
+         && delay.Get ().IsStrictlyPositive ();
+}
+
+/**
+ * Spin, then yield the processor, while waiting for the other threads.
+ * \param [in,out] spins The number of times the caller waited so far.
+ */
+void
+Pause (uint32_t &spins)
+{
+  if (++spins > 1000)
+    {
+      sched_yield ();
+    }
+}
+
+} // unnamed namespace
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::t_partition = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The maximum number of threads running the nodes, "
+                   "0 for the number of processors",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::Partition::Partition ()
+  : index (0),
+    currentTs (0),
+    currentUid (0),
+    currentContext (0xffffffff),
+    // uids are allocated from 4.
+    // uid 0 is "invalid" events
+    // uid 1 is "now" events
+    // uid 2 is "destroy" events
+    uid (4),
+    uidStride (1),
+    unscheduledEvents (0),
+    minPostedTs (NO_EVENT),
+    nextTs (NO_EVENT)
+{
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_threadCount (0),
+    m_nPartitions (0),
+    m_lookahead (GetMaximumSimulationTime ()),
+    m_running (false),
+    m_inWindow (false),
+    m_parity (0),
+    m_windowEnd (NO_EVENT),
+    m_stop (false),
+    m_done (false),
+    m_generation (0),
+    m_arrived (0),
+    m_nextWorker (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the partition running the events without node, and all the events
+  // outside of Run
+  m_partitions.push_back (new Partition ());
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      delete *i;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      while (!(*i)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*i)->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      (*i)->events = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "The scheduler cannot be changed during a run");
+  m_schedulerFactory = schedulerFactory;
+  Partition *global = m_partitions.back ();
+  Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+  if (global->events != 0)
+    {
+      while (!global->events->IsEmpty ())
+        {
+          scheduler->Insert (global->events->RemoveNext ());
+        }
+    }
+  global->events = scheduler;
+}
+
+// All the partitions belong to the same process
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (void) const
+{
+  return t_partition != 0 ? t_partition : m_partitions.back ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionIndex (uint32_t context) const
+{
+  // outside of Run there is no node partition
+  return context < m_nodePartition.size () ? m_nodePartition[context] : m_partitions.size () - 1;
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid += partition->uidStride;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  partition->nextTs = std::min (partition->nextTs, ts);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+
+  // group the nodes which cannot be run by different threads
+  std::vector<uint32_t> parent (nNodes);
+  std::vector<uint32_t> groupSize (nNodes, 0);
+  std::vector<uint32_t> groupPartition (nNodes, 0xffffffff);
+  bool bySystemId = false;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      parent[i] = i;
+    }
+  for (NodeList::Iterator n = NodeList::Begin (); n != NodeList::End (); n++)
+    {
+      bySystemId |= (*n)->GetSystemId () != 0;
+      for (uint32_t i = 0; i < (*n)->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> device = (*n)->GetDevice (i);
+          Ptr<Channel> channel = device->GetChannel ();
+          TimeValue delay;
+          if (channel == 0 || IsSplittable (device, channel, delay))
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              uint32_t a = FindGroup (parent, (*n)->GetId ());
+              uint32_t b = FindGroup (parent, channel->GetDevice (j)->GetNode ()->GetId ());
+              parent[std::max (a, b)] = std::min (a, b);
+            }
+        }
+    }
+  uint32_t nGroups = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      nGroups += FindGroup (parent, i) == i ? 1 : 0;
+      groupSize[FindGroup (parent, i)]++;
+    }
+
+  // assign the groups to the partitions, in the order of their first node
+  uint32_t threadCount = m_threadCount != 0 ? m_threadCount : sysconf (_SC_NPROCESSORS_ONLN);
+  uint32_t nPartitions = std::max<uint32_t> (1, std::min (threadCount, nGroups));
+  std::vector<uint32_t> systemIds;
+  uint32_t assigned = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t group = FindGroup (parent, i);
+      if (groupPartition[group] != 0xffffffff)
+        {
+          continue;
+        }
+      if (bySystemId)
+        {
+          uint32_t systemId = NodeList::GetNode (i)->GetSystemId ();
+          std::vector<uint32_t>::iterator it = std::find (systemIds.begin (), systemIds.end (), systemId);
+          groupPartition[group] = (it - systemIds.begin ()) % nPartitions;
+          if (it == systemIds.end ())
+            {
+              systemIds.push_back (systemId);
+            }
+        }
+      else
+        {
+          groupPartition[group] = static_cast<uint64_t> (assigned) * nPartitions / nNodes;
+          assigned += groupSize[group];
+        }
+    }
+
+  // number the partitions which got nodes
+  std::vector<uint32_t> number (nPartitions, 0xffffffff);
+  m_nPartitions = 0;
+  m_nodePartition.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t &partition = number[groupPartition[FindGroup (parent, i)]];
+      if (partition == 0xffffffff)
+        {
+          partition = m_nPartitions++;
+        }
+      m_nodePartition[i] = partition;
+    }
+  m_nPartitions = std::max<uint32_t> (1, m_nPartitions);
+
+  // the point-to-point channels between two partitions set the lookahead
+  m_lookahead = GetMaximumSimulationTime ();
+  for (NodeList::Iterator n = NodeList::Begin (); n != NodeList::End (); n++)
+    {
+      for (uint32_t i = 0; i < (*n)->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> device = (*n)->GetDevice (i);
+          Ptr<Channel> channel = device->GetChannel ();
+          TimeValue delay;
+          if (channel == 0 || !IsSplittable (device, channel, delay))
+            {
+              continue;
+            }
+          bool split = m_nodePartition[channel->GetDevice (0)->GetNode ()->GetId ()]
+            != m_nodePartition[channel->GetDevice (1)->GetNode ()->GetId ()];
+          if (split)
+            {
+              m_lookahead = std::min (m_lookahead, delay.Get ());
+            }
+          // the packets cannot share their data with the ones of the sender
+          channel->SetAttribute ("DeepCopy", BooleanValue (split));
+        }
+    }
+  NS_LOG_INFO (m_nPartitions << " partitions of " << nNodes << " nodes, lookahead " << m_lookahead);
+
+  // interleave the event uids of the partitions, so that they stay unique
+  Partition *global = m_partitions.back ();
+  for (uint32_t i = 0; i < m_nPartitions; i++)
+    {
+      Partition *partition = new Partition ();
+      partition->index = i;
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      partition->currentTs = global->currentTs;
+      partition->currentUid = global->currentUid;
+      partition->uid = global->uid + i;
+      partition->uidStride = m_nPartitions + 1;
+      partition->counters = i < m_counters.size () ? m_counters[i] : Multithreading::Counters (i);
+      m_partitions.insert (m_partitions.end () - 1, partition);
+    }
+  global->index = m_nPartitions;
+  global->uid += m_nPartitions;
+  global->uidStride = m_nPartitions + 1;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      for (uint32_t parity = 0; parity < 2; parity++)
+        {
+          (*i)->mailbox[parity].resize (m_nPartitions + 1);
+        }
+      (*i)->minPostedTs = NO_EVENT;
+      (*i)->nextTs = NO_EVENT;
+    }
+
+  // the events keep their key in their partition
+  std::vector<Scheduler::Event> events;
+  while (!global->events->IsEmpty ())
+    {
+      events.push_back (global->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::iterator i = events.begin (); i != events.end (); i++)
+    {
+      Partition *partition = m_partitions[GetPartitionIndex (i->key.m_context)];
+      partition->events->Insert (*i);
+      partition->nextTs = std::min (partition->nextTs, i->key.m_ts);
+      partition->currentTs = std::min (partition->currentTs, i->key.m_ts);
+      if (partition != global)
+        {
+          partition->unscheduledEvents++;
+          global->unscheduledEvents--;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MergePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *global = m_partitions.back ();
+  for (uint32_t i = 0; i < m_nPartitions; i++)
+    {
+      Partition *partition = m_partitions[i];
+      while (!partition->events->IsEmpty ())
+        {
+          global->events->Insert (partition->events->RemoveNext ());
+        }
+      if (partition->currentTs > global->currentTs)
+        {
+          global->currentTs = partition->currentTs;
+          global->currentUid = partition->currentUid;
+        }
+      global->uid = std::max (global->uid, partition->uid);
+      global->unscheduledEvents += partition->unscheduledEvents;
+      // the next runs carry on with the uids and streams of the partition
+      if (i >= m_counters.size ())
+        {
+          m_counters.push_back (partition->counters);
+        }
+      m_counters[i] = partition->counters;
+      delete partition;
+    }
+  m_partitions.erase (m_partitions.begin (), m_partitions.end () - 1);
+  m_nodePartition.clear ();
+  global->index = 0;
+  global->uidStride = 1;
+  global->currentContext = 0xffffffff;
+  global->mailbox[0].clear ();
+  global->mailbox[1].clear ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+MultithreadedSimulatorImpl::ComparePosted (const PostedEvent &a, const PostedEvent &b)
+{
+  return a.ts < b.ts || (a.ts == b.ts && a.creationTs < b.creationTs);
+}
+
+void
+MultithreadedSimulatorImpl::ReceivePosted (Partition *partition, uint32_t parity)
+{
+  std::vector<PostedEvent> &received = partition->received;
+  for (uint32_t i = 0; i < m_nPartitions; i++)
+    {
+      std::vector<PostedEvent> &posted = m_partitions[i]->mailbox[parity][partition->index];
+      received.insert (received.end (), posted.begin (), posted.end ());
+      posted.clear ();
+    }
+  // the sending partitions are in order, so that the order does not depend
+  // on the threads
+  std::stable_sort (received.begin (), received.end (), ComparePosted);
+  for (std::vector<PostedEvent>::iterator i = received.begin (); i != received.end (); i++)
+    {
+      Insert (partition, i->ts, i->context, i->event);
+    }
+  received.clear ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (Partition *partition)
+{
+  ReceivePosted (partition, 1 - m_parity);
+  partition->minPostedTs = NO_EVENT;
+  while (!partition->events->IsEmpty ()
+         && partition->events->PeekNext ().key.m_ts < m_windowEnd)
+    {
+      ProcessOneEvent (partition);
+    }
+  partition->nextTs = partition->events->IsEmpty () ? NO_EVENT : partition->events->PeekNext ().key.m_ts;
+}
+
+bool
+MultithreadedSimulatorImpl::ProcessGlobalEvents (void)
+{
+  Partition *global = m_partitions.back ();
+  ReceivePosted (global, m_parity);
+  m_parity = 1 - m_parity;
+  while (!m_stop)
+    {
+      // the earliest event a partition may run next
+      uint64_t next = NO_EVENT;
+      for (uint32_t i = 0; i < m_nPartitions; i++)
+        {
+          next = std::min (next, std::min (m_partitions[i]->nextTs, m_partitions[i]->minPostedTs));
+        }
+      uint64_t globalNext = global->events->IsEmpty () ? NO_EVENT : global->events->PeekNext ().key.m_ts;
+      if (globalNext == NO_EVENT && next == NO_EVENT)
+        {
+          return false;
+        }
+      if (globalNext <= next)
+        {
+          ProcessOneEvent (global);
+          continue;
+        }
+      uint64_t lookahead = m_lookahead.GetTimeStep ();
+      m_windowEnd = next > NO_EVENT - lookahead ? NO_EVENT : next + lookahead;
+      m_windowEnd = std::min (m_windowEnd, globalNext);
+      return true;
+    }
+  return false;
+}
+
+void
+MultithreadedSimulatorImpl::ReleaseWorkers (void)
+{
+  m_inWindow = true;
+  m_arrived.store (0, std::memory_order_relaxed);
+  m_generation.fetch_add (1, std::memory_order_release);
+}
+
+void
+MultithreadedSimulatorImpl::WaitWorkers (void)
+{
+  uint32_t spins = 0;
+  while (m_arrived.load (std::memory_order_acquire) < m_nPartitions - 1)
+    {
+      Pause (spins);
+    }
+  m_inWindow = false;
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (Partition *partition)
+{
+  t_partition = partition;
+  Multithreading::SetCounters (partition != 0 ? &partition->counters : 0);
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (void)
+{
+  Partition *partition = m_partitions[m_nextWorker.fetch_add (1)];
+  SetPartition (partition);
+  uint32_t generation = 0;
+  while (true)
+    {
+      uint32_t spins = 0;
+      while (m_generation.load (std::memory_order_acquire) == generation)
+        {
+          Pause (spins);
+        }
+      generation++;
+      if (m_done.load (std::memory_order_acquire))
+        {
+          break;
+        }
+      ProcessWindow (partition);
+      m_arrived.fetch_add (1, std::memory_order_release);
+    }
+  SetPartition (0);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = false;
+  CreatePartitions ();
+  m_running = true;
+  m_done = false;
+  m_generation = 0;
+  m_nextWorker = 1;
+
+  std::vector<Ptr<SystemThread> > workers;
+  if (m_nPartitions > 1)
+    {
+      Multithreading::Enable (true);
+    }
+  for (uint32_t i = 1; i < m_nPartitions; i++)
+    {
+      workers.push_back (Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::RunWorker, this)));
+      workers.back ()->Start ();
+    }
+
+  while (ProcessGlobalEvents ())
+    {
+      ReleaseWorkers ();
+      SetPartition (m_partitions[0]);
+      ProcessWindow (m_partitions[0]);
+      SetPartition (0);
+      WaitWorkers ();
+    }
+
+  m_done.store (true, std::memory_order_release);
+  m_generation.fetch_add (1, std::memory_order_release);
+  for (std::vector<Ptr<SystemThread> >::iterator i = workers.begin (); i != workers.end (); i++)
+    {
+      (*i)->Join ();
+    }
+  Multithreading::Enable (false);
+  m_running = false;
+  MergePartitions ();
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!m_partitions.back ()->events->IsEmpty () || m_partitions.back ()->unscheduledEvents == 0);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  Partition *partition = GetPartition ();
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->currentTs));
+  Scheduler::EventKey key = Insert (partition, tAbsolute.GetTimeStep (), partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  Partition *partition = GetPartition ();
+  uint64_t ts = (delay + TimeStep (partition->currentTs)).GetTimeStep ();
+  uint32_t index = GetPartitionIndex (context);
+
+  // between the windows, the main thread inserts the events itself
+  if (!m_inWindow || index == partition->index)
+    {
+      Insert (m_partitions[index], ts, context, event);
+      return;
+    }
+  NS_ABORT_MSG_IF (ts < m_windowEnd, "Event for context " << context << " at " << TimeStep (ts)
+                   << " scheduled by another partition within the lookahead " << m_lookahead);
+  PostedEvent posted;
+  posted.ts = ts;
+  posted.creationTs = partition->currentTs;
+  posted.context = context;
+  posted.event = event;
+  partition->mailbox[m_parity][index].push_back (posted);
+  if (index != m_nPartitions)
+    {
+      partition->minPostedTs = std::min (partition->minPostedTs, ts);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *partition = GetPartition ();
+  Scheduler::EventKey key = Insert (partition, partition->currentTs, partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetPartition ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = m_partitions[GetPartitionIndex (id.GetContext ())];
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // the events stay in the partition of their context
+  const Partition *partition = m_partitions[GetPartitionIndex (id.GetContext ())];
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < partition->currentTs
+      || (id.GetTs () == partition->currentTs
+          && id.GetUid () <= partition->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetPartition ()->currentContext;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_nPartitions;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+} // namespace ns3
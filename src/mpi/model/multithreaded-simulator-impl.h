@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/multithreading.h"
+#include "ns3/system-mutex.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator running the nodes of a single
+ * process on several threads.
+ *
+ * At the start of Run, the nodes are split into partitions: the nodes linked
+ * by a channel which is not a point-to-point channel with a non-zero delay
+ * always share a partition, and the groups of nodes so formed are assigned
+ * to the partitions in node id order, or by system id if any node has a
+ * non-zero one. Each partition has its own scheduler and is run by its own
+ * thread, the main thread running the first one.
+ *
+ * The lookahead is the minimum delay of the point-to-point channels between
+ * two partitions. The partitions process their events in time windows of at
+ * most the lookahead, separated by a barrier, so that an event scheduled on
+ * another partition always belongs to a later window. Such an event is
+ * posted in a mailbox owned by the sending partition and is inserted by the
+ * receiving partition at the start of the next window, in the order of its
+ * timestamp, of the time it was created and of the sending partition, so
+ * that the runs are reproducible. For the same reason, each partition hands
+ * out its own range of packet uids and of RNG streams.
+ *
+ * The events whose context is not a node, such as the ones scheduled before
+ * Run with Simulator::Schedule, are run by the main thread between two
+ * windows, while the partitions wait, and can thus access any node.
+ *
+ * Simulator::Stop called from a node event takes effect at the end of the
+ * current window. The trace sinks shared by the nodes of several partitions
+ * must be thread-safe.
+ *
+ * The implementation is selected by setting the SimulatorImplementationType
+ * global value to ns3::MultithreadedSimulatorImpl.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \return The number of partitions of the last run.
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * \return The lookahead of the last run.
+   */
+  Time GetLookahead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event posted to another partition. */
+  struct PostedEvent
+  {
+    uint64_t ts;          //!< The timestamp of the event
+    uint64_t creationTs;  //!< The time the event was created
+    uint32_t context;     //!< The context of the event
+    EventImpl *event;     //!< The event
+  };
+  /** The events posted to each partition. */
+  typedef std::vector<std::vector<PostedEvent> > Mailbox;
+
+  /** The state of a partition. */
+  struct Partition
+  {
+    Partition ();
+
+    uint32_t index;               //!< The index of the partition
+    Ptr<Scheduler> events;        //!< The events of the nodes of the partition
+    uint64_t currentTs;           //!< The timestamp of the current event
+    uint32_t currentUid;          //!< The uid of the current event
+    uint32_t currentContext;      //!< The context of the current event
+    uint32_t uid;                 //!< The next event uid
+    uint32_t uidStride;           //!< The step between the event uids
+    uint32_t unscheduledEvents;   //!< The events not yet run or removed
+    Mailbox mailbox[2];           //!< The events posted in the even and odd windows
+    uint64_t minPostedTs;         //!< The minimum timestamp posted to a partition in the window
+    uint64_t nextTs;              //!< The timestamp of the next event at the end of the window
+    std::vector<PostedEvent> received;  //!< The events posted to the partition, being inserted
+    Multithreading::Counters counters;  //!< The packet uids and RNG streams of the partition
+  };
+
+  /** \return The partition of the calling thread. */
+  Partition *GetPartition (void) const;
+  /**
+   * \param [in] context The context of an event.
+   * \return The index of the partition running the events of this context.
+   */
+  uint32_t GetPartitionIndex (uint32_t context) const;
+
+  /**
+   * Insert an event in a partition.
+   * \param [in] partition The partition.
+   * \param [in] ts The timestamp of the event.
+   * \param [in] context The context of the event.
+   * \param [in] event The event.
+   * \return The key of the event.
+   */
+  Scheduler::EventKey Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+
+  /**
+   * Split the nodes into partitions, compute the lookahead and move the
+   * events to the scheduler of their partition.
+   */
+  void CreatePartitions (void);
+  /** Move back the events to the scheduler of the main thread. */
+  void MergePartitions (void);
+
+  /**
+   * Process the events of a partition until the end of the window.
+   * \param [in] partition The partition.
+   */
+  void ProcessWindow (Partition *partition);
+  /**
+   * Order the posted events by timestamp, then by creation time.
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \return true if \pname{a} has to be inserted first.
+   */
+  static bool ComparePosted (const PostedEvent &a, const PostedEvent &b);
+  /**
+   * Insert the events posted to a partition in the previous window.
+   * \param [in] partition The partition.
+   * \param [in] parity The mailbox the events were posted in.
+   */
+  void ReceivePosted (Partition *partition, uint32_t parity);
+  /**
+   * Process the next event of a partition.
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Process the events whose context is not a node and compute the end of the
+   * next window, while the worker threads wait.
+   * \return false if the simulation is over.
+   */
+  bool ProcessGlobalEvents (void);
+  /**
+   * Make the calling thread run a partition.
+   * \param [in] partition The partition, 0 outside the windows.
+   */
+  static void SetPartition (Partition *partition);
+  /** Run the windows of a partition in a worker thread. */
+  void RunWorker (void);
+
+  /** Wait for the worker threads to finish the window. */
+  void WaitWorkers (void);
+  /** Start the next window in the worker threads. */
+  void ReleaseWorkers (void);
+
+  /** The partition run by the calling thread, 0 outside the windows. */
+  static thread_local Partition *t_partition;
+
+  uint32_t m_threadCount;                 //!< The maximum number of threads
+  ObjectFactory m_schedulerFactory;       //!< The factory of the schedulers
+  std::vector<Partition *> m_partitions;  //!< The partitions, the last one running the events without node
+  std::vector<uint32_t> m_nodePartition;  //!< The partition index of each node
+  uint32_t m_nPartitions;                 //!< The number of partitions running nodes
+  Time m_lookahead;                       //!< The minimum delay between two partitions
+  bool m_running;                         //!< Whether Run is in progress
+  bool m_inWindow;                        //!< Whether the partitions are processing a window
+  uint32_t m_parity;                      //!< The mailbox of the current window
+  uint64_t m_windowEnd;                   //!< The end of the current window, excluded
+  std::vector<Multithreading::Counters> m_counters;  //!< The counters of the partitions of the previous runs
+
+  std::atomic<bool> m_stop;               //!< Whether Stop was called
+  std::atomic<bool> m_done;               //!< Whether the worker threads should exit
+  std::atomic<uint32_t> m_generation;     //!< The number of windows started
+  std::atomic<uint32_t> m_arrived;        //!< The worker threads done with the window
+  std::atomic<uint32_t> m_nextWorker;     //!< The index of the next worker thread to start
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  DestroyEvents m_destroyEvents;          //!< The events to run at Simulator::Destroy()
+  SystemMutex m_destroyEventsMutex;       //!< Mutex to protect the destroy events in a run
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
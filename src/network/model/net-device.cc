@@ -231,4 +231,18 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBatch (const std::vector<Ptr<Packet> > &packets, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packets.size () << dest << protocolNumber);
+  NS_ASSERT (!packets.empty ());
+  return Send (packets[0], dest, protocolNumber) ? 1 : 0;
+}
+
+bool
+NetDevice::SupportsSendBatch (void) const
+{
+  return false;
+}
+
 } // namespace ns3
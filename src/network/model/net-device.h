@@ -502,6 +502,20 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param packets packets sent from above down to Network Device, in order
+   * \param dest mac address of the destination of all the packets
+   * \param protocolNumber identifies the type of payload of all the packets
+   *
+   * Called from higher layer to send a burst of packets into Network Device,
+   * as in the Linux bulk dequeue with xmit_more. The packets are accepted in
+   * order until the first one which cannot be; the device may stop its
+   * transmission queue meanwhile. The default implementation only sends the
+   * first packet, see SupportsSendBatch.
+   *
+   * \return the number of packets accepted, at the head of the burst
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<Packet> > &packets, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -601,6 +615,12 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface accepts a whole burst in SendBatch, false
+   *         (the default) if it only accepts the first packet.
+   */
+  virtual bool SupportsSendBatch (void) const;
+
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/multithreading.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -572,6 +573,11 @@ PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
   NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
+  if (Multithreading::IsEnabled ())
+    {
+      // the free list is shared by all the threads
+      return PacketMetadata::Allocate (size);
+    }
   if (size > m_maxSize)
     {
       m_maxSize = size;
@@ -597,7 +603,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || Multithreading::IsEnabled ())
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -237,6 +237,12 @@ public:
    * \returns pointer to head of tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * Copy the tags into a new list which shares no \ref TagData with this one.
+   *
+   * \returns The copy.
+   */
+  PacketTagList DeepCopy (void) const;
 
 private:
   /**
@@ -21,8 +21,10 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/multithreading.h"
 #include <string>
 #include <cstdarg>
+#include <vector>
 
 namespace ns3 {
 
@@ -127,20 +129,54 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer buffer;
+  buffer.AddAtStart (m_buffer.GetSize ());
+  buffer.Begin ().Write (m_buffer.Begin (), m_buffer.End ());
+  ByteTagList byteTagList;
+  byteTagList.Add (m_byteTagList);
+  // the metadata deserialization expects the 4 bytes of the total length
+  uint32_t metaSize = m_metadata.GetSerializedSize ();
+  std::vector<uint8_t> serialized (metaSize);
+  m_metadata.Serialize (&serialized[0], metaSize);
+  PacketMetadata metadata (m_metadata.GetUid (), 0);
+  metadata.Deserialize (&serialized[0], metaSize + 4);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList.DeepCopy (), metadata), false);
+  if (m_nixVector)
+    {
+      copy->SetNixVector (m_nixVector->Copy ());
+    }
+  return copy;
+}
+
+uint64_t
+Packet::AllocateUid (void)
+{
+  /* The upper 32 bits of the packet id in 
+   * metadata is for the system id. For non-
+   * distributed simulations, this is simply 
+   * zero.  The lower 32 bits are for the 
+   * global UID
+   */
+  Multithreading::Counters *counters = Multithreading::GetCounters ();
+  if (counters != 0)
+    {
+      // each partition of a multithreaded run has its own range of uids
+      return static_cast<uint64_t> (counters->partition + 1) << 32 | counters->packetUid++;
+    }
+  return static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | Multithreading::FetchAndIncrement (m_globalUid);
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -173,16 +209,9 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -199,16 +228,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
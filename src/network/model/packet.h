@@ -424,6 +424,14 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with the
+   * original one, so that it can be handed over to another thread.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -713,6 +721,11 @@ private:
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \return A new packet uid.
+   */
+  static uint64_t AllocateUid (void);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/test.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class FlowletTableTestCase : public TestCase
+{
+public:
+  FlowletTableTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void CheckExpired (void);
+
+  FlowletTable m_table;
+};
+
+FlowletTableTestCase::FlowletTableTestCase ()
+  : TestCase ("Sanity check on the fixed size flowlet table")
+{
+}
+
+void
+FlowletTableTestCase::CheckExpired (void)
+{
+  FlowletTable::Entry &entry = m_table.Lookup (1);
+  NS_TEST_EXPECT_MSG_EQ (entry.valid, true, "The entry should still be there");
+  NS_TEST_EXPECT_MSG_EQ (m_table.IsActive (entry), false, "The flowlet should have expired");
+  NS_TEST_EXPECT_MSG_EQ (entry.path, 7, "The expired entry should keep the last path");
+}
+
+void
+FlowletTableTestCase::DoRun (void)
+{
+  m_table.SetSize (1000);
+  NS_TEST_EXPECT_MSG_EQ (m_table.GetSize (), 1024, "The size should be rounded up to a power of two");
+  m_table.SetTimeout (MicroSeconds (50));
+
+  FlowletTable::Entry &entry = m_table.Lookup (1);
+  NS_TEST_EXPECT_MSG_EQ (m_table.IsActive (entry), false, "A new entry should not be active");
+  m_table.Update (entry, 1, 7);
+  NS_TEST_EXPECT_MSG_EQ (m_table.IsActive (m_table.Lookup (1)), true, "The flowlet should be active");
+  NS_TEST_EXPECT_MSG_EQ (m_table.Lookup (1).path, 7, "The flowlet should keep its path");
+  NS_TEST_EXPECT_MSG_EQ (m_table.GetCollisions (), 0, "A flow should not collide with itself");
+
+  Simulator::Schedule (MicroSeconds (51), &FlowletTableTestCase::CheckExpired, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // With a single entry every flow shares it
+  FlowletTable small;
+  small.SetSize (1);
+  small.Update (small.Lookup (1), 1, 3);
+  FlowletTable::Entry &shared = small.Lookup (2);
+  NS_TEST_EXPECT_MSG_EQ (small.IsActive (shared), true, "The second flow should hit the entry of the first one");
+  NS_TEST_EXPECT_MSG_EQ (shared.path, 3, "The second flow should inherit the path of the first one");
+  NS_TEST_EXPECT_MSG_EQ (small.GetCollisions (), 1, "The collision should be counted");
+}
+
+static class FlowletTableTestSuite : public TestSuite
+{
+public:
+  FlowletTableTestSuite ()
+    : TestSuite ("flowlet-table", UNIT)
+  {
+    AddTestCase (new FlowletTableTestCase (), TestCase::QUICK);
+  }
+} g_flowletTableTestSuite;
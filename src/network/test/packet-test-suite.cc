@@ -582,6 +582,28 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test the deep copy, which keeps the data, the tags and the uid. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello"), 5);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddPacketTag (ATestTag<10> (7));
+    Ptr<Packet> copy = tmp->DeepCopy ();
+    NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), tmp->GetUid (), "The copy should keep the uid");
+    CHECK (copy, 1, E (20, 0, 15));
+    ATestTag<10> tag;
+    NS_TEST_EXPECT_MSG_EQ (copy->RemovePacketTag (tag), true, "The copy should keep the packet tags");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (tag.m_data), 7, "The copy should keep the packet tags");
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (tag), true, "The original should keep its packet tags");
+    ATestHeader<10> header;
+    copy->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "The copy should keep the header");
+    uint8_t buf[5];
+    copy->CopyData (buf, 5);
+    NS_TEST_EXPECT_MSG_EQ (std::string (reinterpret_cast<const char *> (buf), 5), "hello", "The copy should keep the data");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 15, "The original should not change");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
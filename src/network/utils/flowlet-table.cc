@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flowlet-table.h"
+#include "ns3/hash-murmur3.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+FlowletTable::FlowletTable ()
+  : m_size (0),
+    m_mask (0),
+    m_timeout (MicroSeconds (50)),
+    m_collisions (0)
+{
+  SetSize (65536);
+}
+
+void
+FlowletTable::SetSize (uint32_t size)
+{
+  NS_ASSERT_MSG (size > 0 && size <= (1u << 31), "Invalid flowlet table size");
+
+  uint32_t entries = 1;
+  while (entries < size)
+    {
+      entries <<= 1;
+    }
+
+  m_size = entries;
+  m_mask = entries - 1;
+  m_entries.clear ();
+}
+
+uint32_t
+FlowletTable::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+FlowletTable::SetTimeout (Time timeout)
+{
+  m_timeout = timeout;
+}
+
+Time
+FlowletTable::GetTimeout (void) const
+{
+  return m_timeout;
+}
+
+FlowletTable::Entry &
+FlowletTable::Lookup (uint32_t flowId)
+{
+  if (m_entries.empty ())
+    {
+      Entry empty;
+      empty.flowId = 0;
+      empty.path = 0;
+      empty.activeTime = Time (0);
+      empty.valid = false;
+      m_entries.assign (m_size, empty);
+    }
+
+  Entry &entry = m_entries[Hash::Function::Murmur3::Fmix32 (flowId) & m_mask];
+  if (entry.flowId != flowId && IsActive (entry))
+    {
+      m_collisions++;
+    }
+  return entry;
+}
+
+bool
+FlowletTable::IsActive (const Entry &entry) const
+{
+  return entry.valid && Simulator::Now () - entry.activeTime <= m_timeout;
+}
+
+void
+FlowletTable::Update (Entry &entry, uint32_t flowId, uint32_t path)
+{
+  entry.flowId = flowId;
+  entry.path = path;
+  entry.activeTime = Simulator::Now ();
+  entry.valid = true;
+}
+
+uint64_t
+FlowletTable::GetCollisions (void) const
+{
+  return m_collisions;
+}
+
+} // namespace ns3
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOWLET_TABLE_H
+#define FLOWLET_TABLE_H
+
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * A hardware style flowlet table: a fixed number of entries indexed by the
+ * hash of the flow id, as the 64K-entry table of CONGA. Flows hashing to the
+ * same entry share it, entries are never removed and simply expire once
+ * their active time is older than the flowlet timeout. The memory is thus
+ * bounded by the configured size whatever the number of flows, and it is
+ * only allocated on the first lookup.
+ */
+class FlowletTable
+{
+public:
+  struct Entry
+  {
+    uint32_t flowId;    //!< The last flow that used the entry
+    uint32_t path;      //!< The port or path of the flowlet
+    Time activeTime;    //!< The last time the flowlet has been seen
+    bool valid;         //!< Whether the entry has ever been used
+  };
+
+  FlowletTable ();
+
+  /**
+   * \param size the number of entries, rounded up to a power of two
+   */
+  void SetSize (uint32_t size);
+  uint32_t GetSize (void) const;
+
+  void SetTimeout (Time timeout);
+  Time GetTimeout (void) const;
+
+  /**
+   * \param flowId the id of the flow
+   * \return the entry the flow hashes to
+   */
+  Entry & Lookup (uint32_t flowId);
+
+  /**
+   * \param entry an entry returned by Lookup
+   * \return whether the flowlet of the entry has not yet expired
+   */
+  bool IsActive (const Entry &entry) const;
+
+  /**
+   * Record that the flow is sent on the path now
+   * \param entry the entry returned by Lookup for the flow
+   * \param flowId the id of the flow
+   * \param path the port or path of the flowlet
+   */
+  void Update (Entry &entry, uint32_t flowId, uint32_t path);
+
+  /**
+   * \return the number of lookups that found the entry still active for another flow
+   */
+  uint64_t GetCollisions (void) const;
+
+private:
+  uint32_t m_size;
+  uint32_t m_mask;
+  Time m_timeout;
+  uint64_t m_collisions;
+  std::vector<Entry> m_entries;
+};
+
+} // namespace ns3
+
+#endif /* FLOWLET_TABLE_H */
@@ -0,0 +1,27 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ipv4-path-selector.h"
+
+namespace ns3 {
+
+Ipv4PathSelector::~Ipv4PathSelector ()
+{
+}
+
+void
+Ipv4PathSelector::FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path,
+                            uint32_t size, bool isRetransmission)
+{
+}
+
+void
+Ipv4PathSelector::FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr,
+                            uint32_t size, bool withECN, Time rtt)
+{
+}
+
+void
+Ipv4PathSelector::FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path)
+{
+}
+
+} // namespace ns3
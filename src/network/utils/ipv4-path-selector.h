@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_PATH_SELECTOR_H
+#define IPV4_PATH_SELECTOR_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * The interface of the edge load balancers (e.g., TLB and Clove) which pick
+ * the path of each segment at the sender and learn from the returning ACKs.
+ * A transport protocol resolves the selector aggregated to its node once per
+ * connection and then drives it through these hooks.
+ */
+class Ipv4PathSelector
+{
+public:
+  virtual ~Ipv4PathSelector ();
+
+  /**
+   * \param flowId the id of the flow
+   * \param saddr the source address of the flow
+   * \param daddr the destination address of the flow
+   * \return the path the next segment of the flow should take
+   */
+  virtual uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr) = 0;
+
+  /**
+   * Notify that a segment of the flow has been sent on the path
+   */
+  virtual void FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path,
+                         uint32_t size, bool isRetransmission);
+
+  /**
+   * Notify that a segment sent on the path has been acknowledged
+   */
+  virtual void FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr,
+                         uint32_t size, bool withECN, Time rtt);
+
+  /**
+   * Notify that the flow has experienced a retransmission timeout on the path
+   */
+  virtual void FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path);
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PATH_SELECTOR_H */
@@ -22,6 +22,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -40,6 +41,12 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("DeepCopy",
+                   "Whether the packets are deep copied before the transmission, "
+                   "because the two devices are run by different threads",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_deepCopy),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,6 +64,7 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
+    m_deepCopy (false),
     m_nDevices (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -99,7 +107,7 @@ PointToPointChannel::TransmitStart (
 
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+                                  m_link[wire].m_dst, m_deepCopy ? p->DeepCopy () : p);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
@@ -150,6 +150,7 @@ private:
   static const int N_DEVICES = 2;
 
   Time          m_delay;    //!< Propagation delay
+  bool          m_deepCopy; //!< Deep copy the packets sent on the channel
   int32_t       m_nDevices; //!< Devices of this channel
 
   /**
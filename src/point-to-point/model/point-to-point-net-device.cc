@@ -596,6 +596,61 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBatch (
+  const std::vector<Ptr<Packet> > &packets,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+  {
+    txq = m_queueInterface->GetTxQueue (0);
+  }
+
+  NS_ASSERT_MSG (!txq || !txq->IsStopped (), "SendBatch should not be called when the device is stopped");
+
+  NS_LOG_FUNCTION (this << packets.size () << dest << protocolNumber);
+
+  if (IsLinkUp () == false)
+    {
+      m_macTxDropTrace (packets[0]);
+      return 0;
+    }
+
+  //
+  // Same as a sequence of Send, except that the link and the queue are only
+  // looked up once: the first packet starts the transmit machine if it is
+  // ready, the others wait in the queue for TransmitComplete.
+  //
+  uint32_t n = 0;
+  for ( ; n < packets.size (); n++)
+    {
+      Ptr<Packet> packet = packets[n];
+      AddHeader (packet, protocolNumber);
+      m_macTxTrace (packet);
+
+      if (!m_queue->Enqueue (Create<QueueItem> (packet)))
+        {
+          m_macTxDropTrace (packet);
+          if (txq)
+          {
+            txq->Stop ();
+          }
+          break;
+        }
+
+      if (m_txMachineState == READY)
+        {
+          packet = m_queue->Dequeue ()->GetPacket ();
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          TransmitStart (packet);
+        }
+    }
+  return n;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -645,6 +700,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSendBatch (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
@@ -23,6 +23,11 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -98,6 +103,315 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the batch send of the PointToPoint model
+ *
+ * It checks that a batch is accepted and received as the same packets sent
+ * one at a time, until the queue of the device is full.
+ */
+class PointToPointBatchTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBatchTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Create a link whose receiver records the arrival times
+   *
+   * \param times the vector of the arrival times
+   * \return the sending device
+   */
+  Ptr<PointToPointNetDevice> CreateLink (std::vector<Time> *times);
+
+  /**
+   * \brief Send packets to the device, one at a time or as a batch
+   *
+   * \param device NetDevice to send to
+   * \param batch whether to send a batch
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, bool batch);
+
+  /**
+   * \brief Record the arrival time of a packet
+   */
+  static bool Receive (std::vector<Time> *times, Ptr<NetDevice> device, Ptr<const Packet> p,
+                uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_singleTimes;  //!< The arrival times of the packets sent one at a time
+  std::vector<Time> m_batchTimes;   //!< The arrival times of the packets sent as a batch
+  uint32_t m_nSingleSent;           //!< The packets sent one at a time accepted by the device
+  uint32_t m_nBatchSent;            //!< The packets of the batch accepted by the device
+};
+
+PointToPointBatchTest::PointToPointBatchTest ()
+  : TestCase ("PointToPoint batch send"),
+    m_nSingleSent (0),
+    m_nBatchSent (0)
+{
+}
+
+Ptr<PointToPointNetDevice>
+PointToPointBatchTest::CreateLink (std::vector<Time> *times)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObjectWithAttributes<DropTailQueue> ("MaxPackets", UintegerValue (5)));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeBoundCallback (&PointToPointBatchTest::Receive, times));
+
+  devA->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+  devB->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+  return devA;
+}
+
+void
+PointToPointBatchTest::SendPackets (Ptr<PointToPointNetDevice> device, bool batch)
+{
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      packets.push_back (Create<Packet> (100 * (i + 1)));
+    }
+
+  if (batch)
+    {
+      m_nBatchSent = device->SendBatch (packets, device->GetBroadcast (), 0x800);
+      return;
+    }
+
+  Ptr<NetDeviceQueue> txq = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  for (uint32_t i = 0; i < packets.size () && !txq->IsStopped (); i++)
+    {
+      if (device->Send (packets[i], device->GetBroadcast (), 0x800))
+        {
+          m_nSingleSent++;
+        }
+    }
+}
+
+bool
+PointToPointBatchTest::Receive (std::vector<Time> *times, Ptr<NetDevice> device, Ptr<const Packet> p,
+                                uint16_t protocol, const Address &from)
+{
+  times->push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointBatchTest::DoRun (void)
+{
+  Ptr<PointToPointNetDevice> single = CreateLink (&m_singleTimes);
+  Ptr<PointToPointNetDevice> batch = CreateLink (&m_batchTimes);
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBatchTest::SendPackets, this, single, false);
+  Simulator::Schedule (Seconds (1.0), &PointToPointBatchTest::SendPackets, this, batch, true);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nBatchSent, 6, "The device should take one packet on the wire and fill its queue");
+  NS_TEST_EXPECT_MSG_EQ (m_nBatchSent, m_nSingleSent, "The batch should be accepted as the single packets");
+  NS_TEST_ASSERT_MSG_EQ (m_batchTimes.size (), m_nBatchSent, "Every accepted packet should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_singleTimes.size (), m_nSingleSent, "Every accepted packet should be received");
+  for (uint32_t i = 0; i < m_batchTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_batchTimes[i], m_singleTimes[i], "The packets should be received at the same time");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for the multithreaded simulator with the PointToPoint model
+ *
+ * It sends packets around a ring of nodes, once with the default simulator
+ * and twice with the nodes split between three threads, and checks that every
+ * node receives the same packets at the same times. The two multithreaded runs
+ * must also give the packets the same uids and draw the same random values.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief The packets received by a node, and the device forwarding them
+   */
+  struct Hop
+  {
+    Ptr<PointToPointNetDevice> next;                    //!< The device to the next node
+    std::vector<std::pair<Time, uint32_t> > received;   //!< The arrival times and sizes
+    std::vector<std::pair<uint64_t, double> > drawn;    //!< The packet uids and the values drawn at their arrival
+    Ptr<UniformRandomVariable> rng;                     //!< The random variable created at the first arrival
+  };
+
+  /**
+   * \brief Send packets around a ring of nodes
+   *
+   * \param impl the simulator implementation, 0 for the default one
+   * \param hops the packets received by each node
+   */
+  void RunRing (Ptr<MultithreadedSimulatorImpl> impl, std::vector<Hop> &hops);
+
+  /**
+   * \brief Send a packet to the device
+   *
+   * \param device NetDevice to send to
+   * \param size the size of the packet
+   */
+  static void Send (Ptr<PointToPointNetDevice> device, uint32_t size);
+
+  /**
+   * \brief Record the arrival of a packet and forward it, shortened, to the next node
+   */
+  static bool Receive (Hop *hop, Ptr<NetDevice> device, Ptr<const Packet> p,
+                       uint16_t protocol, const Address &from);
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint with the multithreaded simulator")
+{
+}
+
+void
+PointToPointMultithreadedTest::RunRing (Ptr<MultithreadedSimulatorImpl> impl, std::vector<Hop> &hops)
+{
+  if (impl != 0)
+    {
+      Simulator::SetImplementation (impl);
+    }
+
+  const uint32_t nNodes = 6;
+  std::vector<Ptr<Node> > nodes;
+  hops.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<PointToPointNetDevice> tx = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointNetDevice> rx = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointChannel> channel = CreateObjectWithAttributes<PointToPointChannel> ("Delay", TimeValue (MicroSeconds (10 * (i + 1))));
+
+      tx->Attach (channel);
+      tx->SetAddress (Mac48Address::Allocate ());
+      tx->SetDataRate (DataRate ("1Gbps"));
+      tx->SetQueue (CreateObject<DropTailQueue> ());
+      rx->Attach (channel);
+      rx->SetAddress (Mac48Address::Allocate ());
+      rx->SetQueue (CreateObject<DropTailQueue> ());
+
+      nodes[i]->AddDevice (tx);
+      nodes[(i + 1) % nNodes]->AddDevice (rx);
+      rx->SetReceiveCallback (MakeBoundCallback (&PointToPointMultithreadedTest::Receive, &hops[(i + 1) % nNodes]));
+      hops[i].next = tx;
+
+      tx->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+      rx->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+    }
+
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      for (uint32_t k = 0; k < 5; k++)
+        {
+          Simulator::ScheduleWithContext (i, MicroSeconds (3 * k + i), &PointToPointMultithreadedTest::Send,
+                                          hops[i].next, 1000 + 10 * i + k);
+        }
+    }
+
+  Simulator::Run ();
+
+  if (impl != 0)
+    {
+      // the nodes 0-1, 2-3 and 4-5 share a partition
+      NS_TEST_EXPECT_MSG_EQ (impl->GetNPartitions (), 3, "The nodes should be split between the threads");
+      NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MicroSeconds (20), "The lookahead should be the delay between the first partitions");
+    }
+
+  Simulator::Destroy ();
+}
+
+void
+PointToPointMultithreadedTest::Send (Ptr<PointToPointNetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Hop *hop, Ptr<NetDevice> device, Ptr<const Packet> p,
+                                        uint16_t protocol, const Address &from)
+{
+  hop->received.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+  if (hop->rng == 0)
+    {
+      hop->rng = CreateObject<UniformRandomVariable> ();
+    }
+  hop->drawn.push_back (std::make_pair (p->GetUid (), hop->rng->GetValue ()));
+  if (p->GetSize () >= 520)
+    {
+      Ptr<Packet> copy = p->Copy ();
+      copy->RemoveAtEnd (20);
+      hop->next->Send (copy, hop->next->GetBroadcast (), 0x800);
+    }
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  std::vector<Hop> expected;
+  std::vector<Hop> hops;
+  std::vector<Hop> again;
+  RunRing (0, expected);
+  RunRing (CreateObjectWithAttributes<MultithreadedSimulatorImpl> ("ThreadCount", UintegerValue (3)), hops);
+  RunRing (CreateObjectWithAttributes<MultithreadedSimulatorImpl> ("ThreadCount", UintegerValue (3)), again);
+
+  for (uint32_t i = 0; i < hops.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (expected[i].received.size (), 0, "Node " << i << " should receive packets");
+      NS_TEST_ASSERT_MSG_EQ (hops[i].received.size (), expected[i].received.size (), "Node " << i << " should receive the same packets");
+      for (uint32_t j = 0; j < hops[i].received.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (hops[i].received[j].first, expected[i].received[j].first, "Packet " << j << " of node " << i << " received at another time");
+          NS_TEST_EXPECT_MSG_EQ (hops[i].received[j].second, expected[i].received[j].second, "Packet " << j << " of node " << i << " of another size");
+        }
+      NS_TEST_ASSERT_MSG_EQ (again[i].drawn.size (), hops[i].drawn.size (), "Node " << i << " should receive the same packets in both runs");
+      for (uint32_t j = 0; j < hops[i].drawn.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (again[i].drawn[j].first, hops[i].drawn[j].first, "Packet " << j << " of node " << i << " with another uid");
+          NS_TEST_EXPECT_MSG_EQ (again[i].drawn[j].second, hops[i].drawn[j].second, "Packet " << j << " of node " << i << " drew another value");
+        }
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +428,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBatchTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -61,6 +61,7 @@ Ipv4TLBProbing::Ipv4TLBProbing ()
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
@@ -77,6 +78,7 @@ Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::~Ipv4TLBProbing ()
@@ -114,6 +116,14 @@ Ipv4TLBProbing::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+int64_t
+Ipv4TLBProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 void
 Ipv4TLBProbing::AddBroadCastAddress (Ipv4Address addr)
 {
@@ -165,7 +175,7 @@ Ipv4TLBProbing::SendProbe (uint32_t path)
 
     // Add timeout
     m_probingTimeoutMap[m_id] =
-        Simulator::Schedule (m_probeTimeout, &Ipv4TLBProbing::ProbeEventTimeout, this, m_id, path);
+        Simulator::ScheduleTimeout (m_probeTimeout, &Ipv4TLBProbing::ProbeEventTimeout, this, m_id, path);
 
     Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
     ipv4TLB->ProbeSend (m_probeAddress, path);
@@ -316,7 +326,7 @@ Ipv4TLBProbing::DoProbe ()
     {
         for (uint32_t i = 0; i < 10; i++) // Try 8 times
         {
-            uint32_t path = availPaths[rand() % availPaths.size ()];
+            uint32_t path = availPaths[m_rand->GetInteger (0, availPaths.size () - 1)];
             if (pathSet.find (path) != pathSet.end ())
             {
                 continue;
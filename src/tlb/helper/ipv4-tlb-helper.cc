@@ -2,10 +2,29 @@
 
 #include "ipv4-tlb-helper.h"
 
+#include "ns3/node.h"
+
 namespace ns3 {
 
-/* ... */
+Ipv4TLBHelper::Ipv4TLBHelper ()
+{
+
+}
 
+int64_t
+Ipv4TLBHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4TLB> tlb = (*i)->GetObject<Ipv4TLB> ();
+        if (tlb != 0)
+        {
+            currentStream += tlb->AssignStreams (currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
 
 }
 
@@ -2,8 +2,31 @@
 #ifndef TLB_HELPER_H
 #define TLB_HELPER_H
 
+#include "ns3/ipv4-tlb.h"
+#include "ns3/node-container.h"
+
 namespace ns3 {
 
+/**
+ * The Ipv4TLB instances are aggregated to the nodes by the InternetStackHelper,
+ * this helper configures the ones already installed.
+ */
+class Ipv4TLBHelper
+{
+public:
+    Ipv4TLBHelper ();
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by the Ipv4TLB of the nodes. Return the number of streams that
+     * have been assigned.
+     *
+     * \param c NodeContainer of the set of nodes whose Ipv4TLB should use a fixed stream
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams (NodeContainer c, int64_t stream);
+};
 
 }
 
@@ -64,6 +64,7 @@ Ipv4TLB::Ipv4TLB ():
     m_flowletTimeout (MicroSeconds (5000000))
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
@@ -108,6 +109,7 @@ Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
     m_flowletTimeout (other.m_flowletTimeout)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -189,20 +191,22 @@ Ipv4TLB::GetTypeId (void)
 void
 Ipv4TLB::AddAddressWithTor (Ipv4Address address, uint32_t torId)
 {
-    m_ipTorMap[address] = torId;
+    std::vector<std::pair<Ipv4Address, uint32_t> >::iterator itr =
+        std::lower_bound (m_ipTorMap.begin (), m_ipTorMap.end (), std::make_pair (address, 0u), Ipv4TLB::AddressLess);
+    if (itr != m_ipTorMap.end () && itr->first == address)
+    {
+        itr->second = torId;
+        return;
+    }
+    m_ipTorMap.insert (itr, std::make_pair (address, torId));
 }
 
 void
 Ipv4TLB::AddAvailPath (uint32_t destTor, uint32_t path)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
-    {
-        std::vector<uint32_t> paths;
-        m_availablePath[destTor] = paths;
-        itr = m_availablePath.find (destTor);
-    }
-    (itr->second).push_back (path);
+    TLBDestTor &tor = Ipv4TLB::GetDestTor (destTor);
+    tor.availPaths.push_back (path);
+    tor.availSlots.push_back (Ipv4TLB::GetPathSlot (tor, path));
 }
 
 std::vector<uint32_t>
@@ -216,28 +220,29 @@ Ipv4TLB::GetAvailPath (Ipv4Address daddr)
         return emptyVector;
     }
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    const TLBDestTor *tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor == 0)
     {
         return emptyVector;
     }
-    return itr->second;
+    return tor->availPaths;
 }
 
 uint32_t
 Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
+    Ipv4TLB::RunAging ();
+
     struct TLBAcklet acklet;
-    std::map<uint32_t, TLBAcklet>::iterator ackletItr = m_acklets.find (flowId);
+    uint32_t ackletHandle = m_acklets.Find (flowId);
 
-    if (ackletItr != m_acklets.end ())
+    if (ackletHandle != TLBFlowTable<TLBAcklet>::NONE)
     {
         // Existing flow
-        acklet = ackletItr->second;
+        acklet = m_acklets.Get (ackletHandle);
         if (Simulator::Now () - acklet.activeTime <= m_ackletTimeout) // Timeout
         {
-            acklet.activeTime = Simulator::Now ();
-            m_acklets[flowId] = acklet;
+            m_acklets.Get (ackletHandle).activeTime = Simulator::Now ();
             return acklet.pathId;
         }
 
@@ -268,7 +273,7 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
             acklet.pathId = newPath.pathId;
             acklet.activeTime = Simulator::Now ();
 
-            m_acklets[flowId] = acklet;
+            m_acklets.Get (ackletHandle) = acklet;
 
             return newPath.pathId;
         }
@@ -291,7 +296,7 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     acklet.pathId = newPath.pathId;
     acklet.activeTime = Simulator::Now ();
 
-    m_acklets[flowId] = acklet;
+    m_acklets.Get (m_acklets.Insert (flowId)) = acklet;
 
     return newPath.pathId;
 }
@@ -299,14 +304,18 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 uint32_t
 Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
-    if (!m_agingEvent.IsRunning ())
+    Ipv4TLB::RunAging ();
+
+    if (!m_agingTimer.IsRunning ())
     {
-        m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
+        m_agingTimer.SetPeriod (m_agingCheckTime);
+        m_agingTimer.Start ();
     }
 
-    if (!m_dreEvent.IsRunning ())
+    if (!m_dreTimer.IsRunning ())
     {
-        m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
+        m_dreTimer.SetPeriod (m_dreTime);
+        m_dreTimer.Start ();
     }
 
     uint32_t destTor = 0;
@@ -322,21 +331,27 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    std::map<uint32_t, TLBFlowInfo>::iterator flowItr = m_flowInfo.find (flowId);
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
 
     // First check if the flow is a new flow
-    if (flowItr == m_flowInfo.end ())
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         // New flow
         struct PathInfo newPath;
         if (Ipv4TLB::WhereToChange (destTor, newPath, false, 0))
         {
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            if (!m_pathSelectTrace.IsEmpty ())
+            {
+                m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            }
         }
         else
         {
             newPath = Ipv4TLB::SelectRandomPath (destTor);
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            if (!m_pathSelectTrace.IsEmpty ())
+            {
+                m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            }
         }
         Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
         Ipv4TLB::AssignFlowToPath (flowId, destTor, newPath.pathId);
@@ -344,22 +359,26 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
     else if (m_rerouteEnable)
     {
-        Time flowActiveTime = (flowItr->second).activeTime;
-        (flowItr->second).activeTime = Simulator::Now ();
+        TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+        Time flowActiveTime = flowInfo.activeTime;
+        flowInfo.activeTime = Simulator::Now ();
 
         // Old flow
-        uint32_t oldPath = (flowItr->second).path;
+        uint32_t oldPath = flowInfo.path;
         struct PathInfo oldPathInfo = Ipv4TLB::JudgePath (destTor, oldPath);
         if (0 == 1
-                && ((flowItr->second).retransmissionSize > m_flowRetransVeryHigh
-                || (flowItr->second).timeoutCount >= 1))
+                && (flowInfo.retransmissionSize > m_flowRetransVeryHigh
+                || flowInfo.timeoutCount >= 1))
         {
             struct PathInfo newPath;
             if (Ipv4TLB::WhereToChange (destTor, newPath, true, oldPath))
             {
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    if (!m_pathChangeTrace.IsEmpty ())
+                    {
+                        m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    }
                 }
             }
             else
@@ -367,7 +386,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 newPath = Ipv4TLB::SelectRandomPath (destTor);
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    if (!m_pathChangeTrace.IsEmpty ())
+                    {
+                        m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    }
                 }
             }
 
@@ -383,13 +405,13 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         }
         else if ((oldPathInfo.pathType == BadPath || Simulator::Now () - flowActiveTime > m_flowletTimeout) // Trigger for rerouting
                 && oldPathInfo.quantifiedDre <= m_dreMultiply * 8  // TODO To be fixed
-                && (flowItr->second).size >= m_S
-                /*&& ((static_cast<double> ((flowItr->second).ecnSize) / (flowItr->second).size > m_ecnPortionHigh && Simulator::Now () - (flowItr->second).timeStamp >= m_T) || (flowItr->second).retransmissionSize > m_flowRetransHigh)*/
-                && Simulator::Now() - (flowItr->second).tryChangePath > MicroSeconds (100))
+                && flowInfo.size >= m_S
+                /*&& ((static_cast<double> (flowInfo.ecnSize) / flowInfo.size > m_ecnPortionHigh && Simulator::Now () - flowInfo.timeStamp >= m_T) || flowInfo.retransmissionSize > m_flowRetransHigh)*/
+                && Simulator::Now() - flowInfo.tryChangePath > MicroSeconds (100))
         {
-            if (rand () % RANDOM_BASE < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
+            if (static_cast<int> (m_rand->GetInteger (0, RANDOM_BASE - 1)) < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
             {
-                (flowItr->second).tryChangePath = Simulator::Now ();
+                flowInfo.tryChangePath = Simulator::Now ();
                 return oldPath;
             }
             struct PathInfo newPath;
@@ -400,7 +422,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                     return oldPath;
                 }
 
-                m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                if (!m_pathChangeTrace.IsEmpty ())
+                {
+                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                }
 
                 // Calculate the pause time
                 Time pauseTime = oldPathInfo.rttMin - newPath.rttMin;
@@ -425,9 +450,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
     else
     {
-        (flowItr->second).activeTime = Simulator::Now ();
+        TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+        flowInfo.activeTime = Simulator::Now ();
 
-        uint32_t oldPath = (flowItr->second).path;
+        uint32_t oldPath = flowInfo.path;
         return oldPath;
     }
 }
@@ -446,6 +472,8 @@ Ipv4TLB::GetPauseTime (uint32_t flowId)
 void
 Ipv4TLB::FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt)
 {
+    Ipv4TLB::RunAging ();
+
     // NS_LOG_FUNCTION (flowId << path << daddr << size << withECN << rtt);
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
@@ -460,6 +488,8 @@ Ipv4TLB::FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t s
 void
 Ipv4TLB::FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t size, bool isRetransmission)
 {
+    Ipv4TLB::RunAging ();
+
     // NS_LOG_FUNCTION (flowId << daddr << path << size << isRetransmission);
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
@@ -498,6 +528,8 @@ Ipv4TLB::FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t s
 void
 Ipv4TLB::FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path)
 {
+    Ipv4TLB::RunAging ();
+
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
@@ -517,45 +549,45 @@ Ipv4TLB::FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path)
 void
 Ipv4TLB::FlowFinish (uint32_t flowId, Ipv4Address daddr)
 {
+    Ipv4TLB::RunAging ();
+
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         NS_LOG_ERROR ("Cannot finish a non-existing flow");
         return;
     }
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
 
-    Ipv4TLB::RemoveFlowFromPath (flowId, destTor, (itr->second).path);
+    Ipv4TLB::RemoveFlowFromPath (flowId, destTor, flowInfo.path);
 
 }
 
 void
 Ipv4TLB::ProbeSend (Ipv4Address daddr, uint32_t path)
 {
+    Ipv4TLB::RunAging ();
+
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
-    {
-        m_pathInfo[key] = Ipv4TLB::GetInitPathInfo (path);
-    }
-
+    Ipv4TLB::GetPathInfo (destTor, path);
 }
 
 void
 Ipv4TLB::ProbeRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt)
 {
+    Ipv4TLB::RunAging ();
+
     NS_LOG_FUNCTION (path << daddr << size << withECN << rtt);
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
@@ -568,7 +600,10 @@ Ipv4TLB::ProbeRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool withEC
 
 void
 Ipv4TLB::ProbeTimeout (uint32_t path, Ipv4Address daddr)
-{   uint32_t destTor = 0;
+{
+    Ipv4TLB::RunAging ();
+
+    uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
@@ -585,6 +620,14 @@ Ipv4TLB::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+int64_t
+Ipv4TLB::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 void
 Ipv4TLB::PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
                         uint32_t size, bool withECN, Time rtt, bool isProbing)
@@ -605,34 +648,36 @@ Ipv4TLB::PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
 bool
 Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool withECN, Time rtt)
 {
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         NS_LOG_ERROR ("Cannot update info for a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+    if (flowInfo.path != path)
     {
         return false;
     }
-    (itr->second).size += size;
+    flowInfo.size += size;
     if (withECN)
     {
-        (itr->second).ecnSize += size;
+        flowInfo.ecnSize += size;
     }
-    (itr->second).liveTime = Simulator::Now ();
+    flowInfo.liveTime = Simulator::Now ();
+    m_flowInfo.Refresh (flowHandle);
 
     // Added Dec 23rd
     /*
     if (m_isSmooth)
     {
-        (itr->second).rtt = (SMOOTH_BASE - m_smoothAlpha) * (itr->second).rtt / SMOOTH_BASE + m_smoothAlpha * rtt / SMOOTH_BASE;
+        flowInfo.rtt = (SMOOTH_BASE - m_smoothAlpha) * flowInfo.rtt / SMOOTH_BASE + m_smoothAlpha * rtt / SMOOTH_BASE;
     }
     else
     {
-        if (rtt < (itr->second).rtt)
+        if (rtt < flowInfo.rtt)
         {
-            (itr->second).rtt = rtt;
+            flowInfo.rtt = rtt;
         }
     }
     */
@@ -640,19 +685,19 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 
     // Added Jan 11st
     /*
-    (itr->second).epAckSize += size;
+    flowInfo.epAckSize += size;
     if (withECN)
     {
-        (itr->second).epEcnSize += size;
+        flowInfo.epEcnSize += size;
     }
-    if (Simulator::Now () - (itr->second).epTimeStamp > m_epCheckTime)
+    if (Simulator::Now () - flowInfo.epTimeStamp > m_epCheckTime)
     {
-        double originalEcnPortion = (itr->second).epEcnPortion;
-        double newEcnPortition = static_cast<double> ((itr->second).epEcnSize) / (itr->second).epAckSize;
-        (itr->second).epAckSize = 1;
-        (itr->second).epEcnSize = 0;
-        (itr->second).epEcnPortion = m_epAlpha * originalEcnPortion + (1.0 - m_epAlpha) * newEcnPortition;
-        (itr->second).epTimeStamp = Simulator::Now ();
+        double originalEcnPortion = flowInfo.epEcnPortion;
+        double newEcnPortition = static_cast<double> (flowInfo.epEcnSize) / flowInfo.epAckSize;
+        flowInfo.epAckSize = 1;
+        flowInfo.epEcnSize = 0;
+        flowInfo.epEcnPortion = m_epAlpha * originalEcnPortion + (1.0 - m_epAlpha) * newEcnPortition;
+        flowInfo.epTimeStamp = Simulator::Now ();
     }
     */
     // --
@@ -663,18 +708,7 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 void
 Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool withECN, Time rtt)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
-    {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
-    {
-        pathInfo = itr->second;
-    }
+    TLBPathInfo &pathInfo = Ipv4TLB::GetPathInfo (destTor, path);
 
     pathInfo.size += size;
     if (withECN)
@@ -712,26 +746,25 @@ Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool wi
     }
     */
     // --
-
-    m_pathInfo[key] = pathInfo;
 }
 
 bool
 Ipv4TLB::TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout)
 {
     isVeryTimeout = false;
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+    if (flowInfo.path != path)
     {
         return false;
     }
-    (itr->second).timeoutCount ++;
-    if ((itr->second).timeoutCount >= m_flowTimeoutCount)
+    flowInfo.timeoutCount ++;
+    if (flowInfo.timeoutCount >= m_flowTimeoutCount)
     {
         isVeryTimeout = true;
     }
@@ -741,33 +774,33 @@ Ipv4TLB::TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout)
 bool
 Ipv4TLB::SendFlow (uint32_t flowId, uint32_t path, uint32_t size)
 {
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         NS_LOG_ERROR ("Cannot retransmit a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+    if (flowInfo.path != path)
     {
         return false;
     }
-    (itr->second).sendSize += size;
+    flowInfo.sendSize += size;
     return true;
 }
 
 void
 Ipv4TLB::SendPath (uint32_t destTor, uint32_t path, uint32_t size)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    TLBPathInfo *pathInfo = Ipv4TLB::FindPathInfo (destTor, path);
 
-    if (itr == m_pathInfo.end ())
+    if (pathInfo == 0)
     {
         NS_LOG_ERROR ("Cannot send a non-existing path");
         return;
     }
 
-    (itr->second).dreValue += size;
+    pathInfo->dreValue += size;
 }
 
 bool
@@ -775,26 +808,27 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 {
     needRetranPath = false;
     needHighRetransPath = false;
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    uint32_t flowHandle = m_flowInfo.Find (flowId);
+    if (flowHandle == TLBFlowTable<TLBFlowInfo>::NONE)
     {
         NS_LOG_ERROR ("Cannot retransmit a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+    if (flowInfo.path != path)
     {
         return false;
     }
-    if (Simulator::Now () - (itr->second).timeStamp < MicroSeconds (1000))
+    if (Simulator::Now () - flowInfo.timeStamp < MicroSeconds (1000))
     {
         return false;
     }
-    (itr->second).retransmissionSize += size;
-    if ((itr->second).retransmissionSize > m_flowRetransHigh)
+    flowInfo.retransmissionSize += size;
+    if (flowInfo.retransmissionSize > m_flowRetransHigh)
     {
         needRetranPath = true;
     }
-    if ((itr->second).retransmissionSize > m_flowRetransVeryHigh)
+    if (flowInfo.retransmissionSize > m_flowRetransVeryHigh)
     {
         needHighRetransPath = true;
     }
@@ -805,48 +839,48 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 void
 Ipv4TLB::TimeoutPath (uint32_t destTor, uint32_t path, bool isProbing, bool isVeryTimeout)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *pathInfo = Ipv4TLB::FindPathInfo (destTor, path);
+    if (pathInfo == 0)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
     if (!isProbing)
     {
-        (itr->second).isTimeout = true;
+        pathInfo->isTimeout = true;
         if (isVeryTimeout)
         {
-            (itr->second).isVeryTimeout = true;
+            pathInfo->isVeryTimeout = true;
         }
     }
     else
     {
-        (itr->second).isProbingTimeout = true;
+        pathInfo->isProbingTimeout = true;
     }
 }
 
 void
 Ipv4TLB::RetransPath (uint32_t destTor, uint32_t path, bool needHighRetransPath)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *pathInfo = Ipv4TLB::FindPathInfo (destTor, path);
+    if (pathInfo == 0)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
-    (itr->second).isRetransmission = true;
+    pathInfo->isRetransmission = true;
     if (needHighRetransPath)
     {
-        (itr->second).isHighRetransmission = true;
+        pathInfo->isHighRetransmission = true;
     }
 }
 
 void
 Ipv4TLB::UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor)
 {
-    TLBFlowInfo flowInfo;
+    uint32_t flowHandle = m_flowInfo.Insert (flowId);
+    TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+    flowInfo.flowId = flowId;
     flowInfo.path = path;
     flowInfo.destTor = destTor;
     flowInfo.size = 0;
@@ -873,8 +907,6 @@ Ipv4TLB::UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor)
 
     // Added Jan 12nd
     flowInfo.activeTime = Simulator::Now ();
-
-    m_flowInfo[flowId] = flowInfo;
 }
 
 TLBPathInfo
@@ -912,65 +944,51 @@ Ipv4TLB::GetInitPathInfo (uint32_t path)
 void
 Ipv4TLB::AssignFlowToPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
-    {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
-    {
-        pathInfo = itr->second;
-    }
-
-    pathInfo.flowCounter ++;
-    m_pathInfo[key] = pathInfo;
+    Ipv4TLB::GetPathInfo (destTor, path).flowCounter ++;
 }
 
 void
 Ipv4TLB::RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *pathInfo = Ipv4TLB::FindPathInfo (destTor, path);
+    if (pathInfo == 0)
     {
         NS_LOG_ERROR ("Cannot remove flow from a non-existing path");
         return;
     }
-    if ((itr->second).flowCounter == 0)
+    if (pathInfo->flowCounter == 0)
     {
         NS_LOG_ERROR ("Cannot decrease from counter while it has reached 0");
         return;
     }
-    (itr->second).flowCounter --;
+    pathInfo->flowCounter --;
 
 }
 
 bool
 Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, uint32_t oldPath)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    const TLBDestTor *tor = Ipv4TLB::FindDestTor (destTor);
 
-    if (itr == m_availablePath.end ())
+    if (tor == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         return false;
     }
 
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
+    // Judge every parallel path once, the passes below only read the verdicts
+    Ipv4TLB::JudgePaths (*tor);
 
     // Firstly, checking good path
     uint32_t minCounter = std::numeric_limits<uint32_t>::max ();
     Time minRTT = Seconds (666);
     uint32_t minRTTLevel = 5;
     uint32_t minDre = std::pow (2, m_dreQ);
-    std::vector<PathInfo> candidatePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    std::vector<PathInfo> &candidatePaths = m_candidatePaths;
+    candidatePaths.clear ();
+    for (std::vector<PathInfo>::const_iterator pathItr = m_judgedPaths.begin (); pathItr != m_judgedPaths.end (); ++pathItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        const PathInfo &pathInfo = *pathItr;
         if (pathInfo.pathType == GoodPath)
         {
             if (m_runMode == TLB_RUNMODE_COUNTER)
@@ -1048,20 +1066,20 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         {
             if (minCounter <= m_K)
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
             }
         }
         else if (m_runMode == TLB_RUNMODE_MINRTT)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Good Path: " << newPath.pathId);
         return true;
@@ -1086,11 +1104,9 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
     minRTT = Seconds (666);
     minDre = std::pow (2, m_dreQ);
     candidatePaths.clear ();
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    for (std::vector<PathInfo>::const_iterator pathItr = m_judgedPaths.begin (); pathItr != m_judgedPaths.end (); ++pathItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        const PathInfo &pathInfo = *pathItr;
         if (pathInfo.pathType == GreyPath
             && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
         {
@@ -1169,32 +1185,30 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         {
             if (minCounter <= m_K)
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
             }
         }
         else if (m_runMode == TLB_RUNMODE_MINRTT)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
 
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Grey Path: " << newPath.pathId);
         return true;
     }
 
    // Thirdly, checking bad path
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    for (std::vector<PathInfo>::const_iterator pathItr = m_judgedPaths.begin (); pathItr != m_judgedPaths.end (); ++pathItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        const PathInfo &pathInfo = *pathItr;
         if (pathInfo.pathType == BadPath
             && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
         {
@@ -1212,9 +1226,9 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
 struct PathInfo
 Ipv4TLB::SelectRandomPath (uint32_t destTor)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    const TLBDestTor *tor = Ipv4TLB::FindDestTor (destTor);
 
-    if (itr == m_availablePath.end ())
+    if (tor == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         PathInfo pathInfo;
@@ -1222,27 +1236,25 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
         return pathInfo;
     }
 
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
-    std::vector<PathInfo> availablePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    Ipv4TLB::JudgePaths (*tor);
+    std::vector<PathInfo> &availablePaths = m_candidatePaths;
+    availablePaths.clear ();
+    for (std::vector<PathInfo>::const_iterator pathItr = m_judgedPaths.begin (); pathItr != m_judgedPaths.end (); ++pathItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GoodPath || pathInfo.pathType == GreyPath || pathInfo.pathType == BadPath)
+        if (pathItr->pathType == GoodPath || pathItr->pathType == GreyPath || pathItr->pathType == BadPath)
         {
-            availablePaths.push_back (pathInfo);
+            availablePaths.push_back (*pathItr);
         }
     }
 
     struct PathInfo newPath;
     if (!availablePaths.empty ())
     {
-        newPath = availablePaths[rand() % availablePaths.size ()];
+        newPath = availablePaths[m_rand->GetInteger (0, availablePaths.size () - 1)];
     }
     else
     {
-        uint32_t pathId = (itr->second)[rand() % (itr->second).size ()];
-        newPath = Ipv4TLB::JudgePath (destTor, pathId);
+        newPath = m_judgedPaths[m_rand->GetInteger (0, m_judgedPaths.size () - 1)];
     }
     NS_LOG_LOGIC ("Random selection return path: " << newPath.pathId);
     return newPath;
@@ -1251,12 +1263,15 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
 struct PathInfo
 Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, pathId);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    return Ipv4TLB::JudgePathInfo (pathId, Ipv4TLB::FindPathInfo (destTor, pathId));
+}
 
+struct PathInfo
+Ipv4TLB::JudgePathInfo (uint32_t pathId, const TLBPathInfo *info)
+{
     struct PathInfo path;
     path.pathId = pathId;
-    if (itr == m_pathInfo.end ())
+    if (info == 0)
     {
         path.pathType = GreyPath;
         /*path.pathType = GoodPath;*/
@@ -1268,7 +1283,7 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
         path.quantifiedDre = 0;
         return path;
     }
-    TLBPathInfo pathInfo = itr->second;
+    const TLBPathInfo &pathInfo = *info;
     path.rttMin = pathInfo.minRtt;
     path.size = pathInfo.size;
     path.ecnPortion = static_cast<double>(pathInfo.ecnSize) / pathInfo.size;
@@ -1306,6 +1321,18 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
     return path;
 }
 
+void
+Ipv4TLB::JudgePaths (const TLBDestTor &tor)
+{
+    m_judgedPaths.clear ();
+    for (uint32_t i = 0; i < tor.availSlots.size (); i++)
+    {
+        uint32_t slot = tor.availSlots[i];
+        m_judgedPaths.push_back (Ipv4TLB::JudgePathInfo (tor.pathIds[slot],
+                    tor.hasPathInfo[slot] ? &tor.pathInfo[slot] : 0));
+    }
+}
+
 bool
 Ipv4TLB::PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR)
 {
@@ -1323,9 +1350,10 @@ Ipv4TLB::PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR)
 bool
 Ipv4TLB::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
 {
-    std::map<Ipv4Address, uint32_t>::iterator torItr = m_ipTorMap.find (daddr);
+    std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator torItr =
+        std::lower_bound (m_ipTorMap.begin (), m_ipTorMap.end (), std::make_pair (daddr, 0u), Ipv4TLB::AddressLess);
 
-    if (torItr == m_ipTorMap.end ())
+    if (torItr == m_ipTorMap.end () || torItr->first != daddr)
     {
         return false;
     }
@@ -1333,91 +1361,180 @@ Ipv4TLB::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
     return true;
 }
 
-void
-Ipv4TLB::PathAging (void)
+bool
+Ipv4TLB::AddressLess (const std::pair<Ipv4Address, uint32_t> &l, const std::pair<Ipv4Address, uint32_t> &r)
 {
-    NS_LOG_LOGIC (this << " Path Info: " << (Simulator::Now ()));
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
-    {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        NS_LOG_LOGIC ("\t" << " Size: " << (itr->second).size
-                           << " ECN Size: " << (itr->second).ecnSize
-                           << " Min RTT: " << (itr->second).minRtt
-                           << " Is Retransmission: " << (itr->second).isRetransmission
-                           << " Is HRetransmission: " << (itr->second).isHighRetransmission
-                           << " Is Timeout: " << (itr->second).isTimeout
-                           << " Is VTimeout: " << (itr->second).isVeryTimeout
-                           << " Is ProbingTimeout: " << (itr->second).isProbingTimeout
-                           << " Flow Counter: " << (itr->second).flowCounter);
-        if (Simulator::Now() - (itr->second).timeStamp1 > m_T1)
-        {
-            (itr->second).size = 1;
-            (itr->second).ecnSize = 0;
-            (itr->second).isTimeout = false;
-            (itr->second).timeStamp1 = Simulator::Now ();
-        }
-        if (Simulator::Now () - (itr->second).timeStamp2 > m_T2)
+    return l.first < r.first;
+}
+
+const Ipv4TLB::TLBDestTor *
+Ipv4TLB::FindDestTor (uint32_t destTor) const
+{
+    if (destTor >= m_destTors.size () || m_destTors[destTor].availPaths.empty ())
+    {
+        return 0;
+    }
+    return &m_destTors[destTor];
+}
+
+Ipv4TLB::TLBDestTor &
+Ipv4TLB::GetDestTor (uint32_t destTor)
+{
+    if (destTor >= m_destTors.size ())
+    {
+        m_destTors.resize (destTor + 1);
+    }
+    return m_destTors[destTor];
+}
+
+uint32_t
+Ipv4TLB::GetPathSlot (TLBDestTor &tor, uint32_t path)
+{
+    // A ToR only has a handful of parallel paths, a scan of the ids is cheaper than a map
+    for (uint32_t slot = 0; slot < tor.pathIds.size (); slot++)
+    {
+        if (tor.pathIds[slot] == path)
         {
-            (itr->second).isRetransmission = false;
-            (itr->second).isHighRetransmission = false;
-            (itr->second).isVeryTimeout = false;
-            (itr->second).isProbingTimeout = false;
-            (itr->second).timeStamp2 = Simulator::Now ();
+            return slot;
         }
-        if (Simulator::Now () - (itr->second).timeStamp3 > m_T1)
+    }
+    tor.pathIds.push_back (path);
+    tor.pathInfo.push_back (TLBPathInfo ());
+    tor.hasPathInfo.push_back (false);
+    return tor.pathIds.size () - 1;
+}
+
+TLBPathInfo *
+Ipv4TLB::FindPathInfo (uint32_t destTor, uint32_t path)
+{
+    if (destTor >= m_destTors.size ())
+    {
+        return 0;
+    }
+        TLBDestTor &tor = m_destTors[destTor];
+        for (uint32_t slot = 0; slot < tor.pathIds.size (); slot++)
         {
-            if (m_isSmooth)
+            if (tor.pathIds[slot] == path)
             {
-                Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
-                if ((itr->second).minRtt < desiredRtt)
-                {
-                    (itr->second).minRtt = std::min (desiredRtt, (itr->second).minRtt * m_smoothBeta1 / SMOOTH_BASE);
-                }
-                else
-                {
-                    (itr->second).minRtt = std::max (desiredRtt, (itr->second).minRtt * m_smoothBeta2 / SMOOTH_BASE);
-                }
+                return tor.hasPathInfo[slot] ? &tor.pathInfo[slot] : 0;
             }
-            else
-            {
-                (itr->second).minRtt = Seconds (666);
-            }
-            (itr->second).timeStamp3 = Simulator::Now ();
         }
+        return 0;
+    }
 
-        /*
-        if (Simulator::Now () - (itr->second).epTimeStamp > m_epAgingTime)
+    TLBPathInfo &
+    Ipv4TLB::GetPathInfo (uint32_t destTor, uint32_t path)
+    {
+        TLBDestTor &tor = Ipv4TLB::GetDestTor (destTor);
+        uint32_t slot = Ipv4TLB::GetPathSlot (tor, path);
+        if (!tor.hasPathInfo[slot])
         {
-            (itr->second).epAckSize = 1;
-            (itr->second).epEcnSize = 0;
-            (itr->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr->second).epTimeStamp = Simulator::Now ();
+            tor.pathInfo[slot] = Ipv4TLB::GetInitPathInfo (path);
+            tor.hasPathInfo[slot] = true;
         }
-        */
+        return tor.pathInfo[slot];
+    }
+
+void
+Ipv4TLB::RunAging (void)
+{
+    while (m_agingTimer.IsExpired ())
+    {
+        Ipv4TLB::PathAging (m_agingTimer.Expire ());
     }
 
-    std::map<uint32_t, TLBFlowInfo>::iterator itr2 = m_flowInfo.begin ();
-    for ( ; itr2 != m_flowInfo.end (); ++itr2)
+    while (m_dreTimer.IsExpired ())
     {
-        if (Simulator::Now () - (itr2->second).liveTime >= m_flowDieTime)
+        m_dreTimer.Expire ();
+        if (!Ipv4TLB::DreAging ())
         {
-            Ipv4TLB::RemoveFlowFromPath ((itr2->second).flowId, (itr2->second).destTor, (itr2->second).path);
-            m_flowInfo.erase (itr2);
+            m_dreTimer.ExpireAll ();
         }
+    }
+}
 
-        /*
-        else if (Simulator::Now () - (itr2->second).epTimeStamp > m_epAgingTime)
+    void
+    Ipv4TLB::PathAging (Time now)
+    {
+        NS_LOG_LOGIC (this << " Path Info: " << now);
+        for (uint32_t destTor = 0; destTor < m_destTors.size (); destTor++)
+        {
+        TLBDestTor &tor = m_destTors[destTor];
+        for (uint32_t slot = 0; slot < tor.pathIds.size (); slot++)
         {
-            (itr2->second).epAckSize = 1;
-            (itr2->second).epEcnSize = 0;
-            (itr2->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr2->second).epTimeStamp = Simulator::Now ();
+            if (!tor.hasPathInfo[slot])
+            {
+                continue;
+            }
+            TLBPathInfo &pathInfo = tor.pathInfo[slot];
+            NS_LOG_LOGIC ("<" << destTor << "," << tor.pathIds[slot] << ">");
+            NS_LOG_LOGIC ("\t" << " Size: " << pathInfo.size
+                               << " ECN Size: " << pathInfo.ecnSize
+                               << " Min RTT: " << pathInfo.minRtt
+                               << " Is Retransmission: " << pathInfo.isRetransmission
+                               << " Is HRetransmission: " << pathInfo.isHighRetransmission
+                               << " Is Timeout: " << pathInfo.isTimeout
+                               << " Is VTimeout: " << pathInfo.isVeryTimeout
+                               << " Is ProbingTimeout: " << pathInfo.isProbingTimeout
+                               << " Flow Counter: " << pathInfo.flowCounter);
+            if (now - pathInfo.timeStamp1 > m_T1)
+            {
+                pathInfo.size = 1;
+                pathInfo.ecnSize = 0;
+                pathInfo.isTimeout = false;
+                pathInfo.timeStamp1 = now;
+            }
+            if (now - pathInfo.timeStamp2 > m_T2)
+            {
+                pathInfo.isRetransmission = false;
+                pathInfo.isHighRetransmission = false;
+                pathInfo.isVeryTimeout = false;
+                pathInfo.isProbingTimeout = false;
+                pathInfo.timeStamp2 = now;
+            }
+            if (now - pathInfo.timeStamp3 > m_T1)
+            {
+                if (m_isSmooth)
+                {
+                    Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
+                    if (pathInfo.minRtt < desiredRtt)
+                    {
+                        pathInfo.minRtt = std::min (desiredRtt, pathInfo.minRtt * m_smoothBeta1 / SMOOTH_BASE);
+                    }
+                    else
+                    {
+                        pathInfo.minRtt = std::max (desiredRtt, pathInfo.minRtt * m_smoothBeta2 / SMOOTH_BASE);
+                    }
+                }
+                else
+                {
+                    pathInfo.minRtt = Seconds (666);
+                }
+                pathInfo.timeStamp3 = now;
+            }
+
+            /*
+            if (now - pathInfo.epTimeStamp > m_epAgingTime)
+            {
+                pathInfo.epAckSize = 1;
+                pathInfo.epEcnSize = 0;
+                pathInfo.epEcnPortion = m_epDefaultEcnPortion;
+                pathInfo.epTimeStamp = now;
+            }
+            */
         }
-        */
     }
 
-    m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
+    // The aging list is sorted by live time, the dead flows are at its front
+    uint32_t flowHandle = m_flowInfo.GetOldest ();
+    while (flowHandle != TLBFlowTable<TLBFlowInfo>::NONE
+            && now - m_flowInfo.Get (flowHandle).liveTime >= m_flowDieTime)
+    {
+        const TLBFlowInfo &flowInfo = m_flowInfo.Get (flowHandle);
+        Ipv4TLB::RemoveFlowFromPath (flowInfo.flowId, flowInfo.destTor, flowInfo.path);
+        m_flowInfo.Remove (flowHandle);
+        flowHandle = m_flowInfo.GetOldest ();
+    }
 }
 
 std::vector<PathInfo>
@@ -1425,33 +1542,39 @@ Ipv4TLB::GatherParallelPaths (uint32_t destTor)
 {
     std::vector<PathInfo> paths;
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    const TLBDestTor *tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor == 0)
     {
         return paths;
     }
 
-    std::vector<uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr )
-    {
-        paths.push_back(Ipv4TLB::JudgePath ((itr->first), *innerItr));
-    }
+    Ipv4TLB::JudgePaths (*tor);
+    paths = m_judgedPaths;
 
     return paths;
 }
 
-void
+bool
 Ipv4TLB::DreAging (void)
 {
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
+    bool active = false;
+    for (uint32_t destTor = 0; destTor < m_destTors.size (); destTor++)
     {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        (itr->second).dreValue *= (1 - m_dreAlpha);
-        NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre ((itr->second).dreValue));
+        TLBDestTor &tor = m_destTors[destTor];
+        for (uint32_t slot = 0; slot < tor.pathIds.size (); slot++)
+        {
+            if (!tor.hasPathInfo[slot])
+            {
+                continue;
+            }
+            NS_LOG_LOGIC ("<" << destTor << "," << tor.pathIds[slot] << ">");
+            tor.pathInfo[slot].dreValue *= (1 - m_dreAlpha);
+            NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre (tor.pathInfo[slot].dreValue));
+            active = active || tor.pathInfo[slot].dreValue != 0;
+        }
     }
 
-    m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
+    return active;
 }
 
 uint32_t
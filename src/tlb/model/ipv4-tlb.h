@@ -7,9 +7,12 @@
 #include "ns3/traced-value.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/data-rate.h"
-#include "ns3/event-id.h"
+#include "ns3/lazy-timer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-path-selector.h"
 #include "tlb-flow-info.h"
 #include "tlb-path-info.h"
+#include "tlb-flow-table.h"
 
 #include <vector>
 #include <map>
@@ -48,7 +51,7 @@ struct TLBAcklet {
 
 class Node;
 
-class Ipv4TLB : public Object
+class Ipv4TLB : public Object, public Ipv4PathSelector
 {
 
 public:
@@ -66,17 +69,17 @@ public:
     std::vector<uint32_t> GetAvailPath (Ipv4Address daddr);
 
     // These methods are used for TCP flows
-    uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
+    virtual uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
 
     uint32_t GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
 
     Time GetPauseTime (uint32_t flowId);
 
-    void FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt);
+    virtual void FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt);
 
-    void FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t size, bool isRetrasmission);
+    virtual void FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t size, bool isRetrasmission);
 
-    void FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path);
+    virtual void FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path);
 
     void FlowFinish (uint32_t flowId, Ipv4Address daddr);
 
@@ -90,12 +93,31 @@ public:
     // Node
     void SetNode (Ptr<Node> node);
 
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model. Return the number of streams that have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams (int64_t stream);
+
     static std::string GetPathType (PathType type);
 
     static std::string GetLogo (void);
 
 private:
 
+    // The paths towards a destination ToR, the state of each path is stored at the slot of the path
+    struct TLBDestTor
+    {
+        std::vector<uint32_t> availPaths;   // The available path ids, in the order they have been added
+        std::vector<uint32_t> availSlots;   // The slot of each available path
+        std::vector<uint32_t> pathIds;      // The path id of each slot
+        std::vector<TLBPathInfo> pathInfo;  // The path state of each slot
+        std::vector<bool> hasPathInfo;      // Whether the path state of the slot has been created
+    };
+
     void PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
                         uint32_t size, bool withECN, Time rtt, bool isProbing);
 
@@ -129,13 +151,39 @@ private:
 
     struct PathInfo JudgePath (uint32_t destTor, uint32_t path);
 
+    struct PathInfo JudgePathInfo (uint32_t path, const TLBPathInfo *pathInfo);
+
+    // Judge all the available paths of the ToR into m_judgedPaths
+    void JudgePaths (const TLBDestTor &tor);
+
     bool PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR);
 
     bool FindTorId (Ipv4Address daddr, uint32_t &destTorId);
 
-    void PathAging (void);
+    static bool AddressLess (const std::pair<Ipv4Address, uint32_t> &l, const std::pair<Ipv4Address, uint32_t> &r);
+
+    // The ToR if it has available paths, 0 otherwise
+    const TLBDestTor *FindDestTor (uint32_t destTor) const;
+
+    TLBDestTor &GetDestTor (uint32_t destTor);
+
+    uint32_t GetPathSlot (TLBDestTor &tor, uint32_t path);
 
-    void DreAging (void);
+    // The path state if it has been created, 0 otherwise
+    TLBPathInfo *FindPathInfo (uint32_t destTor, uint32_t path);
+
+    // The path state, created with its initial value if needed
+    TLBPathInfo &GetPathInfo (uint32_t destTor, uint32_t path);
+
+    // Run the path aging and the DRE decays due since the previous call, the
+    // path state is only used by the public methods, thus each of them runs
+    // the due updates first instead of scheduling an event every period
+    void RunAging (void);
+
+    void PathAging (Time now);
+
+    // Returns false if all the DRE values are zero, the next decays can then be skipped
+    bool DreAging (void);
 
     std::vector<PathInfo> GatherParallelPaths (uint32_t destTor);
 
@@ -216,25 +264,30 @@ private:
     // --
 
     // Variables
-    std::map<uint32_t, TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo> m_pathInfo; /* <DestTorId, PathId>, TLBPathInfo> */
+    TLBFlowTable<TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
 
-    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+    std::vector<TLBDestTor> m_destTors; /* Indexed by DestTorId, available paths and path state */
 
-    std::map<Ipv4Address, uint32_t> m_ipTorMap; /* <DestAddress, DestTorId> */
+    TLBFlowTable<TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
 
-    std::map<uint32_t, std::vector<uint32_t> > m_availablePath; /* <DestTorId, List<PathId>> */
+    std::vector<std::pair<Ipv4Address, uint32_t> > m_ipTorMap; /* <DestAddress, DestTorId>, sorted by address */
 
     std::map<uint32_t, Ipv4Address> m_probingAgent; /* <DestTorId, ProbingAgentAddress>*/
 
-    EventId m_agingEvent;
+    LazyTimer m_agingTimer;
 
-    EventId m_dreEvent;
+    LazyTimer m_dreTimer;
 
     Ptr<Node> m_node;
 
     std::map<uint32_t, Time> m_pauseTime; // Used in the TCP pause, not mandatory
 
+    Ptr<UniformRandomVariable> m_rand; // Used in the random path selection and the path change possibility
+
+    // Scratch space of the path selection, kept to avoid allocating on every decision
+    std::vector<PathInfo> m_judgedPaths;
+    std::vector<PathInfo> m_candidatePaths;
+
     typedef void (* TLBPathCallback) (uint32_t flowId, uint32_t fromTor,
             uint32_t toTor, uint32_t path, bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
 
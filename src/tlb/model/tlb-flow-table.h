@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_FLOW_TABLE_H
+#define TLB_FLOW_TABLE_H
+
+#include "ns3/hash-murmur3.h"
+#include "ns3/assert.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * The per-flow state of TLB, keyed by flow id.
+ *
+ * The entries live in a slab and are reused once removed, they are found
+ * through an open-addressing (linear probing) index. A handle to an entry
+ * stays valid until the entry is removed, a reference returned by Get only
+ * until the next Insert.
+ *
+ * The entries are also chained in an aging list: Insert and Refresh move an
+ * entry to the back, so that when the owner refreshes an entry each time it
+ * updates its live time, the list stays sorted by live time and the expired
+ * entries are found at the front without visiting the others.
+ */
+template <typename T>
+class TLBFlowTable
+{
+public:
+  static const uint32_t NONE = 0xffffffff;
+
+  TLBFlowTable ();
+
+  /**
+   * \return the handle of the flow, NONE if the flow is not in the table
+   */
+  uint32_t Find (uint32_t flowId) const;
+
+  /**
+   * \return the handle of the flow, added with a value initialized state if
+   * it was not in the table, in both cases moved to the back of the aging list
+   */
+  uint32_t Insert (uint32_t flowId);
+
+  void Remove (uint32_t handle);
+
+  T & Get (uint32_t handle);
+  const T & Get (uint32_t handle) const;
+
+  /**
+   * Move the entry to the back of the aging list
+   */
+  void Refresh (uint32_t handle);
+
+  /**
+   * \return the handle at the front of the aging list, NONE if the table is empty
+   */
+  uint32_t GetOldest (void) const;
+
+  uint32_t GetSize (void) const;
+
+private:
+  struct Entry
+  {
+    uint32_t flowId;
+    uint32_t prev;
+    uint32_t next;
+    T value;
+  };
+
+  uint32_t Home (uint32_t flowId) const;
+  uint32_t FindIndex (uint32_t flowId) const;
+  void Rehash (uint32_t capacity);
+  void Unlink (uint32_t handle);
+  void PushBack (uint32_t handle);
+
+  std::vector<Entry> m_entries;       //!< The slab
+  std::vector<uint32_t> m_freeEntries;
+  std::vector<uint32_t> m_index;      //!< Open-addressing index, handles or NONE
+  uint32_t m_mask;
+  uint32_t m_size;
+  uint32_t m_head;                    //!< The oldest entry
+  uint32_t m_tail;                    //!< The newest entry
+};
+
+template <typename T>
+const uint32_t TLBFlowTable<T>::NONE;
+
+template <typename T>
+TLBFlowTable<T>::TLBFlowTable ()
+  : m_mask (0),
+    m_size (0),
+    m_head (NONE),
+    m_tail (NONE)
+{
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::Home (uint32_t flowId) const
+{
+  return Hash::Function::Murmur3::Fmix32 (flowId) & m_mask;
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::FindIndex (uint32_t flowId) const
+{
+  if (m_index.empty ())
+    {
+      return NONE;
+    }
+  for (uint32_t i = Home (flowId); m_index[i] != NONE; i = (i + 1) & m_mask)
+    {
+      if (m_entries[m_index[i]].flowId == flowId)
+        {
+          return i;
+        }
+    }
+  return NONE;
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::Find (uint32_t flowId) const
+{
+  uint32_t i = FindIndex (flowId);
+  return i == NONE ? NONE : m_index[i];
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::Insert (uint32_t flowId)
+{
+  uint32_t handle = Find (flowId);
+  if (handle != NONE)
+    {
+      Refresh (handle);
+      return handle;
+    }
+
+  // Keep the index at most half full so that the probe sequences stay short
+  if (2 * (m_size + 1) > m_index.size ())
+    {
+      Rehash (m_index.empty () ? 64 : 2 * m_index.size ());
+    }
+
+  if (m_freeEntries.empty ())
+    {
+      handle = m_entries.size ();
+      m_entries.push_back (Entry ());
+    }
+  else
+    {
+      handle = m_freeEntries.back ();
+      m_freeEntries.pop_back ();
+    }
+  Entry &entry = m_entries[handle];
+  entry.flowId = flowId;
+  entry.value = T ();
+
+  uint32_t i = Home (flowId);
+  while (m_index[i] != NONE)
+    {
+      i = (i + 1) & m_mask;
+    }
+  m_index[i] = handle;
+  m_size++;
+
+  PushBack (handle);
+  return handle;
+}
+
+template <typename T>
+void
+TLBFlowTable<T>::Remove (uint32_t handle)
+{
+  NS_ASSERT (handle < m_entries.size ());
+  uint32_t i = FindIndex (m_entries[handle].flowId);
+  NS_ASSERT (i != NONE && m_index[i] == handle);
+
+  Unlink (handle);
+  m_freeEntries.push_back (handle);
+  m_size--;
+
+  // Backward shift deletion: move back the following entries of the probe
+  // sequence whose home is not between the hole and their position
+  m_index[i] = NONE;
+  for (uint32_t j = (i + 1) & m_mask; m_index[j] != NONE; j = (j + 1) & m_mask)
+    {
+      uint32_t home = Home (m_entries[m_index[j]].flowId);
+      if (((j - home) & m_mask) >= ((j - i) & m_mask))
+        {
+          m_index[i] = m_index[j];
+          m_index[j] = NONE;
+          i = j;
+        }
+    }
+}
+
+template <typename T>
+T &
+TLBFlowTable<T>::Get (uint32_t handle)
+{
+  NS_ASSERT (handle < m_entries.size ());
+  return m_entries[handle].value;
+}
+
+template <typename T>
+const T &
+TLBFlowTable<T>::Get (uint32_t handle) const
+{
+  NS_ASSERT (handle < m_entries.size ());
+  return m_entries[handle].value;
+}
+
+template <typename T>
+void
+TLBFlowTable<T>::Refresh (uint32_t handle)
+{
+  if (handle == m_tail)
+    {
+      return;
+    }
+  Unlink (handle);
+  PushBack (handle);
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::GetOldest (void) const
+{
+  return m_head;
+}
+
+template <typename T>
+uint32_t
+TLBFlowTable<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+void
+TLBFlowTable<T>::Rehash (uint32_t capacity)
+{
+  m_index.assign (capacity, NONE);
+  m_mask = capacity - 1;
+  for (uint32_t handle = m_head; handle != NONE; handle = m_entries[handle].next)
+    {
+      uint32_t i = Home (m_entries[handle].flowId);
+      while (m_index[i] != NONE)
+        {
+          i = (i + 1) & m_mask;
+        }
+      m_index[i] = handle;
+    }
+}
+
+template <typename T>
+void
+TLBFlowTable<T>::Unlink (uint32_t handle)
+{
+  Entry &entry = m_entries[handle];
+  if (entry.prev == NONE)
+    {
+      m_head = entry.next;
+    }
+  else
+    {
+      m_entries[entry.prev].next = entry.next;
+    }
+  if (entry.next == NONE)
+    {
+      m_tail = entry.prev;
+    }
+  else
+    {
+      m_entries[entry.next].prev = entry.prev;
+    }
+}
+
+template <typename T>
+void
+TLBFlowTable<T>::PushBack (uint32_t handle)
+{
+  Entry &entry = m_entries[handle];
+  entry.prev = m_tail;
+  entry.next = NONE;
+  if (m_tail == NONE)
+    {
+      m_head = handle;
+    }
+  else
+    {
+      m_entries[m_tail].next = handle;
+    }
+  m_tail = handle;
+}
+
+} // namespace ns3
+
+#endif /* TLB_FLOW_TABLE_H */
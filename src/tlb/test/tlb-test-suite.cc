@@ -2,6 +2,7 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-tlb.h"
+#include "ns3/tlb-flow-table.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +47,66 @@ TlbTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// The flow table finds, removes and ages flows across the growth of its index
+class TlbFlowTableTestCase : public TestCase
+{
+public:
+  TlbFlowTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbFlowTableTestCase::TlbFlowTableTestCase ()
+  : TestCase ("TLB flow table lookup, removal and aging order")
+{
+}
+
+void
+TlbFlowTableTestCase::DoRun (void)
+{
+  TLBFlowTable<TLBAcklet> table;
+  NS_TEST_ASSERT_MSG_EQ (table.GetOldest (), TLBFlowTable<TLBAcklet>::NONE, "A new table should be empty");
+
+  // Enough flows to grow the index several times
+  const uint32_t flows = 1000;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      table.Get (table.Insert (i * 7919)).pathId = i;
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), flows, "All the flows should be in the table");
+
+  // Remove every other flow, the backward shift deletion should keep the others reachable
+  for (uint32_t i = 0; i < flows; i += 2)
+    {
+      table.Remove (table.Find (i * 7919));
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), flows / 2, "Half of the flows should have been removed");
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      uint32_t handle = table.Find (i * 7919);
+      if (i % 2 == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (handle, TLBFlowTable<TLBAcklet>::NONE, "Flow " << i << " should have been removed");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_NE (handle, TLBFlowTable<TLBAcklet>::NONE, "Flow " << i << " should still be found");
+          NS_TEST_ASSERT_MSG_EQ (table.Get (handle).pathId, i, "Flow " << i << " has lost its state");
+        }
+    }
+
+  // The aging list follows the insertion order, refreshed flows go to the back
+  NS_TEST_ASSERT_MSG_EQ (table.Get (table.GetOldest ()).pathId, 1, "Flow 1 should be the oldest");
+  table.Refresh (table.Find (1 * 7919));
+  NS_TEST_ASSERT_MSG_EQ (table.Get (table.GetOldest ()).pathId, 3, "Flow 3 should be the oldest once 1 is refreshed");
+
+  // A reinserted flow starts from a clean state and reuses a free entry
+  uint32_t handle = table.Insert (0);
+  NS_TEST_ASSERT_MSG_EQ (table.Get (handle).pathId, 0, "A new flow should start from a clean state");
+  NS_TEST_EXPECT_MSG_EQ (table.GetSize (), flows / 2 + 1, "The flow should have been added");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +122,7 @@ TlbTestSuite::TlbTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new TlbTestCase1, TestCase::QUICK);
+  AddTestCase (new TlbFlowTableTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -24,6 +24,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/shared-buffer-pool.h"
 #include "traffic-control-helper.h"
 
 namespace ns3 {
@@ -47,6 +48,12 @@ QueueDiscFactory::AddPacketFilter (ObjectFactory factory)
   m_packetFiltersFactory.push_back (factory);
 }
 
+void
+QueueDiscFactory::AddAqmPolicy (ObjectFactory factory)
+{
+  m_aqmPoliciesFactory.push_back (factory);
+}
+
 uint16_t
 QueueDiscFactory::AddQueueDiscClass (ObjectFactory factory)
 {
@@ -82,6 +89,13 @@ QueueDiscFactory::CreateQueueDisc (const std::vector<Ptr<QueueDisc> > & queueDis
       qd->AddPacketFilter (i->Create<PacketFilter> ());
     }
 
+  // create and add the AQM policies
+  for (std::vector<ObjectFactory>::iterator i = m_aqmPoliciesFactory.begin ();
+       i != m_aqmPoliciesFactory.end (); i++ )
+    {
+      qd->AddAqmPolicy (i->Create<AqmPolicy> ());
+    }
+
   // create and add the queue disc classes
   for (uint32_t i = 0; i < m_queueDiscClassesFactory.size (); i++)
     {
@@ -102,6 +116,7 @@ QueueDiscFactory::CreateQueueDisc (const std::vector<Ptr<QueueDisc> > & queueDis
 
 
 TrafficControlHelper::TrafficControlHelper ()
+  : m_useSharedBuffer (false)
 {
 }
 
@@ -217,6 +232,34 @@ TrafficControlHelper::AddPacketFilter (uint16_t handle, std::string type,
   m_queueDiscFactory[handle].AddPacketFilter (factory);
 }
 
+void
+TrafficControlHelper::AddAqmPolicy (uint16_t handle, std::string type,
+                                    std::string n01, const AttributeValue& v01,
+                                    std::string n02, const AttributeValue& v02,
+                                    std::string n03, const AttributeValue& v03,
+                                    std::string n04, const AttributeValue& v04,
+                                    std::string n05, const AttributeValue& v05,
+                                    std::string n06, const AttributeValue& v06,
+                                    std::string n07, const AttributeValue& v07,
+                                    std::string n08, const AttributeValue& v08)
+{
+  NS_ABORT_MSG_IF (handle >= m_queueDiscFactory.size (), "A queue disc with handle "
+                   << handle << " does not exist");
+
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set (n01, v01);
+  factory.Set (n02, v02);
+  factory.Set (n03, v03);
+  factory.Set (n04, v04);
+  factory.Set (n05, v05);
+  factory.Set (n06, v06);
+  factory.Set (n07, v07);
+  factory.Set (n08, v08);
+
+  m_queueDiscFactory[handle].AddAqmPolicy (factory);
+}
+
 TrafficControlHelper::ClassIdList
 TrafficControlHelper::AddQueueDiscClasses (uint16_t handle, uint16_t count, std::string type,
                                            std::string n01, const AttributeValue& v01,
@@ -329,6 +372,20 @@ TrafficControlHelper::AddChildQueueDiscs (uint16_t handle, const TrafficControlH
   return list;
 }
 
+void
+TrafficControlHelper::SetSharedBuffer (std::string n01, const AttributeValue& v01,
+                                       std::string n02, const AttributeValue& v02,
+                                       std::string n03, const AttributeValue& v03,
+                                       std::string n04, const AttributeValue& v04)
+{
+  m_useSharedBuffer = true;
+  m_sharedBufferFactory.SetTypeId ("ns3::SharedBufferPool");
+  m_sharedBufferFactory.Set (n01, v01);
+  m_sharedBufferFactory.Set (n02, v02);
+  m_sharedBufferFactory.Set (n03, v03);
+  m_sharedBufferFactory.Set (n04, v04);
+}
+
 QueueDiscContainer
 TrafficControlHelper::Install (Ptr<NetDevice> d)
 {
@@ -355,6 +412,12 @@ TrafficControlHelper::Install (Ptr<NetDevice> d)
   // Set the root queue disc on the device
   tc->SetRootQueueDiscOnDevice (d, m_queueDiscs[0]);
 
+  // Create the node-level shared buffer, unless the node already has one
+  if (m_useSharedBuffer && tc->GetSharedBuffer () == 0)
+    {
+      tc->SetSharedBuffer (m_sharedBufferFactory.Create<SharedBufferPool> ());
+    }
+
   return container;
 }
 
@@ -63,6 +63,13 @@ public:
    */
   void AddPacketFilter (ObjectFactory factory);
 
+  /**
+   * \brief Add a factory to create an AQM policy
+   *
+   * \param factory the factory used to create an AQM policy
+   */
+  void AddAqmPolicy (ObjectFactory factory);
+
   /**
    * \brief Add a factory to create a queue disc class
    *
@@ -101,6 +108,8 @@ private:
   std::vector<ObjectFactory> m_internalQueuesFactory;
   /// Vector of factories to create packet filters
   std::vector<ObjectFactory> m_packetFiltersFactory;
+  /// Vector of factories to create AQM policies
+  std::vector<ObjectFactory> m_aqmPoliciesFactory;
   /// Vector of factories to create queue disc classes
   std::vector<ObjectFactory> m_queueDiscClassesFactory;
   /// Map storing the associations between class IDs and child queue disc handles
@@ -257,6 +266,41 @@ public:
                         std::string n07 = "", const AttributeValue &v07 = EmptyAttributeValue (),
                         std::string n08 = "", const AttributeValue &v08 = EmptyAttributeValue ());
 
+  /**
+   * Helper function used to add an AQM policy (of the given type and with
+   * the given attributes) to the tail of the chain of policies of the queue disc
+   * having the given handle. E.g., call it on the handles returned by
+   * AddChildQueueDiscs to have every class of a DWRR queue disc run the policy.
+   *
+   * \param handle the handle of the queue disc
+   * \param type the type of AQM policy
+   * \param n01 the name of the attribute to set on the AQM policy
+   * \param v01 the value of the attribute to set on the AQM policy
+   * \param n02 the name of the attribute to set on the AQM policy
+   * \param v02 the value of the attribute to set on the AQM policy
+   * \param n03 the name of the attribute to set on the AQM policy
+   * \param v03 the value of the attribute to set on the AQM policy
+   * \param n04 the name of the attribute to set on the AQM policy
+   * \param v04 the value of the attribute to set on the AQM policy
+   * \param n05 the name of the attribute to set on the AQM policy
+   * \param v05 the value of the attribute to set on the AQM policy
+   * \param n06 the name of the attribute to set on the AQM policy
+   * \param v06 the value of the attribute to set on the AQM policy
+   * \param n07 the name of the attribute to set on the AQM policy
+   * \param v07 the value of the attribute to set on the AQM policy
+   * \param n08 the name of the attribute to set on the AQM policy
+   * \param v08 the value of the attribute to set on the AQM policy
+   */
+  void AddAqmPolicy (uint16_t handle, std::string type,
+                     std::string n01 = "", const AttributeValue &v01 = EmptyAttributeValue (),
+                     std::string n02 = "", const AttributeValue &v02 = EmptyAttributeValue (),
+                     std::string n03 = "", const AttributeValue &v03 = EmptyAttributeValue (),
+                     std::string n04 = "", const AttributeValue &v04 = EmptyAttributeValue (),
+                     std::string n05 = "", const AttributeValue &v05 = EmptyAttributeValue (),
+                     std::string n06 = "", const AttributeValue &v06 = EmptyAttributeValue (),
+                     std::string n07 = "", const AttributeValue &v07 = EmptyAttributeValue (),
+                     std::string n08 = "", const AttributeValue &v08 = EmptyAttributeValue ());
+
   typedef std::vector<uint16_t> ClassIdList;
 
   /**
@@ -410,6 +454,25 @@ public:
                                  std::string n14 = "", const AttributeValue &v14 = EmptyAttributeValue (),
                                  std::string n15 = "", const AttributeValue &v15 = EmptyAttributeValue ());
 
+  /**
+   * Helper function used to make the root queue discs installed by this helper
+   * draw from a buffer shared by all the root queue discs of the node. A
+   * SharedBufferPool with the given attributes is created for every node that
+   * does not have one yet; nodes that already have one keep it.
+   * \param n01 the name of the attribute to set on the shared buffer
+   * \param v01 the value of the attribute to set on the shared buffer
+   * \param n02 the name of the attribute to set on the shared buffer
+   * \param v02 the value of the attribute to set on the shared buffer
+   * \param n03 the name of the attribute to set on the shared buffer
+   * \param v03 the value of the attribute to set on the shared buffer
+   * \param n04 the name of the attribute to set on the shared buffer
+   * \param v04 the value of the attribute to set on the shared buffer
+   */
+  void SetSharedBuffer (std::string n01 = "", const AttributeValue &v01 = EmptyAttributeValue (),
+                        std::string n02 = "", const AttributeValue &v02 = EmptyAttributeValue (),
+                        std::string n03 = "", const AttributeValue &v03 = EmptyAttributeValue (),
+                        std::string n04 = "", const AttributeValue &v04 = EmptyAttributeValue ());
+
   /**
    * \param c set of devices
    * \returns a QueueDisc container with the queue discs installed on the devices
@@ -455,6 +518,10 @@ private:
   std::vector<QueueDiscFactory> m_queueDiscFactory;
   /// Vector of all the created queue discs
   std::vector<Ptr<QueueDisc> > m_queueDiscs;
+  /// Whether the installed root queue discs draw from a node-level shared buffer
+  bool m_useSharedBuffer;
+  /// Factory to create the node-level shared buffer
+  ObjectFactory m_sharedBufferFactory;
 };
 
 } // namespace ns3
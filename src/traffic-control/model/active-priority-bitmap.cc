@@ -0,0 +1,90 @@
+#include "active-priority-bitmap.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+const uint32_t ActivePriorityBitmap::NONE;
+
+ActivePriorityBitmap::ActivePriorityBitmap ()
+    : m_nActive (0)
+{
+}
+
+bool
+ActivePriorityBitmap::AddPriority (uint32_t priority)
+{
+    std::vector<uint32_t>::iterator itr = std::lower_bound (m_priorities.begin (), m_priorities.end (), priority);
+    if (itr != m_priorities.end () && *itr == priority)
+    {
+        return false;
+    }
+    NS_ASSERT_MSG (m_nActive == 0, "Cannot add a priority while some levels are active");
+    m_priorities.insert (itr, priority);
+    m_words.resize ((m_priorities.size () + 63) / 64, 0);
+    return true;
+}
+
+uint32_t
+ActivePriorityBitmap::GetLevel (uint32_t priority) const
+{
+    std::vector<uint32_t>::const_iterator itr = std::lower_bound (m_priorities.begin (), m_priorities.end (), priority);
+    NS_ASSERT_MSG (itr != m_priorities.end () && *itr == priority, "Unknown priority " << priority);
+    return itr - m_priorities.begin ();
+}
+
+uint32_t
+ActivePriorityBitmap::GetNLevels (void) const
+{
+    return m_priorities.size ();
+}
+
+void
+ActivePriorityBitmap::SetActive (uint32_t level)
+{
+    NS_ASSERT (level < m_priorities.size ());
+    uint64_t bit = static_cast<uint64_t> (1) << (level % 64);
+    if ((m_words[level / 64] & bit) == 0)
+    {
+        m_words[level / 64] |= bit;
+        m_nActive++;
+    }
+}
+
+void
+ActivePriorityBitmap::SetInactive (uint32_t level)
+{
+    NS_ASSERT (level < m_priorities.size ());
+    uint64_t bit = static_cast<uint64_t> (1) << (level % 64);
+    if ((m_words[level / 64] & bit) != 0)
+    {
+        m_words[level / 64] &= ~bit;
+        m_nActive--;
+    }
+}
+
+uint32_t
+ActivePriorityBitmap::GetHighest (void) const
+{
+    if (m_nActive == 0)
+    {
+        return NONE;
+    }
+    for (uint32_t i = m_words.size (); i-- > 0; )
+    {
+        if (m_words[i] != 0)
+        {
+            return i * 64 + 63 - __builtin_clzll (m_words[i]);
+        }
+    }
+    return NONE;
+}
+
+bool
+ActivePriorityBitmap::IsEmpty (void) const
+{
+    return m_nActive == 0;
+}
+
+} // namespace ns3
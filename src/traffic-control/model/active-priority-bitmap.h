@@ -0,0 +1,59 @@
+#ifndef ACTIVE_PRIORITY_BITMAP_H
+#define ACTIVE_PRIORITY_BITMAP_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * The strict priority core shared by the multi-class queue discs.
+ *
+ * The priorities of the classes are arbitrary numbers, the higher the
+ * better. They are mapped to dense levels (0 for the lowest registered
+ * priority) and a bit per level tells whether any class of that level has
+ * packets, so that the highest active level is found with a find-first-set
+ * on a few words instead of a scan of the classes.
+ */
+class ActivePriorityBitmap
+{
+public:
+    static const uint32_t NONE = 0xffffffff;
+
+    ActivePriorityBitmap ();
+
+    /**
+     * Register a priority. Registering a new priority shifts the levels of
+     * the higher priorities, thus it must happen while no level is active.
+     * \return true if the priority was not registered yet
+     */
+    bool AddPriority (uint32_t priority);
+
+    /**
+     * \return the level of a registered priority
+     */
+    uint32_t GetLevel (uint32_t priority) const;
+
+    uint32_t GetNLevels (void) const;
+
+    void SetActive (uint32_t level);
+    void SetInactive (uint32_t level);
+
+    /**
+     * \return the highest active level, NONE if no level is active
+     */
+    uint32_t GetHighest (void) const;
+
+    bool IsEmpty (void) const;
+
+private:
+    std::vector<uint32_t> m_priorities; //!< Registered priorities, sorted
+    std::vector<uint64_t> m_words;
+    uint32_t m_nActive;                 //!< Number of active levels
+};
+
+} // namespace ns3
+
+#endif
@@ -0,0 +1,442 @@
+#include "aqm-policy.h"
+#include "queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AqmPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (AqmPolicy);
+
+TypeId
+AqmPolicy::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::AqmPolicy")
+        .SetParent<Object> ()
+        .SetGroupName ("TrafficControl")
+        .AddAttribute ("Action", "The verdict of the policy on congestion",
+                        EnumValue (AqmPolicy::MARK),
+                        MakeEnumAccessor (&AqmPolicy::m_action),
+                        MakeEnumChecker (AqmPolicy::MARK, "MARK",
+                                         AqmPolicy::MARK_OR_DROP, "MARK_OR_DROP",
+                                         AqmPolicy::DROP, "DROP"))
+    ;
+    return tid;
+}
+
+AqmPolicy::AqmPolicy (bool onEnqueue, bool onDequeue)
+    : m_action (MARK),
+      m_onEnqueue (onEnqueue),
+      m_onDequeue (onDequeue)
+{
+    NS_LOG_FUNCTION (this << onEnqueue << onDequeue);
+}
+
+AqmPolicy::~AqmPolicy ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+bool
+AqmPolicy::IsEnqueuePolicy (void) const
+{
+    return m_onEnqueue;
+}
+
+bool
+AqmPolicy::IsDequeuePolicy (void) const
+{
+    return m_onDequeue;
+}
+
+AqmPolicy::Verdict
+AqmPolicy::Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes)
+{
+    return PASS;
+}
+
+AqmPolicy::Verdict
+AqmPolicy::Dequeue (Ptr<const QueueDiscItem> item, Time sojourn)
+{
+    return PASS;
+}
+
+int64_t
+AqmPolicy::AssignStreams (int64_t stream)
+{
+    return 0;
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (SojournThresholdPolicy);
+
+TypeId
+SojournThresholdPolicy::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::SojournThresholdPolicy")
+        .SetParent<AqmPolicy> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<SojournThresholdPolicy> ()
+        .AddAttribute ("Threshold", "The sojourn time above which the packets are marked",
+                        StringValue ("20us"),
+                        MakeTimeAccessor (&SojournThresholdPolicy::m_threshold),
+                        MakeTimeChecker ())
+    ;
+    return tid;
+}
+
+SojournThresholdPolicy::SojournThresholdPolicy ()
+    : AqmPolicy (false, true)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+SojournThresholdPolicy::~SojournThresholdPolicy ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (CoDelLawPolicy);
+
+TypeId
+CoDelLawPolicy::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::CoDelLawPolicy")
+        .SetParent<AqmPolicy> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<CoDelLawPolicy> ()
+        .AddAttribute ("Interval", "The time the sojourn time has to stay above the target before marking",
+                        StringValue ("100us"),
+                        MakeTimeAccessor (&CoDelLawPolicy::m_interval),
+                        MakeTimeChecker ())
+        .AddAttribute ("Target", "The sojourn time target",
+                        StringValue ("10us"),
+                        MakeTimeAccessor (&CoDelLawPolicy::m_target),
+                        MakeTimeChecker ())
+    ;
+    return tid;
+}
+
+CoDelLawPolicy::CoDelLawPolicy ()
+    : AqmPolicy (false, true),
+      m_firstAboveTime (0),
+      m_marking (false),
+      m_markNext (0),
+      m_markCount (0)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+CoDelLawPolicy::~CoDelLawPolicy ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+AqmPolicy::Verdict
+CoDelLawPolicy::Dequeue (Ptr<const QueueDiscItem> item, Time sojourn)
+{
+    NS_LOG_FUNCTION (this << item << sojourn);
+
+    Time now = Simulator::Now ();
+    bool okToMark = OkToMark (sojourn, now);
+
+    if (m_marking)
+    {
+        if (!okToMark)
+        {
+            m_marking = false;
+        }
+        else if (now >= m_markNext)
+        {
+            m_markCount++;
+            m_markNext = now + ControlLaw ();
+            return m_action;
+        }
+    }
+    else if (okToMark)
+    {
+        m_marking = true;
+        m_markCount = 1;
+        m_markNext = now + m_interval;
+        return m_action;
+    }
+
+    return PASS;
+}
+
+bool
+CoDelLawPolicy::OkToMark (Time sojourn, Time now)
+{
+    if (sojourn < m_target)
+    {
+        m_firstAboveTime = Time (0);
+        return false;
+    }
+
+    if (m_firstAboveTime == Time (0))
+    {
+        m_firstAboveTime = now + m_interval;
+    }
+    else if (now > m_firstAboveTime)
+    {
+        return true;
+    }
+    return false;
+}
+
+Time
+CoDelLawPolicy::ControlLaw (void) const
+{
+    uint64_t timeStep = m_interval.GetTimeStep ();
+    timeStep = static_cast<uint64_t> (timeStep / sqrt (static_cast<double> (m_markCount)));
+    return TimeStep (timeStep);
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (RedPolicy);
+
+TypeId
+RedPolicy::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::RedPolicy")
+        .SetParent<AqmPolicy> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<RedPolicy> ()
+        .AddAttribute ("Mode", "Whether the thresholds are in bytes or packets",
+                        EnumValue (Queue::QUEUE_MODE_PACKETS),
+                        MakeEnumAccessor (&RedPolicy::m_mode),
+                        MakeEnumChecker (Queue::QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                                         Queue::QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+        .AddAttribute ("MinTh", "The average queue length above which the packets may be marked",
+                        DoubleValue (5),
+                        MakeDoubleAccessor (&RedPolicy::m_minTh),
+                        MakeDoubleChecker<double> ())
+        .AddAttribute ("MaxTh", "The average queue length above which every packet is marked",
+                        DoubleValue (15),
+                        MakeDoubleAccessor (&RedPolicy::m_maxTh),
+                        MakeDoubleChecker<double> ())
+        .AddAttribute ("MaxP", "The marking probability at MaxTh",
+                        DoubleValue (0.02),
+                        MakeDoubleAccessor (&RedPolicy::m_maxP),
+                        MakeDoubleChecker<double> (0.0, 1.0))
+        .AddAttribute ("QW", "The weight of the queue length in the average",
+                        DoubleValue (0.002),
+                        MakeDoubleAccessor (&RedPolicy::m_weight),
+                        MakeDoubleChecker<double> (0.0, 1.0))
+    ;
+    return tid;
+}
+
+RedPolicy::RedPolicy ()
+    : AqmPolicy (true, false),
+      m_average (0.0)
+{
+    NS_LOG_FUNCTION (this);
+    m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+RedPolicy::~RedPolicy ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+RedPolicy::DoDispose (void)
+{
+    NS_LOG_FUNCTION (this);
+    m_uv = 0;
+    AqmPolicy::DoDispose ();
+}
+
+AqmPolicy::Verdict
+RedPolicy::Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes)
+{
+    NS_LOG_FUNCTION (this << item << nPackets << nBytes);
+
+    // The queue length the packet finds
+    double queueLength = m_mode == Queue::QUEUE_MODE_PACKETS ? nPackets - 1 : nBytes - item->GetPacketSize ();
+    m_average = (1 - m_weight) * m_average + m_weight * queueLength;
+
+    if (m_average < m_minTh)
+    {
+        return PASS;
+    }
+    if (m_average >= m_maxTh)
+    {
+        NS_LOG_LOGIC ("Average queue length " << m_average << " above MaxTh");
+        return m_action;
+    }
+
+    double p = m_maxP * (m_average - m_minTh) / (m_maxTh - m_minTh);
+    return m_uv->GetValue () < p ? m_action : PASS;
+}
+
+int64_t
+RedPolicy::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_uv->SetStream (stream);
+    return 1;
+}
+
+double
+RedPolicy::GetAverageQueueLength (void) const
+{
+    return m_average;
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (PieProbabilityPolicy);
+
+TypeId
+PieProbabilityPolicy::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::PieProbabilityPolicy")
+        .SetParent<AqmPolicy> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<PieProbabilityPolicy> ()
+        .AddAttribute ("A", "Value of alpha",
+                        DoubleValue (0.125),
+                        MakeDoubleAccessor (&PieProbabilityPolicy::m_a),
+                        MakeDoubleChecker<double> ())
+        .AddAttribute ("B", "Value of beta",
+                        DoubleValue (1.25),
+                        MakeDoubleAccessor (&PieProbabilityPolicy::m_b),
+                        MakeDoubleChecker<double> ())
+        .AddAttribute ("Tupdate", "Time period to calculate the probability",
+                        TimeValue (Seconds (0.03)),
+                        MakeTimeAccessor (&PieProbabilityPolicy::m_tUpdate),
+                        MakeTimeChecker ())
+        .AddAttribute ("QueueDelayReference", "Desired queue delay",
+                        TimeValue (Seconds (0.02)),
+                        MakeTimeAccessor (&PieProbabilityPolicy::m_qDelayRef),
+                        MakeTimeChecker ())
+    ;
+    return tid;
+}
+
+PieProbabilityPolicy::PieProbabilityPolicy ()
+    : AqmPolicy (true, true),
+      m_probability (0.0),
+      m_qDelay (0),
+      m_qDelayOld (0),
+      m_nextUpdate (0)
+{
+    NS_LOG_FUNCTION (this);
+    m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+PieProbabilityPolicy::~PieProbabilityPolicy ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+PieProbabilityPolicy::DoDispose (void)
+{
+    NS_LOG_FUNCTION (this);
+    m_uv = 0;
+    AqmPolicy::DoDispose ();
+}
+
+AqmPolicy::Verdict
+PieProbabilityPolicy::Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes)
+{
+    NS_LOG_FUNCTION (this << item << nPackets << nBytes);
+
+    Time now = Simulator::Now ();
+    if (nPackets == 1)
+    {
+        // The queue was empty, the last sojourn time is stale
+        m_qDelay = Time (0);
+    }
+
+    // Catch up with the updates due since the last packet
+    while (now >= m_nextUpdate)
+    {
+        if (m_probability == 0 && m_qDelay.IsZero () && m_qDelayOld.IsZero ())
+        {
+            // Nothing would change until the next packet
+            int64_t missed = (now - m_nextUpdate).GetTimeStep () / m_tUpdate.GetTimeStep ();
+            m_nextUpdate += TimeStep ((missed + 1) * m_tUpdate.GetTimeStep ());
+            break;
+        }
+        UpdateProbability ();
+        m_nextUpdate += m_tUpdate;
+    }
+
+    if (m_qDelayOld.GetSeconds () < 0.5 * m_qDelayRef.GetSeconds () && m_probability < 0.2)
+    {
+        return PASS;
+    }
+    if (nPackets <= 2)
+    {
+        return PASS;
+    }
+    return m_uv->GetValue () < m_probability ? m_action : PASS;
+}
+
+AqmPolicy::Verdict
+PieProbabilityPolicy::Dequeue (Ptr<const QueueDiscItem> item, Time sojourn)
+{
+    m_qDelay = sojourn;
+    return PASS;
+}
+
+void
+PieProbabilityPolicy::UpdateProbability (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    double alpha = m_a;
+    double beta = m_b;
+    if (m_probability < 0.01)
+    {
+        alpha = m_a / 8;
+        beta = m_b / 8;
+    }
+    else if (m_probability < 0.1)
+    {
+        alpha = m_a / 2;
+        beta = m_b / 2;
+    }
+
+    double p = m_probability + alpha * (m_qDelay.GetSeconds () - m_qDelayRef.GetSeconds ())
+        + beta * (m_qDelay.GetSeconds () - m_qDelayOld.GetSeconds ());
+
+    // For non-linear drop in prob
+    if (m_qDelay.IsZero () && m_qDelayOld.IsZero ())
+    {
+        p *= 0.98;
+    }
+    else if (m_qDelay.GetSeconds () > 0.2)
+    {
+        p += 0.02;
+    }
+
+    m_probability = (p > 0) ? p : 0;
+    m_qDelayOld = m_qDelay;
+}
+
+int64_t
+PieProbabilityPolicy::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_uv->SetStream (stream);
+    return 1;
+}
+
+double
+PieProbabilityPolicy::GetProbability (void) const
+{
+    return m_probability;
+}
+
+}
@@ -0,0 +1,244 @@
+#ifndef AQM_POLICY_H
+#define AQM_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/queue.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+class QueueDiscItem;
+
+/**
+ * \ingroup traffic-control
+ *
+ * AqmPolicy is the base class of the marking and dropping policies that any
+ * queue disc can chain (see QueueDisc::AddAqmPolicy), so that an AQM does not
+ * need a queue disc subclass of its own and can be attached, e.g., to every
+ * child queue disc of a DWRR or WFQ queue disc.
+ *
+ * A policy is consulted on enqueue, on dequeue or on both and returns a
+ * verdict. The queue disc evaluates every policy of the chain, so that each one
+ * keeps its state up to date, and applies the most severe verdict once:
+ *
+ * - PASS: the packet goes on untouched
+ * - MARK: the packet is marked if it is ECN capable, otherwise it goes on
+ * - MARK_OR_DROP: the packet is marked if it is ECN capable, otherwise it is dropped
+ * - DROP: the packet is dropped
+ *
+ * The Action attribute sets the verdict a policy returns on congestion.
+ */
+class AqmPolicy : public Object
+{
+public:
+    enum Verdict
+    {
+        PASS = 0,
+        MARK = 1,
+        MARK_OR_DROP = 2,
+        DROP = 3
+    };
+
+    static TypeId GetTypeId (void);
+
+    virtual ~AqmPolicy ();
+
+    /**
+     * @return true if the policy is consulted when a packet is enqueued
+     */
+    bool IsEnqueuePolicy (void) const;
+
+    /**
+     * @return true if the policy is consulted when a packet is dequeued
+     */
+    bool IsDequeuePolicy (void) const;
+
+    /**
+     * Consult the policy on the enqueue of a packet
+     * @param item the packet
+     * @param nPackets the packets in the queue disc, this one included
+     * @param nBytes the bytes in the queue disc, this one included
+     * @return the verdict
+     */
+    virtual Verdict Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes);
+
+    /**
+     * Consult the policy on the dequeue of a packet
+     * @param item the packet
+     * @param sojourn the time the packet spent in the queue disc
+     * @return the verdict
+     */
+    virtual Verdict Dequeue (Ptr<const QueueDiscItem> item, Time sojourn);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this policy, if any
+     * @param stream first stream index to use
+     * @return the number of stream indices assigned
+     */
+    virtual int64_t AssignStreams (int64_t stream);
+
+protected:
+    /**
+     * @param onEnqueue whether the policy is consulted on enqueue
+     * @param onDequeue whether the policy is consulted on dequeue
+     */
+    AqmPolicy (bool onEnqueue, bool onDequeue);
+
+    Verdict m_action;           //!< The verdict on congestion
+
+private:
+    bool m_onEnqueue;
+    bool m_onDequeue;
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * Mark the packets whose sojourn time exceeds a threshold, as TCN does.
+ */
+class SojournThresholdPolicy : public AqmPolicy
+{
+public:
+    static TypeId GetTypeId (void);
+
+    SojournThresholdPolicy ();
+
+    virtual ~SojournThresholdPolicy ();
+
+    virtual Verdict Dequeue (Ptr<const QueueDiscItem> item, Time sojourn)
+    {
+        return sojourn > m_threshold ? m_action : PASS;
+    }
+
+private:
+    Time m_threshold;
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * Mark the packets with the CoDel control law: once the sojourn time has stayed
+ * above Target for Interval, mark a packet and then the packets dequeued after
+ * Interval / sqrt (count), until the sojourn time goes below Target.
+ */
+class CoDelLawPolicy : public AqmPolicy
+{
+public:
+    static TypeId GetTypeId (void);
+
+    CoDelLawPolicy ();
+
+    virtual ~CoDelLawPolicy ();
+
+    virtual Verdict Dequeue (Ptr<const QueueDiscItem> item, Time sojourn);
+
+private:
+    /**
+     * Whether the sojourn time has been above the target for an interval
+     * @param sojourn the sojourn time of the packet
+     * @param now the current time
+     * @return true if the packets should be marked
+     */
+    bool OkToMark (Time sojourn, Time now);
+
+    Time ControlLaw (void) const;
+
+    Time m_interval;
+    Time m_target;
+
+    Time m_firstAboveTime;          //!< The time the sojourn time has to stay above the target until
+    bool m_marking;                 //!< Whether the policy is in the marking state
+    Time m_markNext;                //!< The time of the next mark
+    uint32_t m_markCount;           //!< The number of marks since entering the marking state
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * Mark the packets with a probability growing linearly from 0 to MaxP while the
+ * average queue length, an EWMA of the queue length on enqueue, goes from MinTh
+ * to MaxTh, and every packet beyond MaxTh, as RED does without the gentle mode
+ * and the idle period correction.
+ */
+class RedPolicy : public AqmPolicy
+{
+public:
+    static TypeId GetTypeId (void);
+
+    RedPolicy ();
+
+    virtual ~RedPolicy ();
+
+    virtual Verdict Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes);
+
+    virtual int64_t AssignStreams (int64_t stream);
+
+    /**
+     * @return the average queue length
+     */
+    double GetAverageQueueLength (void) const;
+
+protected:
+    virtual void DoDispose (void);
+
+private:
+    Queue::QueueMode m_mode;
+    double m_minTh;
+    double m_maxTh;
+    double m_maxP;
+    double m_weight;
+
+    double m_average;
+    Ptr<UniformRandomVariable> m_uv;
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * Mark the packets with the PIE probability, updated every Tupdate from the
+ * sojourn time of the last dequeued packet. The updates are done lazily, when
+ * the next packet is enqueued, so the policy schedules no event.
+ */
+class PieProbabilityPolicy : public AqmPolicy
+{
+public:
+    static TypeId GetTypeId (void);
+
+    PieProbabilityPolicy ();
+
+    virtual ~PieProbabilityPolicy ();
+
+    virtual Verdict Enqueue (Ptr<const QueueDiscItem> item, uint32_t nPackets, uint32_t nBytes);
+
+    virtual Verdict Dequeue (Ptr<const QueueDiscItem> item, Time sojourn);
+
+    virtual int64_t AssignStreams (int64_t stream);
+
+    /**
+     * @return the current probability
+     */
+    double GetProbability (void) const;
+
+protected:
+    virtual void DoDispose (void);
+
+private:
+    void UpdateProbability (void);
+
+    double m_a;
+    double m_b;
+    Time m_tUpdate;
+    Time m_qDelayRef;
+
+    double m_probability;
+    Time m_qDelay;                  //!< The sojourn time of the last dequeued packet
+    Time m_qDelayOld;               //!< The queue delay at the previous update
+    Time m_nextUpdate;
+    Ptr<UniformRandomVariable> m_uv;
+};
+
+}
+
+#endif
@@ -32,8 +32,6 @@
 #include "codel-queue-disc.h"
 #include "ns3/object-factory.h"
 #include "ns3/drop-tail-queue.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/ipv4-queue-disc-item.h"
 
 namespace ns3 {
 
@@ -66,86 +64,6 @@ static uint32_t CoDelGetTime (void)
   return ns >> CODEL_SHIFT;
 }
 
-/**
- * CoDel time stamp, used to carry CoDel time informations.
- */
-class CoDelTimestampTag : public Tag
-{
-public:
-  CoDelTimestampTag ();
-  /**
-   * \brief Get the type ID.
-   * \return the object TypeId
-   */
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-  virtual void Print (std::ostream &os) const;
-
-  /**
-   * Gets the Tag creation time
-   * @return the time object stored in the tag
-   */
-  Time GetTxTime (void) const;
-private:
-  uint64_t m_creationTime; //!< Tag creation time
-};
-
-CoDelTimestampTag::CoDelTimestampTag ()
-  : m_creationTime (Simulator::Now ().GetTimeStep ())
-{
-}
-
-TypeId
-CoDelTimestampTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("ns3::CoDelTimestampTag")
-    .SetParent<Tag> ()
-    .AddConstructor<CoDelTimestampTag> ()
-    .AddAttribute ("CreationTime",
-                   "The time at which the timestamp was created",
-                   StringValue ("0.0s"),
-                   MakeTimeAccessor (&CoDelTimestampTag::GetTxTime),
-                   MakeTimeChecker ())
-  ;
-  return tid;
-}
-
-TypeId
-CoDelTimestampTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-
-uint32_t
-CoDelTimestampTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void
-CoDelTimestampTag::Serialize (TagBuffer i) const
-{
-  i.WriteU64 (m_creationTime);
-}
-void
-CoDelTimestampTag::Deserialize (TagBuffer i)
-{
-  m_creationTime = i.ReadU64 ();
-}
-void
-CoDelTimestampTag::Print (std::ostream &os) const
-{
-  os << "CreationTime=" << m_creationTime;
-}
-Time
-CoDelTimestampTag::GetTxTime (void) const
-{
-  return TimeStep (m_creationTime);
-}
-
 NS_OBJECT_ENSURE_REGISTERED (CoDelQueueDisc);
 
 TypeId CoDelQueueDisc::GetTypeId (void)
@@ -283,7 +201,6 @@ bool
 CoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  Ptr<Packet> p = item->GetPacket ();
 
   if (m_mode == Queue::QUEUE_MODE_PACKETS && (GetInternalQueue (0)->GetNPackets () + 1 > m_maxPackets))
     {
@@ -301,10 +218,6 @@ CoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       return false;
     }
 
-  // Tag packet with current time for DoDequeue() to compute sojourn time
-  CoDelTimestampTag tag;
-  p->AddPacketTag (tag);
-
   GetInternalQueue (0)->Enqueue (item);
 
   NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
@@ -314,16 +227,12 @@ CoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 }
 
 bool
-CoDelQueueDisc::OkToDrop (Ptr<Packet> p, uint32_t now)
+CoDelQueueDisc::OkToDrop (Ptr<QueueDiscItem> item, uint32_t now)
 {
   NS_LOG_FUNCTION (this);
-  CoDelTimestampTag tag;
   bool okToDrop;
 
-  bool found = p->RemovePacketTag (tag);
-  NS_ASSERT_MSG (found, "found a packet without an input timestamp tag");
-  NS_UNUSED (found);    //silence compiler warning
-  Time delta = Simulator::Now () - tag.GetTxTime ();
+  Time delta = Simulator::Now () - item->GetTimeStamp ();
   NS_LOG_INFO ("Sojourn time " << delta.GetSeconds ());
   m_sojourn = delta;
   uint32_t sojournTime = Time2CoDel (delta);
@@ -377,7 +286,7 @@ CoDelQueueDisc::DoDequeue (void)
   NS_LOG_LOGIC ("Number bytes remaining " << GetInternalQueue (0)->GetNBytes ());
 
   // Determine if p should be dropped
-  bool okToDrop = OkToDrop (p, now);
+  bool okToDrop = OkToDrop (item, now);
 
   if (m_dropping)
     { // In the dropping state (sojourn time has gone above target and hasn't come down yet)
@@ -407,7 +316,7 @@ CoDelQueueDisc::DoDequeue (void)
               if (m_markingMode)
               {
                   NS_LOG_LOGIC ("Marking mode is on. We will mark ECN instead of dropping the packet");
-                  if (!MarkingECN (item))
+                  if (!Mark (item))
                   {
                     NS_LOG_ERROR ("Cannot marking ECN");
                     ++m_states;
@@ -449,7 +358,7 @@ CoDelQueueDisc::DoDequeue (void)
                 NS_LOG_LOGIC ("Number bytes remaining " << GetInternalQueue (0)->GetNBytes ());
               }
 
-              if (!m_markingMode && !OkToDrop (p, now))
+              if (!m_markingMode && !OkToDrop (item, now))
                 {
                   /* leave dropping state */
                   NS_LOG_LOGIC ("Leaving dropping state");
@@ -484,7 +393,7 @@ CoDelQueueDisc::DoDequeue (void)
           if (m_markingMode)
           {
               NS_LOG_LOGIC ("Marking mode is on. We will mark ECN instead of dropping the packet");
-              if (!MarkingECN (item))
+              if (!Mark (item))
               {
                   NS_LOG_ERROR ("Cannot marking ECN");
                   return item;
@@ -523,7 +432,7 @@ CoDelQueueDisc::DoDequeue (void)
                 NS_LOG_LOGIC ("Number packets remaining " << GetInternalQueue (0)->GetNPackets ());
                 NS_LOG_LOGIC ("Number bytes remaining " << GetInternalQueue (0)->GetNBytes ());
 
-                okToDrop = OkToDrop (p, now);
+                okToDrop = OkToDrop (item, now);
               }
               m_dropping = true;
             }
@@ -715,30 +624,5 @@ CoDelQueueDisc::InitializeParams (void)
   NS_LOG_FUNCTION (this);
 }
 
-bool
-CoDelQueueDisc::MarkingECN (Ptr<QueueDiscItem> item)
-{
-  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-  if (ipv4Item == 0)
-  {
-    NS_LOG_ERROR ("Cannot convert the queue disc item to ipv4 queue disc item");
-    return false;
-  }
-
-  Ipv4Header header = ipv4Item -> GetHeader ();
-
-  if (header.GetEcn () != Ipv4Header::ECN_ECT1)
-  {
-    NS_LOG_ERROR ("Cannot mark because the ECN field is not ECN_ECT1");
-    return false;
-  }
-
-  header.SetEcn(Ipv4Header::ECN_CE);
-  ipv4Item->SetHeader(header);
-
-  return true;
-
-}
-
 } // namespace ns3
 
@@ -1,25 +1,42 @@
 #include "ns3/log.h"
+#include "ns3/uinteger.h"
 #include "dwrr-queue-disc.h"
-#include "ns3/ipv4-queue-disc-item.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DWRRQueueDisc");
 
+NS_OBJECT_ENSURE_REGISTERED (DWRRClass);
 NS_OBJECT_ENSURE_REGISTERED (DWRRQueueDisc);
 
 TypeId
 DWRRClass::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::DWRRClass")
-      .SetParent<Object> ()
+      .SetParent<QueueDiscClass> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<DWRRClass> ()
+      .AddAttribute ("Priority",
+                     "The strict priority of the class, the higher the better",
+                     UintegerValue (0),
+                     MakeUintegerAccessor (&DWRRClass::priority),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("Quantum",
+                     "The bytes the class may send per round",
+                     UintegerValue (1500),
+                     MakeUintegerAccessor (&DWRRClass::quantum),
+                     MakeUintegerChecker<uint32_t> (1))
     ;
     return tid;
 }
 
 DWRRClass::DWRRClass ()
+    : priority (0),
+      quantum (1500),
+      deficit (0),
+      level (0),
+      next (0),
+      prev (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -28,7 +45,7 @@ TypeId
 DWRRQueueDisc::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::DWRRQueueDisc")
-      .SetParent<Object> ()
+      .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<DWRRQueueDisc> ()
     ;
@@ -56,11 +73,70 @@ void
 DWRRQueueDisc::AddDWRRClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority, uint32_t quantum)
 {
     Ptr<DWRRClass> dwrrClass = CreateObject<DWRRClass> ();
+    dwrrClass->SetQueueDisc (qdisc);
     dwrrClass->priority = priority;
-    dwrrClass->qdisc = qdisc;
     dwrrClass->quantum = quantum;
-    dwrrClass->deficit = 0;
+    AddClass (dwrrClass, cl);
+}
+
+void
+DWRRQueueDisc::AddClass (Ptr<DWRRClass> dwrrClass, int32_t cl)
+{
+    NS_ASSERT_MSG (GetNPackets () == 0, "Cannot add a DWRR class while packets are queued");
+
     m_DWRRs[cl] = dwrrClass;
+    AddChildQueueDisc (dwrrClass->GetQueueDisc ());
+
+    m_priorities.AddPriority (dwrrClass->priority);
+    m_rings.assign (m_priorities.GetNLevels (), 0);
+    std::map<int32_t, Ptr<DWRRClass> >::iterator itr = m_DWRRs.begin ();
+    for ( ; itr != m_DWRRs.end (); ++itr)
+    {
+        itr->second->level = m_priorities.GetLevel (itr->second->priority);
+    }
+}
+
+void
+DWRRQueueDisc::Activate (DWRRClass *dwrrClass)
+{
+    DWRRClass *&head = m_rings[dwrrClass->level];
+    if (head == 0)
+    {
+        dwrrClass->next = dwrrClass;
+        dwrrClass->prev = dwrrClass;
+        head = dwrrClass;
+        m_priorities.SetActive (dwrrClass->level);
+    }
+    else
+    {
+        // The tail of the ring is just before the head
+        dwrrClass->next = head;
+        dwrrClass->prev = head->prev;
+        head->prev->next = dwrrClass;
+        head->prev = dwrrClass;
+    }
+}
+
+void
+DWRRQueueDisc::Deactivate (DWRRClass *dwrrClass)
+{
+    DWRRClass *&head = m_rings[dwrrClass->level];
+    if (dwrrClass->next == dwrrClass)
+    {
+        head = 0;
+        m_priorities.SetInactive (dwrrClass->level);
+    }
+    else
+    {
+        dwrrClass->prev->next = dwrrClass->next;
+        dwrrClass->next->prev = dwrrClass->prev;
+        if (head == dwrrClass)
+        {
+            head = dwrrClass->next;
+        }
+    }
+    dwrrClass->next = 0;
+    dwrrClass->prev = 0;
 }
 
 bool
@@ -86,15 +162,15 @@ DWRRQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
     NS_LOG_LOGIC ("Found class for the enqueued item: " << cl << " with priority: " << dwrrClass->priority);
 
-    if (!dwrrClass->qdisc->Enqueue (item))
+    if (!dwrrClass->GetQueueDisc ()->Enqueue (item))
     {
         Drop (item);
         return false;
     }
 
-    if (dwrrClass->qdisc->GetNPackets () == 1)
+    if (dwrrClass->GetQueueDisc ()->GetNPackets () == 1)
     {
-        m_active[dwrrClass->priority].push_back (dwrrClass);
+        Activate (PeekPointer (dwrrClass));
         dwrrClass->deficit = dwrrClass->quantum;
     }
 
@@ -106,69 +182,50 @@ DWRRQueueDisc::DoDequeue (void)
 {
     NS_LOG_FUNCTION (this);
 
-    Ptr<const QueueDiscItem> item = 0;
-
-    if (m_active.empty ())
-    {
-        NS_LOG_LOGIC ("Active map is empty");
-        return 0;
-    }
-
-    int32_t highestPriority = -1;
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > >::const_iterator itr = m_active.begin ();
-    for (; itr != m_active.end (); ++itr)
+    while (true)
     {
-        if (static_cast<int32_t>(itr->first) > highestPriority
-                && !(itr->second).empty ())
+        uint32_t level = m_priorities.GetHighest ();
+        if (level == ActivePriorityBitmap::NONE)
         {
-            highestPriority = static_cast<int32_t> (itr->first);
+            NS_LOG_LOGIC ("Cannot find active queue");
+            return 0;
         }
-    }
 
-    if (highestPriority == -1)
-    {
-        NS_LOG_LOGIC ("Cannot find active queue");
-        return 0;
-    }
+        DWRRClass *dwrrClass = m_rings[level];
 
-    while (true)
-    {
-        Ptr<DWRRClass> dwrrClass = m_active[highestPriority].front ();
-
-        item = dwrrClass->qdisc->Peek ();
+        Ptr<const QueueDiscItem> item = dwrrClass->GetQueueDisc ()->Peek ();
         if (item == 0)
         {
             NS_LOG_LOGIC ("Cannot peek from the internal queue disc");
             return 0;
         }
 
-        Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
-        if (ipv4Item == 0)
-        {
-            NS_LOG_ERROR ("Cannot convert to the Ipv4QueueDiscItem");
-            return 0;
-        }
-
-        uint32_t length = ipv4Item->GetPacketSize ();
+        int32_t length = item->GetPacketSize ();
 
         if (length <= dwrrClass->deficit)
         {
-            dwrrClass->deficit -= length;
-            Ptr<QueueDiscItem> retItem = dwrrClass->qdisc->Dequeue ();
-            if (retItem == 0)
+            Ptr<QueueDiscItem> retItem = dwrrClass->GetQueueDisc ()->Dequeue ();
+            // The child queue disc may drop packets while dequeuing, even all of them
+            if (dwrrClass->GetQueueDisc ()->GetNPackets () == 0)
+            {
+                Deactivate (dwrrClass);
+            }
+            else if (retItem == 0)
             {
                 return 0;
             }
-            if (dwrrClass->qdisc->GetNPackets () == 0)
+            if (retItem == 0)
             {
-                m_active[highestPriority].pop_front ();
+                continue;
             }
+            // The peeked packet may have been dropped, only the one sent is
+            // charged, overdrawing the deficit if it is larger
+            dwrrClass->deficit -= static_cast<int32_t> (retItem->GetPacketSize ());
             return retItem;
         }
 
         dwrrClass->deficit += dwrrClass->quantum;
-        m_active[highestPriority].pop_front ();
-        m_active[highestPriority].push_back (dwrrClass);
+        m_rings[level] = dwrrClass->next;
     }
 
     return 0;
@@ -179,38 +236,45 @@ DWRRQueueDisc::DoPeek (void) const
 {
     NS_LOG_FUNCTION (this);
 
-    if (m_active.empty ())
+    uint32_t level = m_priorities.GetHighest ();
+    if (level == ActivePriorityBitmap::NONE)
     {
-        NS_LOG_LOGIC ("Active map is empty");
+        NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
-    int32_t highestPriority = -1;
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > >::const_iterator itr = m_active.begin ();
-    for (; itr != m_active.end (); ++itr)
+    return m_rings[level]->GetQueueDisc ()->Peek ();
+}
+
+bool
+DWRRQueueDisc::CheckConfig (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    // The classes created by the helper are identified by their index
+    for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
     {
-        if (static_cast<int32_t>(itr->first) >= highestPriority
-                && !(itr->second).empty ())
+        Ptr<DWRRClass> dwrrClass = DynamicCast<DWRRClass> (GetQueueDiscClass (i));
+        if (dwrrClass == 0)
         {
-            highestPriority = static_cast<int32_t>(itr->first);
+            NS_LOG_ERROR ("The classes of DWRRQueueDisc must be DWRRClass");
+            return false;
         }
+        std::map<int32_t, Ptr<DWRRClass> >::iterator itr = m_DWRRs.find (i);
+        if (itr != m_DWRRs.end () && itr->second != dwrrClass)
+        {
+            NS_LOG_ERROR ("The class id " << i << " is used twice");
+            return false;
+        }
+        AddClass (dwrrClass, i);
     }
 
-    if (highestPriority == -1)
+    if (m_DWRRs.empty ())
     {
-        NS_LOG_LOGIC ("Cannot find active queue");
-        return 0;
+        NS_LOG_ERROR ("DWRRQueueDisc needs at least one class");
+        return false;
     }
 
-    Ptr<DWRRClass> dwrrClass = m_active.at (highestPriority).front ();
-
-    return dwrrClass->qdisc->Peek ();
-}
-
-bool
-DWRRQueueDisc::CheckConfig (void)
-{
-    NS_LOG_FUNCTION (this);
     return true;
 }
 
@@ -222,7 +286,7 @@ DWRRQueueDisc::InitializeParams (void)
     std::map<int32_t, Ptr<DWRRClass> >::iterator itr = m_DWRRs.begin ();
     for ( ; itr != m_DWRRs.end (); ++itr)
     {
-        itr->second->qdisc->Initialize ();
+        itr->second->GetQueueDisc ()->Initialize ();
     }
 
 }
@@ -2,11 +2,20 @@
 #define DWRR_QUEUE_DISC_H
 
 #include "ns3/queue-disc.h"
-#include <list>
+#include "active-priority-bitmap.h"
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
-class DWRRClass : public Object
+/**
+ * \ingroup traffic-control
+ *
+ * A class of the DWRR queue disc. The classes of the highest priority having
+ * packets are served in round robin, each one sending up to its quantum of
+ * bytes per round.
+ */
+class DWRRClass : public QueueDiscClass
 {
 public:
 
@@ -15,12 +24,41 @@ public:
     DWRRClass ();
 
     uint32_t priority;
-
-    Ptr<QueueDisc> qdisc;
     uint32_t quantum;
-    uint32_t deficit;
+    int32_t deficit;    //!< The bytes left to send in the round, negative once overdrawn
+
+    uint32_t level;     //!< The dense level of the priority
+    DWRRClass *next;    //!< Links in the round robin ring of the level while active
+    DWRRClass *prev;
 };
 
+/**
+ * \ingroup traffic-control
+ *
+ * Strict priority among the priority levels and deficit weighted round robin
+ * among the classes of a level, each class feeding its own child queue disc.
+ *
+ * The classes are either added with AddDWRRClass, under any class id, or
+ * created by a TrafficControlHelper as queue disc classes of type
+ * ns3::DWRRClass, whose class ids are their indices. For instance, 2 strict
+ * priority classes above 6 weighted ones, each with a TCN queue disc and
+ * selected by the DSCP of the packets:
+ *
+ * \code
+ *   TrafficControlHelper tc;
+ *   uint16_t handle = tc.SetRootQueueDisc ("ns3::DWRRQueueDisc");
+ *   tc.AddPacketFilter (handle, "ns3::Ipv4DscpPacketFilter",
+ *                       "DscpMap", StringValue ("46:0 48:1 10:2 18:3 26:4 34:5 8:6"),
+ *                       "DefaultClass", IntegerValue (7));
+ *   TrafficControlHelper::ClassIdList classes = tc.AddQueueDiscClasses (handle, 2, "ns3::DWRRClass",
+ *                                                                        "Priority", UintegerValue (1));
+ *   TrafficControlHelper::ClassIdList weighted = tc.AddQueueDiscClasses (handle, 6, "ns3::DWRRClass",
+ *                                                                         "Quantum", UintegerValue (3000));
+ *   classes.insert (classes.end (), weighted.begin (), weighted.end ());
+ *   tc.AddChildQueueDiscs (handle, classes, "ns3::TCNQueueDisc");
+ *   tc.Install (switchDevices);
+ * \endcode
+ */
 class DWRRQueueDisc : public QueueDisc
 {
 public:
@@ -42,10 +80,16 @@ private:
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
-    // The internal DWRR queue discs are first organized in a map
-    // with the priority as key and then in a linked list if they are
-    // with the same priority
-    std::map<uint32_t, std::list<Ptr<DWRRClass> > > m_active;
+    void AddClass (Ptr<DWRRClass> dwrrClass, int32_t cl);
+
+    void Activate (DWRRClass *dwrrClass);
+    void Deactivate (DWRRClass *dwrrClass);
+
+    // The active classes of each priority level are linked in a circular
+    // list whose head is the class being served, the levels with active
+    // classes are tracked in a bitmap
+    ActivePriorityBitmap m_priorities;
+    std::vector<DWRRClass *> m_rings;
     std::map<int32_t, Ptr<DWRRClass> > m_DWRRs;
 };
 
@@ -40,95 +40,12 @@
 #include "ns3/abort.h"
 #include "ns3/string.h"
 #include "ns3/drop-tail-queue.h"
-#include "ns3/ipv4-queue-disc-item.h"
 #include "pie-queue-disc.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PieQueueDisc");
 
-
-/**
- * PIE time stamp, used to carry PIE time informations.
- */
-class PieTimestampTag : public Tag
-{
-public:
-  PieTimestampTag ();
-  /**
-   * \brief Get the type ID.
-   * \return the object TypeId
-   */
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-  virtual void Print (std::ostream &os) const;
-
-  /**
-   * Gets the Tag creation time
-   * @return the time object stored in the tag
-   */
-  Time GetTxTime (void) const;
-private:
-  uint64_t m_creationTime; //!< Tag creation time
-};
-
-PieTimestampTag::PieTimestampTag ()
-  : m_creationTime (Simulator::Now ().GetTimeStep ())
-{
-}
-
-TypeId
-PieTimestampTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("ns3::PieTimestampTag")
-    .SetParent<Tag> ()
-    .AddConstructor<PieTimestampTag> ()
-    .AddAttribute ("CreationTime",
-                   "The time at which the timestamp was created",
-                   StringValue ("0.0s"),
-                   MakeTimeAccessor (&PieTimestampTag::GetTxTime),
-                   MakeTimeChecker ())
-  ;
-  return tid;
-}
-
-TypeId
-PieTimestampTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-
-uint32_t
-PieTimestampTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void
-PieTimestampTag::Serialize (TagBuffer i) const
-{
-  i.WriteU64 (m_creationTime);
-}
-void
-PieTimestampTag::Deserialize (TagBuffer i)
-{
-  m_creationTime = i.ReadU64 ();
-}
-void
-PieTimestampTag::Print (std::ostream &os) const
-{
-  os << "CreationTime=" << m_creationTime;
-}
-Time
-PieTimestampTag::GetTxTime (void) const
-{
-  return TimeStep (m_creationTime);
-}
-
-
 NS_OBJECT_ENSURE_REGISTERED (PieQueueDisc);
 
 TypeId PieQueueDisc::GetTypeId (void)
@@ -188,6 +105,11 @@ TypeId PieQueueDisc::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&PieQueueDisc::m_maxBurst),
                    MakeTimeChecker ())
+    .AddAttribute ("LazyUpdate",
+                   "Update the drop probability when packets are enqueued or dequeued instead of scheduling an event every Tupdate",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PieQueueDisc::m_lazyUpdate),
+                   MakeBooleanChecker ())
   ;
 
   return tid;
@@ -265,6 +187,7 @@ Time
 PieQueueDisc::GetQueueDelay (void)
 {
   NS_LOG_FUNCTION (this);
+  CatchUpP ();
   return m_qDelay;
 }
 
@@ -281,6 +204,8 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  CatchUpP ();
+
   uint32_t nQueued = GetQueueSize ();
 
   if ((GetMode () == Queue::QUEUE_MODE_PACKETS && nQueued >= m_queueLimit)
@@ -292,14 +217,10 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       return false;
     }
 
-  Ptr<Packet> p = item->GetPacket ();
-  PieTimestampTag tag;
-  p->AddPacketTag (tag);
-
   if (MarkingEarly (item, nQueued))
     {
       // Early probability drop: proactive
-      PieQueueDisc::MarkingECN (item);
+      Mark (item);
       m_stats.unforcedDrop++;
     }
 
@@ -328,6 +249,14 @@ PieQueueDisc::InitializeParams (void)
   m_qDelayOld = Time (Seconds (0));
   m_stats.forcedDrop = 0;
   m_stats.unforcedDrop = 0;
+
+  if (m_lazyUpdate)
+    {
+      // Take over the periodic updates from the next one on
+      m_updateTimer.SetPeriod (m_tUpdate);
+      m_updateTimer.Start (Simulator::GetDelayLeft (m_rtrsEvent));
+      Simulator::Remove (m_rtrsEvent);
+    }
 }
 
 bool PieQueueDisc::MarkingEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
@@ -386,6 +315,28 @@ bool PieQueueDisc::MarkingEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
 void PieQueueDisc::CalculateP ()
 {
   NS_LOG_FUNCTION (this);
+  UpdateP (Simulator::Now ());
+  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueueDisc::CalculateP, this);
+}
+
+void
+PieQueueDisc::CatchUpP (void)
+{
+  while (m_updateTimer.IsExpired ())
+    {
+      if (!BURST_ALLOWANCE_MODULE && GetInternalQueue (0)->IsEmpty ()
+          && m_qDelayOld.IsZero () && m_markingProb == 0)
+        {
+          m_updateTimer.ExpireAll ();
+          break;
+        }
+      UpdateP (m_updateTimer.Expire ());
+    }
+}
+
+void PieQueueDisc::UpdateP (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
   Time qDelay;
   double p = 0.0;
   bool missingInitFlag = false;
@@ -410,9 +361,7 @@ void PieQueueDisc::CalculateP ()
   }
   else
   {
-    PieTimestampTag timestamp;
-    item->GetPacket ()->PeekPacketTag (timestamp);
-    qDelay = Simulator::Now () - timestamp.GetTxTime ();
+    qDelay = now - item->GetTimeStamp ();
   }
 
   m_qDelay = qDelay;
@@ -536,7 +485,6 @@ void PieQueueDisc::CalculateP ()
     }
 
   m_qDelayOld = qDelay;
-  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueueDisc::CalculateP, this);
 }
 
 Ptr<QueueDiscItem>
@@ -544,6 +492,8 @@ PieQueueDisc::DoDequeue ()
 {
   NS_LOG_FUNCTION (this);
 
+  CatchUpP ();
+
   if (GetInternalQueue (0)->IsEmpty ())
     {
       NS_LOG_LOGIC ("Queue empty");
@@ -554,10 +504,6 @@ PieQueueDisc::DoDequeue ()
   double now = Simulator::Now ().GetSeconds ();
   uint32_t pktSize = item->GetPacketSize ();
 
-  Ptr<Packet> p = item->GetPacket ();
-  PieTimestampTag tag;
-  p->RemovePacketTag (tag);
-
   // if not in a measurement cycle and the queue has built up to dq_threshold,
   // start the measurement cycle
 
@@ -679,30 +625,4 @@ PieQueueDisc::CheckConfig (void)
   return true;
 }
 
-bool
-PieQueueDisc::MarkingECN (Ptr<QueueDiscItem> item)
-{
-  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-  if (ipv4Item == 0)
-  {
-    NS_LOG_ERROR ("Cannot convert the queue disc item to ipv4 queue disc item");
-    return false;
-  }
-
-  Ipv4Header header = ipv4Item -> GetHeader ();
-
-  if (header.GetEcn () != Ipv4Header::ECN_ECT1)
-  {
-    NS_LOG_ERROR ("Cannot mark because the ECN field is not ECN_ECT1");
-    return false;
-  }
-
-  header.SetEcn(Ipv4Header::ECN_CE);
-  ipv4Item->SetHeader(header);
-
-  return true;
-
-}
-
-
 } //namespace ns3
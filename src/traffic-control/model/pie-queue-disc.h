@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/timer.h"
+#include "ns3/lazy-timer.h"
 #include "ns3/event-id.h"
 #include "ns3/random-variable-stream.h"
 
@@ -171,7 +172,21 @@ private:
    */
   void CalculateP ();
 
-  bool MarkingECN (Ptr<QueueDiscItem> item);
+  /**
+   * \brief Update the drop probability as the periodic update at time now
+   * \param now the time of the update
+   */
+  void UpdateP (Time now);
+
+  /**
+   * \brief In lazy mode, run the updates due since the last enqueue or dequeue.
+   *
+   * The queue has not changed since then, thus each update sees the same
+   * queue as the periodic update would have seen at its time. Once the queue
+   * is empty and the probability has decayed to zero, the remaining updates
+   * would not change anything and are skipped at once.
+   */
+  void CatchUpP (void);
 
   Stats m_stats;                                //!< PIE statistics
 
@@ -186,6 +201,7 @@ private:
   double m_a;                                   //!< Parameter to pie controller
   double m_b;                                   //!< Parameter to pie controller
   uint32_t m_dqThreshold;                       //!< Minimum queue size in bytes before dequeue rate is measured
+  bool m_lazyUpdate;                            //!< Update the drop probability on enqueue and dequeue instead of with events
 
   // ** Variables maintained by PIE
   double m_markingProb;                         //!< Variable used in calculation of marking probability
@@ -199,6 +215,7 @@ private:
   double m_dqStart;                             //!< Start timestamp of current measurement cycle
   uint32_t m_dqCount;                           //!< Number of bytes departed since current measurement cycle starts
   EventId m_rtrsEvent;                          //!< Event used to decide the decision of interval of drop probability calculation
+  LazyTimer m_updateTimer;                      //!< The drop probability updates in lazy mode
   Ptr<UniformRandomVariable> m_uv;              //!< Rng stream
 };
 
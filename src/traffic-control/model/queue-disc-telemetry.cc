@@ -0,0 +1,181 @@
+#include "queue-disc-telemetry.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QueueDiscTelemetry");
+
+NS_OBJECT_ENSURE_REGISTERED (QueueDiscTelemetry);
+
+static const char TELEMETRY_MAGIC[8] = { 'Q', 'D', 'T', 'E', 'L', 'E', 'M', 1 };
+
+TypeId
+QueueDiscTelemetry::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::QueueDiscTelemetry")
+        .SetParent<Object> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<QueueDiscTelemetry> ()
+        .AddAttribute ("Capacity", "The number of samples of the ring buffer",
+                        UintegerValue (65536),
+                        MakeUintegerAccessor (&QueueDiscTelemetry::m_capacity),
+                        MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("FileName", "The file the samples are dumped to, empty to keep the last Capacity samples in memory",
+                        StringValue (""),
+                        MakeStringAccessor (&QueueDiscTelemetry::m_fileName),
+                        MakeStringChecker ())
+    ;
+    return tid;
+}
+
+QueueDiscTelemetry::QueueDiscTelemetry ()
+    : m_head (0),
+      m_nSamples (0),
+      m_nTotalSamples (0),
+      m_fileOpened (false)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+QueueDiscTelemetry::~QueueDiscTelemetry ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+QueueDiscTelemetry::DoDispose (void)
+{
+    NS_LOG_FUNCTION (this);
+    Flush ();
+    if (m_fileOpened)
+    {
+        m_file.close ();
+    }
+    Object::DoDispose ();
+}
+
+void
+QueueDiscTelemetry::Overflow (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    if (m_ring.empty ())
+    {
+        // The first record, so that a recorder which is never used costs nothing
+        m_ring.resize (m_capacity);
+        std::memset (&m_ring[0], 0, m_ring.size () * sizeof (QueueDiscTelemetrySample));
+        if (!m_fileName.empty ())
+        {
+            Simulator::ScheduleDestroy (&QueueDiscTelemetry::Flush, Ptr<QueueDiscTelemetry> (this));
+        }
+        return;
+    }
+
+    if (!m_fileName.empty ())
+    {
+        Flush ();
+    }
+    else
+    {
+        NS_LOG_LOGIC ("The ring buffer wraps around");
+        m_head = 0;
+    }
+}
+
+void
+QueueDiscTelemetry::WriteSamples (uint32_t first, uint32_t n)
+{
+    NS_LOG_FUNCTION (this << first << n);
+
+    if (!m_fileOpened)
+    {
+        m_file.open (m_fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+        NS_ABORT_MSG_IF (!m_file.is_open (), "Cannot open the telemetry file " << m_fileName);
+        m_fileOpened = true;
+
+        uint32_t sampleSize = sizeof (QueueDiscTelemetrySample);
+        uint64_t stepsPerSecond = Seconds (1).GetTimeStep ();
+        m_file.write (TELEMETRY_MAGIC, sizeof (TELEMETRY_MAGIC));
+        m_file.write (reinterpret_cast<const char *> (&sampleSize), sizeof (sampleSize));
+        m_file.write (reinterpret_cast<const char *> (&stepsPerSecond), sizeof (stepsPerSecond));
+    }
+    m_file.write (reinterpret_cast<const char *> (&m_ring[first]), n * sizeof (QueueDiscTelemetrySample));
+}
+
+void
+QueueDiscTelemetry::Flush (void)
+{
+    NS_LOG_FUNCTION (this);
+
+    // Samples are dumped as soon as the ring buffer is full, so it never wraps around
+    if (m_fileName.empty () || m_head == 0)
+    {
+        return;
+    }
+    WriteSamples (0, m_head);
+    m_file.flush ();
+    m_head = 0;
+    m_nSamples = 0;
+}
+
+uint32_t
+QueueDiscTelemetry::GetNSamples (void) const
+{
+    return m_nSamples;
+}
+
+const QueueDiscTelemetrySample &
+QueueDiscTelemetry::GetSample (uint32_t i) const
+{
+    NS_ASSERT (i < m_nSamples);
+    uint32_t oldest = m_nSamples == m_ring.size () ? m_head % m_ring.size () : 0;
+    return m_ring[(oldest + i) % m_ring.size ()];
+}
+
+uint64_t
+QueueDiscTelemetry::GetNTotalSamples (void) const
+{
+    return m_nTotalSamples;
+}
+
+bool
+QueueDiscTelemetry::ReadFile (std::string fileName, std::vector<QueueDiscTelemetrySample> &samples)
+{
+    NS_LOG_FUNCTION (fileName);
+
+    std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+    if (!file.is_open ())
+    {
+        return false;
+    }
+
+    char magic[sizeof (TELEMETRY_MAGIC)];
+    uint32_t sampleSize = 0;
+    uint64_t stepsPerSecond = 0;
+    file.read (magic, sizeof (magic));
+    file.read (reinterpret_cast<char *> (&sampleSize), sizeof (sampleSize));
+    file.read (reinterpret_cast<char *> (&stepsPerSecond), sizeof (stepsPerSecond));
+    if (!file || std::memcmp (magic, TELEMETRY_MAGIC, sizeof (magic)) != 0
+        || sampleSize != sizeof (QueueDiscTelemetrySample))
+    {
+        return false;
+    }
+    if (stepsPerSecond != (uint64_t) Seconds (1).GetTimeStep ())
+    {
+        NS_LOG_WARN ("The dump was recorded with a different time resolution");
+    }
+
+    QueueDiscTelemetrySample sample;
+    while (file.read (reinterpret_cast<char *> (&sample), sizeof (sample)))
+    {
+        samples.push_back (sample);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,148 @@
+#ifndef QUEUE_DISC_TELEMETRY_H
+#define QUEUE_DISC_TELEMETRY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include <vector>
+#include <string>
+#include <fstream>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * A fixed-size sample of the state of a queue disc, taken on every
+ * enqueue, dequeue, drop and mark. The layout is the one of the binary
+ * dump, two samples share a cache line.
+ */
+struct QueueDiscTelemetrySample
+{
+    enum Event
+    {
+        ENQUEUE = 0,
+        DEQUEUE = 1,
+        DROP = 2,
+        MARK = 3
+    };
+
+    int64_t time;       //!< The time of the event, in time steps
+    int64_t sojourn;    //!< The sojourn time of the packet, in time steps, dequeue only
+    uint32_t bytes;     //!< The bytes in the queue disc after the event
+    uint32_t packets;   //!< The packets in the queue disc after the event
+    uint32_t size;      //!< The size of the packet
+    uint8_t event;      //!< The Event
+    uint8_t pad[3];
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * A per queue disc telemetry recorder replacing the Config path trace sinks
+ * and the NS_LOG output otherwise used to analyze the queue behavior. The
+ * samples are written in a ring buffer preallocated on the first record, so
+ * that recording an event is a single 32 byte store.
+ *
+ * If FileName is set, the ring buffer is dumped to the file whenever it is
+ * full and once more when the simulator is destroyed, so the file holds every
+ * sample. Otherwise the ring buffer keeps the last Capacity samples, which can
+ * be read with GetSample.
+ *
+ * The file starts with a header (the magic "QDTELEM", a version byte, the size
+ * of a sample and the number of time steps per second, as uint32_t and
+ * uint64_t) followed by the samples until the end of the file. ReadFile and
+ * examples/buffer-management/queue_analyze.py read it back.
+ */
+class QueueDiscTelemetry : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+
+    QueueDiscTelemetry ();
+
+    virtual ~QueueDiscTelemetry ();
+
+    /**
+     * Record an event of the queue disc
+     * @param event the QueueDiscTelemetrySample::Event
+     * @param bytes the bytes in the queue disc after the event
+     * @param packets the packets in the queue disc after the event
+     * @param size the size of the packet
+     * @param sojourn the sojourn time of the packet
+     */
+    inline void Record (uint8_t event, uint32_t bytes, uint32_t packets, uint32_t size, Time sojourn);
+
+    /**
+     * Dump the samples recorded so far to the file and empty the ring buffer.
+     * Does nothing if FileName is not set.
+     */
+    void Flush (void);
+
+    /**
+     * @return the number of samples in the ring buffer
+     */
+    uint32_t GetNSamples (void) const;
+
+    /**
+     * @param i the index of the sample, 0 being the oldest one in the ring buffer
+     * @return the sample
+     */
+    const QueueDiscTelemetrySample & GetSample (uint32_t i) const;
+
+    /**
+     * @return the number of samples recorded since the start of the simulation
+     */
+    uint64_t GetNTotalSamples (void) const;
+
+    /**
+     * Read a telemetry dump
+     * @param fileName the name of the file
+     * @param samples the vector the samples are appended to
+     * @return false if the file cannot be read or is not a telemetry dump
+     */
+    static bool ReadFile (std::string fileName, std::vector<QueueDiscTelemetrySample> &samples);
+
+protected:
+    virtual void DoDispose (void);
+
+private:
+    void Overflow (void);
+    void WriteSamples (uint32_t first, uint32_t n);
+
+    uint32_t m_capacity;
+    std::string m_fileName;
+
+    std::vector<QueueDiscTelemetrySample> m_ring;
+    uint32_t m_head;            //!< The index of the next sample to write
+    uint32_t m_nSamples;        //!< The number of valid samples in the ring buffer
+    uint64_t m_nTotalSamples;
+
+    std::ofstream m_file;
+    bool m_fileOpened;
+};
+
+void
+QueueDiscTelemetry::Record (uint8_t event, uint32_t bytes, uint32_t packets, uint32_t size, Time sojourn)
+{
+    if (m_head == m_ring.size ())
+    {
+        Overflow ();
+    }
+    QueueDiscTelemetrySample &sample = m_ring[m_head++];
+    sample.time = Simulator::Now ().GetTimeStep ();
+    sample.sojourn = sojourn.GetTimeStep ();
+    sample.bytes = bytes;
+    sample.packets = packets;
+    sample.size = size;
+    sample.event = event;
+    if (m_nSamples < m_ring.size ())
+    {
+        m_nSamples++;
+    }
+    m_nTotalSamples++;
+}
+
+}
+
+#endif
@@ -20,21 +20,36 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/unused.h"
+#include "ns3/simulator.h"
 #include "queue-disc.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("QueueDisc");
 
+/**
+ * \return the bin of the occupancy histogram of the given number of bytes
+ */
+static inline uint32_t
+OccupancyBin (uint32_t bytes)
+{
+  return bytes == 0 ? 0 : 32 - __builtin_clz (bytes);
+}
+
 QueueDiscItem::QueueDiscItem (Ptr<Packet> p, const Address& addr, uint16_t protocol)
   : QueueItem (p),
     m_address (addr),
     m_protocol (protocol),
-    m_txq (0)
+    m_txq (0),
+    m_tstamp (Seconds (0))
 {
 }
 
@@ -67,6 +82,25 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+Time
+QueueDiscItem::GetTimeStamp (void) const
+{
+  return m_tstamp;
+}
+
+void
+QueueDiscItem::SetTimeStamp (Time t)
+{
+  m_tstamp = t;
+}
+
+bool
+QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
@@ -134,6 +168,49 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BatchDequeue",
+                   "Whether a run dequeues up to Quota packets at once and sends them to the device in a batch",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QueueDisc::m_batchDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SharedBufferAlpha",
+                   "The Dynamic Threshold alpha used in the shared buffer, zero to use the buffer default",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&QueueDisc::m_sharedBufferAlpha),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("SharedBufferPriority",
+                   "The priority whose reserved headroom is used in the shared buffer",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QueueDisc::m_sharedBufferPriority),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("SojournTimeBinWidth",
+                   "The bin width of the sojourn time histogram, zero to disable the histogram",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&QueueDisc::m_sojournBinWidth),
+                   MakeTimeChecker ())
+    .AddAttribute ("SojournTimeBins",
+                   "The number of bins of the sojourn time histogram",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&QueueDisc::m_sojournBins),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Telemetry",
+                   "The recorder of the enqueue, dequeue, drop and mark events, none by default",
+                   PointerValue (),
+                   MakePointerAccessor (&QueueDisc::SetTelemetry,
+                                        &QueueDisc::GetTelemetry),
+                   MakePointerChecker<QueueDiscTelemetry> ())
+    .AddAttribute ("AverageOccupancy",
+                   "The time-weighted average number of bytes since the start of the measurement window",
+                   TypeId::ATTR_GET,
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&QueueDisc::GetAverageOccupancy),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PeakOccupancy",
+                   "The peak number of bytes since the start of the measurement window",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QueueDisc::GetPeakOccupancy),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -158,6 +235,13 @@ TypeId QueueDisc::GetTypeId (void)
     .AddTraceSource ("Drop", "Drop a packet stored in the queue disc",
                      MakeTraceSourceAccessor (&QueueDisc::m_traceDrop),
                      "ns3::QueueItem::TracedCallback")
+    .AddTraceSource ("Mark", "Mark a packet stored in the queue disc",
+                     MakeTraceSourceAccessor (&QueueDisc::m_traceMark),
+                     "ns3::QueueItem::TracedCallback")
+    .AddTraceSource ("SojournTime",
+                     "Sojourn time of the last packet dequeued from the queue disc",
+                     MakeTraceSourceAccessor (&QueueDisc::m_traceSojourn),
+                     "ns3::Time::TracedCallback")
     .AddTraceSource ("PacketsInQueue",
                      "Number of packets currently stored in the queue disc",
                      MakeTraceSourceAccessor (&QueueDisc::m_nPackets),
@@ -179,9 +263,19 @@ QueueDisc::QueueDisc ()
      m_nTotalDroppedBytes (0),
      m_nTotalRequeuedPackets (0),
      m_nTotalRequeuedBytes (0),
-     m_running (false)
+     m_running (false),
+     m_batchDequeue (false),
+     m_parent (0),
+     m_dequeuing (false),
+     m_transmitting (false),
+     m_sharedBufferId (0),
+     m_occupancyWindowStart (0),
+     m_occupancyLastUpdate (0),
+     m_peakOccupancy (0),
+     m_occupancyIntegral (0.0)
 {
   NS_LOG_FUNCTION (this);
+  std::fill (m_occupancyHistogram, m_occupancyHistogram + OCCUPANCY_BINS, 0);
 }
 
 void
@@ -191,9 +285,16 @@ QueueDisc::DoDispose (void)
   m_queues.clear ();
   m_filters.clear ();
   m_classes.clear ();
+  m_policies.clear ();
+  m_enqueuePolicies.clear ();
+  m_dequeuePolicies.clear ();
   m_device = 0;
   m_devQueueIface = 0;
-  m_requeued = 0;
+  m_requeued.clear ();
+  m_batch.clear ();
+  m_batchPackets.clear ();
+  m_sharedBuffer = 0;
+  m_telemetry = 0;
   Object::DoDispose ();
 }
 
@@ -308,6 +409,126 @@ QueueDisc::GetQuota (void) const
   return m_quota;
 }
 
+void
+QueueDisc::SetSharedBuffer (Ptr<SharedBufferPool> pool)
+{
+  NS_LOG_FUNCTION (this << pool);
+  NS_ASSERT_MSG (m_sharedBuffer == 0, "The queue disc is already attached to a shared buffer");
+  m_sharedBuffer = pool;
+  m_sharedBufferId = pool->RegisterQueue (m_sharedBufferAlpha, m_sharedBufferPriority);
+}
+
+Ptr<SharedBufferPool>
+QueueDisc::GetSharedBuffer (void) const
+{
+  return m_sharedBuffer;
+}
+
+const std::vector<uint32_t> &
+QueueDisc::GetSojournTimeHistogram (void) const
+{
+  return m_sojournHistogram;
+}
+
+double
+QueueDisc::GetAverageOccupancy (void) const
+{
+  Time now = Simulator::Now ();
+  int64_t window = (now - m_occupancyWindowStart).GetTimeStep ();
+  if (window <= 0)
+    {
+      return m_nBytes;
+    }
+  return GetOccupancyIntegral () / window;
+}
+
+double
+QueueDisc::GetOccupancyIntegral (void) const
+{
+  int64_t elapsed = (Simulator::Now () - m_occupancyLastUpdate).GetTimeStep ();
+  return m_occupancyIntegral + static_cast<double> (m_nBytes) * elapsed;
+}
+
+Time
+QueueDisc::GetOccupancyWindowStart (void) const
+{
+  return m_occupancyWindowStart;
+}
+
+uint32_t
+QueueDisc::GetPeakOccupancy (void) const
+{
+  return m_peakOccupancy;
+}
+
+std::vector<Time>
+QueueDisc::GetOccupancyHistogram (void) const
+{
+  std::vector<Time> histogram (OCCUPANCY_BINS);
+  for (uint32_t i = 0; i < OCCUPANCY_BINS; i++)
+    {
+      histogram[i] = TimeStep (m_occupancyHistogram[i]);
+    }
+  histogram[OccupancyBin (m_nBytes)] += Simulator::Now () - m_occupancyLastUpdate;
+  return histogram;
+}
+
+uint32_t
+QueueDisc::GetOccupancyPercentile (double quantile) const
+{
+  NS_LOG_FUNCTION (this << quantile);
+
+  std::vector<Time> histogram = GetOccupancyHistogram ();
+  double target = quantile * (Simulator::Now () - m_occupancyWindowStart).GetTimeStep ();
+  int64_t accumulated = 0;
+  for (uint32_t i = 0; i < OCCUPANCY_BINS; i++)
+    {
+      accumulated += histogram[i].GetTimeStep ();
+      if (accumulated > 0 && accumulated >= target)
+        {
+          return i == 0 ? 0 : static_cast<uint32_t> ((static_cast<uint64_t> (1) << i) - 1);
+        }
+    }
+  return m_nBytes;
+}
+
+void
+QueueDisc::ResetOccupancyStats (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_occupancyWindowStart = Simulator::Now ();
+  m_occupancyLastUpdate = m_occupancyWindowStart;
+  m_peakOccupancy = m_nBytes;
+  m_occupancyIntegral = 0.0;
+  std::fill (m_occupancyHistogram, m_occupancyHistogram + OCCUPANCY_BINS, 0);
+}
+
+void
+QueueDisc::UpdateOccupancy (void)
+{
+  Time now = Simulator::Now ();
+  int64_t elapsed = (now - m_occupancyLastUpdate).GetTimeStep ();
+  if (elapsed > 0)
+    {
+      m_occupancyIntegral += static_cast<double> (m_nBytes) * elapsed;
+      m_occupancyHistogram[OccupancyBin (m_nBytes)] += elapsed;
+      m_occupancyLastUpdate = now;
+    }
+}
+
+void
+QueueDisc::SetTelemetry (Ptr<QueueDiscTelemetry> telemetry)
+{
+  NS_LOG_FUNCTION (this << telemetry);
+  m_telemetry = telemetry;
+}
+
+Ptr<QueueDiscTelemetry>
+QueueDisc::GetTelemetry (void) const
+{
+  return m_telemetry;
+}
+
 void
 QueueDisc::AddInternalQueue (Ptr<Queue> queue)
 {
@@ -354,6 +575,7 @@ QueueDisc::AddQueueDiscClass (Ptr<QueueDiscClass> qdClass)
   NS_LOG_FUNCTION (this);
   NS_ABORT_MSG_IF (qdClass->GetQueueDisc () == 0, "Cannot add a class with no attached queue disc");
   m_classes.push_back (qdClass);
+  AddChildQueueDisc (qdClass->GetQueueDisc ());
 }
 
 Ptr<QueueDiscClass>
@@ -369,6 +591,34 @@ QueueDisc::GetNQueueDiscClasses (void) const
   return m_classes.size ();
 }
 
+void
+QueueDisc::AddAqmPolicy (Ptr<AqmPolicy> policy)
+{
+  NS_LOG_FUNCTION (this << policy);
+  m_policies.push_back (policy);
+  if (policy->IsEnqueuePolicy ())
+    {
+      m_enqueuePolicies.push_back (policy);
+    }
+  if (policy->IsDequeuePolicy ())
+    {
+      m_dequeuePolicies.push_back (policy);
+    }
+}
+
+Ptr<AqmPolicy>
+QueueDisc::GetAqmPolicy (uint32_t i) const
+{
+  NS_ASSERT (i < m_policies.size ());
+  return m_policies[i];
+}
+
+uint32_t
+QueueDisc::GetNAqmPolicies (void) const
+{
+  return m_policies.size ();
+}
+
 int32_t
 QueueDisc::Classify (Ptr<QueueDiscItem> item)
 {
@@ -398,13 +648,61 @@ QueueDisc::Drop (Ptr<QueueDiscItem> item)
                  << " is reported to be dropped is greater than the amount of bytes"
                  << "stored in the queue disc");
 
+  UpdateOccupancy ();
   m_nPackets--;
   m_nBytes -= item->GetPacketSize ();
   m_nTotalDroppedPackets++;
   m_nTotalDroppedBytes += item->GetPacketSize ();
 
+  if (m_sharedBuffer != 0)
+    {
+      m_sharedBuffer->Release (m_sharedBufferId, item->GetPacketSize ());
+    }
+
+  if (m_telemetry != 0)
+    {
+      m_telemetry->Record (QueueDiscTelemetrySample::DROP, m_nBytes, m_nPackets,
+                           item->GetPacketSize (), Time (0));
+    }
+
   NS_LOG_LOGIC ("m_traceDrop (p)");
   m_traceDrop (item);
+
+  // The parent is dequeuing from this queue disc and still counts the packet
+  if (m_parent != 0 && m_dequeuing)
+    {
+      m_parent->Drop (item);
+    }
+}
+
+void
+QueueDisc::AddChildQueueDisc (Ptr<QueueDisc> child)
+{
+  NS_LOG_FUNCTION (this << child);
+  NS_ASSERT_MSG (child->m_parent == 0 || child->m_parent == this,
+                 "The queue disc is already the child of another queue disc");
+  child->m_parent = this;
+}
+
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (!item->Mark ())
+    {
+      return false;
+    }
+
+  if (m_telemetry != 0)
+    {
+      m_telemetry->Record (QueueDiscTelemetrySample::MARK, m_nBytes, m_nPackets,
+                           item->GetPacketSize (), Time (0));
+    }
+
+  NS_LOG_LOGIC ("m_traceMark (p)");
+  m_traceMark (item);
+  return true;
 }
 
 bool
@@ -412,14 +710,58 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  m_nPackets++;
-  m_nBytes += item->GetPacketSize ();
   m_nTotalReceivedPackets++;
   m_nTotalReceivedBytes += item->GetPacketSize ();
 
+  item->SetTimeStamp (Simulator::Now ());
+
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
 
+  // The packet never enters the queue disc if the shared buffer rejects it
+  if (m_sharedBuffer != 0 && !m_sharedBuffer->Admit (m_sharedBufferId, item->GetPacketSize ()))
+    {
+      NS_LOG_LOGIC ("Rejected by the shared buffer");
+      m_nTotalDroppedPackets++;
+      m_nTotalDroppedBytes += item->GetPacketSize ();
+
+      if (m_telemetry != 0)
+        {
+          m_telemetry->Record (QueueDiscTelemetrySample::DROP, m_nBytes, m_nPackets,
+                               item->GetPacketSize (), Time (0));
+        }
+
+      NS_LOG_LOGIC ("m_traceDrop (p)");
+      m_traceDrop (item);
+      return false;
+    }
+
+  UpdateOccupancy ();
+  m_nPackets++;
+  m_nBytes += item->GetPacketSize ();
+  m_peakOccupancy = std::max<uint32_t> (m_peakOccupancy, m_nBytes);
+
+  if (m_telemetry != 0)
+    {
+      m_telemetry->Record (QueueDiscTelemetrySample::ENQUEUE, m_nBytes, m_nPackets,
+                           item->GetPacketSize (), Time (0));
+    }
+
+  if (!m_enqueuePolicies.empty ())
+    {
+      AqmPolicy::Verdict verdict = AqmPolicy::PASS;
+      for (std::vector<Ptr<AqmPolicy> >::iterator policy = m_enqueuePolicies.begin ();
+           policy != m_enqueuePolicies.end (); policy++)
+        {
+          verdict = std::max (verdict, (*policy)->Enqueue (item, m_nPackets, m_nBytes));
+        }
+      if (verdict != AqmPolicy::PASS && !EnforceVerdict (item, verdict))
+        {
+          Drop (item);
+          return false;
+        }
+    }
+
   return DoEnqueue (item);
 }
 
@@ -429,15 +771,62 @@ QueueDisc::Dequeue (void)
   NS_LOG_FUNCTION (this);
 
   Ptr<QueueDiscItem> item;
+  m_dequeuing = true;
   item = DoDequeue ();
 
+  while (item != 0 && !m_dequeuePolicies.empty ())
+    {
+      AqmPolicy::Verdict verdict = AqmPolicy::PASS;
+      Time sojourn = Simulator::Now () - item->GetTimeStamp ();
+      for (std::vector<Ptr<AqmPolicy> >::iterator policy = m_dequeuePolicies.begin ();
+           policy != m_dequeuePolicies.end (); policy++)
+        {
+          verdict = std::max (verdict, (*policy)->Dequeue (item, sojourn));
+        }
+      if (verdict == AqmPolicy::PASS || EnforceVerdict (item, verdict))
+        {
+          break;
+        }
+      Drop (item);
+      item = DoDequeue ();
+    }
+  m_dequeuing = false;
+
   if (item != 0)
     {
+      UpdateOccupancy ();
       m_nPackets--;
       m_nBytes -= item->GetPacketSize ();
 
+      // The packets dequeued to be sent to the device keep their bytes in the
+      // shared buffer until the device takes them, as they may be requeued
+      if (m_sharedBuffer != 0 && !m_transmitting)
+        {
+          m_sharedBuffer->Release (m_sharedBufferId, item->GetPacketSize ());
+        }
+
       NS_LOG_LOGIC ("m_traceDequeue (p)");
       m_traceDequeue (item);
+
+      if (!m_sojournBinWidth.IsZero () || !m_traceSojourn.IsEmpty () || m_telemetry != 0)
+        {
+          Time sojourn = Simulator::Now () - item->GetTimeStamp ();
+          m_traceSojourn (sojourn);
+          if (m_telemetry != 0)
+            {
+              m_telemetry->Record (QueueDiscTelemetrySample::DEQUEUE, m_nBytes, m_nPackets,
+                                   item->GetPacketSize (), sojourn);
+            }
+          if (!m_sojournBinWidth.IsZero ())
+            {
+              if (m_sojournHistogram.empty ())
+                {
+                  m_sojournHistogram.resize (m_sojournBins, 0);
+                }
+              uint64_t bin = sojourn.GetTimeStep () / m_sojournBinWidth.GetTimeStep ();
+              m_sojournHistogram[std::min<uint64_t> (bin, m_sojournBins - 1)]++;
+            }
+        }
     }
 
   return item;
@@ -458,19 +847,47 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      if (m_batchDequeue && m_device->SupportsSendBatch ())
+        {
+          while (quota > 0 && RestartBatch (quota))
+            {
+            }
+        }
+      else
         {
-          quota -= 1;
-          if (quota <= 0)
+          while (Restart ())
             {
-              /// \todo netif_schedule (q);
-              break;
+              quota -= 1;
+              if (quota <= 0)
+                {
+                  /// \todo netif_schedule (q);
+                  break;
+                }
             }
         }
       RunEnd ();
     }
 }
 
+bool
+QueueDisc::EnforceVerdict (Ptr<QueueDiscItem> item, AqmPolicy::Verdict verdict)
+{
+  NS_LOG_FUNCTION (this << item << verdict);
+
+  switch (verdict)
+    {
+    case AqmPolicy::MARK:
+      Mark (item);
+      return true;
+    case AqmPolicy::MARK_OR_DROP:
+      return Mark (item);
+    case AqmPolicy::DROP:
+      return false;
+    default:
+      return true;
+    }
+}
+
 bool
 QueueDisc::RunBegin (void)
 {
@@ -505,6 +922,32 @@ QueueDisc::Restart (void)
   return Transmit (item);
 }
 
+bool
+QueueDisc::RestartBatch (uint32_t &quota)
+{
+  NS_LOG_FUNCTION (this << quota);
+  NS_ASSERT (m_batch.empty ());
+
+  while (m_batch.size () < quota)
+    {
+      Ptr<QueueDiscItem> item = DequeuePacket ();
+      if (item == 0)
+        {
+          break;
+        }
+      m_batch.push_back (item);
+    }
+
+  if (m_batch.empty ())
+    {
+      NS_LOG_LOGIC ("No packet to send");
+      return false;
+    }
+
+  quota -= m_batch.size ();
+  return TransmitBatch ();
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket ()
 {
@@ -513,16 +956,17 @@ QueueDisc::DequeuePacket ()
   Ptr<QueueDiscItem> item;
 
   // First check if there is a requeued packet
-  if (m_requeued != 0)
+  if (!m_requeued.empty ())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
-        if (!m_devQueueIface->GetTxQueue (m_requeued->GetTxQueueIndex ())->IsStopped ())
+        if (!m_devQueueIface->GetTxQueue (m_requeued.front ()->GetTxQueueIndex ())->IsStopped ())
           {
-            item = m_requeued;
-            m_requeued = 0;
+            item = m_requeued.front ();
+            m_requeued.pop_front ();
 
+            UpdateOccupancy ();
             m_nPackets--;
             m_nBytes -= item->GetPacketSize ();
 
@@ -539,7 +983,9 @@ QueueDisc::DequeuePacket ()
       // is not stopped.
       if (m_devQueueIface->GetTxQueuesN ()>1 || !m_devQueueIface->GetTxQueue (0)->IsStopped ())
         {
+          m_transmitting = true;
           item = Dequeue ();
+          m_transmitting = false;
           // If the item is not null, add the header to the packet.
           if (item != 0)
             {
@@ -555,11 +1001,14 @@ void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  m_requeued = item;
+  m_requeued.push_back (item);
   /// \todo netif_schedule (q);
 
+  UpdateOccupancy ();
   m_nPackets++;       // it's still part of the queue
   m_nBytes += item->GetPacketSize ();
+  m_peakOccupancy = std::max<uint32_t> (m_peakOccupancy, m_nBytes);
+  // The bytes are still in the shared buffer, in the area they were admitted in
   m_nTotalRequeuedPackets++;
   m_nTotalRequeuedBytes += item->GetPacketSize ();
 
@@ -587,6 +1036,10 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
     {
       Requeue (item);
     }
+  else if (m_sharedBuffer != 0)
+    {
+      m_sharedBuffer->Release (m_sharedBufferId, item->GetPacketSize ());
+    }
 
   // If the transmission succeeded but now the queue is stopped, return false
   if (ret && m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
@@ -597,4 +1050,64 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return ret;
 }
 
+bool
+QueueDisc::TransmitBatch (void)
+{
+  NS_LOG_FUNCTION (this << m_batch.size ());
+  NS_ASSERT (m_devQueueIface);
+
+  uint32_t first = 0;
+  while (first < m_batch.size ())
+    {
+      Ptr<QueueDiscItem> head = m_batch[first];
+      Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (head->GetTxQueueIndex ());
+
+      // send copies of the packets because the device might add the
+      // MAC header even if the transmission is unsuccessful (see BUG 2284)
+      uint32_t last = first;
+      m_batchPackets.clear ();
+      while (last < m_batch.size ()
+             && m_batch[last]->GetTxQueueIndex () == head->GetTxQueueIndex ()
+             && m_batch[last]->GetProtocol () == head->GetProtocol ()
+             && m_batch[last]->GetAddress () == head->GetAddress ())
+        {
+          m_batchPackets.push_back (m_batch[last]->GetPacket ()->Copy ());
+          last++;
+        }
+
+      uint32_t sent = 0;
+      if (!txq->IsStopped ())
+        {
+          sent = m_device->SendBatch (m_batchPackets, head->GetAddress (), head->GetProtocol ());
+        }
+
+      if (m_sharedBuffer != 0)
+        {
+          for (uint32_t i = first; i < first + sent; i++)
+            {
+              m_sharedBuffer->Release (m_sharedBufferId, m_batch[i]->GetPacketSize ());
+            }
+        }
+
+      // If the device did not take the whole run or is now stopped, requeue
+      // the rest of the batch
+      if (sent < last - first || txq->IsStopped ())
+        {
+          for (uint32_t i = first + sent; i < m_batch.size (); i++)
+            {
+              Requeue (m_batch[i]);
+            }
+          m_batch.clear ();
+          m_batchPackets.clear ();
+          return false;
+        }
+
+      first = last;
+    }
+
+  m_batch.clear ();
+  m_batchPackets.clear ();
+  return true;
+}
+
 } // namespace ns3
@@ -22,10 +22,15 @@
 
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
+#include "ns3/nstime.h"
 #include <ns3/queue.h>
 #include "ns3/net-device.h"
 #include <vector>
+#include <deque>
 #include "packet-filter.h"
+#include "shared-buffer-pool.h"
+#include "queue-disc-telemetry.h"
+#include "aqm-policy.h"
 
 namespace ns3 {
 
@@ -38,7 +43,8 @@ class QueueDisc;
  * QueueDiscItem is the abstract base class for items that are stored in a queue
  * disc. It is derived from QueueItem (which only consists of a Ptr<Packet>)
  * to additionally store the destination MAC address, the
- * L3 protocol number and the transmission queue index,
+ * L3 protocol number, the transmission queue index and the time the item
+ * has been enqueued in the queue disc, which sojourn based AQMs rely on.
  */
 class QueueDiscItem : public QueueItem {
 public:
@@ -76,6 +82,20 @@ public:
    */
   void SetTxQueueIndex (uint8_t txq);
 
+  /**
+   * \brief Get the time the item has been enqueued in the queue disc
+   * \return the enqueue timestamp of this item.
+   */
+  Time GetTimeStamp (void) const;
+
+  /**
+   * \brief Set the time the item has been enqueued in the queue disc
+   *
+   * QueueDisc::Enqueue stamps every item, queue discs should not need to call it.
+   * \param t the enqueue timestamp of this item.
+   */
+  void SetTimeStamp (Time t);
+
   /**
    * \brief Add the header to the packet
    *
@@ -85,6 +105,18 @@ public:
    */
   virtual void AddHeader (void) = 0;
 
+  /**
+   * \brief Mark the packet as having experienced congestion
+   *
+   * Subclasses keeping the header separate turn an ECT(0) or ECT(1) ECN field
+   * of the header to CE in place, as long as the header has not been added to
+   * the packet yet. As INET_ECN_set_ce in Linux, packets which are not ECN
+   * capable or already CE are left untouched. The base class does not know
+   * about ECN and returns false.
+   * \return true if the packet was ECN capable and is now marked.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -115,6 +147,7 @@ private:
   Address m_address;      //!< MAC destination address
   uint16_t m_protocol;    //!< L3 Protocol number
   uint8_t m_txq;          //!< Transmission queue index
+  Time m_tstamp;          //!< Enqueue timestamp
 };
 
 
@@ -298,6 +331,92 @@ public:
    */
   virtual uint32_t GetQuota (void) const;
 
+  /**
+   * \brief Make this queue disc draw its packets from the given node-level buffer.
+   *
+   * Once set, every packet is first admitted by the shared buffer (according to
+   * the SharedBufferAlpha and SharedBufferPriority attributes of this queue disc)
+   * and only then handed to DoEnqueue. Only root queue discs should be attached.
+   * \param pool the shared buffer
+   */
+  void SetSharedBuffer (Ptr<SharedBufferPool> pool);
+
+  /**
+   * \brief Get the shared buffer this queue disc draws from
+   * \return the shared buffer, or 0 if the queue disc has a private buffer only.
+   */
+  Ptr<SharedBufferPool> GetSharedBuffer (void) const;
+
+  /**
+   * \brief Get the histogram of the sojourn time of the dequeued packets
+   *
+   * The histogram is kept only if the SojournTimeBinWidth attribute is not zero.
+   * Bin i counts the packets whose sojourn time is in [i * width, (i + 1) * width),
+   * the last bin also counts the longer sojourn times.
+   * \return the number of packets in each bin, empty until the first dequeue.
+   */
+  const std::vector<uint32_t> & GetSojournTimeHistogram (void) const;
+
+  /**
+   * \brief Get the time-weighted average number of bytes stored in the queue disc
+   * \return the average occupancy since the start of the measurement window.
+   */
+  double GetAverageOccupancy (void) const;
+
+  /**
+   * \brief Get the integral of the number of bytes stored in the queue disc over time
+   * \return the integral since the start of the measurement window, in byte time steps.
+   */
+  double GetOccupancyIntegral (void) const;
+
+  /**
+   * \brief Get the start of the measurement window of the occupancy statistics
+   * \return the time of the last call to ResetOccupancyStats, 0 if never called.
+   */
+  Time GetOccupancyWindowStart (void) const;
+
+  /**
+   * \brief Get the peak number of bytes stored in the queue disc
+   * \return the peak occupancy since the start of the measurement window.
+   */
+  uint32_t GetPeakOccupancy (void) const;
+
+  /**
+   * \brief Get the time spent at each occupancy since the start of the measurement window
+   *
+   * Bin 0 is the time the queue disc has been empty, bin i > 0 the time it has
+   * stored between 2^(i-1) and 2^i - 1 bytes.
+   * \return the time spent in each bin.
+   */
+  std::vector<Time> GetOccupancyHistogram (void) const;
+
+  /**
+   * \brief Get a percentile of the occupancy over the measurement window
+   *
+   * The percentile is bounded by the occupancy histogram, so it is exact to a
+   * factor of two.
+   * \param quantile the quantile, between 0 and 1
+   * \return the upper bound of the bin the quantile falls in, in bytes.
+   */
+  uint32_t GetOccupancyPercentile (double quantile) const;
+
+  /**
+   * \brief Start a new measurement window of the occupancy statistics
+   */
+  void ResetOccupancyStats (void);
+
+  /**
+   * \brief Record every enqueue, dequeue, drop and mark of this queue disc
+   * \param telemetry the recorder, or 0 to stop recording
+   */
+  void SetTelemetry (Ptr<QueueDiscTelemetry> telemetry);
+
+  /**
+   * \brief Get the telemetry recorder of this queue disc
+   * \return the recorder, or 0 if this queue disc does not record its events.
+   */
+  Ptr<QueueDiscTelemetry> GetTelemetry (void) const;
+
   /**
    * Pass a packet to store to the queue discipline. This function only updates
    * the statistics and calls the (private) DoEnqueue function, which must be
@@ -387,6 +506,31 @@ public:
    */
   uint32_t GetNQueueDiscClasses (void) const;
 
+  /**
+   * \brief Add an AQM policy to the tail of the chain of policies.
+   *
+   * The policies are consulted in order when a packet is enqueued (after the
+   * shared buffer admission and before DoEnqueue) or dequeued (after DoDequeue)
+   * and the most severe verdict is applied. Packets dropped on dequeue are
+   * replaced by the next packet returned by DoDequeue. On a child queue disc,
+   * they are also dropped from its parents (see AddChildQueueDisc).
+   * \param policy the policy to be added
+   */
+  void AddAqmPolicy (Ptr<AqmPolicy> policy);
+
+  /**
+   * \brief Get the i-th AQM policy
+   * \param i the index of the policy
+   * \return the i-th AQM policy.
+   */
+  Ptr<AqmPolicy> GetAqmPolicy (uint32_t i) const;
+
+  /**
+   * \brief Get the number of AQM policies
+   * \return the number of AQM policies.
+   */
+  uint32_t GetNAqmPolicies (void) const;
+
   /**
    * Classify a packet by calling the packet filters, one at a time, until either
    * a filter able to classify the packet is found or all the filters have been
@@ -439,6 +583,25 @@ protected:
    */
   void Drop (Ptr<QueueDiscItem> item);
 
+  /**
+   *  \brief Make this queue disc the parent of a child queue disc
+   *  \param child the child queue disc
+   *  The packets the child drops while it is dequeued (e.g., by CoDel or by a
+   *  dequeue AQM policy) are also dropped from this queue disc, and so on up to
+   *  the root, whose shared buffer gets the bytes back. This method is called
+   *  by the subclasses for the queue discs they dequeue from.
+   */
+  void AddChildQueueDisc (Ptr<QueueDisc> child);
+
+  /**
+   *  \brief Mark a packet
+   *  \param item item to mark
+   *  \return true if the packet was ECN capable and is now marked.
+   *  This method is called by subclasses to mark a packet (by calling QueueDiscItem::Mark)
+   *  and notify parent (this class) of the mark.
+   */
+  bool Mark (Ptr<QueueDiscItem> item);
+
 private:
 
   /**
@@ -492,6 +655,15 @@ private:
    */
   bool Restart (void);
 
+  /**
+   * Modelled after the bulk dequeue of the Linux function qdisc_restart
+   * (net/sched/sch_generic.c): dequeue up to the given number of packets and
+   * send them to the device as a batch (by calling TransmitBatch).
+   * \param quota the remaining quota, decreased by the number of dequeued packets
+   * \return true if all the packets are successfully sent to the device.
+   */
+  bool RestartBatch (uint32_t &quota);
+
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
@@ -513,11 +685,39 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> p);
 
+  /**
+   * Modelled after the Linux function dev_hard_start_xmit (net/core/dev.c)
+   * Sends the dequeued batch to the device, each run of packets with the same
+   * destination, protocol and transmission queue at once, and requeues the
+   * packets that the device does not accept.
+   * \return true if the transmission succeeded and the queue is not stopped
+   */
+  bool TransmitBatch (void);
+
+  /**
+   * Mark or drop a packet according to the verdict of the AQM policies
+   * \param item the packet
+   * \param verdict the most severe verdict of the policies
+   * \return false if the packet has to be dropped
+   */
+  bool EnforceVerdict (Ptr<QueueDiscItem> item, AqmPolicy::Verdict verdict);
+
+  /**
+   * Account the time elapsed since the last change of the occupancy to the
+   * current occupancy. Called before every change of m_nBytes.
+   */
+  void UpdateOccupancy (void);
+
+  static const uint32_t OCCUPANCY_BINS = 33;  //!< Bins of the occupancy histogram, one per power of two
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<Queue> > m_queues;            //!< Internal queues
   std::vector<Ptr<PacketFilter> > m_filters;    //!< Packet filters
   std::vector<Ptr<QueueDiscClass> > m_classes;  //!< Classes
+  std::vector<Ptr<AqmPolicy> > m_policies;      //!< AQM policies
+  std::vector<Ptr<AqmPolicy> > m_enqueuePolicies;   //!< AQM policies consulted on enqueue
+  std::vector<Ptr<AqmPolicy> > m_dequeuePolicies;   //!< AQM policies consulted on dequeue
 
   TracedValue<uint32_t> m_nPackets; //!< Number of packets in the queue
   TracedValue<uint32_t> m_nBytes;   //!< Number of bytes in the queue
@@ -532,7 +732,26 @@ private:
   Ptr<NetDevice> m_device;          //!< The NetDevice on which this queue discipline is installed
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
-  Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  bool m_batchDequeue;              //!< Whether a run sends the dequeued packets to the device in batches
+  std::deque<Ptr<QueueDiscItem> > m_requeued;     //!< The packets that failed to be transmitted, in order
+  std::vector<Ptr<QueueDiscItem> > m_batch;       //!< The batch being transmitted
+  std::vector<Ptr<Packet> > m_batchPackets;       //!< The packets of a run of the batch
+  QueueDisc *m_parent;              //!< The queue disc this one is a child of, if any
+  bool m_dequeuing;                 //!< Whether a packet is being dequeued
+  bool m_transmitting;              //!< Whether a packet is being dequeued to be sent to the device
+  Ptr<SharedBufferPool> m_sharedBuffer;   //!< The node-level buffer this queue disc draws from
+  uint32_t m_sharedBufferId;        //!< The id of this queue disc in the shared buffer
+  double m_sharedBufferAlpha;       //!< The Dynamic Threshold alpha of this queue disc
+  uint32_t m_sharedBufferPriority;  //!< The priority whose headroom this queue disc can use
+  Time m_sojournBinWidth;           //!< The bin width of the sojourn time histogram, zero to disable it
+  uint32_t m_sojournBins;           //!< The number of bins of the sojourn time histogram
+  std::vector<uint32_t> m_sojournHistogram;   //!< The sojourn time histogram
+  Ptr<QueueDiscTelemetry> m_telemetry;        //!< The telemetry recorder, if any
+  Time m_occupancyWindowStart;      //!< The start of the measurement window
+  Time m_occupancyLastUpdate;       //!< The time of the last change of the occupancy
+  uint32_t m_peakOccupancy;         //!< The peak occupancy in the measurement window
+  double m_occupancyIntegral;       //!< The integral of the occupancy over the measurement window, in byte time steps
+  int64_t m_occupancyHistogram[OCCUPANCY_BINS];   //!< The time steps spent in each occupancy bin
 
   /// Traced callback: fired when a packet is enqueued
   TracedCallback<Ptr<const QueueItem> > m_traceEnqueue;
@@ -542,6 +761,10 @@ private:
   TracedCallback<Ptr<const QueueItem> > m_traceRequeue;
   /// Traced callback: fired when a packet is dropped
   TracedCallback<Ptr<const QueueItem> > m_traceDrop;
+  /// Traced callback: fired when a packet is marked
+  TracedCallback<Ptr<const QueueItem> > m_traceMark;
+  /// Traced callback: fired with the sojourn time of every dequeued packet
+  TracedCallback<Time> m_traceSojourn;
 };
 
 } // namespace ns3
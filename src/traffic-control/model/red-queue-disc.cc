@@ -469,24 +469,12 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       return false;
     }
 
-  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-  Ipv4Header header;
-  bool isIpv4Item = (ipv4Item != 0);
-  if (isIpv4Item)
-  {
-    header = ipv4Item -> GetHeader();
-    NS_LOG_DEBUG("\t Header: " << header);
-  }
-
   if (dropType == DTYPE_UNFORCED)
     {
       NS_LOG_DEBUG ("\t Dropping\\Marking due to Prob Mark " << m_qAvg);
-      if (isIpv4Item &&
-          header.GetEcn() == Ipv4Header::ECN_ECT1)
+      if (Mark (item))
       {
         NS_LOG_DEBUG ("\t Marking CE due to DTYPE_UNFORCED ");
-        header.SetEcn(Ipv4Header::ECN_CE);
-        ipv4Item->SetHeader(header);
         m_stats.unforcedMarking++;
       }
       /*
@@ -500,12 +488,9 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   else if (dropType == DTYPE_FORCED)
     {
       NS_LOG_DEBUG ("\t Dropping\\Marking due to Hard Mark " << m_qAvg);
-      if (isIpv4Item &&
-          header.GetEcn() == Ipv4Header::ECN_ECT1)
+      if (Mark (item))
       {
         NS_LOG_DEBUG ("\t Marking CE Due to DTYPE_FORCED" );
-        header.SetEcn(Ipv4Header::ECN_CE);
-        ipv4Item->SetHeader(header);
         m_stats.forcedMarking++;
       }
       /*
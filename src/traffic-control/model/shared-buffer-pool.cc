@@ -0,0 +1,213 @@
+#include "shared-buffer-pool.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedBufferPool");
+
+NS_OBJECT_ENSURE_REGISTERED (SharedBufferPool);
+
+TypeId
+SharedBufferPool::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::SharedBufferPool")
+        .SetParent<Object> ()
+        .SetGroupName ("TrafficControl")
+        .AddConstructor<SharedBufferPool> ()
+        .AddAttribute ("BufferSize", "The total number of bytes of the shared buffer, headroom included",
+                        UintegerValue (9 * 1024 * 1024),
+                        MakeUintegerAccessor (&SharedBufferPool::m_bufferSize),
+                        MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("Policy", "The admission policy of the shared area",
+                        EnumValue (SharedBufferPool::DYNAMIC_THRESHOLD),
+                        MakeEnumAccessor (&SharedBufferPool::m_policy),
+                        MakeEnumChecker (SharedBufferPool::STATIC_THRESHOLD, "STATIC_THRESHOLD",
+                                         SharedBufferPool::DYNAMIC_THRESHOLD, "DYNAMIC_THRESHOLD"))
+        .AddAttribute ("StaticThreshold", "The maximum shared bytes per queue under the static policy",
+                        UintegerValue (1500 * 100),
+                        MakeUintegerAccessor (&SharedBufferPool::m_staticThreshold),
+                        MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("Alpha", "The default Dynamic Threshold alpha of the queues",
+                        DoubleValue (1.0),
+                        MakeDoubleAccessor (&SharedBufferPool::m_alpha),
+                        MakeDoubleChecker<double> (0.0))
+        .AddTraceSource ("Occupancy", "Number of bytes currently stored in the shared buffer",
+                        MakeTraceSourceAccessor (&SharedBufferPool::m_occupancy),
+                        "ns3::TracedValueCallback::Uint32")
+    ;
+    return tid;
+}
+
+SharedBufferPool::SharedBufferPool ()
+    : m_totalHeadroom (0),
+      m_sharedUsed (0),
+      m_occupancy (0)
+{
+    NS_LOG_FUNCTION (this);
+}
+
+SharedBufferPool::~SharedBufferPool ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+SharedBufferPool::DoDispose (void)
+{
+    NS_LOG_FUNCTION (this);
+    m_queues.clear ();
+    Object::DoDispose ();
+}
+
+uint32_t
+SharedBufferPool::RegisterQueue (double alpha, uint32_t priority)
+{
+    NS_LOG_FUNCTION (this << alpha << priority);
+
+    QueueState state;
+    state.alpha = alpha > 0.0 ? alpha : m_alpha;
+    state.priority = priority;
+    state.sharedUsed = 0;
+    state.headroomUsed = 0;
+    m_queues.push_back (state);
+
+    if (priority >= m_headroom.size ())
+    {
+        m_headroom.resize (priority + 1, 0);
+        m_headroomUsed.resize (priority + 1, 0);
+    }
+
+    return m_queues.size () - 1;
+}
+
+bool
+SharedBufferPool::Admit (uint32_t queueId, uint32_t bytes)
+{
+    NS_LOG_FUNCTION (this << queueId << bytes);
+    NS_ASSERT (queueId < m_queues.size ());
+
+    QueueState &state = m_queues[queueId];
+
+    uint32_t sharedSize = GetSharedSize ();
+    if (m_sharedUsed + bytes <= sharedSize
+            && state.sharedUsed + bytes <= GetQueueThreshold (queueId))
+    {
+        state.sharedUsed += bytes;
+        m_sharedUsed += bytes;
+        m_occupancy += bytes;
+        return true;
+    }
+
+    // The queue has exhausted its share, fall back to the headroom of its priority
+    uint32_t priority = state.priority;
+    if (m_headroomUsed[priority] + bytes <= m_headroom[priority])
+    {
+        NS_LOG_LOGIC ("Queue: " << queueId << " admitted in the headroom of priority: " << priority);
+        state.headroomUsed += bytes;
+        m_headroomUsed[priority] += bytes;
+        m_occupancy += bytes;
+        return true;
+    }
+
+    NS_LOG_LOGIC ("Queue: " << queueId << " rejected, shared used: " << m_sharedUsed
+            << ", queue used: " << state.sharedUsed);
+    return false;
+}
+
+void
+SharedBufferPool::Release (uint32_t queueId, uint32_t bytes)
+{
+    NS_LOG_FUNCTION (this << queueId << bytes);
+    NS_ASSERT (queueId < m_queues.size ());
+
+    QueueState &state = m_queues[queueId];
+    NS_ASSERT_MSG (state.sharedUsed + state.headroomUsed >= bytes,
+            "The queue releases more bytes than it holds");
+
+    // Give back the headroom first, so that the shared area reflects the
+    // bytes the queue is still holding beyond its reservation
+    uint32_t fromHeadroom = std::min (state.headroomUsed, bytes);
+    state.headroomUsed -= fromHeadroom;
+    m_headroomUsed[state.priority] -= fromHeadroom;
+
+    uint32_t fromShared = bytes - fromHeadroom;
+    state.sharedUsed -= fromShared;
+    m_sharedUsed -= fromShared;
+
+    m_occupancy -= bytes;
+}
+
+void
+SharedBufferPool::SetPriorityHeadroom (uint32_t priority, uint32_t bytes)
+{
+    NS_LOG_FUNCTION (this << priority << bytes);
+
+    if (priority >= m_headroom.size ())
+    {
+        m_headroom.resize (priority + 1, 0);
+        m_headroomUsed.resize (priority + 1, 0);
+    }
+
+    m_totalHeadroom = m_totalHeadroom - m_headroom[priority] + bytes;
+    m_headroom[priority] = bytes;
+
+    NS_ABORT_MSG_IF (m_totalHeadroom > m_bufferSize, "The reserved headroom exceeds the buffer size");
+}
+
+uint32_t
+SharedBufferPool::GetPriorityHeadroom (uint32_t priority) const
+{
+    if (priority >= m_headroom.size ())
+    {
+        return 0;
+    }
+    return m_headroom[priority];
+}
+
+uint32_t
+SharedBufferPool::GetBufferSize (void) const
+{
+    return m_bufferSize;
+}
+
+uint32_t
+SharedBufferPool::GetOccupancy (void) const
+{
+    return m_occupancy;
+}
+
+uint32_t
+SharedBufferPool::GetQueueOccupancy (uint32_t queueId) const
+{
+    NS_ASSERT (queueId < m_queues.size ());
+    return m_queues[queueId].sharedUsed + m_queues[queueId].headroomUsed;
+}
+
+uint32_t
+SharedBufferPool::GetQueueThreshold (uint32_t queueId) const
+{
+    NS_ASSERT (queueId < m_queues.size ());
+
+    if (m_policy == SharedBufferPool::STATIC_THRESHOLD)
+    {
+        return m_staticThreshold;
+    }
+
+    uint32_t sharedSize = GetSharedSize ();
+    uint32_t sharedFree = m_sharedUsed < sharedSize ? sharedSize - m_sharedUsed : 0;
+    return static_cast<uint32_t> (m_queues[queueId].alpha * sharedFree);
+}
+
+uint32_t
+SharedBufferPool::GetSharedSize (void) const
+{
+    return m_bufferSize - m_totalHeadroom;
+}
+
+}
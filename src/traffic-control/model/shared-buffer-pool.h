@@ -0,0 +1,108 @@
+#ifndef SHARED_BUFFER_POOL_H
+#define SHARED_BUFFER_POOL_H
+
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * A node-level shared buffer, modelled after the shared packet memory of
+ * merchant silicon switches. All the root queue discs of a node draw from
+ * the same pool, and the admission of each packet is decided by the pool
+ * according to the configured policy:
+ *
+ * - STATIC: each queue may use at most StaticThreshold bytes of the shared area
+ * - DYNAMIC_THRESHOLD: each queue may use at most alpha * (free shared bytes),
+ *   as in Choudhury and Hahne's Dynamic Threshold scheme
+ *
+ * On top of the shared area, every priority can be given a reserved headroom
+ * that is carved out of the buffer and only used by the queues of that
+ * priority once their share of the shared area is exhausted.
+ */
+class SharedBufferPool : public Object
+{
+public:
+    enum AdmissionPolicy
+    {
+        STATIC_THRESHOLD,
+        DYNAMIC_THRESHOLD
+    };
+
+    static TypeId GetTypeId (void);
+
+    SharedBufferPool ();
+
+    virtual ~SharedBufferPool ();
+
+    /**
+     * Register a queue drawing from this pool
+     * @param alpha the Dynamic Threshold alpha of the queue, zero to use the pool default
+     * @param priority the priority whose headroom the queue can use
+     * @return the id used by the queue in the following calls
+     */
+    uint32_t RegisterQueue (double alpha, uint32_t priority);
+
+    /**
+     * Check whether the packet can be admitted and, if so, account it to the queue
+     * @param queueId the id returned by RegisterQueue
+     * @param bytes the size of the packet
+     * @return true if the packet is admitted
+     */
+    bool Admit (uint32_t queueId, uint32_t bytes);
+
+    /**
+     * Return the bytes held by the queue to the pool
+     * @param queueId the id returned by RegisterQueue
+     * @param bytes the number of bytes
+     */
+    void Release (uint32_t queueId, uint32_t bytes);
+
+    void SetPriorityHeadroom (uint32_t priority, uint32_t bytes);
+    uint32_t GetPriorityHeadroom (uint32_t priority) const;
+
+    uint32_t GetBufferSize (void) const;
+    uint32_t GetOccupancy (void) const;
+    uint32_t GetQueueOccupancy (uint32_t queueId) const;
+
+    /**
+     * @param queueId the id returned by RegisterQueue
+     * @return the current number of shared bytes the queue is allowed to hold
+     */
+    uint32_t GetQueueThreshold (uint32_t queueId) const;
+
+protected:
+    virtual void DoDispose (void);
+
+private:
+    struct QueueState
+    {
+        double alpha;
+        uint32_t priority;
+        uint32_t sharedUsed;
+        uint32_t headroomUsed;
+    };
+
+    uint32_t GetSharedSize (void) const;
+
+    uint32_t m_bufferSize;
+    AdmissionPolicy m_policy;
+    uint32_t m_staticThreshold;
+    double m_alpha;
+
+    uint32_t m_totalHeadroom;
+    uint32_t m_sharedUsed;
+    std::vector<uint32_t> m_headroom;
+    std::vector<uint32_t> m_headroomUsed;
+
+    std::vector<QueueState> m_queues;
+
+    TracedValue<uint32_t> m_occupancy;
+};
+
+}
+
+#endif
@@ -15,8 +15,6 @@ public:
 
     virtual ~TCNQueueDisc ();
 
-    bool MarkingECN (Ptr<QueueDiscItem> item);
-
 private:
     // Operations offered by multi queue disc should be the same as queue disc
     virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
@@ -20,6 +20,7 @@
 #include "traffic-control-layer.h"
 #include "ns3/log.h"
 #include "ns3/object-vector.h"
+#include "ns3/pointer.h"
 #include "ns3/packet.h"
 #include "ns3/queue-disc.h"
 
@@ -40,6 +41,10 @@ TrafficControlLayer::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TrafficControlLayer::m_rootQueueDiscs),
                    MakeObjectVectorChecker<QueueDisc> ())
+    .AddAttribute ("SharedBuffer", "The buffer shared by all the root queue discs of the node.",
+                   PointerValue (),
+                   MakePointerAccessor (&TrafficControlLayer::m_sharedBuffer),
+                   MakePointerChecker<SharedBufferPool> ())
   ;
   return tid;
 }
@@ -64,6 +69,7 @@ TrafficControlLayer::DoDispose (void)
   m_rootQueueDiscs.clear ();
   m_handlers.clear ();
   m_netDeviceQueueToQueueDiscMap.clear ();
+  m_sharedBuffer = 0;
   Object::DoDispose ();
 }
 
@@ -109,6 +115,12 @@ TrafficControlLayer::DoInitialize (void)
                 }
             }
 
+          // let the root queue disc draw from the node-level buffer, if any
+          if (m_sharedBuffer != 0)
+            {
+              m_rootQueueDiscs[j]->SetSharedBuffer (m_sharedBuffer);
+            }
+
           // initialize the queue disc
           m_rootQueueDiscs[j]->Initialize ();
         }
@@ -207,6 +219,19 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
   m_rootQueueDiscs[index] = 0;
 }
 
+void
+TrafficControlLayer::SetSharedBuffer (Ptr<SharedBufferPool> pool)
+{
+  NS_LOG_FUNCTION (this << pool);
+  m_sharedBuffer = pool;
+}
+
+Ptr<SharedBufferPool>
+TrafficControlLayer::GetSharedBuffer (void) const
+{
+  return m_sharedBuffer;
+}
+
 void
 TrafficControlLayer::SetNode (Ptr<Node> node)
 {
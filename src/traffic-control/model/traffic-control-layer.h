@@ -157,6 +157,21 @@ public:
    */
   virtual void DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device);
 
+  /**
+   * \brief Set the buffer shared by all the root queue discs of the node.
+   *
+   * The root queue discs are attached to the shared buffer when this object is
+   * initialized, hence the shared buffer must be set before the simulation starts.
+   * \param pool the shared buffer
+   */
+  void SetSharedBuffer (Ptr<SharedBufferPool> pool);
+
+  /**
+   * \brief Get the buffer shared by all the root queue discs of the node.
+   * \return the shared buffer, or 0 if every queue disc has a private buffer.
+   */
+  Ptr<SharedBufferPool> GetSharedBuffer (void) const;
+
   /**
    * \brief Set node associated with this stack.
    * \param node node to set
@@ -237,6 +252,7 @@ private:
   /// This map plays the role of the qdisc field of the netdev_queue struct in Linux
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDeviceQueueToQueueDiscMap;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
+  Ptr<SharedBufferPool> m_sharedBuffer;  //!< Buffer shared by the root queue discs
 };
 
 } // namespace ns3
@@ -1,6 +1,8 @@
 #include "ns3/log.h"
+#include "ns3/enum.h"
 #include "wfq-queue-disc.h"
-#include "ns3/ipv4-queue-disc-item.h"
+
+#include <algorithm>
 
 namespace ns3 {
 
@@ -20,6 +22,12 @@ WFQClass::GetTypeId (void)
 }
 
 WFQClass::WFQClass ()
+    : headStartTime (0),
+      headFinTime (0),
+      lengthBytes (0),
+      weight (1),
+      cl (0),
+      level (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -28,14 +36,22 @@ TypeId
 WFQQueueDisc::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::WFQQueueDisc")
-      .SetParent<Object> ()
+      .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<WFQQueueDisc> ()
+      .AddAttribute ("VirtualTime", "The approximation of the virtual time: SCFQ or STFQ",
+                      EnumValue (WFQQueueDisc::SCFQ),
+                      MakeEnumAccessor (&WFQQueueDisc::m_mode),
+                      MakeEnumChecker (WFQQueueDisc::SCFQ, "SCFQ",
+                                       WFQQueueDisc::STFQ, "STFQ"))
     ;
     return tid;
 }
 
+const uint32_t WFQQueueDisc::VIRTUAL_TIME_SHIFT;
+
 WFQQueueDisc::WFQQueueDisc ()
+    : m_mode (SCFQ)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -54,13 +70,27 @@ WFQQueueDisc::AddWFQClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t weight)
 void
 WFQQueueDisc::AddWFQClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t priority, uint32_t weight)
 {
+    NS_ASSERT_MSG (GetNPackets () == 0, "Cannot add a WFQ class while packets are queued");
+    NS_ASSERT_MSG (weight > 0, "The weight of a WFQ class must be positive");
+
     Ptr<WFQClass> wfqClass = CreateObject<WFQClass> ();
     wfqClass->priority = priority;
     wfqClass->qdisc = qdisc;
-    wfqClass->headFinTime = 0;
-    wfqClass->lengthBytes = 0;
     wfqClass->weight = weight;
+    wfqClass->cl = cl;
     m_WFQs[cl] = wfqClass;
+    AddChildQueueDisc (qdisc);
+
+    m_priorities.AddPriority (priority);
+    m_heaps.assign (m_priorities.GetNLevels (), std::vector<WFQClass *> ());
+    m_virtualTime.assign (m_priorities.GetNLevels (), 0);
+    m_maxFinTime.assign (m_priorities.GetNLevels (), 0);
+    std::map<int32_t, Ptr<WFQClass> >::iterator itr = m_WFQs.begin ();
+    for ( ; itr != m_WFQs.end (); ++itr)
+    {
+        itr->second->level = m_priorities.GetLevel (itr->second->priority);
+        m_heaps[itr->second->level].reserve (m_WFQs.size ());
+    }
 }
 
 bool
@@ -85,13 +115,7 @@ WFQQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
     NS_LOG_LOGIC ("Found class for the enqueued item: " << cl << " with priority: " << wfqClass->priority);
 
-    Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-    if (ipv4Item == 0)
-    {
-        NS_LOG_ERROR ("Cannot convert to the Ipv4QueueDiscItem");
-        Drop (item);
-        return false;
-    }
+    uint32_t length = item->GetPacketSize ();
 
     if (!wfqClass->qdisc->Enqueue (item))
     {
@@ -99,19 +123,17 @@ WFQQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         return false;
     }
 
-    uint32_t length = ipv4Item->GetPacketSize ();
-
-    uint64_t virtualTime = 0;
-    std::map<uint32_t, uint64_t>::iterator itr2 = m_virtualTime.find (wfqClass->priority);
-    if (itr2 != m_virtualTime.end ())
-    {
-        virtualTime = itr2->second;
-    }
-
     if (wfqClass->qdisc->GetNPackets () == 1)
     {
-        wfqClass->headFinTime = length / wfqClass->weight + virtualTime;
-        m_virtualTime[wfqClass->priority] = wfqClass->headFinTime;
+        // A class becoming active starts from the virtual time, unless its
+        // last packet has not finished yet
+        wfqClass->headStartTime = std::max (m_virtualTime[wfqClass->level], wfqClass->headFinTime);
+        wfqClass->headFinTime = wfqClass->headStartTime + GetServiceTime (length, PeekPointer (wfqClass));
+
+        std::vector<WFQClass *> &heap = m_heaps[wfqClass->level];
+        heap.push_back (PeekPointer (wfqClass));
+        std::push_heap (heap.begin (), heap.end (), GetHeapOrder ());
+        m_priorities.SetActive (wfqClass->level);
     }
 
     wfqClass->lengthBytes += length;
@@ -124,92 +146,74 @@ WFQQueueDisc::DoDequeue (void)
 {
     NS_LOG_FUNCTION (this);
 
-    int32_t highestPriority = -1;
-    std::map<int32_t, Ptr<WFQClass> >::const_iterator itr = m_WFQs.begin ();
-
-    // Strict priority scheduling
-    for (; itr != m_WFQs.end (); ++itr)
+    while (true)
     {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) > highestPriority
-                && wfqClass->lengthBytes > 0)
+        // Strict priority scheduling
+        uint32_t level = m_priorities.GetHighest ();
+        if (level == ActivePriorityBitmap::NONE)
         {
-            highestPriority = static_cast<int32_t> (wfqClass->priority);
+            NS_LOG_LOGIC ("Cannot find active queue");
+            return 0;
         }
-    }
 
-    if (highestPriority == -1)
-    {
-        NS_LOG_LOGIC ("Cannot find active queue");
-        return 0;
-    }
+        // The smallest head tag is at the top of the heap
+        HeapOrder order = GetHeapOrder ();
+        std::vector<WFQClass *> &heap = m_heaps[level];
+        WFQClass *wfqClassToDequeue = heap.front ();
 
-    // Find the smallest head finish time
-    uint64_t smallestHeadFinTime = 0;
-    Ptr<WFQClass> wfqClassToDequeue = 0;
+        Ptr<QueueDiscItem> retItem = wfqClassToDequeue->qdisc->Dequeue ();
 
-    itr = m_WFQs.begin ();
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) != highestPriority
-                || wfqClass->lengthBytes == 0)
+        // The child queue disc may drop packets while dequeuing, even all of them
+        wfqClassToDequeue->lengthBytes = wfqClassToDequeue->qdisc->GetNBytes ();
+
+        if (retItem == 0 && wfqClassToDequeue->lengthBytes > 0)
         {
-            continue;
+            NS_LOG_ERROR ("Cannot dequeue from the internal queue disc");
+            return 0;
         }
-        if (wfqClassToDequeue == 0 || wfqClass->headFinTime < smallestHeadFinTime)
+
+        if (retItem != 0)
         {
-            wfqClassToDequeue = wfqClass;
-            smallestHeadFinTime = wfqClass->headFinTime;
+            // The child queue disc may have dropped the peeked packet, the
+            // finish tag is charged with the one sent
+            wfqClassToDequeue->headFinTime = wfqClassToDequeue->headStartTime
+                + GetServiceTime (retItem->GetPacketSize (), wfqClassToDequeue);
+            m_virtualTime[level] = m_mode == STFQ ? wfqClassToDequeue->headStartTime : wfqClassToDequeue->headFinTime;
+            m_maxFinTime[level] = std::max (m_maxFinTime[level], wfqClassToDequeue->headFinTime);
+        }
+        else
+        {
+            // Nothing was sent, the dropped packets are not charged
+            wfqClassToDequeue->headFinTime = wfqClassToDequeue->headStartTime;
         }
-    }
-
-    Ptr<const QueueDiscItem> item = wfqClassToDequeue->qdisc->Peek ();
-
-    if (item == 0)
-    {
-        NS_LOG_LOGIC ("Cannot peek from the internal queue disc");
-        return 0;
-    }
-
-    Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
-    if (ipv4Item == 0)
-    {
-        NS_LOG_ERROR ("Cannot convert to the Ipv4QueueDiscItem");
-        return 0;
-    }
 
-    Ptr<QueueDiscItem> retItem = wfqClassToDequeue->qdisc->Dequeue ();
+        std::pop_heap (heap.begin (), heap.end (), order);
 
-    if (retItem == 0)
-    {
-        NS_LOG_ERROR ("Cannot dequeue from the internal queue disc");
-        return 0;
-    }
-
-    wfqClassToDequeue->lengthBytes -= ipv4Item->GetPacketSize ();
+        if (wfqClassToDequeue->lengthBytes > 0)
+        {
+            // The next packet of a backlogged class starts when the previous one finishes
+            Ptr<const QueueDiscItem> nextItem = wfqClassToDequeue->qdisc->Peek ();
+            uint32_t nextLength = nextItem->GetPacketSize ();
+            wfqClassToDequeue->headStartTime = wfqClassToDequeue->headFinTime;
+            wfqClassToDequeue->headFinTime += GetServiceTime (nextLength, wfqClassToDequeue);
 
-    if (wfqClassToDequeue->lengthBytes > 0)
-    {
-        Ptr<const QueueDiscItem> nextItem = wfqClassToDequeue->qdisc->Peek ();
-        Ptr<const Ipv4QueueDiscItem> ipv4NextItem = DynamicCast<const Ipv4QueueDiscItem> (nextItem);
-        uint32_t nextLength = ipv4NextItem->GetPacketSize ();
-        wfqClassToDequeue->headFinTime += nextLength / wfqClassToDequeue->weight;
-
-        uint64_t virtualTime = 0;
-        std::map<uint32_t, uint64_t>::iterator itr2 = m_virtualTime.find (wfqClassToDequeue->priority);
-        if (itr2 != m_virtualTime.end ())
+            std::push_heap (heap.begin (), heap.end (), order);
+        }
+        else
         {
-            virtualTime = itr2->second;
+            heap.pop_back ();
+            if (heap.empty ())
+            {
+                m_priorities.SetInactive (level);
+                m_virtualTime[level] = m_maxFinTime[level];
+            }
         }
 
-        if (virtualTime < wfqClassToDequeue->headFinTime)
+        if (retItem != 0)
         {
-            m_virtualTime[wfqClassToDequeue->priority] = wfqClassToDequeue->headFinTime;
+            return retItem;
         }
     }
-
-    return retItem;
 }
 
 Ptr<const QueueDiscItem>
@@ -217,47 +221,47 @@ WFQQueueDisc::DoPeek (void) const
 {
     NS_LOG_FUNCTION (this);
 
-    int32_t highestPriority = -1;
-    std::map<int32_t, Ptr<WFQClass> >::const_iterator itr = m_WFQs.begin ();
-
     // Strict priority scheduling
-    for (; itr != m_WFQs.end (); ++itr)
-    {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) > highestPriority
-                && wfqClass->lengthBytes > 0)
-        {
-            highestPriority = static_cast<int32_t> (wfqClass->priority);
-        }
-    }
-
-    if (highestPriority == -1)
+    uint32_t level = m_priorities.GetHighest ();
+    if (level == ActivePriorityBitmap::NONE)
     {
         NS_LOG_LOGIC ("Cannot find active queue");
         return 0;
     }
 
-    // Find the smallest head finish time
-    uint64_t smallestHeadFinTime = 0;
-    Ptr<WFQClass> wfqClassToDequeue = 0;
+    return m_heaps[level].front ()->qdisc->Peek ();
+}
 
-    itr = m_WFQs.begin ();
-    for (; itr != m_WFQs.end (); ++itr)
+uint64_t
+WFQQueueDisc::GetServiceTime (uint32_t length, const WFQClass *wfqClass)
+{
+    return (static_cast<uint64_t> (length) << VIRTUAL_TIME_SHIFT) / wfqClass->weight;
+}
+
+bool
+WFQQueueDisc::LaterFinish (const WFQClass *a, const WFQClass *b)
+{
+    if (a->headFinTime != b->headFinTime)
     {
-        Ptr<WFQClass> wfqClass = itr->second;
-        if (static_cast<int32_t> (wfqClass->priority) != highestPriority
-                || wfqClass->lengthBytes == 0)
-        {
-            continue;
-        }
-        if (wfqClassToDequeue == 0 || wfqClass->headFinTime < smallestHeadFinTime)
-        {
-            wfqClassToDequeue = wfqClass;
-            smallestHeadFinTime = wfqClass->headFinTime;
-        }
+        return a->headFinTime > b->headFinTime;
     }
+    return a->cl > b->cl;
+}
+
+bool
+WFQQueueDisc::LaterStart (const WFQClass *a, const WFQClass *b)
+{
+    if (a->headStartTime != b->headStartTime)
+    {
+        return a->headStartTime > b->headStartTime;
+    }
+    return a->cl > b->cl;
+}
 
-    return wfqClassToDequeue->qdisc->Peek ();
+WFQQueueDisc::HeapOrder
+WFQQueueDisc::GetHeapOrder (void) const
+{
+    return m_mode == STFQ ? &WFQQueueDisc::LaterStart : &WFQQueueDisc::LaterFinish;
 }
 
 bool
@@ -2,7 +2,9 @@
 #define WFQ_QUEUE_DISC_H
 
 #include "ns3/queue-disc.h"
-#include <list>
+#include "active-priority-bitmap.h"
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -18,15 +20,47 @@ public:
 
     Ptr<QueueDisc> qdisc;
 
-    uint64_t headFinTime;
+    uint64_t headStartTime;     //!< Virtual start time of the head packet
+    uint64_t headFinTime;       //!< Virtual finish time of the head packet, or of the last one once idle
     uint32_t lengthBytes;
     uint32_t weight;
+
+    int32_t cl;         //!< The class id, breaks the ties between equal tags
+    uint32_t level;     //!< The dense level of the priority
 };
 
+/**
+ * \ingroup traffic-control
+ *
+ * Weighted fair queueing among the classes of the same priority, strict
+ * priority among the priorities.
+ *
+ * Each packet gets a virtual start time S = max (V, F'), where V is the
+ * virtual time of its priority and F' the finish time of the previous packet
+ * of its class, and a virtual finish time F = S + length / weight. The
+ * virtual times are kept in fixed point with VIRTUAL_TIME_SHIFT fractional
+ * bits, so that small packets of heavy classes still advance their class.
+ * While the priority is busy, the virtual time is approximated as in:
+ *
+ * - SCFQ (Self-Clocked Fair Queueing): the packet with the smallest finish
+ *   time is served and V is the finish time of the packet in service
+ * - STFQ (Start-time Fair Queueing): the packet with the smallest start time
+ *   is served and V is the start time of the packet in service
+ *
+ * Once the priority is idle, V is the largest finish time served.
+ */
 class WFQQueueDisc : public QueueDisc
 {
 public:
 
+    enum VirtualTimeMode
+    {
+        SCFQ,
+        STFQ
+    };
+
+    static const uint32_t VIRTUAL_TIME_SHIFT = 16;
+
     static TypeId GetTypeId (void);
 
     WFQQueueDisc ();
@@ -44,8 +78,29 @@ private:
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
+    /**
+     * \return the virtual service time of length bytes for the class
+     */
+    static uint64_t GetServiceTime (uint32_t length, const WFQClass *wfqClass);
+
+    /**
+     * The heap orders: true if the head of a is served after the head of b
+     */
+    static bool LaterFinish (const WFQClass *a, const WFQClass *b);
+    static bool LaterStart (const WFQClass *a, const WFQClass *b);
+
+    typedef bool (*HeapOrder) (const WFQClass *a, const WFQClass *b);
+    HeapOrder GetHeapOrder (void) const;
+
+    VirtualTimeMode m_mode;
+
+    // The active classes of each priority level are kept in a min-heap of
+    // their head tags, the levels with active classes are tracked in a bitmap
+    ActivePriorityBitmap m_priorities;
+    std::vector<std::vector<WFQClass *> > m_heaps;
+    std::vector<uint64_t> m_virtualTime;
+    std::vector<uint64_t> m_maxFinTime;     //!< The largest finish time served in each level
     std::map<int32_t, Ptr<WFQClass> > m_WFQs;
-    std::map<uint32_t, uint64_t> m_virtualTime;
 
 };
 
@@ -3,7 +3,6 @@
 #include "ns3/object-factory.h"
 #include "xxx-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
-#include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/string.h"
 
 #define DEFAULT_XXX_LIMIT 100
@@ -14,58 +13,6 @@ NS_LOG_COMPONENT_DEFINE ("XXXQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (XXXQueueDisc);
 
-XXXTimestampTag::XXXTimestampTag ()
-    : m_creationTime (Simulator::Now ().GetTimeStep ())
-{
-
-}
-
-TypeId
-XXXTimestampTag::GetTypeId (void)
-{
-    static TypeId tid = TypeId ("ns3::XXXTimestampTag")
-        .SetParent<Tag> ()
-        .AddConstructor<XXXTimestampTag> ()
-    ;
-    return tid;
-}
-
-TypeId
-XXXTimestampTag::GetInstanceTypeId (void) const
-{
-    return GetTypeId ();
-}
-
-uint32_t
-XXXTimestampTag::GetSerializedSize (void) const
-{
-    return sizeof (uint64_t);
-}
-
-void
-XXXTimestampTag::Serialize (TagBuffer i) const
-{
-    i.WriteU64 (m_creationTime);
-}
-
-void
-XXXTimestampTag::Deserialize (TagBuffer i)
-{
-    m_creationTime = i.ReadU64 ();
-}
-
-void
-XXXTimestampTag::Print (std::ostream &os) const
-{
-    os << "CreationTime=" << m_creationTime;
-}
-
-Time
-XXXTimestampTag::GetTxTime (void) const
-{
-    return TimeStep (m_creationTime);
-}
-
 TypeId
 XXXQueueDisc::GetTypeId (void)
 {
@@ -103,10 +50,6 @@ XXXQueueDisc::GetTypeId (void)
 }
 
 XXXQueueDisc::XXXQueueDisc ()
-    : m_firstAboveTime (0),
-      m_marking (false),
-      m_markNext (0),
-      m_markCount (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -121,7 +64,6 @@ XXXQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
     NS_LOG_FUNCTION (this << item);
 
-    Ptr<Packet> p = item->GetPacket ();
     if (m_mode == Queue::QUEUE_MODE_PACKETS && (GetInternalQueue (0)->GetNPackets () + 1 > m_maxPackets))
     {
         Drop (item);
@@ -134,10 +76,6 @@ XXXQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         return false;
     }
 
-    //TODO Add Time Tag
-    XXXTimestampTag tag;
-    p->AddPacketTag (tag);
-
     GetInternalQueue (0)->Enqueue (item);
 
     return true;
@@ -148,74 +86,12 @@ XXXQueueDisc::DoDequeue (void)
 {
     NS_LOG_FUNCTION (this);
 
-    Time now = Simulator::Now ();
-
-    bool instantaneousMarking = false;
-    bool persistentMarking = false;
-
     if (GetInternalQueue (0)->IsEmpty ())
     {
         return NULL;
     }
 
-
-    Ptr<QueueDiscItem> item = StaticCast<QueueDiscItem> (GetInternalQueue (0)->Dequeue ());
-    Ptr<Packet> p = item->GetPacket ();
-
-    XXXTimestampTag tag;
-    bool found = p->RemovePacketTag (tag);
-    if (!found)
-    {
-        NS_LOG_ERROR ("Cannot find the XXX Timestamp Tag");
-        return NULL;
-    }
-
-    Time sojournTime = now - tag.GetTxTime ();
-
-     // First we check the instantaneous queue length
-    if (sojournTime > m_instantMarkingThreshold)
-    {
-        instantaneousMarking = true;
-    }
-
-    //Second we check the persistent marking
-    bool okToMark = OkToMark (p, sojournTime, now);
-    if (m_marking)
-    {
-        if (!okToMark)
-        {
-            m_marking = false;
-        }
-        else if (now >= m_markNext)
-        {
-            m_markCount ++;
-            m_markNext = now + XXXQueueDisc::ControlLaw ();
-            persistentMarking = true;
-        }
-    }
-    else
-    {
-        if (okToMark)
-        {
-            m_marking = true;
-            m_markCount = 1;
-            m_markNext = now + m_persistentMarkingInterval;
-            persistentMarking = true;
-        }
-
-    }
-
-    if (instantaneousMarking || persistentMarking)
-    {
-        if (!XXXQueueDisc::MarkingECN (item))
-        {
-            NS_LOG_ERROR ("Cannot mark ECN");
-            // return NULL;
-            return item; // Hey buddy, if the packet is not ECN supported, we should never drop it
-        }
-    }
-
-    return item;
+    return StaticCast<QueueDiscItem> (GetInternalQueue (0)->Dequeue ());
 }
 
 Ptr<const QueueDiscItem>
@@ -255,65 +131,20 @@ XXXQueueDisc::CheckConfig (void)
         return false;
     }
 
+    // The packets are marked on dequeue if either the instantaneous sojourn
+    // policy or the persistent CoDel law policy says so. The packets which are
+    // not ECN capable are never dropped.
+    AddAqmPolicy (CreateObjectWithAttributes<SojournThresholdPolicy> ("Threshold", TimeValue (m_instantMarkingThreshold)));
+    AddAqmPolicy (CreateObjectWithAttributes<CoDelLawPolicy> ("Interval", TimeValue (m_persistentMarkingInterval),
+                                                              "Target", TimeValue (m_persistentMarkingTarget)));
+
     return true;
 }
 
-
 void
 XXXQueueDisc::InitializeParams (void)
 {
     NS_LOG_FUNCTION (this);
 }
 
-bool
-XXXQueueDisc::MarkingECN (Ptr<QueueDiscItem> item)
-{
-    Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-    if (ipv4Item == 0)   {
-        NS_LOG_ERROR ("Cannot convert the queue disc item to ipv4 queue disc item");
-        return false;
-    }
-
-    Ipv4Header header = ipv4Item -> GetHeader ();
-
-    if (header.GetEcn () != Ipv4Header::ECN_ECT1)   {
-        NS_LOG_ERROR ("Cannot mark because the ECN field is not ECN_ECT1");
-        return false;
-    }
-
-    header.SetEcn(Ipv4Header::ECN_CE);
-    ipv4Item->SetHeader(header);
-    return true;
-}
-
-bool
-XXXQueueDisc::OkToMark (Ptr<Packet> p, Time sojournTime, Time now)
-{
-    if (sojournTime < m_persistentMarkingTarget)
-    {
-        m_firstAboveTime = Time (0);
-        return false;
-    }
-    else
-    {
-        if (m_firstAboveTime == Time (0))
-        {
-            m_firstAboveTime = now + m_persistentMarkingInterval;
-        }
-        else if (now > m_firstAboveTime)
-        {
-            return true;
-        }
-        return false;
-    }
-}
-
-Time
-XXXQueueDisc::ControlLaw (void)
-{
-    uint64_t timeStep = m_persistentMarkingInterval.GetTimeStep ();
-    timeStep = static_cast<uint64_t> (timeStep / sqrt (static_cast<double> (m_markCount)));
-    return TimeStep (timeStep);
-}
-
 }
@@ -0,0 +1,288 @@
+#include "ns3/test.h"
+#include "ns3/aqm-policy.h"
+#include "ns3/tcn-queue-disc.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/shared-buffer-pool.h"
+#include "ns3/packet-filter.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class AqmTestItem : public QueueDiscItem {
+public:
+  AqmTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable);
+  virtual ~AqmTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  bool IsMarked (void) const;
+
+private:
+  AqmTestItem ();
+  AqmTestItem (const AqmTestItem &);
+  AqmTestItem &operator = (const AqmTestItem &);
+
+  bool m_ecnCapable;
+  bool m_marked;
+};
+
+AqmTestItem::AqmTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable)
+  : QueueDiscItem (p, addr, protocol),
+    m_ecnCapable (ecnCapable),
+    m_marked (false)
+{
+}
+
+AqmTestItem::~AqmTestItem ()
+{
+}
+
+void
+AqmTestItem::AddHeader (void)
+{
+}
+
+bool
+AqmTestItem::Mark (void)
+{
+  if (!m_ecnCapable || m_marked)
+    {
+      return false;
+    }
+  m_marked = true;
+  return true;
+}
+
+bool
+AqmTestItem::IsMarked (void) const
+{
+  return m_marked;
+}
+
+static Ptr<AqmTestItem>
+CreateAqmTestItem (bool ecnCapable)
+{
+  Address dest;
+  return Create<AqmTestItem> (Create<Packet> (1000), dest, 0, ecnCapable);
+}
+
+// The policies return their verdicts from the queue state
+class AqmPolicyVerdictTest : public TestCase
+{
+public:
+  AqmPolicyVerdictTest ();
+  virtual void DoRun (void);
+
+private:
+  void CheckCoDelLaw (Ptr<AqmPolicy> policy, Time sojourn, AqmPolicy::Verdict expected);
+};
+
+AqmPolicyVerdictTest::AqmPolicyVerdictTest ()
+  : TestCase ("Verdicts of the sojourn threshold, CoDel law, RED and PIE policies")
+{
+}
+
+void
+AqmPolicyVerdictTest::CheckCoDelLaw (Ptr<AqmPolicy> policy, Time sojourn, AqmPolicy::Verdict expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (policy->Dequeue (CreateAqmTestItem (true), sojourn), expected,
+                         "Unexpected CoDel law verdict at " << Simulator::Now ().GetMicroSeconds () << "us");
+}
+
+void
+AqmPolicyVerdictTest::DoRun (void)
+{
+  Ptr<AqmPolicy> threshold = CreateObjectWithAttributes<SojournThresholdPolicy> ("Threshold", TimeValue (MicroSeconds (10)),
+                                                                                  "Action", EnumValue (AqmPolicy::DROP));
+  NS_TEST_EXPECT_MSG_EQ (threshold->IsEnqueuePolicy (), false, "The sojourn threshold is not an enqueue policy");
+  NS_TEST_EXPECT_MSG_EQ (threshold->Dequeue (CreateAqmTestItem (true), MicroSeconds (10)), AqmPolicy::PASS,
+                         "A sojourn time at the threshold should pass");
+  NS_TEST_EXPECT_MSG_EQ (threshold->Dequeue (CreateAqmTestItem (true), MicroSeconds (11)), AqmPolicy::DROP,
+                         "A sojourn time above the threshold should get the configured action");
+
+  // Above the target from 0us: the first mark after the interval, then after interval / sqrt (2)
+  Ptr<AqmPolicy> codel = CreateObjectWithAttributes<CoDelLawPolicy> ("Interval", TimeValue (MicroSeconds (100)),
+                                                                     "Target", TimeValue (MicroSeconds (10)));
+  Simulator::Schedule (MicroSeconds (0), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::PASS);
+  Simulator::Schedule (MicroSeconds (50), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::PASS);
+  Simulator::Schedule (MicroSeconds (101), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::MARK);
+  Simulator::Schedule (MicroSeconds (150), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::PASS);
+  Simulator::Schedule (MicroSeconds (201), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::MARK);
+  Simulator::Schedule (MicroSeconds (250), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::PASS);
+  Simulator::Schedule (MicroSeconds (272), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::MARK);
+  Simulator::Schedule (MicroSeconds (280), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (5), AqmPolicy::PASS);
+  Simulator::Schedule (MicroSeconds (290), &AqmPolicyVerdictTest::CheckCoDelLaw, this, codel, MicroSeconds (20), AqmPolicy::PASS);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // With a unit weight the average is the queue length the packet finds
+  Ptr<RedPolicy> red = CreateObjectWithAttributes<RedPolicy> ("MinTh", DoubleValue (2),
+                                                              "MaxTh", DoubleValue (4),
+                                                              "MaxP", DoubleValue (1.0),
+                                                              "QW", DoubleValue (1.0));
+  red->AssignStreams (1);
+  NS_TEST_EXPECT_MSG_EQ (red->IsDequeuePolicy (), false, "RED is not a dequeue policy");
+  NS_TEST_EXPECT_MSG_EQ (red->Enqueue (CreateAqmTestItem (true), 2, 2000), AqmPolicy::PASS, "Below MinTh the packets should pass");
+  NS_TEST_EXPECT_MSG_EQ (red->Enqueue (CreateAqmTestItem (true), 5, 5000), AqmPolicy::MARK, "Above MaxTh the packets should be marked");
+  NS_TEST_EXPECT_MSG_EQ (red->GetAverageQueueLength (), 4, "The average should follow the queue length");
+  uint32_t nMarked = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      nMarked += red->Enqueue (CreateAqmTestItem (true), 4, 4000) == AqmPolicy::MARK ? 1 : 0;
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (nMarked, 500, 60, "Half way between the thresholds half of the packets should be marked");
+
+  // A persistent sojourn time above the reference makes the probability grow
+  Ptr<PieProbabilityPolicy> pie = CreateObjectWithAttributes<PieProbabilityPolicy> ("Tupdate", TimeValue (MilliSeconds (1)),
+                                                                                    "QueueDelayReference", TimeValue (MilliSeconds (1)));
+  pie->AssignStreams (2);
+  NS_TEST_EXPECT_MSG_EQ (pie->Enqueue (CreateAqmTestItem (true), 1, 1000), AqmPolicy::PASS, "The first packet should pass");
+  NS_TEST_EXPECT_MSG_EQ (pie->GetProbability (), 0, "The probability should start at zero");
+  Simulator::Stop (MilliSeconds (50));
+  Simulator::Run ();
+  pie->Dequeue (CreateAqmTestItem (true), MilliSeconds (50));
+  pie->Enqueue (CreateAqmTestItem (true), 10, 10000);
+  NS_TEST_EXPECT_MSG_GT (pie->GetProbability (), 0.01, "The probability should grow with the queue delay");
+  Simulator::Destroy ();
+}
+
+// The queue disc applies the most severe verdict of its chain
+class AqmPolicyChainTest : public TestCase
+{
+public:
+  AqmPolicyChainTest ();
+  virtual void DoRun (void);
+
+private:
+  void Dequeue (Ptr<QueueDisc> queue, Ptr<QueueDiscItem> expected, bool marked);
+};
+
+AqmPolicyChainTest::AqmPolicyChainTest ()
+  : TestCase ("Enforcement of the AQM policies chained on a queue disc")
+{
+}
+
+void
+AqmPolicyChainTest::Dequeue (Ptr<QueueDisc> queue, Ptr<QueueDiscItem> expected, bool marked)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (item, expected, "Unexpected packet dequeued at " << Simulator::Now ().GetMicroSeconds () << "us");
+  if (item != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (DynamicCast<AqmTestItem> (item)->IsMarked (), marked, "Unexpected marking");
+    }
+}
+
+void
+AqmPolicyChainTest::DoRun (void)
+{
+  // RED drops on enqueue, a sojourn threshold marks or drops on dequeue
+  Ptr<TCNQueueDisc> queue = CreateObject<TCNQueueDisc> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queue->SetAttribute ("Threshold", TimeValue (Seconds (1)));
+  queue->AddAqmPolicy (CreateObjectWithAttributes<RedPolicy> ("MinTh", DoubleValue (3),
+                                                              "MaxTh", DoubleValue (3),
+                                                              "QW", DoubleValue (1.0),
+                                                              "Action", EnumValue (AqmPolicy::DROP)));
+  queue->AddAqmPolicy (CreateObjectWithAttributes<SojournThresholdPolicy> ("Threshold", TimeValue (MicroSeconds (10)),
+                                                                           "Action", EnumValue (AqmPolicy::MARK_OR_DROP)));
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNAqmPolicies (), 3, "TCN should add its own policy to the chain");
+
+  Ptr<AqmTestItem> notEct = CreateAqmTestItem (false);
+  Ptr<AqmTestItem> ect = CreateAqmTestItem (true);
+  Ptr<AqmTestItem> ect2 = CreateAqmTestItem (true);
+  Ptr<AqmTestItem> late = CreateAqmTestItem (false);
+  queue->Enqueue (notEct);
+  queue->Enqueue (ect);
+  queue->Enqueue (ect2);
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (CreateAqmTestItem (true)), false, "RED should drop the fourth packet");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "The dropped packet should not be counted");
+
+  // The packet which is not ECN capable is dropped, the next ones are marked
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChainTest::Dequeue, this, queue, ect, true);
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChainTest::Dequeue, this, queue, ect2, true);
+  Simulator::Schedule (MicroSeconds (20), &QueueDisc::Enqueue, queue, late);
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChainTest::Dequeue, this, queue, late, false);
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChainTest::Dequeue, this, queue, Ptr<QueueDiscItem> (0), false);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 2, "One packet dropped on enqueue, one on dequeue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The queue disc should be empty");
+  Simulator::Destroy ();
+}
+
+// The drops of a dequeue policy on a child queue disc reach the root
+class AqmPolicyChildTest : public TestCase
+{
+public:
+  AqmPolicyChildTest ();
+  virtual void DoRun (void);
+
+private:
+  void Dequeue (Ptr<QueueDisc> root, Ptr<QueueDiscItem> expected);
+};
+
+AqmPolicyChildTest::AqmPolicyChildTest ()
+  : TestCase ("Dequeue policy dropping on a child of DWRR")
+{
+}
+
+void
+AqmPolicyChildTest::Dequeue (Ptr<QueueDisc> root, Ptr<QueueDiscItem> expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (root->Dequeue (), expected, "Unexpected packet dequeued at " << Simulator::Now ().GetMicroSeconds () << "us");
+}
+
+void
+AqmPolicyChildTest::DoRun (void)
+{
+  Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool> ();
+  pool->SetAttribute ("BufferSize", UintegerValue (10000));
+
+  Ptr<TCNQueueDisc> child = CreateObject<TCNQueueDisc> ();
+  child->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  child->SetAttribute ("Threshold", TimeValue (Seconds (1)));
+  child->AddAqmPolicy (CreateObjectWithAttributes<SojournThresholdPolicy> ("Threshold", TimeValue (MicroSeconds (10)),
+                                                                           "Action", EnumValue (AqmPolicy::DROP)));
+  Ptr<DWRRQueueDisc> root = CreateObject<DWRRQueueDisc> ();
+  // The test items match no filter
+  root->AddDWRRClass (child, PacketFilter::PF_NO_MATCH, 1500);
+  root->SetSharedBuffer (pool);
+  root->Initialize ();
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      root->Enqueue (CreateAqmTestItem (true));
+    }
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 4000, "Every packet should be admitted");
+
+  // The four packets are too old and dropped before the late one is dequeued
+  Ptr<AqmTestItem> late = CreateAqmTestItem (true);
+  Simulator::Schedule (MicroSeconds (20), &QueueDisc::Enqueue, root, late);
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChildTest::Dequeue, this, root, late);
+  Simulator::Schedule (MicroSeconds (20), &AqmPolicyChildTest::Dequeue, this, root, Ptr<QueueDiscItem> (0));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (child->GetTotalDroppedPackets (), 4, "The policy should drop the old packets");
+  NS_TEST_EXPECT_MSG_EQ (root->GetTotalDroppedPackets (), 4, "The drops of the child should be counted by the root");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNPackets (), 0, "The root queue disc should be empty");
+  NS_TEST_EXPECT_MSG_EQ (root->GetNBytes (), 0, "The root queue disc should hold no byte");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 0, "Every byte should be given back to the buffer");
+  Simulator::Destroy ();
+}
+
+static class AqmPolicyTestSuite : public TestSuite
+{
+public:
+  AqmPolicyTestSuite ()
+    : TestSuite ("aqm-policy", UNIT)
+  {
+    AddTestCase (new AqmPolicyVerdictTest (), TestCase::QUICK);
+    AddTestCase (new AqmPolicyChainTest (), TestCase::QUICK);
+    AddTestCase (new AqmPolicyChildTest (), TestCase::QUICK);
+  }
+} g_aqmPolicyTestSuite;
@@ -0,0 +1,432 @@
+#include "ns3/test.h"
+#include "ns3/active-priority-bitmap.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/wfq-queue-disc.h"
+#include "ns3/tcn-queue-disc.h"
+#include "ns3/aqm-policy.h"
+#include "ns3/packet-filter.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+class MultiClassTestItem : public QueueDiscItem {
+public:
+  MultiClassTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, int32_t cl);
+  virtual ~MultiClassTestItem ();
+  virtual void AddHeader (void);
+  int32_t GetClass (void) const;
+
+private:
+  MultiClassTestItem ();
+  MultiClassTestItem (const MultiClassTestItem &);
+  MultiClassTestItem &operator = (const MultiClassTestItem &);
+
+  int32_t m_cl;
+};
+
+MultiClassTestItem::MultiClassTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, int32_t cl)
+  : QueueDiscItem (p, addr, protocol),
+    m_cl (cl)
+{
+}
+
+MultiClassTestItem::~MultiClassTestItem ()
+{
+}
+
+void
+MultiClassTestItem::AddHeader (void)
+{
+}
+
+int32_t
+MultiClassTestItem::GetClass (void) const
+{
+  return m_cl;
+}
+
+// Classifies the test items by the class they carry
+class MultiClassTestFilter : public PacketFilter
+{
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<MultiClassTestItem> (item) != 0;
+  }
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const
+  {
+    return DynamicCast<MultiClassTestItem> (item)->GetClass ();
+  }
+};
+
+// Drops the packets of a given size when they are dequeued
+class MultiClassTestDropPolicy : public AqmPolicy
+{
+public:
+  MultiClassTestDropPolicy (uint32_t size)
+    : AqmPolicy (false, true),
+      m_size (size)
+  {
+  }
+  virtual Verdict Dequeue (Ptr<const QueueDiscItem> item, Time sojourn)
+  {
+    return item->GetPacketSize () == m_size ? DROP : PASS;
+  }
+
+private:
+  uint32_t m_size;
+};
+
+static Ptr<QueueDisc>
+CreateChildQueueDisc (void)
+{
+  Ptr<QueueDisc> qdisc = CreateObject<TCNQueueDisc> ();
+  qdisc->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  qdisc->SetAttribute ("MaxPackets", UintegerValue (1000));
+  return qdisc;
+}
+
+static void
+EnqueueClass (Ptr<QueueDisc> qdisc, int32_t cl, uint32_t nPackets, uint32_t size = 1000)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      qdisc->Enqueue (Create<MultiClassTestItem> (Create<Packet> (size), dest, 0, cl));
+    }
+}
+
+static int32_t
+DequeueClass (Ptr<QueueDisc> qdisc)
+{
+  Ptr<QueueDiscItem> item = qdisc->Dequeue ();
+  if (item == 0)
+    {
+      return -1;
+    }
+  return DynamicCast<MultiClassTestItem> (item)->GetClass ();
+}
+
+// Test 1: the bitmap finds the highest active priority across several words
+class ActivePriorityBitmapTest : public TestCase
+{
+public:
+  ActivePriorityBitmapTest ();
+  virtual void DoRun (void);
+};
+
+ActivePriorityBitmapTest::ActivePriorityBitmapTest ()
+  : TestCase ("Highest active priority of the bitmap")
+{
+}
+
+void
+ActivePriorityBitmapTest::DoRun (void)
+{
+  ActivePriorityBitmap bitmap;
+  for (uint32_t priority = 300; priority > 0; priority -= 3)
+    {
+      bitmap.AddPriority (priority);
+    }
+  NS_TEST_EXPECT_MSG_EQ (bitmap.AddPriority (150), false, "A priority should be registered once");
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetNLevels (), 100, "Every priority should get a level");
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetLevel (3), 0, "The lowest priority should get the lowest level");
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetLevel (300), 99, "The highest priority should get the highest level");
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetHighest (), ActivePriorityBitmap::NONE, "No level should be active");
+
+  bitmap.SetActive (5);
+  bitmap.SetActive (70);
+  bitmap.SetActive (70);
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetHighest (), 70, "The level in the second word should be found");
+  bitmap.SetInactive (70);
+  NS_TEST_EXPECT_MSG_EQ (bitmap.GetHighest (), 5, "The level in the first word should be found");
+  bitmap.SetInactive (5);
+  NS_TEST_EXPECT_MSG_EQ (bitmap.IsEmpty (), true, "No level should be active anymore");
+}
+
+// Test 2: DWRR serves the classes of a priority in proportion of their quanta
+class DWRRQueueDiscSchedulingTest : public TestCase
+{
+public:
+  DWRRQueueDiscSchedulingTest ();
+  virtual void DoRun (void);
+};
+
+DWRRQueueDiscSchedulingTest::DWRRQueueDiscSchedulingTest ()
+  : TestCase ("DWRR round robin with 40 classes and strict priority")
+{
+}
+
+void
+DWRRQueueDiscSchedulingTest::DoRun (void)
+{
+  Ptr<DWRRQueueDisc> dwrr = CreateObject<DWRRQueueDisc> ();
+  dwrr->AddPacketFilter (CreateObject<MultiClassTestFilter> ());
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      dwrr->AddDWRRClass (CreateChildQueueDisc (), cl, 1000 * (1 + cl % 2));
+    }
+  dwrr->AddDWRRClass (CreateChildQueueDisc (), 40, 5, 1000);
+  dwrr->Initialize ();
+
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      EnqueueClass (dwrr, cl, 10);
+    }
+
+  // A round serves one packet of the odd classes and two of the even ones
+  std::vector<uint32_t> served (40, 0);
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      int32_t cl = DequeueClass (dwrr);
+      NS_TEST_ASSERT_MSG_EQ ((cl >= 0 && cl < 40), true, "A packet of a low priority class should be dequeued");
+      served[cl]++;
+    }
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (served[cl], 1u + cl % 2, "Each class should be served its quantum in a round");
+    }
+
+  EnqueueClass (dwrr, 40, 2);
+  NS_TEST_EXPECT_MSG_EQ (DequeueClass (dwrr), 40, "The high priority class should be served first");
+  NS_TEST_EXPECT_MSG_EQ (DequeueClass (dwrr), 40, "The high priority class should be served first");
+  NS_TEST_EXPECT_MSG_EQ ((DequeueClass (dwrr) != 40), true, "The low priority classes should be served again");
+
+  while (DequeueClass (dwrr) >= 0)
+    {
+    }
+  NS_TEST_EXPECT_MSG_EQ (dwrr->GetNPackets (), 0, "Every packet should be dequeued");
+  NS_TEST_EXPECT_MSG_EQ (dwrr->Peek (), 0, "Nothing should be left to peek");
+
+  Simulator::Destroy ();
+}
+
+// Test 3: WFQ serves the backlogged classes of a priority in proportion of their weights
+class WFQQueueDiscSchedulingTest : public TestCase
+{
+public:
+  WFQQueueDiscSchedulingTest ();
+  virtual void DoRun (void);
+};
+
+WFQQueueDiscSchedulingTest::WFQQueueDiscSchedulingTest ()
+  : TestCase ("WFQ weighted shares with 40 classes and strict priority")
+{
+}
+
+void
+WFQQueueDiscSchedulingTest::DoRun (void)
+{
+  static const uint32_t weights[] = {1, 2, 4, 5};
+
+  Ptr<WFQQueueDisc> wfq = CreateObject<WFQQueueDisc> ();
+  wfq->AddPacketFilter (CreateObject<MultiClassTestFilter> ());
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      wfq->AddWFQClass (CreateChildQueueDisc (), cl, weights[cl % 4]);
+    }
+  wfq->AddWFQClass (CreateChildQueueDisc (), 40, 5, 1);
+  wfq->Initialize ();
+
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      EnqueueClass (wfq, cl, 500);
+    }
+
+  // Skip the start, where the classes are served in the order they became active
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      DequeueClass (wfq);
+    }
+
+  std::vector<uint32_t> served (40, 0);
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      int32_t cl = DequeueClass (wfq);
+      NS_TEST_ASSERT_MSG_EQ ((cl >= 0 && cl < 40), true, "A packet of a low priority class should be dequeued");
+      served[cl]++;
+    }
+  for (int32_t cl = 0; cl < 40; cl++)
+    {
+      // 3000 packets for a total weight of 120
+      NS_TEST_EXPECT_MSG_EQ_TOL (served[cl], 25 * weights[cl % 4], 1, "Each class should get its weighted share");
+    }
+
+  EnqueueClass (wfq, 40, 1);
+  NS_TEST_EXPECT_MSG_EQ (DequeueClass (wfq), 40, "The high priority class should be served first");
+
+  while (DequeueClass (wfq) >= 0)
+    {
+    }
+  NS_TEST_EXPECT_MSG_EQ (wfq->GetNPackets (), 0, "Every packet should be dequeued");
+
+  Simulator::Destroy ();
+}
+
+// Test 4: WFQ byte shares under saturating load with heterogeneous packet sizes
+class WFQQueueDiscShareTest : public TestCase
+{
+public:
+  WFQQueueDiscShareTest (uint32_t nClasses, WFQQueueDisc::VirtualTimeMode mode);
+  virtual void DoRun (void);
+
+private:
+  static std::string GetName (uint32_t nClasses, WFQQueueDisc::VirtualTimeMode mode);
+
+  uint32_t m_nClasses;
+  WFQQueueDisc::VirtualTimeMode m_mode;
+};
+
+WFQQueueDiscShareTest::WFQQueueDiscShareTest (uint32_t nClasses, WFQQueueDisc::VirtualTimeMode mode)
+  : TestCase (GetName (nClasses, mode)),
+    m_nClasses (nClasses),
+    m_mode (mode)
+{
+}
+
+std::string
+WFQQueueDiscShareTest::GetName (uint32_t nClasses, WFQQueueDisc::VirtualTimeMode mode)
+{
+  std::ostringstream oss;
+  oss << "WFQ " << (mode == WFQQueueDisc::STFQ ? "STFQ" : "SCFQ") << " byte shares with " << nClasses << " classes";
+  return oss.str ();
+}
+
+void
+WFQQueueDiscShareTest::DoRun (void)
+{
+  Ptr<WFQQueueDisc> wfq = CreateObject<WFQQueueDisc> ();
+  wfq->SetAttribute ("VirtualTime", EnumValue (m_mode));
+  wfq->AddPacketFilter (CreateObject<MultiClassTestFilter> ());
+
+  std::vector<uint32_t> weights (m_nClasses);
+  std::vector<uint32_t> sizes (m_nClasses);
+  uint32_t totalWeight = 0;
+  for (uint32_t cl = 0; cl < m_nClasses; cl++)
+    {
+      weights[cl] = 1 + cl % 8;
+      sizes[cl] = 64 + (cl * 389) % 1437;
+      totalWeight += weights[cl];
+      wfq->AddWFQClass (CreateChildQueueDisc (), cl, weights[cl]);
+    }
+  wfq->Initialize ();
+
+  for (uint32_t cl = 0; cl < m_nClasses; cl++)
+    {
+      EnqueueClass (wfq, cl, 10, sizes[cl]);
+    }
+
+  // Refill the served class after each dequeue to keep every class backlogged
+  std::vector<uint64_t> served (m_nClasses, 0);
+  uint64_t totalServed = 0;
+  for (uint32_t i = 0; i < 400 * totalWeight; i++)
+    {
+      int32_t cl = DequeueClass (wfq);
+      NS_TEST_ASSERT_MSG_EQ ((cl >= 0 && cl < static_cast<int32_t> (m_nClasses)), true, "Every class should stay backlogged");
+      served[cl] += sizes[cl];
+      totalServed += sizes[cl];
+      EnqueueClass (wfq, cl, 1, sizes[cl]);
+    }
+
+  for (uint32_t cl = 0; cl < m_nClasses; cl++)
+    {
+      double share = static_cast<double> (served[cl]) / totalServed;
+      double expected = static_cast<double> (weights[cl]) / totalWeight;
+      NS_TEST_EXPECT_MSG_EQ_TOL (share / expected, 1.0, 0.01, "Class " << cl << " should get its weighted share of the bytes");
+    }
+
+  Simulator::Destroy ();
+}
+
+// Test 5: a parent charges a class with the packet its child sends, not with
+// the peeked one the child drops on dequeue
+class MultiClassChildDropShareTest : public TestCase
+{
+public:
+  MultiClassChildDropShareTest (bool wfq);
+  virtual void DoRun (void);
+
+private:
+  bool m_wfq;
+};
+
+MultiClassChildDropShareTest::MultiClassChildDropShareTest (bool wfq)
+  : TestCase (wfq ? "WFQ shares with a child dropping the peeked packets"
+                  : "DWRR shares with a child dropping the peeked packets"),
+    m_wfq (wfq)
+{
+}
+
+void
+MultiClassChildDropShareTest::DoRun (void)
+{
+  Ptr<QueueDisc> dropping = CreateChildQueueDisc ();
+  dropping->AddAqmPolicy (CreateObject<MultiClassTestDropPolicy> (100));
+
+  Ptr<QueueDisc> qdisc;
+  if (m_wfq)
+    {
+      Ptr<WFQQueueDisc> wfq = CreateObject<WFQQueueDisc> ();
+      wfq->AddWFQClass (dropping, 0, 1);
+      wfq->AddWFQClass (CreateChildQueueDisc (), 1, 1);
+      qdisc = wfq;
+    }
+  else
+    {
+      Ptr<DWRRQueueDisc> dwrr = CreateObject<DWRRQueueDisc> ();
+      dwrr->AddDWRRClass (dropping, 0, 1500);
+      dwrr->AddDWRRClass (CreateChildQueueDisc (), 1, 1500);
+      qdisc = dwrr;
+    }
+  qdisc->AddPacketFilter (CreateObject<MultiClassTestFilter> ());
+  qdisc->Initialize ();
+
+  // The head of class 0 is always a small packet, dropped when dequeued, in
+  // front of a full sized one
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      EnqueueClass (qdisc, 0, 1, 100);
+      EnqueueClass (qdisc, 0, 1, 1500);
+    }
+  EnqueueClass (qdisc, 1, 10, 1500);
+
+  std::vector<uint32_t> served (2, 0);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      int32_t cl = DequeueClass (qdisc);
+      NS_TEST_ASSERT_MSG_EQ ((cl == 0 || cl == 1), true, "Both classes should stay backlogged");
+      served[cl]++;
+      if (cl == 0)
+        {
+          EnqueueClass (qdisc, 0, 1, 100);
+        }
+      EnqueueClass (qdisc, cl, 1, 1500);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (served[0], served[1], 2, "The classes should get the same share of the bytes sent");
+
+  Simulator::Destroy ();
+}
+
+static class MultiClassQueueDiscTestSuite : public TestSuite
+{
+public:
+  MultiClassQueueDiscTestSuite ()
+    : TestSuite ("multi-class-queue-disc", UNIT)
+  {
+    AddTestCase (new ActivePriorityBitmapTest (), TestCase::QUICK);
+    AddTestCase (new DWRRQueueDiscSchedulingTest (), TestCase::QUICK);
+    AddTestCase (new WFQQueueDiscSchedulingTest (), TestCase::QUICK);
+    for (uint32_t nClasses = 4; nClasses <= 64; nClasses *= 2)
+      {
+        AddTestCase (new WFQQueueDiscShareTest (nClasses, WFQQueueDisc::SCFQ), TestCase::QUICK);
+        AddTestCase (new WFQQueueDiscShareTest (nClasses, WFQQueueDisc::STFQ), TestCase::QUICK);
+      }
+    AddTestCase (new MultiClassChildDropShareTest (false), TestCase::QUICK);
+    AddTestCase (new MultiClassChildDropShareTest (true), TestCase::QUICK);
+  }
+} g_multiClassQueueDiscTestSuite;
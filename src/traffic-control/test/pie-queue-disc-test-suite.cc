@@ -0,0 +1,140 @@
+#include "ns3/test.h"
+#include "ns3/pie-queue-disc.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class PieQueueDiscTestItem : public QueueDiscItem {
+public:
+  PieQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~PieQueueDiscTestItem ();
+  virtual void AddHeader (void);
+
+private:
+  PieQueueDiscTestItem ();
+  PieQueueDiscTestItem (const PieQueueDiscTestItem &);
+  PieQueueDiscTestItem &operator = (const PieQueueDiscTestItem &);
+};
+
+PieQueueDiscTestItem::PieQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+PieQueueDiscTestItem::~PieQueueDiscTestItem ()
+{
+}
+
+void
+PieQueueDiscTestItem::AddHeader (void)
+{
+}
+
+// The lazy updates of the drop probability match the periodic ones
+class PieQueueDiscLazyUpdateTest : public TestCase
+{
+public:
+  PieQueueDiscLazyUpdateTest ();
+  virtual void DoRun (void);
+
+private:
+  Ptr<PieQueueDisc> CreatePie (bool lazy);
+  void Enqueue (void);
+  void Dequeue (void);
+
+  Ptr<PieQueueDisc> m_periodic;
+  Ptr<PieQueueDisc> m_lazy;
+  uint32_t m_nSamples;
+  uint32_t m_nDelayMismatches;
+};
+
+PieQueueDiscLazyUpdateTest::PieQueueDiscLazyUpdateTest ()
+  : TestCase ("Lazy drop probability updates are equivalent to the periodic ones"),
+    m_nSamples (0),
+    m_nDelayMismatches (0)
+{
+}
+
+Ptr<PieQueueDisc>
+PieQueueDiscLazyUpdateTest::CreatePie (bool lazy)
+{
+  Ptr<PieQueueDisc> pie = CreateObject<PieQueueDisc> ();
+  pie->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  pie->SetAttribute ("QueueLimit", UintegerValue (1000));
+  pie->SetAttribute ("Tupdate", StringValue ("1ms"));
+  pie->SetAttribute ("QueueDelayReference", StringValue ("1ms"));
+  pie->SetAttribute ("LazyUpdate", BooleanValue (lazy));
+  pie->AssignStreams (1);
+  pie->Initialize ();
+  return pie;
+}
+
+void
+PieQueueDiscLazyUpdateTest::Enqueue (void)
+{
+  Address dest;
+  m_periodic->Enqueue (Create<PieQueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+  m_lazy->Enqueue (Create<PieQueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+}
+
+void
+PieQueueDiscLazyUpdateTest::Dequeue (void)
+{
+  m_periodic->Dequeue ();
+  m_lazy->Dequeue ();
+  m_nSamples++;
+  if (m_periodic->GetQueueDelay () != m_lazy->GetQueueDelay ())
+    {
+      m_nDelayMismatches++;
+    }
+}
+
+void
+PieQueueDiscLazyUpdateTest::DoRun (void)
+{
+  m_periodic = CreatePie (false);
+  m_lazy = CreatePie (true);
+
+  // Two overloaded periods separated by an idle one, with times which never
+  // coincide with the updates
+  for (uint32_t period = 0; period < 2; period++)
+    {
+      Time start = MilliSeconds (150 * period);
+      for (uint32_t i = 0; i < 2000; i++)
+        {
+          Simulator::Schedule (start + NanoSeconds (37000 * i + 500), &PieQueueDiscLazyUpdateTest::Enqueue, this);
+        }
+      for (uint32_t i = 0; i < 2000; i++)
+        {
+          Simulator::Schedule (start + NanoSeconds (41000 * i + 300), &PieQueueDiscLazyUpdateTest::Dequeue, this);
+        }
+    }
+  Simulator::Stop (MilliSeconds (300));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nSamples, 4000, "Every dequeue should have been run");
+  NS_TEST_EXPECT_MSG_EQ (m_nDelayMismatches, 0, "The queue delay samples should be identical");
+  NS_TEST_EXPECT_MSG_GT (m_periodic->GetStats ().unforcedDrop, 0, "The overload should trigger early marks");
+  NS_TEST_EXPECT_MSG_EQ (m_lazy->GetStats ().unforcedDrop, m_periodic->GetStats ().unforcedDrop,
+                         "The early marks should be identical");
+  NS_TEST_EXPECT_MSG_EQ (m_lazy->GetStats ().forcedDrop, m_periodic->GetStats ().forcedDrop,
+                         "The forced drops should be identical");
+
+  m_periodic = 0;
+  m_lazy = 0;
+  Simulator::Destroy ();
+}
+
+static class PieQueueDiscTestSuite : public TestSuite
+{
+public:
+  PieQueueDiscTestSuite ()
+    : TestSuite ("pie-queue-disc", UNIT)
+  {
+    AddTestCase (new PieQueueDiscLazyUpdateTest (), TestCase::QUICK);
+  }
+} g_pieQueueDiscTestSuite;
@@ -0,0 +1,329 @@
+#include "ns3/test.h"
+#include "ns3/tcn-queue-disc.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+
+using namespace ns3;
+
+class SojournTestItem : public QueueDiscItem {
+public:
+  SojournTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~SojournTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  SojournTestItem ();
+  SojournTestItem (const SojournTestItem &);
+  SojournTestItem &operator = (const SojournTestItem &);
+};
+
+SojournTestItem::SojournTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+SojournTestItem::~SojournTestItem ()
+{
+}
+
+void
+SojournTestItem::AddHeader (void)
+{
+}
+
+bool
+SojournTestItem::Mark (void)
+{
+  return true;
+}
+
+// The queue disc stamps the items on enqueue and measures their sojourn time on dequeue
+class QueueDiscSojournTimeTest : public TestCase
+{
+public:
+  QueueDiscSojournTimeTest ();
+  virtual void DoRun (void);
+
+private:
+  void Enqueue (Ptr<QueueDisc> queue);
+  void Dequeue (Ptr<QueueDisc> queue, Time expectedSojourn);
+  void TraceSojourn (Time sojourn);
+
+  Time m_lastSojourn;
+  uint32_t m_nTraced;
+};
+
+QueueDiscSojournTimeTest::QueueDiscSojournTimeTest ()
+  : TestCase ("Enqueue timestamp and sojourn time histogram of the queue discs"),
+    m_nTraced (0)
+{
+}
+
+void
+QueueDiscSojournTimeTest::Enqueue (Ptr<QueueDisc> queue)
+{
+  Address dest;
+  Ptr<QueueDiscItem> item = Create<SojournTestItem> (Create<Packet> (1000), dest, 0);
+  queue->Enqueue (item);
+  NS_TEST_EXPECT_MSG_EQ (item->GetTimeStamp (), Simulator::Now (), "The item should be stamped on enqueue");
+}
+
+void
+QueueDiscSojournTimeTest::Dequeue (Ptr<QueueDisc> queue, Time expectedSojourn)
+{
+  Ptr<QueueDiscItem> item = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_NE (item, 0, "There should be a packet to dequeue");
+  NS_TEST_EXPECT_MSG_EQ (m_lastSojourn, expectedSojourn, "The traced sojourn time should be the time spent in the queue disc");
+}
+
+void
+QueueDiscSojournTimeTest::TraceSojourn (Time sojourn)
+{
+  m_lastSojourn = sojourn;
+  m_nTraced++;
+}
+
+void
+QueueDiscSojournTimeTest::DoRun (void)
+{
+  Ptr<TCNQueueDisc> queue = CreateObject<TCNQueueDisc> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queue->SetAttribute ("SojournTimeBinWidth", TimeValue (MicroSeconds (10)));
+  queue->SetAttribute ("SojournTimeBins", UintegerValue (4));
+  queue->TraceConnectWithoutContext ("SojournTime", MakeCallback (&QueueDiscSojournTimeTest::TraceSojourn, this));
+  queue->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetSojournTimeHistogram ().empty (), true, "The histogram should be empty before any dequeue");
+
+  Simulator::Schedule (MicroSeconds (0), &QueueDiscSojournTimeTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (0), &QueueDiscSojournTimeTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (0), &QueueDiscSojournTimeTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (5), &QueueDiscSojournTimeTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (0), &QueueDiscSojournTimeTest::Dequeue, this, queue, MicroSeconds (0));
+  Simulator::Schedule (MicroSeconds (15), &QueueDiscSojournTimeTest::Dequeue, this, queue, MicroSeconds (15));
+  Simulator::Schedule (MicroSeconds (40), &QueueDiscSojournTimeTest::Dequeue, this, queue, MicroSeconds (40));
+  Simulator::Schedule (MicroSeconds (45), &QueueDiscSojournTimeTest::Dequeue, this, queue, MicroSeconds (40));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nTraced, 4, "Every dequeued packet should be traced");
+
+  const std::vector<uint32_t> &histogram = queue->GetSojournTimeHistogram ();
+  NS_TEST_ASSERT_MSG_EQ (histogram.size (), 4, "The histogram should have the configured number of bins");
+  NS_TEST_EXPECT_MSG_EQ (histogram[0], 1, "One packet has not waited");
+  NS_TEST_EXPECT_MSG_EQ (histogram[1], 1, "One packet has waited between 10us and 20us");
+  NS_TEST_EXPECT_MSG_EQ (histogram[2], 0, "No packet has waited between 20us and 30us");
+  NS_TEST_EXPECT_MSG_EQ (histogram[3], 2, "The last bin should count the longer sojourn times");
+
+  Simulator::Destroy ();
+}
+
+// The queue disc records its events in the telemetry ring buffer and dumps them
+class QueueDiscTelemetryTest : public TestCase
+{
+public:
+  QueueDiscTelemetryTest ();
+  virtual void DoRun (void);
+
+private:
+  Ptr<QueueDisc> CreateQueue (Ptr<QueueDiscTelemetry> telemetry);
+  void Enqueue (Ptr<QueueDisc> queue);
+  void Dequeue (Ptr<QueueDisc> queue);
+  void CheckSamples (const QueueDiscTelemetrySample *samples, uint32_t n, uint32_t first);
+};
+
+QueueDiscTelemetryTest::QueueDiscTelemetryTest ()
+  : TestCase ("Telemetry ring buffer and binary dump of the queue discs")
+{
+}
+
+Ptr<QueueDisc>
+QueueDiscTelemetryTest::CreateQueue (Ptr<QueueDiscTelemetry> telemetry)
+{
+  Ptr<TCNQueueDisc> queue = CreateObject<TCNQueueDisc> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queue->SetAttribute ("MaxPackets", UintegerValue (2));
+  queue->SetAttribute ("Threshold", TimeValue (MicroSeconds (10)));
+  queue->SetTelemetry (telemetry);
+  queue->Initialize ();
+  return queue;
+}
+
+void
+QueueDiscTelemetryTest::Enqueue (Ptr<QueueDisc> queue)
+{
+  Address dest;
+  queue->Enqueue (Create<SojournTestItem> (Create<Packet> (1000), dest, 0));
+}
+
+void
+QueueDiscTelemetryTest::Dequeue (Ptr<QueueDisc> queue)
+{
+  queue->Dequeue ();
+}
+
+// Three enqueues, the last one dropped, then a dequeue marked after 20us
+void
+QueueDiscTelemetryTest::CheckSamples (const QueueDiscTelemetrySample *samples, uint32_t n, uint32_t first)
+{
+  static const uint8_t events[] = { QueueDiscTelemetrySample::ENQUEUE, QueueDiscTelemetrySample::ENQUEUE,
+                                    QueueDiscTelemetrySample::ENQUEUE, QueueDiscTelemetrySample::DROP,
+                                    QueueDiscTelemetrySample::MARK, QueueDiscTelemetrySample::DEQUEUE };
+  static const uint32_t packets[] = { 1, 2, 3, 2, 2, 1 };
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) samples[i].event, (uint32_t) events[first + i], "Unexpected event of sample " << i);
+      NS_TEST_EXPECT_MSG_EQ (samples[i].packets, packets[first + i], "Unexpected packets of sample " << i);
+      NS_TEST_EXPECT_MSG_EQ (samples[i].bytes, packets[first + i] * 1000, "Unexpected bytes of sample " << i);
+      NS_TEST_EXPECT_MSG_EQ (samples[i].size, 1000, "Unexpected size of sample " << i);
+    }
+  if (first + n == 6)
+    {
+      NS_TEST_EXPECT_MSG_EQ (samples[n - 1].time, MicroSeconds (20).GetTimeStep (), "The dequeue should be recorded at 20us");
+      NS_TEST_EXPECT_MSG_EQ (samples[n - 1].sojourn, MicroSeconds (20).GetTimeStep (), "The sojourn time should be recorded on dequeue");
+    }
+}
+
+void
+QueueDiscTelemetryTest::DoRun (void)
+{
+  // The ring buffer keeps the last samples in memory
+  Ptr<QueueDiscTelemetry> ring = CreateObject<QueueDiscTelemetry> ();
+  ring->SetAttribute ("Capacity", UintegerValue (4));
+  Ptr<QueueDisc> ringQueue = CreateQueue (ring);
+
+  // The dump is written whenever the ring buffer is full and on Simulator::Destroy
+  std::string fileName = CreateTempDirFilename ("queue-disc-telemetry.bin");
+  Ptr<QueueDiscTelemetry> dump = CreateObject<QueueDiscTelemetry> ();
+  dump->SetAttribute ("Capacity", UintegerValue (4));
+  dump->SetAttribute ("FileName", StringValue (fileName));
+  Ptr<QueueDisc> dumpQueue = CreateQueue (dump);
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (MicroSeconds (0), &QueueDiscTelemetryTest::Enqueue, this, ringQueue);
+      Simulator::Schedule (MicroSeconds (0), &QueueDiscTelemetryTest::Enqueue, this, dumpQueue);
+    }
+  Simulator::Schedule (MicroSeconds (20), &QueueDiscTelemetryTest::Dequeue, this, ringQueue);
+  Simulator::Schedule (MicroSeconds (20), &QueueDiscTelemetryTest::Dequeue, this, dumpQueue);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (ring->GetNTotalSamples (), 6, "Every event should be recorded");
+  NS_TEST_ASSERT_MSG_EQ (ring->GetNSamples (), 4, "The ring buffer should keep the last Capacity samples");
+  std::vector<QueueDiscTelemetrySample> last;
+  for (uint32_t i = 0; i < ring->GetNSamples (); i++)
+    {
+      last.push_back (ring->GetSample (i));
+    }
+  CheckSamples (&last[0], last.size (), 2);
+
+  Simulator::Destroy ();
+
+  std::vector<QueueDiscTelemetrySample> samples;
+  NS_TEST_ASSERT_MSG_EQ (QueueDiscTelemetry::ReadFile (fileName, samples), true, "The dump should be readable");
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 6, "The dump should hold every sample");
+  CheckSamples (&samples[0], samples.size (), 0);
+}
+
+// The queue disc keeps the time-weighted statistics of its occupancy
+class QueueDiscOccupancyTest : public TestCase
+{
+public:
+  QueueDiscOccupancyTest ();
+  virtual void DoRun (void);
+
+private:
+  void Enqueue (Ptr<QueueDisc> queue);
+  void Dequeue (Ptr<QueueDisc> queue);
+  void CheckWindow (Ptr<QueueDisc> queue);
+  void CheckNewWindow (Ptr<QueueDisc> queue);
+};
+
+QueueDiscOccupancyTest::QueueDiscOccupancyTest ()
+  : TestCase ("Time-weighted occupancy statistics of the queue discs")
+{
+}
+
+void
+QueueDiscOccupancyTest::Enqueue (Ptr<QueueDisc> queue)
+{
+  Address dest;
+  queue->Enqueue (Create<SojournTestItem> (Create<Packet> (1000), dest, 0));
+}
+
+void
+QueueDiscOccupancyTest::Dequeue (Ptr<QueueDisc> queue)
+{
+  queue->Dequeue ();
+}
+
+// 1000 bytes for 20us, 2000 bytes for 20us and empty for 10us
+void
+QueueDiscOccupancyTest::CheckWindow (Ptr<QueueDisc> queue)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetAverageOccupancy (), 1200, 1e-9, "Unexpected average occupancy");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetPeakOccupancy (), 2000, "Unexpected peak occupancy");
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetOccupancyIntegral (), 1200.0 * MicroSeconds (50).GetTimeStep (), 1e-3, "Unexpected occupancy integral");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyWindowStart (), Seconds (0), "The window should start with the simulation");
+
+  DoubleValue average;
+  queue->GetAttribute ("AverageOccupancy", average);
+  NS_TEST_EXPECT_MSG_EQ_TOL (average.Get (), 1200, 1e-9, "The attribute should report the average occupancy");
+
+  std::vector<Time> histogram = queue->GetOccupancyHistogram ();
+  NS_TEST_EXPECT_MSG_EQ (histogram[0], MicroSeconds (10), "The queue disc has been empty for 10us");
+  NS_TEST_EXPECT_MSG_EQ (histogram[10], MicroSeconds (20), "The queue disc has stored 512 to 1023 bytes for 20us");
+  NS_TEST_EXPECT_MSG_EQ (histogram[11], MicroSeconds (20), "The queue disc has stored 1024 to 2047 bytes for 20us");
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyPercentile (0.1), 0, "Unexpected 10th percentile");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyPercentile (0.5), 1023, "Unexpected median");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyPercentile (0.999), 2047, "Unexpected 99.9th percentile");
+
+  queue->ResetOccupancyStats ();
+}
+
+// Empty for 10us and 1000 bytes for 10us
+void
+QueueDiscOccupancyTest::CheckNewWindow (Ptr<QueueDisc> queue)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetAverageOccupancy (), 500, 1e-9, "The average should restart with the window");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetPeakOccupancy (), 1000, "The peak should restart with the window");
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetOccupancyIntegral (), 1000.0 * MicroSeconds (10).GetTimeStep (), 1e-3, "The integral should restart with the window");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyWindowStart (), MicroSeconds (50), "The window should start at the reset");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetOccupancyHistogram ()[11], Seconds (0), "The histogram should restart with the window");
+}
+
+void
+QueueDiscOccupancyTest::DoRun (void)
+{
+  Ptr<TCNQueueDisc> queue = CreateObject<TCNQueueDisc> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_PACKETS));
+  queue->Initialize ();
+
+  Simulator::Schedule (MicroSeconds (0), &QueueDiscOccupancyTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (10), &QueueDiscOccupancyTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (30), &QueueDiscOccupancyTest::Dequeue, this, queue);
+  Simulator::Schedule (MicroSeconds (40), &QueueDiscOccupancyTest::Dequeue, this, queue);
+  Simulator::Schedule (MicroSeconds (50), &QueueDiscOccupancyTest::CheckWindow, this, queue);
+  Simulator::Schedule (MicroSeconds (60), &QueueDiscOccupancyTest::Enqueue, this, queue);
+  Simulator::Schedule (MicroSeconds (70), &QueueDiscOccupancyTest::CheckNewWindow, this, queue);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+static class QueueDiscSojournTestSuite : public TestSuite
+{
+public:
+  QueueDiscSojournTestSuite ()
+    : TestSuite ("queue-disc-sojourn", UNIT)
+  {
+    AddTestCase (new QueueDiscSojournTimeTest (), TestCase::QUICK);
+    AddTestCase (new QueueDiscTelemetryTest (), TestCase::QUICK);
+    AddTestCase (new QueueDiscOccupancyTest (), TestCase::QUICK);
+  }
+} g_queueDiscSojournTestSuite;
@@ -0,0 +1,279 @@
+#include "ns3/test.h"
+#include "ns3/shared-buffer-pool.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class SharedBufferTestItem : public QueueDiscItem {
+public:
+  SharedBufferTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~SharedBufferTestItem ();
+  virtual void AddHeader (void);
+
+private:
+  SharedBufferTestItem ();
+  SharedBufferTestItem (const SharedBufferTestItem &);
+  SharedBufferTestItem &operator = (const SharedBufferTestItem &);
+};
+
+SharedBufferTestItem::SharedBufferTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+SharedBufferTestItem::~SharedBufferTestItem ()
+{
+}
+
+void
+SharedBufferTestItem::AddHeader (void)
+{
+}
+
+// Test 1: Dynamic Threshold admission and priority headroom on the pool itself
+class SharedBufferPoolDynamicThresholdTest : public TestCase
+{
+public:
+  SharedBufferPoolDynamicThresholdTest ();
+  virtual void DoRun (void);
+};
+
+SharedBufferPoolDynamicThresholdTest::SharedBufferPoolDynamicThresholdTest ()
+  : TestCase ("Dynamic Threshold admission and per-priority headroom")
+{
+}
+
+void
+SharedBufferPoolDynamicThresholdTest::DoRun (void)
+{
+  Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool> ();
+  pool->SetAttribute ("BufferSize", UintegerValue (12000));
+  pool->SetAttribute ("Policy", EnumValue (SharedBufferPool::DYNAMIC_THRESHOLD));
+  pool->SetPriorityHeadroom (1, 2000);
+
+  uint32_t q0 = pool->RegisterQueue (1.0, 0);
+  uint32_t q1 = pool->RegisterQueue (0.5, 1);
+
+  // Shared area is 10000 bytes, with alpha 1 the queue converges to half of it
+  uint32_t admitted = 0;
+  while (pool->Admit (q0, 1000))
+    {
+      admitted++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (admitted, 5, "With alpha 1 a single queue should take half of the shared area");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetQueueOccupancy (q0), 5000, "The pool should account the admitted bytes");
+
+  // Free shared bytes are 5000, thus the threshold of q1 is 2500 bytes
+  NS_TEST_EXPECT_MSG_EQ (pool->GetQueueThreshold (q1), 2500, "The threshold should follow the free shared bytes");
+  admitted = 0;
+  while (pool->Admit (q1, 1000))
+    {
+      admitted++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (admitted, 4, "q1 should get its shared bytes plus the headroom of its priority");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 9000, "Occupancy should include the headroom bytes");
+
+  // The headroom is given back first
+  pool->Release (q1, 2000);
+  NS_TEST_EXPECT_MSG_EQ (pool->Admit (q1, 1000), true, "The headroom should be available again");
+
+  pool->Release (q0, 5000);
+  NS_TEST_EXPECT_MSG_EQ (pool->GetQueueOccupancy (q0), 0, "All the bytes of q0 should be released");
+}
+
+// Test 2: root queue discs reject the packets the shared buffer does not admit
+class SharedBufferQueueDiscAdmissionTest : public TestCase
+{
+public:
+  SharedBufferQueueDiscAdmissionTest ();
+  virtual void DoRun (void);
+};
+
+SharedBufferQueueDiscAdmissionTest::SharedBufferQueueDiscAdmissionTest ()
+  : TestCase ("Queue discs attached to a static shared buffer")
+{
+}
+
+void
+SharedBufferQueueDiscAdmissionTest::DoRun (void)
+{
+  Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool> ();
+  pool->SetAttribute ("BufferSize", UintegerValue (5000));
+  pool->SetAttribute ("Policy", EnumValue (SharedBufferPool::STATIC_THRESHOLD));
+  pool->SetAttribute ("StaticThreshold", UintegerValue (3000));
+
+  Ptr<RedQueueDisc> first = CreateObject<RedQueueDisc> ();
+  Ptr<RedQueueDisc> second = CreateObject<RedQueueDisc> ();
+  first->SetAttribute ("QueueLimit", UintegerValue (100));
+  second->SetAttribute ("QueueLimit", UintegerValue (100));
+  first->SetSharedBuffer (pool);
+  second->SetSharedBuffer (pool);
+  first->Initialize ();
+  second->Initialize ();
+
+  Address dest;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      first->Enqueue (Create<SharedBufferTestItem> (Create<Packet> (1000), dest, 0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (first->GetNPackets (), 3, "The static threshold should limit the first queue disc");
+  NS_TEST_EXPECT_MSG_EQ (first->GetTotalDroppedPackets (), 1, "The rejected packet should be counted as dropped");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      second->Enqueue (Create<SharedBufferTestItem> (Create<Packet> (1000), dest, 0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (second->GetNPackets (), 2, "The second queue disc should be limited by the buffer size");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 5000, "The buffer should be full");
+
+  first->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 4000, "A dequeue should release bytes to the buffer");
+  NS_TEST_EXPECT_MSG_EQ (second->Enqueue (Create<SharedBufferTestItem> (Create<Packet> (1000), dest, 0)), true,
+                         "The released bytes should be available to the other queue disc");
+
+  Simulator::Destroy ();
+}
+
+// Test 3: the packets a child queue disc drops while dequeued leave the shared buffer
+class SharedBufferChildDropTest : public TestCase
+{
+public:
+  SharedBufferChildDropTest ();
+  virtual void DoRun (void);
+
+private:
+  void Dequeue (Ptr<QueueDisc> root, Ptr<SharedBufferPool> pool);
+};
+
+SharedBufferChildDropTest::SharedBufferChildDropTest ()
+  : TestCase ("Drops of a CoDel child under DWRR give the bytes back to the shared buffer")
+{
+}
+
+void
+SharedBufferChildDropTest::Dequeue (Ptr<QueueDisc> root, Ptr<SharedBufferPool> pool)
+{
+  root->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), root->GetNBytes (),
+                         "The buffer should hold the bytes of the root queue disc");
+}
+
+void
+SharedBufferChildDropTest::DoRun (void)
+{
+  Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool> ();
+  pool->SetAttribute ("BufferSize", UintegerValue (100000));
+
+  Ptr<CoDelQueueDisc> codel = CreateObject<CoDelQueueDisc> ();
+  codel->SetAttribute ("MarkingMode", BooleanValue (false));
+  Ptr<DWRRQueueDisc> dwrr = CreateObject<DWRRQueueDisc> ();
+  // The test items match no filter
+  dwrr->AddDWRRClass (codel, PacketFilter::PF_NO_MATCH, 1000);
+  dwrr->SetSharedBuffer (pool);
+  dwrr->Initialize ();
+
+  Address dest;
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      dwrr->Enqueue (Create<SharedBufferTestItem> (Create<Packet> (1000), dest, 0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 50000, "Every packet should be admitted");
+
+  // The sojourn times exceed the CoDel target for longer than an interval
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      Simulator::Schedule (MilliSeconds (200 + 10 * i), &SharedBufferChildDropTest::Dequeue, this, dwrr, pool);
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_GT (codel->GetTotalDroppedPackets (), 0, "CoDel should drop packets while dequeued");
+  NS_TEST_EXPECT_MSG_EQ (dwrr->GetTotalDroppedPackets (), codel->GetTotalDroppedPackets (),
+                         "The drops of the child should be counted by the root");
+  NS_TEST_EXPECT_MSG_EQ (dwrr->GetNPackets (), 0, "The root queue disc should be drained");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 0, "Every byte should be given back to the buffer");
+
+  Simulator::Destroy ();
+}
+
+// Test 4: the requeued packets keep their bytes in the area they were admitted in
+class SharedBufferRequeueTest : public TestCase
+{
+public:
+  SharedBufferRequeueTest ();
+  virtual void DoRun (void);
+};
+
+SharedBufferRequeueTest::SharedBufferRequeueTest ()
+  : TestCase ("Packets requeued from the headroom of the shared buffer")
+{
+}
+
+void
+SharedBufferRequeueTest::DoRun (void)
+{
+  Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool> ();
+  pool->SetAttribute ("BufferSize", UintegerValue (5000));
+  pool->SetAttribute ("Policy", EnumValue (SharedBufferPool::STATIC_THRESHOLD));
+  pool->SetAttribute ("StaticThreshold", UintegerValue (3000));
+  pool->SetPriorityHeadroom (1, 2000);
+  uint32_t other = pool->RegisterQueue (0.0, 1);
+
+  // The device rejects the packets larger than its MTU, which are requeued
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetChannel (CreateObject<SimpleChannel> ());
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetMtu (500);
+  device->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  queue->SetAttribute ("QueueLimit", UintegerValue (100));
+  queue->SetAttribute ("SharedBufferPriority", UintegerValue (1));
+  queue->SetNetDevice (device);
+  queue->SetSharedBuffer (pool);
+  queue->Initialize ();
+
+  Address dest = Mac48Address::Allocate ();
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->Enqueue (Create<SharedBufferTestItem> (Create<Packet> (1000), dest, 0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 5000, "The shared area and the headroom should be full");
+
+  queue->Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalRequeuedPackets (), 1, "The packet should be requeued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 5, "The requeued packet should still be counted");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 5000, "The requeued packet should still be in the buffer");
+  NS_TEST_EXPECT_MSG_EQ (pool->Admit (other, 1000), false, "The requeued packet should still hold the headroom");
+
+  device->SetMtu (1500);
+  queue->Run ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "Every packet should be sent");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetOccupancy (), 0, "Every byte should be given back to the buffer");
+
+  Simulator::Destroy ();
+}
+
+static class SharedBufferPoolTestSuite : public TestSuite
+{
+public:
+  SharedBufferPoolTestSuite ()
+    : TestSuite ("shared-buffer-pool", UNIT)
+  {
+    AddTestCase (new SharedBufferPoolDynamicThresholdTest (), TestCase::QUICK);
+    AddTestCase (new SharedBufferQueueDiscAdmissionTest (), TestCase::QUICK);
+    AddTestCase (new SharedBufferChildDropTest (), TestCase::QUICK);
+    AddTestCase (new SharedBufferRequeueTest (), TestCase::QUICK);
+  }
+} g_sharedBufferPoolTestSuite;
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ipv4-xpath-path-helper.h"
+#include "ns3/log.h"
+#include "ns3/ipv4.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4-xpath-tag.h"
+
+#include <deque>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4XPathPathHelper");
+
+Ipv4XPathPathHelper::Ipv4XPathPathHelper ()
+  : m_topologyBuilt (false)
+{
+
+}
+
+void
+Ipv4XPathPathHelper::AddSwitch (Ptr<Node> node)
+{
+  if (m_switchIndex.find (node->GetId ()) != m_switchIndex.end ())
+  {
+    return;
+  }
+  m_switchIndex[node->GetId ()] = m_switches.size ();
+  m_switches.push_back (node);
+  m_topologyBuilt = false;
+}
+
+void
+Ipv4XPathPathHelper::AddSwitches (NodeContainer nodes)
+{
+  for (NodeContainer::Iterator itr = nodes.Begin (); itr != nodes.End (); ++itr)
+  {
+    AddSwitch (*itr);
+  }
+}
+
+std::vector<uint32_t>
+Ipv4XPathPathHelper::GetPaths (Ptr<Node> src, Ptr<Node> dst)
+{
+  BuildTopology ();
+
+  std::map<uint32_t, uint32_t>::const_iterator srcItr = m_switchIndex.find (src->GetId ());
+  std::map<uint32_t, uint32_t>::const_iterator dstItr = m_switchIndex.find (dst->GetId ());
+  NS_ASSERT_MSG (srcItr != m_switchIndex.end () && dstItr != m_switchIndex.end (),
+                 "Paths can only be enumerated between switches added to the helper");
+
+  std::vector<uint32_t> paths;
+  const std::vector<uint32_t> &distances = GetDistances (dstItr->second);
+  if (distances[srcItr->second] == std::numeric_limits<uint32_t>::max ())
+  {
+    NS_LOG_WARN ("Switch: " << src->GetId () << " cannot reach switch: " << dst->GetId ());
+    return paths;
+  }
+
+  std::vector<uint32_t> ports;
+  EnumeratePaths (srcItr->second, dstItr->second, distances, ports, paths);
+  return paths;
+}
+
+void
+Ipv4XPathPathHelper::BuildTopology (void)
+{
+  if (m_topologyBuilt)
+  {
+    return;
+  }
+
+  m_links.assign (m_switches.size (), std::vector<std::pair<uint32_t, uint32_t> > ());
+  m_distances.clear ();
+
+  for (uint32_t i = 0; i < m_switches.size (); i++)
+  {
+    Ptr<Ipv4> ipv4 = m_switches[i]->GetObject<Ipv4> ();
+    NS_ASSERT_MSG (ipv4, "The switches should have an Ipv4 stack installed");
+
+    // Interface 0 is the loopback, the ports XPath forwards to are the Ipv4 interfaces
+    for (uint32_t port = 1; port < ipv4->GetNInterfaces (); port++)
+    {
+      Ptr<NetDevice> dev = ipv4->GetNetDevice (port);
+      Ptr<Channel> channel = dev->GetChannel ();
+      if (channel == 0)
+      {
+        continue;
+      }
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+      {
+        Ptr<NetDevice> peerDev = channel->GetDevice (j);
+        if (peerDev == dev)
+        {
+          continue;
+        }
+        std::map<uint32_t, uint32_t>::const_iterator peerItr = m_switchIndex.find (peerDev->GetNode ()->GetId ());
+        if (peerItr != m_switchIndex.end ())
+        {
+          m_links[i].push_back (std::make_pair (port, peerItr->second));
+        }
+      }
+    }
+  }
+
+  m_topologyBuilt = true;
+}
+
+const std::vector<uint32_t> &
+Ipv4XPathPathHelper::GetDistances (uint32_t dst)
+{
+  std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_distances.find (dst);
+  if (itr != m_distances.end ())
+  {
+    return itr->second;
+  }
+
+  // The links among the switches are bidirectional, a BFS from the destination
+  // gives the hop distance of every switch towards it
+  std::vector<uint32_t> &distances = m_distances[dst];
+  distances.assign (m_switches.size (), std::numeric_limits<uint32_t>::max ());
+  distances[dst] = 0;
+  std::deque<uint32_t> pending;
+  pending.push_back (dst);
+  while (!pending.empty ())
+  {
+    uint32_t current = pending.front ();
+    pending.pop_front ();
+    for (uint32_t i = 0; i < m_links[current].size (); i++)
+    {
+      uint32_t peer = m_links[current][i].second;
+      if (distances[peer] == std::numeric_limits<uint32_t>::max ())
+      {
+        distances[peer] = distances[current] + 1;
+        pending.push_back (peer);
+      }
+    }
+  }
+  return distances;
+}
+
+void
+Ipv4XPathPathHelper::EnumeratePaths (uint32_t current, uint32_t dst, const std::vector<uint32_t> &distances,
+                                     std::vector<uint32_t> &ports, std::vector<uint32_t> &paths) const
+{
+  if (current == dst)
+  {
+    paths.push_back (Ipv4XPathTag::EncodePathId (ports));
+    return;
+  }
+
+  for (uint32_t i = 0; i < m_links[current].size (); i++)
+  {
+    const std::pair<uint32_t, uint32_t> &link = m_links[current][i];
+    if (distances[link.second] + 1 != distances[current])
+    {
+      continue;
+    }
+    ports.push_back (link.first);
+    EnumeratePaths (link.second, dst, distances, ports, paths);
+    ports.pop_back ();
+  }
+}
+
+}
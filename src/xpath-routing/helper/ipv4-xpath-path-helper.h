@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef XPATH_PATH_HELPER_H
+#define XPATH_PATH_HELPER_H
+
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Enumerate the XPath path ids between the switches of a Clos or fat-tree
+ * topology. The switches are the nodes running Ipv4XPathRouting, and the
+ * paths between two of them are all the shortest paths over the links among
+ * the switches, which in these topologies are exactly the up-down paths.
+ *
+ * The path ids use the binary format of Ipv4XPathTag, they list the output
+ * port of every hop from the source switch up to, but not including, the
+ * destination switch.
+ */
+class Ipv4XPathPathHelper
+{
+public:
+    Ipv4XPathPathHelper ();
+
+    void AddSwitch (Ptr<Node> node);
+
+    void AddSwitches (NodeContainer nodes);
+
+    /**
+     * \param src the switch the source route starts at, e.g., the source ToR
+     * \param dst the switch the source route ends at, e.g., the destination ToR
+     * \return the path ids of all the shortest paths from src to dst
+     */
+    std::vector<uint32_t> GetPaths (Ptr<Node> src, Ptr<Node> dst);
+
+private:
+    void BuildTopology (void);
+
+    const std::vector<uint32_t> &GetDistances (uint32_t dst);
+
+    void EnumeratePaths (uint32_t current, uint32_t dst, const std::vector<uint32_t> &distances,
+                         std::vector<uint32_t> &ports, std::vector<uint32_t> &paths) const;
+
+    std::vector<Ptr<Node> > m_switches;
+    std::map<uint32_t, uint32_t> m_switchIndex;
+
+    bool m_topologyBuilt;
+    // The (port, neighbour switch) links of each switch
+    std::vector<std::vector<std::pair<uint32_t, uint32_t> > > m_links;
+    std::map<uint32_t, std::vector<uint32_t> > m_distances;
+};
+
+}
+
+#endif /* XPATH_PATH_HELPER_H */
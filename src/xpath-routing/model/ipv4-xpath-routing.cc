@@ -69,7 +69,7 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
 
   Ipv4XPathTag ipv4XPathTag;
-  bool found = packet->RemovePacketTag (ipv4XPathTag);
+  bool found = packet->PeekPacketTag (ipv4XPathTag);
   if (!found)
   {
     NS_LOG_ERROR (this << " Cannot perform XPath routing without knowing the Path ID");
@@ -77,22 +77,17 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  uint32_t pathId = ipv4XPathTag.GetPathId ();
-
-  if (pathId == 0)
+  if (ipv4XPathTag.IsFinalHop ())
   {
     NS_LOG_LOGIC (this << " Reaching final hop, XPath will not handle the final hop");
+    packet->RemovePacketTag (ipv4XPathTag);
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
 
-  uint32_t currentPort = pathId - (pathId / 100) * 100;
-
-  // NS_LOG_LOGIC (this << " Current port is: " << currentPort);
-
-  // std::cout << "Path: " << pathId << ", Current Port: " << currentPort << std::endl;
+  uint32_t currentPort = ipv4XPathTag.GetCurrentPort ();
 
-  if (currentPort > m_ipv4->GetNInterfaces ())
+  if (currentPort >= m_ipv4->GetNInterfaces ())
   {
     NS_LOG_ERROR (this << " Port number error");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -101,48 +96,64 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   NS_LOG_LOGIC (this << " Forwarding packet: " << packet << " to port: " << currentPort);
 
-  ipv4XPathTag.SetPathId (pathId / 100);
-  packet->AddPacketTag (ipv4XPathTag);
+  // Advance the hop pointer without removing the tag from the packet
+  ipv4XPathTag.NextHop ();
+  packet->ReplacePacketTag (ipv4XPathTag);
 
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (currentPort);
+  Ptr<Ipv4Route> route = Ipv4XPathRouting::ConstructIpv4Route (currentPort, destAddress);
+  ucb (route, packet, header);
+
+  return true;
+}
+
+Ptr<Ipv4Route>
+Ipv4XPathRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
+{
+  // Routes are never modified once built, reuse the one of this port and destination
+  std::pair<uint32_t, Ipv4Address> key = std::make_pair (port, destAddress);
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> >::iterator routeItr = m_routeCache.find (key);
+  if (routeItr != m_routeCache.end ())
+  {
+    return routeItr->second;
+  }
+
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
   Ptr<Channel> channel = dev->GetChannel ();
   uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
   Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
   uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
   Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress (nextIf, 0).GetLocal ();
   Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (currentPort));
+  route->SetOutputDevice (dev);
   route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (currentPort, 0).GetLocal ());
+  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
   route->SetDestination (destAddress);
-
-  ucb (route, packet, header);
-
-  return true;
+  m_routeCache[key] = route;
+  return route;
 }
 
 void
 Ipv4XPathRouting::NotifyInterfaceUp (uint32_t interface)
 {
-
+  m_routeCache.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyInterfaceDown (uint32_t interface)
 {
-
+  m_routeCache.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_routeCache.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_routeCache.clear ();
 }
 
 void
@@ -162,6 +173,7 @@ Ipv4XPathRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4XPathRouting::DoDispose (void)
 {
+  m_routeCache.clear ();
   m_ipv4 = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -3,8 +3,10 @@
 #define IPV4_XPATH_ROUTING_H
 
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
 
 #include <map>
+#include <utility>
 
 namespace ns3 {
 
@@ -33,7 +35,12 @@ public:
 
 private:
 
+  Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
+
   Ptr<Ipv4> m_ipv4;
+
+  // (port, destination) to route cache, flushed whenever an interface or address changes
+  std::map<std::pair<uint32_t, Ipv4Address>, Ptr<Ipv4Route> > m_routeCache;
 };
 
 }
@@ -2,6 +2,15 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-xpath-routing.h"
+#include "ns3/ipv4-xpath-path-helper.h"
+#include "ns3/ipv4-xpath-tag.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +55,136 @@ XpathRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// The source route of the tag is walked hop by hop in both path id formats
+class XpathTagTestCase : public TestCase
+{
+public:
+  XpathTagTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+XpathTagTestCase::XpathTagTestCase ()
+  : TestCase ("XPath tag walks binary and legacy decimal path ids")
+{
+}
+
+void
+XpathTagTestCase::DoRun (void)
+{
+  std::vector<uint32_t> ports;
+  ports.push_back (2);
+  ports.push_back (63);
+  ports.push_back (17);
+
+  Ipv4XPathTag tag;
+  tag.SetPathId (Ipv4XPathTag::EncodePathId (ports));
+  NS_TEST_ASSERT_MSG_EQ (tag.GetHopCount (), 3, "The binary path id should hold three hops");
+
+  // The hop pointer should survive the serialization in the packet tag list
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddPacketTag (tag);
+  for (uint32_t i = 0; i < ports.size (); i++)
+    {
+      Ipv4XPathTag hopTag;
+      NS_TEST_ASSERT_MSG_EQ (packet->PeekPacketTag (hopTag), true, "The tag should be on the packet");
+      NS_TEST_ASSERT_MSG_EQ (hopTag.IsFinalHop (), false, "The route should not be over yet");
+      NS_TEST_EXPECT_MSG_EQ (hopTag.GetCurrentPort (), ports[i], "Unexpected port at hop " << i);
+      hopTag.NextHop ();
+      packet->ReplacePacketTag (hopTag);
+    }
+  NS_TEST_ASSERT_MSG_EQ (packet->PeekPacketTag (tag), true, "The tag should be on the packet");
+  NS_TEST_EXPECT_MSG_EQ (tag.IsFinalHop (), true, "All the hops should have been taken");
+
+  tag.SetPathId (302);
+  NS_TEST_ASSERT_MSG_EQ (tag.GetHopCount (), 2, "The decimal path id should hold two hops");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetCurrentPort (), 2, "The first hop is in the lowest digits");
+  tag.NextHop ();
+  NS_TEST_EXPECT_MSG_EQ (tag.GetCurrentPort (), 3, "Unexpected port at the second hop");
+  tag.NextHop ();
+  NS_TEST_EXPECT_MSG_EQ (tag.IsFinalHop (), true, "All the hops should have been taken");
+}
+
+// The helper finds all the leaf to leaf paths of a leaf-spine topology
+class XpathPathHelperTestCase : public TestCase
+{
+public:
+  XpathPathHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Connect (Ptr<Node> a, Ptr<Node> b);
+};
+
+XpathPathHelperTestCase::XpathPathHelperTestCase ()
+  : TestCase ("XPath path helper enumerates the paths of a leaf-spine topology")
+{
+}
+
+void
+XpathPathHelperTestCase::Connect (Ptr<Node> a, Ptr<Node> b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> devA = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> devB = CreateObject<SimpleNetDevice> ();
+  devA->SetChannel (channel);
+  devB->SetChannel (channel);
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  a->GetObject<Ipv4> ()->AddInterface (devA);
+  b->GetObject<Ipv4> ()->AddInterface (devB);
+}
+
+void
+XpathPathHelperTestCase::DoRun (void)
+{
+  NodeContainer leaves;
+  leaves.Create (2);
+  NodeContainer spines;
+  spines.Create (2);
+  NodeContainer hosts;
+  hosts.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (leaves);
+  internet.Install (spines);
+  internet.Install (hosts);
+
+  // Leaf interfaces 1 and 2 go to the spines, spine interfaces 1 and 2 go to the leaves
+  for (uint32_t i = 0; i < leaves.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < spines.GetN (); j++)
+        {
+          Connect (leaves.Get (i), spines.Get (j));
+        }
+    }
+  Connect (leaves.Get (0), hosts.Get (0));
+  Connect (leaves.Get (1), hosts.Get (1));
+
+  Ipv4XPathPathHelper helper;
+  helper.AddSwitches (leaves);
+  helper.AddSwitches (spines);
+
+  std::vector<uint32_t> paths = helper.GetPaths (leaves.Get (0), leaves.Get (1));
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 2, "There should be one path through each spine");
+
+  for (uint32_t j = 0; j < spines.GetN (); j++)
+    {
+      std::vector<uint32_t> ports;
+      ports.push_back (j + 1);
+      ports.push_back (2);
+      uint32_t expected = Ipv4XPathTag::EncodePathId (ports);
+      NS_TEST_EXPECT_MSG_EQ ((std::find (paths.begin (), paths.end (), expected) != paths.end ()), true,
+                             "Missing the path through spine " << j);
+    }
+
+  paths = helper.GetPaths (leaves.Get (0), spines.Get (1));
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 1, "A leaf should reach a spine directly");
+
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +200,8 @@ XpathRoutingTestSuite::XpathRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new XpathRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new XpathTagTestCase, TestCase::QUICK);
+  AddTestCase (new XpathPathHelperTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -22,6 +22,8 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <new>
+#include <cstdlib>
 #include <string.h>
 
 #include "ns3/core-module.h"
@@ -39,13 +41,35 @@ std::string g_me;
 // Output field width
 int g_fwidth = 6;
 
+// Count the memory allocations of the program, to report them per event
+uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size != 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
 class Bench 
 {
 public:
   Bench (const uint32_t population, const uint32_t total)
   : m_population (population),
     m_total (total),
-    m_count (0)
+    m_count (0),
+    m_rearm (false)
   { };
   
   void SetRandomStream (Ptr<RandomVariableStream> stream)
@@ -62,15 +86,23 @@ public:
   {
     m_total = total;
   }
+
+  void SetRearm (bool rearm)
+  {
+    m_rearm = rearm;
+  }
     
   void RunBench (void);
 private:
   void Cb (void);
+  void Timeout (void);
   
   Ptr<RandomVariableStream> m_rand;
   uint32_t m_population;
   uint32_t m_total;
   uint32_t m_count;
+  bool m_rearm;
+  std::vector<EventId> m_timeouts;
 };
 
 void
@@ -81,6 +113,7 @@ Bench::RunBench (void)
 
   DEB ("initializing");
   m_count = 0;
+  m_timeouts.assign (m_rearm ? m_population : 0, EventId ());
 
 
   time.Start ();
@@ -94,10 +127,12 @@ Bench::RunBench (void)
   DEB ("initialization took " << init << "s");
 
   DEB ("running");
+  uint64_t allocations = g_allocations;
   time.Start ();
   Simulator::Run ();
   simu = time.End ();
   simu /= 1000;
+  allocations = g_allocations - allocations;
   DEB ("run took " << simu << "s");
 
   LOG (std::setw (g_fwidth) << init <<
@@ -105,7 +140,8 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (init / m_population) <<
        std::setw (g_fwidth) << simu <<
        std::setw (g_fwidth) << (m_count / simu) <<
-       std::setw (g_fwidth) << (simu / m_count));
+       std::setw (g_fwidth) << (simu / m_count) <<
+       std::setw (g_fwidth) << (double (allocations) / m_count));
 
 }
 
@@ -120,16 +156,47 @@ Bench::Cb (void)
 
   Time after = NanoSeconds (m_rand->GetValue ());
   Simulator::Schedule (after, &Bench::Cb, this);
+  if (m_rearm)
+    {
+      // like a retransmission timer restarted by each ACK, which
+      // almost never expires
+      EventId &timeout = m_timeouts[m_count % m_population];
+      Simulator::Cancel (timeout);
+      timeout = Simulator::ScheduleTimeout (MilliSeconds (200), &Bench::Timeout, this);
+    }
   ++m_count;
 }
 
+void
+Bench::Timeout (void)
+{
+}
+
 
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, bool dc)
 {
   Ptr<RandomVariableStream> stream = 0;
   
-  if (filename == "")
+  if (dc)
+    {
+      // Relative event times of a data center network, in ns: packet
+      // serializations and propagations within a few us, delayed ACKs
+      // and queue samples within hundreds of us, and a few retransmission
+      // timeouts within hundreds of ms
+      LOGME ("using data center event distribution");
+      Ptr<EmpiricalRandomVariable> erv = CreateObject<EmpiricalRandomVariable> ();
+      erv->CDF (0, 0.0);
+      erv->CDF (120, 0.25);
+      erv->CDF (1200, 0.5);
+      erv->CDF (10000, 0.8);
+      erv->CDF (100000, 0.9);
+      erv->CDF (500000, 0.95);
+      erv->CDF (1000000, 0.95);
+      erv->CDF (200000000, 1.0);
+      stream = erv;
+    }
+  else if (filename == "")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
@@ -185,12 +252,16 @@ int main (int argc, char *argv[])
   bool schedCal  = false;
   bool schedHeap = false;
   bool schedList = false;
-  bool schedMap  = true;
+  bool schedMap  = false;
+  bool schedQuad = true;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  bool dc = false;
+  bool pool = true;
+  bool rearm = false;
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -198,28 +269,39 @@ int main (int argc, char *argv[])
              "Event intervals are taken from one of:\n"
              "  an exponential distribution, with mean 100 ns,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
-             "  or standard input, by the argument --file=\"-\"\n"
+             "  standard input, by the argument --file=\"-\",\n"
+             "  or a data center mix of us delays and rare ms timeouts, by --dc\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "The memory allocations per event of the simulation are\n"
+             "reported, with or without the reuse of the event memory.\n"
+             "With --rearm, each event also restarts one of pop timeouts\n"
+             "of 200 ms, like the retransmission timers of as many flows.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
-  cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("map",   "use MapScheduler",              schedMap);
+  cmd.AddValue ("quad",  "use QuadHeapScheduler (default)", schedQuad);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dc",    "use the data center distribution", dc);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("pool",  "reuse the event memory (default true)", pool);
+  cmd.AddValue ("rearm", "rearm a timeout on each event",  rearm);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
+  ObjectFactory factory ("ns3::QuadHeapScheduler");
+  if (schedMap)  { factory.SetTypeId ("ns3::MapScheduler");      }
   if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
   if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
   if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
   Simulator::SetScheduler (factory);
+  EventImpl::EnablePool (pool);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
@@ -228,22 +310,26 @@ int main (int argc, char *argv[])
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("event pool: " << (pool ? "on" : "off"));
+  LOGME ("timeouts: " << (rearm ? "rearmed" : "off"));
   
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRearm (rearm);
+  bench->SetRandomStream (GetRandomStream (filename, dc));
 
   // table header
   LOG ("");
   LOG (std::left << std::setw (g_fwidth) << "Run #" <<
        std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+       std::left << std::setw (4 * g_fwidth) << "Simulation:");
   LOG (std::left << std::setw (g_fwidth) << "" <<
        std::left << std::setw (g_fwidth) << "Time (s)" <<
        std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
        std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
        std::left << std::setw (g_fwidth) << "Time (s)" <<
        std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Alloc (/ev)" );
   LOG (std::setfill ('-') <<
        std::right << std::setw (g_fwidth) << " " <<
        std::right << std::setw (g_fwidth) << " " <<       
@@ -252,6 +338,7 @@ int main (int argc, char *argv[])
        std::right << std::setw (g_fwidth) << " " <<       
        std::right << std::setw (g_fwidth) << " " <<       
        std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
        std::setfill (' ')
        );
        